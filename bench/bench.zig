@@ -0,0 +1,315 @@
+//! `zig build bench -Doptimize=ReleaseFast [-- options]`
+//!
+//! Times the QVL algorithms and the L0 frame path on synthetic workloads
+//! (see generators.zig) and prints one JSON object per benchmark and size:
+//!
+//!   {"bench":"detect_betrayal","size":100000,"iters":20,"ops_per_sec":...,
+//!    "p50_ns":...,"p99_ns":...,"max_ns":...,"mode":"ReleaseFast"}
+//!
+//! `size` is edges for graph benchmarks and frames (or proofs) for the rest.
+//! Percentiles are exact over the per-operation samples. Options:
+//!   --max-edges N   largest graph (default 1000000; sizes are 10K/100K/1M)
+//!   --iters N       fixed iteration count for graph benchmarks
+//!   --filter S      only benchmarks whose name contains S
+//!   --dir PATH      scratch directory for the WAL (default .bench-wal)
+
+const std = @import("std");
+const builtin = @import("builtin");
+const qvl_ffi = @import("qvl_ffi");
+const lwf = @import("lwf");
+const opq = @import("opq");
+const gen = @import("generators.zig");
+
+const qvl = qvl_ffi.qvl;
+const ProofOfPath = qvl_ffi.pop_mod.ProofOfPath;
+const NodeId = qvl.types.NodeId;
+
+const graph_sizes = [_]usize{ 10_000, 100_000, 1_000_000 };
+const frame_count = 10_000;
+
+const Options = struct {
+    max_edges: usize = 1_000_000,
+    iters: ?usize = null,
+    filter: ?[]const u8 = null,
+    dir: []const u8 = ".bench-wal",
+
+    fn wants(self: *const Options, name: []const u8) bool {
+        const filter = self.filter orelse return true;
+        return std.mem.indexOf(u8, name, filter) != null;
+    }
+
+    fn wantsAny(self: *const Options, names: []const []const u8) bool {
+        for (names) |name| {
+            if (self.wants(name)) return true;
+        }
+        return false;
+    }
+
+    /// Graph iterations: fewer as graphs grow, so each size takes similar time
+    fn graphIters(self: *const Options, edges: usize) usize {
+        return self.iters orelse std.math.clamp(1_000_000 / edges, 3, 100);
+    }
+};
+
+/// Per-operation samples of one benchmark run
+const Run = struct {
+    samples: std.ArrayListUnmanaged(u64),
+
+    fn init(allocator: std.mem.Allocator, iters: usize) !Run {
+        return .{ .samples = try std.ArrayListUnmanaged(u64).initCapacity(allocator, iters) };
+    }
+
+    fn deinit(self: *Run, allocator: std.mem.Allocator) void {
+        self.samples.deinit(allocator);
+    }
+
+    fn start() std.time.Instant {
+        return std.time.Instant.now() catch unreachable;
+    }
+
+    fn stop(self: *Run, started: std.time.Instant) void {
+        const now = std.time.Instant.now() catch unreachable;
+        self.samples.appendAssumeCapacity(now.since(started));
+    }
+};
+
+const Reporter = struct {
+    out: *std.Io.Writer,
+
+    fn emit(self: *Reporter, name: []const u8, size: usize, run: *Run) !void {
+        const samples = run.samples.items;
+        if (samples.len == 0) return;
+        std.mem.sort(u64, samples, {}, std.sort.asc(u64));
+
+        var total: u64 = 0;
+        for (samples) |ns| total += ns;
+        const ops_per_sec = @as(f64, @floatFromInt(samples.len)) * std.time.ns_per_s /
+            @as(f64, @floatFromInt(@max(total, 1)));
+
+        try self.out.print(
+            "{{\"bench\":\"{s}\",\"size\":{d},\"iters\":{d},\"ops_per_sec\":{d:.1},\"p50_ns\":{d},\"p99_ns\":{d},\"max_ns\":{d},\"mode\":\"{s}\"}}\n",
+            .{ name, size, samples.len, ops_per_sec, percentile(samples, 50), percentile(samples, 99), samples[samples.len - 1], @tagName(builtin.mode) },
+        );
+        try self.out.flush();
+    }
+
+    /// Nearest-rank percentile of sorted samples
+    fn percentile(sorted: []const u64, percent: usize) u64 {
+        const rank = (sorted.len * percent + 99) / 100;
+        return sorted[@max(rank, 1) - 1];
+    }
+};
+
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+    const allocator = if (builtin.mode == .Debug) gpa.allocator() else std.heap.smp_allocator;
+
+    const args = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, args);
+
+    var options = Options{};
+    var i: usize = 1;
+    while (i < args.len) : (i += 1) {
+        const has_value = i + 1 < args.len;
+        if (std.mem.eql(u8, args[i], "--max-edges") and has_value) {
+            options.max_edges = try std.fmt.parseInt(usize, args[i + 1], 10);
+            i += 1;
+        } else if (std.mem.eql(u8, args[i], "--iters") and has_value) {
+            options.iters = try std.fmt.parseInt(usize, args[i + 1], 10);
+            i += 1;
+        } else if (std.mem.eql(u8, args[i], "--filter") and has_value) {
+            options.filter = args[i + 1];
+            i += 1;
+        } else if (std.mem.eql(u8, args[i], "--dir") and has_value) {
+            options.dir = args[i + 1];
+            i += 1;
+        } else {
+            std.debug.print("Unknown option: {s}\n", .{args[i]});
+            return error.InvalidArgument;
+        }
+    }
+
+    var buf: [1024]u8 = undefined;
+    var stdout = std.fs.File.stdout().writer(&buf);
+    var reporter = Reporter{ .out = &stdout.interface };
+
+    if (builtin.mode == .Debug) {
+        std.debug.print("bench: Debug build; use -Doptimize=ReleaseFast for real numbers\n", .{});
+    }
+
+    for (graph_sizes) |edges| {
+        if (edges > options.max_edges) break;
+        try benchGraph(allocator, &reporter, &options, edges);
+    }
+    if (options.wantsAny(&.{ "qvl_verify_pop", "qvl_verify_pop_cached" })) try benchVerifyPop(allocator, &reporter);
+    if (options.wantsAny(&.{ "lwf_encode", "lwf_decode" })) try benchFrameCodec(allocator, &reporter, &options);
+    if (options.wants("wal_append")) try benchWal(allocator, &reporter, &options);
+}
+
+fn benchGraph(allocator: std.mem.Allocator, reporter: *Reporter, options: *const Options, edges: usize) !void {
+    if (!options.wantsAny(&.{ "detect_betrayal", "find_trust_path", "run_inference" })) return;
+
+    var graph = try gen.scaleFreeGraph(allocator, .{ .edges = edges });
+    defer graph.deinit(allocator);
+    const iters = options.graphIters(edges);
+    var prng = std.Random.DefaultPrng.init(edges);
+    const random = prng.random();
+
+    if (options.wants("detect_betrayal")) {
+        var run = try Run.init(allocator, iters);
+        defer run.deinit(allocator);
+        for (0..iters) |n| {
+            const source = graph.ring_heads[n % graph.ring_heads.len];
+            const started = Run.start();
+            var result = try qvl.betrayal.detectBetrayal(&graph.risk, source, allocator);
+            run.stop(started);
+            result.deinit();
+        }
+        try reporter.emit("detect_betrayal", edges, &run);
+    }
+
+    if (options.wants("find_trust_path")) {
+        // Point queries are cheap: run many more of them
+        const path_iters = iters * 10;
+        var run = try Run.init(allocator, path_iters);
+        defer run.deinit(allocator);
+        for (0..path_iters) |_| {
+            const target = random.uintLessThan(NodeId, graph.nodes);
+            const started = Run.start();
+            var result = try qvl.pathfinding.findTrustPath(&graph.risk, 0, target, qvl.pathfinding.zeroHeuristic, &graph, allocator);
+            run.stop(started);
+            result.deinit();
+        }
+        try reporter.emit("find_trust_path", edges, &run);
+    }
+
+    if (options.wants("run_inference")) {
+        var run = try Run.init(allocator, iters);
+        defer run.deinit(allocator);
+        for (0..iters) |_| {
+            const started = Run.start();
+            var result = try qvl.inference.runInference(&graph.risk, .{}, allocator);
+            run.stop(started);
+            result.deinit();
+        }
+        try reporter.emit("run_inference", edges, &run);
+    }
+}
+
+/// qvl_verify_pop over two-hop proofs (root -> hub -> leaf). The first pass
+/// misses the verdict cache; the second hits it.
+fn benchVerifyPop(allocator: std.mem.Allocator, reporter: *Reporter) !void {
+    const hubs = 64;
+    const leaves_per_hub = 32;
+    const count = hubs * leaves_per_hub;
+
+    const ctx = qvl_ffi.qvl_init() orelse return error.InitFailed;
+    defer qvl_ffi.qvl_deinit(ctx);
+    const graph = &ctx.trust_graph;
+    const root = graph.getDid(graph.root_idx) orelse return error.NodeNotFound;
+
+    const senders = try allocator.alloc([32]u8, count);
+    defer allocator.free(senders);
+    for (0..hubs) |h| {
+        var hub_did = [_]u8{0} ** 32;
+        std.mem.writeInt(u32, hub_did[0..4], @intCast(h + 1), .little);
+        try graph.grantTrust(hub_did, .full, .friends, 0);
+        const hub_idx = graph.getNode(hub_did).?;
+        for (0..leaves_per_hub) |l| {
+            const sender = &senders[h * leaves_per_hub + l];
+            sender.* = hub_did;
+            sender[31] = 0xff;
+            std.mem.writeInt(u32, sender[4..8], @intCast(l + 1), .little);
+            const leaf_idx = try graph.getOrInsertNode(sender.*);
+            try graph.addEdge(hub_idx, .{ .target_idx = leaf_idx, .level = .full, .expires_at = 0, .visibility = .friends });
+        }
+    }
+
+    const proofs = try allocator.alloc([]u8, count);
+    var serialized: usize = 0;
+    defer {
+        for (proofs[0..serialized]) |bytes| allocator.free(bytes);
+        allocator.free(proofs);
+    }
+    for (senders, proofs) |sender, *bytes| {
+        var proof = (try ProofOfPath.construct(allocator, sender, root, graph)) orelse return error.NoPath;
+        defer proof.deinit();
+        bytes.* = try proof.serialize(allocator);
+        serialized += 1;
+    }
+
+    inline for (.{ "qvl_verify_pop", "qvl_verify_pop_cached" }) |name| {
+        var run = try Run.init(allocator, count);
+        defer run.deinit(allocator);
+        for (senders, proofs) |*sender, bytes| {
+            const started = Run.start();
+            const verdict = qvl_ffi.qvl_verify_pop(ctx, bytes.ptr, bytes.len, sender, &root);
+            run.stop(started);
+            if (verdict != .valid) return error.UnexpectedVerdict;
+        }
+        try reporter.emit(name, count, &run);
+    }
+}
+
+fn benchFrameCodec(allocator: std.mem.Allocator, reporter: *Reporter, options: *const Options) !void {
+    const frames = try gen.frameStream(allocator, .{ .count = frame_count });
+    defer gen.freeFrames(allocator, frames);
+
+    const encoded = try allocator.alloc([]u8, frames.len);
+    var done: usize = 0;
+    defer {
+        for (encoded[0..done]) |bytes| allocator.free(bytes);
+        allocator.free(encoded);
+    }
+
+    if (options.wants("lwf_encode")) {
+        var run = try Run.init(allocator, frames.len);
+        defer run.deinit(allocator);
+        var wire: [2048]u8 = undefined;
+        for (frames) |*frame| {
+            const started = Run.start();
+            const len = try frame.encodeInto(&wire);
+            run.stop(started);
+            std.mem.doNotOptimizeAway(wire[len - 1]);
+        }
+        try reporter.emit("lwf_encode", frames.len, &run);
+    }
+
+    if (options.wants("lwf_decode")) {
+        for (frames, encoded) |*frame, *bytes| {
+            bytes.* = try frame.encode(allocator);
+            done += 1;
+        }
+        var run = try Run.init(allocator, frames.len);
+        defer run.deinit(allocator);
+        for (encoded) |bytes| {
+            const started = Run.start();
+            const frame = try lwf.LWFFrame.decode(allocator, bytes);
+            run.stop(started);
+            frame.deinit(allocator);
+        }
+        try reporter.emit("lwf_decode", frames.len, &run);
+    }
+}
+
+/// Write-through WALStore.appendFrame into a fresh scratch directory
+fn benchWal(allocator: std.mem.Allocator, reporter: *Reporter, options: *const Options) !void {
+    std.fs.cwd().deleteTree(options.dir) catch {};
+    defer std.fs.cwd().deleteTree(options.dir) catch {};
+
+    const frames = try gen.frameStream(allocator, .{ .count = frame_count });
+    defer gen.freeFrames(allocator, frames);
+
+    var store = try opq.store.WALStore.init(allocator, options.dir, 64 * 1024 * 1024);
+    defer store.deinit();
+
+    var run = try Run.init(allocator, frames.len);
+    defer run.deinit(allocator);
+    for (frames) |*frame| {
+        const started = Run.start();
+        _ = try store.appendFrame(frame);
+        run.stop(started);
+    }
+    try reporter.emit("wal_append", frames.len, &run);
+}
@@ -0,0 +1,167 @@
+//! Synthetic workloads for `zig build bench`
+//!
+//! Trust graphs grow by preferential attachment (each new node links to
+//! `links_per_node` endpoints picked in proportion to their degree), which
+//! gives the heavy-tailed hub structure real vouch graphs show. A few short
+//! negative cycles are planted afterwards so betrayal detection has work to
+//! find. Frame streams carry random payloads with MTU-like sizes. Both are
+//! seeded, so runs are comparable across builds.
+
+const std = @import("std");
+const qvl_ffi = @import("qvl_ffi");
+const lwf = @import("lwf");
+const time = @import("time");
+
+const qvl = qvl_ffi.qvl;
+const RiskGraph = qvl.types.RiskGraph;
+const RiskEdge = qvl.types.RiskEdge;
+const NodeId = qvl.types.NodeId;
+
+pub const GraphConfig = struct {
+    /// Total edges, including ring edges
+    edges: usize,
+    links_per_node: usize = 4,
+    /// Planted rings per 10K edges (at least one)
+    betrayal_rings_per_10k: usize = 1,
+    seed: u64 = 0x51ab1e,
+};
+
+pub const Graph = struct {
+    risk: RiskGraph,
+    nodes: NodeId,
+    /// First node of every planted ring
+    ring_heads: []NodeId,
+
+    pub fn deinit(self: *Graph, allocator: std.mem.Allocator) void {
+        self.risk.deinit();
+        allocator.free(self.ring_heads);
+    }
+};
+
+/// Scale-free risk graph with planted betrayal rings
+pub fn scaleFreeGraph(allocator: std.mem.Allocator, config: GraphConfig) !Graph {
+    std.debug.assert(config.links_per_node > 0 and config.edges > config.links_per_node * 8);
+    var prng = std.Random.DefaultPrng.init(config.seed);
+    const random = prng.random();
+
+    const ring_count = @max(1, config.edges / 10_000 * config.betrayal_rings_per_10k);
+    const ring_len_max = 5;
+    const vouch_edges = config.edges - ring_count * ring_len_max;
+
+    var edges = try std.ArrayListUnmanaged(RiskEdge).initCapacity(allocator, config.edges);
+    defer edges.deinit(allocator);
+    // Every edge endpoint once: picking uniformly from it is picking by degree
+    var endpoints = try std.ArrayListUnmanaged(NodeId).initCapacity(allocator, 2 * config.edges);
+    defer endpoints.deinit(allocator);
+
+    // Seed clique so the first attachments have somewhere to go
+    const m = config.links_per_node;
+    var nodes: NodeId = @intCast(m + 1);
+    for (0..nodes) |a| {
+        for (0..nodes) |b| {
+            if (a == b) continue;
+            edges.appendAssumeCapacity(vouch(random, @intCast(a), @intCast(b)));
+            endpoints.appendAssumeCapacity(@intCast(a));
+            endpoints.appendAssumeCapacity(@intCast(b));
+        }
+    }
+
+    var picked: [16]NodeId = undefined;
+    std.debug.assert(m <= picked.len);
+    while (edges.items.len + m <= vouch_edges) : (nodes += 1) {
+        const node = nodes;
+        var count: usize = 0;
+        while (count < m) {
+            const target = endpoints.items[random.uintLessThan(usize, endpoints.items.len)];
+            if (std.mem.indexOfScalar(NodeId, picked[0..count], target) != null) continue;
+            picked[count] = target;
+            count += 1;
+        }
+        for (picked[0..m]) |target| {
+            // Either direction, so hubs reach the periphery as well
+            const link = if (random.boolean()) vouch(random, node, target) else vouch(random, target, node);
+            edges.appendAssumeCapacity(link);
+            endpoints.appendAssumeCapacity(node);
+            endpoints.appendAssumeCapacity(target);
+        }
+    }
+
+    const ring_heads = try allocator.alloc(NodeId, ring_count);
+    errdefer allocator.free(ring_heads);
+    for (ring_heads) |*head| {
+        const len = random.intRangeAtMost(usize, 3, ring_len_max);
+        var ring: [ring_len_max]NodeId = undefined;
+        for (ring[0..len]) |*member| member.* = random.uintLessThan(NodeId, nodes);
+        for (0..len) |i| {
+            const from = ring[i];
+            const to = ring[(i + 1) % len];
+            if (from == to) continue;
+            edges.appendAssumeCapacity(makeEdge(from, to, -0.4 - 0.5 * random.float(f64), 1));
+        }
+        head.* = ring[0];
+    }
+
+    var risk = RiskGraph.init(allocator);
+    errdefer risk.deinit();
+    // Algorithms iterate `nodes`, not adjacency keys: register every node
+    try risk.nodes.ensureTotalCapacity(allocator, nodes);
+    for (0..nodes) |node| try risk.addNode(@intCast(node));
+    try risk.addEdges(edges.items);
+    return .{ .risk = risk, .nodes = nodes, .ring_heads = ring_heads };
+}
+
+fn vouch(random: std.Random, from: NodeId, to: NodeId) RiskEdge {
+    return makeEdge(from, to, 0.1 + 0.9 * random.float(f64), 3);
+}
+
+fn makeEdge(from: NodeId, to: NodeId, risk: f64, level: u8) RiskEdge {
+    const epoch = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+    return .{
+        .from = from,
+        .to = to,
+        .risk = risk,
+        .timestamp = epoch,
+        .nonce = (@as(u64, from) << 32) | to,
+        .level = level,
+        .expires_at = epoch,
+    };
+}
+
+pub const FrameConfig = struct {
+    count: usize,
+    min_payload: usize = 64,
+    /// Fits a 1280-byte IPv6 minimum MTU with header and trailer
+    max_payload: usize = 1280 - lwf.LWFHeader.SIZE - lwf.LWFTrailer.SIZE,
+    seed: u64 = 0xf4a3e,
+};
+
+/// Frames with random payloads, valid checksums and increasing sequence
+pub fn frameStream(allocator: std.mem.Allocator, config: FrameConfig) ![]lwf.LWFFrame {
+    var prng = std.Random.DefaultPrng.init(config.seed);
+    const random = prng.random();
+
+    const frames = try allocator.alloc(lwf.LWFFrame, config.count);
+    var built: usize = 0;
+    errdefer {
+        for (frames[0..built]) |*frame| frame.deinit(allocator);
+        allocator.free(frames);
+    }
+
+    for (frames, 0..) |*frame, i| {
+        const len = random.intRangeAtMost(usize, config.min_payload, config.max_payload);
+        frame.* = try lwf.LWFFrame.init(allocator, len);
+        built += 1;
+        random.bytes(frame.payload);
+        random.bytes(&frame.header.session_id);
+        frame.header.service_type = lwf.LWFHeader.ServiceType.DATA_TRANSPORT;
+        frame.header.payload_len = @intCast(len);
+        frame.header.sequence = @intCast(i);
+        frame.updateChecksum();
+    }
+    return frames;
+}
+
+pub fn freeFrames(allocator: std.mem.Allocator, frames: []lwf.LWFFrame) void {
+    for (frames) |*frame| frame.deinit(allocator);
+    allocator.free(frames);
+}
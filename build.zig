@@ -283,6 +283,7 @@ pub fn build(b: *std.Build) void {
         .root_module = l4_feed_mod,
     });
     l4_feed_tests.linkLibC(); // Required for DuckDB C API
+    l4_feed_tests.linkSystemLibrary("duckdb");
     const run_l4_feed_tests = b.addRunArtifact(l4_feed_tests);
 
     // ========================================================================
@@ -509,6 +510,41 @@ pub fn build(b: *std.Build) void {
     l1_qvl_ffi_tests.linkLibC(); // Required for C allocator
     const run_l1_qvl_ffi_tests = b.addRunArtifact(l1_qvl_ffi_tests);
 
+    // L2 Session tests (handshake, resumption, worker pool)
+    const l2_session_mod = b.createModule(.{
+        .root_source_file = b.path("core/l2_session/mod.zig"),
+        .target = target,
+        .optimize = optimize,
+    });
+    l2_session_mod.addImport("pqxdh", l1_pqxdh_mod);
+
+    const l2_session_tests = b.addTest(.{
+        .root_module = l2_session_mod,
+    });
+    l2_session_tests.linkLibC();
+    l2_session_tests.addIncludePath(b.path("vendor/liboqs/install/include"));
+    l2_session_tests.addLibraryPath(b.path("vendor/liboqs/install/lib"));
+    l2_session_tests.linkSystemLibrary("oqs");
+    const run_l2_session_tests = b.addRunArtifact(l2_session_tests);
+
+    const l2_session_step = b.step("test-l2-session", "Run L2 session tests");
+    l2_session_step.dependOn(&run_l2_session_tests.step);
+
+    // Capsule gossip transport tests (UTCP adapter for the gossip FanOut)
+    const capsule_gossip_mod = b.createModule(.{
+        .root_source_file = b.path("capsule-core/src/gossip_transport.zig"),
+        .target = target,
+        .optimize = optimize,
+    });
+    capsule_gossip_mod.addImport("l0_transport", l0_mod);
+    capsule_gossip_mod.addImport("qvl", l1_qvl_mod);
+
+    const capsule_gossip_tests = b.addTest(.{
+        .root_module = capsule_gossip_mod,
+    });
+    capsule_gossip_tests.linkLibC();
+    const run_capsule_gossip_tests = b.addRunArtifact(capsule_gossip_tests);
+
     // NOTE: C test harness (test_qvl_ffi.c) can be compiled manually:
     // zig cc -I. l1-identity/test_qvl_ffi.c zig-out/lib/libqvl_ffi.a -o test_qvl_ffi
 
@@ -535,6 +571,8 @@ pub fn build(b: *std.Build) void {
     test_step.dependOn(&run_l1_qvl_tests.step);
     test_step.dependOn(&run_l1_qvl_ffi_tests.step);
     test_step.dependOn(&run_l2_policy_tests.step);
+    test_step.dependOn(&run_l2_session_tests.step);
+    test_step.dependOn(&run_capsule_gossip_tests.step);
     test_step.dependOn(&run_l4_feed_tests.step);
     test_step.dependOn(&run_png_tests.step);
     test_step.dependOn(&run_transport_skins_tests.step);
@@ -585,6 +623,32 @@ pub fn build(b: *std.Build) void {
     const run_crypto_step = b.step("run-crypto", "Run encryption example");
     run_crypto_step.dependOn(&run_crypto_example.step);
 
+    // ========================================================================
+    // Benchmarks: zig build bench -Doptimize=ReleaseFast [-- --max-edges N]
+    // ========================================================================
+    const bench_mod = b.createModule(.{
+        .root_source_file = b.path("bench/bench.zig"),
+        .target = target,
+        .optimize = optimize,
+    });
+    bench_mod.addImport("qvl_ffi", l1_qvl_ffi_mod);
+    bench_mod.addImport("lwf", l0_mod);
+    bench_mod.addImport("opq", opq_mod);
+    bench_mod.addImport("time", time_mod);
+
+    const bench_exe = b.addExecutable(.{
+        .name = "bench",
+        .root_module = bench_mod,
+    });
+    bench_exe.linkLibC(); // QVL FFI uses the C allocator
+
+    const run_bench = b.addRunArtifact(bench_exe);
+    if (b.args) |args| {
+        run_bench.addArgs(args);
+    }
+    const bench_step = b.step("bench", "Run QVL and L0 benchmarks (JSON lines on stdout)");
+    bench_step.dependOn(&run_bench.step);
+
     // ========================================================================
     // Capsule Core (Phase 10) Reference Implementation
     // ========================================================================
@@ -33,6 +33,9 @@ pub const NodeConfig = struct {
     /// QVL minimum trust score for relay selection
     relay_trust_threshold: f64 = 0.5,
 
+    /// Drive the node with io_uring instead of poll (Linux 6.0+, falls back to poll)
+    io_uring: bool = false,
+
     /// Free allocated memory (strings, slices)
     pub fn deinit(self: *NodeConfig, allocator: std.mem.Allocator) void {
         allocator.free(self.data_dir);
@@ -113,6 +116,7 @@ pub const NodeConfig = struct {
             .bootstrap_peers = try peers.toOwnedSlice(),
             .log_level = cfg.log_level,
             .gateway_enabled = cfg.gateway_enabled,
+            .io_uring = cfg.io_uring,
         };
     }
 
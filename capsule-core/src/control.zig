@@ -43,6 +43,8 @@ pub const Command = union(enum) {
     RelayControl: RelayControlArgs,
     /// Get Relay Stats
     RelayStats: void,
+    /// Per-stage latency histograms and heap counters
+    Stats: void,
     /// Build Circuit and Send Message
     RelaySend: RelaySendArgs,
 };
@@ -118,6 +120,8 @@ pub const Response = union(enum) {
     Error: []const u8,
     /// Relay Statistics
     RelayStatsInfo: RelayStatsInfo,
+    /// Pipeline statistics
+    StatsInfo: NodeStats,
 };
 
 pub const NodeStatus = struct {
@@ -197,3 +201,19 @@ pub const RelayStatsInfo = struct {
     packets_dropped: u64,
     trust_threshold: f64,
 };
+
+pub const StageStats = struct {
+    name: []const u8,
+    calls: u64,
+    total_ns: u64,
+    max_ns: u64,
+    /// Histogram bucket bounds (within 2x)
+    p50_ns: u64,
+    p99_ns: u64,
+};
+
+pub const NodeStats = struct {
+    stages: []const StageStats,
+    /// Null when the daemon does not count allocations
+    heap: ?qvl.metrics.AllocStats,
+};
@@ -6,7 +6,7 @@ const net = std.net;
 const l0_transport = @import("l0_transport");
 const lwf = l0_transport.lwf;
 
-pub const VERSION: u32 = 2;
+pub const VERSION: u32 = 3;
 pub const SERVICE_TYPE: u16 = lwf.LWFHeader.ServiceType.IDENTITY_SIGNAL;
 
 pub const DhtNode = struct {
@@ -42,8 +42,11 @@ pub const FederationMessage = union(enum) {
     },
     dht_find_node: struct {
         target_id: [32]u8,
+        /// Echoed by the answer (0 = not part of a lookup)
+        txid: u32 = 0,
     },
     dht_nodes: struct {
+        txid: u32,
         nodes: []const DhtNode,
     },
     // Gateway Coordination
@@ -76,8 +79,10 @@ pub const FederationMessage = union(enum) {
             },
             .dht_find_node => |f| {
                 try writer.writeAll(&f.target_id);
+                try writer.writeInt(u32, f.txid, .big);
             },
             .dht_nodes => |n| {
+                try writer.writeInt(u32, n.txid, .big);
                 try writer.writeInt(u16, @intCast(n.nodes.len), .big);
                 for (n.nodes) |node| {
                     try writer.writeAll(&node.id);
@@ -139,9 +144,11 @@ pub const FederationMessage = union(enum) {
             .dht_find_node => .{
                 .dht_find_node = .{
                     .target_id = try reader.readBytesNoEof(32),
+                    .txid = try reader.readInt(u32, .big),
                 },
             },
             .dht_nodes => {
+                const txid = try reader.readInt(u32, .big);
                 const count = try reader.readInt(u16, .big);
                 const nodes = try allocator.alloc(DhtNode, count);
                 for (0..count) |i| {
@@ -155,7 +162,7 @@ pub const FederationMessage = union(enum) {
                         .key = key,
                     };
                 }
-                return .{ .dht_nodes = .{ .nodes = nodes } };
+                return .{ .dht_nodes = .{ .txid = txid, .nodes = nodes } };
             },
             .hole_punch_request => .{
                 .hole_punch_request = .{
@@ -0,0 +1,123 @@
+//! Gossip over UTCP
+//!
+//! Adapts `qvl.gossip.Transport` to `UTCP.sendFrame`: every batch a
+//! `FanOut` hands over becomes one IDENTITY_SIGNAL frame, addressed through
+//! a NodeId -> address table the node keeps in step with its peers.
+
+const std = @import("std");
+const l0_transport = @import("l0_transport");
+const qvl = @import("qvl");
+
+const gossip = qvl.gossip;
+const NodeId = qvl.types.NodeId;
+const UTCP = l0_transport.utcp.UTCP;
+const LWFFrame = l0_transport.lwf.LWFFrame;
+const LWFHeader = l0_transport.lwf.LWFHeader;
+const LWFTrailer = l0_transport.lwf.LWFTrailer;
+
+pub const UtcpGossip = struct {
+    allocator: std.mem.Allocator,
+    socket: *UTCP,
+    /// Gossip neighbors' datagram addresses
+    peers: std.AutoHashMapUnmanaged(NodeId, std.net.Address) = .{},
+    /// Written to every frame's source_hint
+    source_hint: [24]u8,
+    sequence: u32 = 0,
+    /// Batches dropped: unknown neighbor, allocation or socket failure
+    send_failures: u64 = 0,
+
+    pub fn init(allocator: std.mem.Allocator, socket: *UTCP, source_hint: [24]u8) UtcpGossip {
+        return .{ .allocator = allocator, .socket = socket, .source_hint = source_hint };
+    }
+
+    pub fn deinit(self: *UtcpGossip) void {
+        self.peers.deinit(self.allocator);
+    }
+
+    pub fn setPeer(self: *UtcpGossip, node: NodeId, address: std.net.Address) !void {
+        try self.peers.put(self.allocator, node, address);
+    }
+
+    pub fn removePeer(self: *UtcpGossip, node: NodeId) void {
+        _ = self.peers.remove(node);
+    }
+
+    /// Transport for a FanOut; `self` must outlive it
+    pub fn transport(self: *UtcpGossip) gossip.Transport {
+        return .{ .context = self, .send_fn = send };
+    }
+
+    fn send(ctx: ?*anyopaque, neighbor: NodeId, payload: []const u8) void {
+        const self: *UtcpGossip = @ptrCast(@alignCast(ctx.?));
+        self.sendBatch(neighbor, payload) catch |err| {
+            self.send_failures += 1;
+            std.log.debug("Gossip: batch for node {d} dropped: {}", .{ neighbor, err });
+        };
+    }
+
+    fn sendBatch(self: *UtcpGossip, neighbor: NodeId, payload: []const u8) !void {
+        const address = self.peers.get(neighbor) orelse return error.UnknownPeer;
+        if (payload.len > std.math.maxInt(u16)) return error.PayloadTooLarge;
+
+        // Borrows the FanOut's batch; sendFrame only reads the payload
+        var frame = LWFFrame{
+            .header = LWFHeader.init(),
+            .payload = @constCast(payload),
+            .trailer = LWFTrailer.init(),
+        };
+        frame.header.service_type = LWFHeader.ServiceType.IDENTITY_SIGNAL;
+        frame.header.source_hint = self.source_hint;
+        frame.header.payload_len = @intCast(payload.len);
+        frame.header.sequence = self.sequence;
+        self.sequence +%= 1;
+        frame.updateChecksum();
+        try self.socket.sendFrame(address, &frame, self.allocator);
+    }
+};
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+test "UtcpGossip delivers a FanOut batch as one frame" {
+    const allocator = std.testing.allocator;
+    const loopback = try std.net.Address.parseIp("127.0.0.1", 0);
+
+    var tx_socket = try UTCP.init(allocator, loopback);
+    defer tx_socket.deinit();
+    var rx_socket = try UTCP.init(allocator, loopback);
+    defer rx_socket.deinit();
+
+    var adapter = UtcpGossip.init(allocator, &tx_socket, [_]u8{0x11} ** 24);
+    defer adapter.deinit();
+    try adapter.setPeer(7, try rx_socket.getLocalAddress());
+
+    var fanout = gossip.FanOut.init(allocator, adapter.transport(), gossip.FanOut.DEFAULT_MAX_BATCH);
+    defer fanout.deinit();
+
+    const refs = [_]u64{42};
+    for (0..3) |i| {
+        const msg = gossip.GossipMessage{ .id = 100 + i, .sender = 1, .refs = &refs, .msg_type = .heartbeat, .entropy_stamp = i, .payload = "trust" };
+        try fanout.enqueue(7, &msg);
+    }
+    // No address: counted, not fatal
+    const lost = gossip.GossipMessage{ .id = 9, .sender = 1, .refs = &refs, .msg_type = .heartbeat, .entropy_stamp = 0, .payload = "" };
+    try fanout.enqueue(8, &lost);
+    fanout.flush();
+    try std.testing.expectEqual(@as(u64, 1), adapter.send_failures);
+
+    var buf: [2048]u8 = undefined;
+    const received = try rx_socket.receiveFrame(allocator, &buf);
+    defer received.frame.deinit(allocator);
+    try std.testing.expectEqual(LWFHeader.ServiceType.IDENTITY_SIGNAL, received.frame.header.service_type);
+    try std.testing.expectEqual(@as(u8, 0x11), received.frame.header.source_hint[0]);
+
+    var it = gossip.BatchIterator{ .data = received.frame.payload };
+    var count: u64 = 0;
+    while (try it.next()) |decoded| : (count += 1) {
+        try std.testing.expectEqual(100 + count, decoded.id);
+        try std.testing.expectEqualStrings("trust", decoded.payload);
+        try std.testing.expectEqual(@as(u64, 42), decoded.refAt(0));
+    }
+    try std.testing.expectEqual(@as(u64, 3), count);
+}
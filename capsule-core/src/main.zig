@@ -113,6 +113,8 @@ pub fn main() !void {
         try runCliCommand(allocator, .Sessions, data_dir_override);
     } else if (std.mem.eql(u8, command, "dht")) {
         try runCliCommand(allocator, .Dht, data_dir_override);
+    } else if (std.mem.eql(u8, command, "stats")) {
+        try runCliCommand(allocator, .Stats, data_dir_override);
     } else if (std.mem.eql(u8, command, "qvl-query")) {
         var target_did: ?[]const u8 = null;
         if (args.len >= cmd_idx + 2) {
@@ -167,6 +169,7 @@ fn printUsage() void {
         \\  trust      <did> <score>              Set trust override
         \\  sessions                              List active sessions
         \\  dht                                   Show DHT status
+        \\  stats                                 Pipeline latency and heap counters (JSON)
         \\  qvl-query  [did]                      Query QVL metrics
         \\  identity                              Show node identity
         \\  lockdown                              Emergency network lockdown
@@ -190,10 +193,7 @@ fn runDaemon(allocator: std.mem.Allocator, port_override: ?u16, data_dir_overrid
                 allocator.free(cfg.data_dir);
                 cfg.data_dir = try allocator.dupe(u8, d);
             }
-            const node = try node_mod.CapsuleNode.init(allocator, cfg);
-            defer node.deinit();
-            try node.start();
-            return;
+            return runNode(allocator, cfg);
         }
         std.log.err("Failed to load configuration: {}", .{err});
         return err;
@@ -207,9 +207,17 @@ fn runDaemon(allocator: std.mem.Allocator, port_override: ?u16, data_dir_overrid
         config.data_dir = try allocator.dupe(u8, d);
     }
 
+    return runNode(allocator, config);
+}
+
+fn runNode(allocator: std.mem.Allocator, config: config_mod.NodeConfig) !void {
+    // Count the daemon's heap traffic for the Stats command
+    var counting = node_mod.metrics.CountingAllocator{ .child = allocator };
+
     // Initialize Node
-    const node = try node_mod.CapsuleNode.init(allocator, config);
+    const node = try node_mod.CapsuleNode.init(counting.allocator(), config);
     defer node.deinit();
+    node.alloc_stats = &counting;
 
     // Run Node
     try node.start();
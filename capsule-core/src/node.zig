@@ -15,11 +15,18 @@ const qvl_store_mod = @import("qvl_store.zig");
 const control_mod = @import("control.zig");
 const circuit_mod = @import("circuit.zig");
 const relay_service_mod = @import("relay_service.zig");
+const uring_loop = @import("uring_loop.zig");
+const frame_shards = @import("frame_shards.zig");
+const gossip_transport = @import("gossip_transport.zig");
+const qvl = @import("qvl");
 
 const NodeConfig = config_mod.NodeConfig;
 const UTCP = l0_transport.utcp.UTCP;
+const RecvBatch = l0_transport.utcp.RecvBatch;
+const SendBatch = l0_transport.utcp.SendBatch;
 const SoulKey = l1_identity.soulkey.SoulKey;
-const RiskGraph = l1_identity.qvl.types.RiskGraph;
+const PersistentGraph = l1_identity.qvl.storage.PersistentGraph;
+pub const metrics = l1_identity.qvl.metrics;
 const DhtService = l0_transport.dht.DhtService;
 const Gateway = l0_transport.gateway.Gateway;
 const Quarantine = l0_transport.quarantine;
@@ -29,6 +36,45 @@ const PeerTable = peer_table_mod.PeerTable;
 const PeerSession = fed.PeerSession;
 const StorageService = storage_mod.StorageService;
 const QvlStore = qvl_store_mod.QvlStore;
+const gossip = qvl.gossip;
+const UtcpGossip = gossip_transport.UtcpGossip;
+
+/// Datagrams drained per UTCP receive syscall
+const UTCP_BATCH = 32;
+/// Receive rounds per poll wakeup before servicing other sockets
+const UTCP_MAX_ROUNDS = 4;
+/// Frames queued per shard before the event loop starts dropping
+const SHARD_QUEUE = 1024;
+/// Event loop tick (10Hz)
+pub const TICK_MS = 100;
+/// Relay sessions idle this long (seconds) are dropped
+const RELAY_SESSION_MAX_AGE = 3600;
+/// Nodes per FIND_NODE answer (16 IPv4 entries fit one UTCP datagram)
+const DHT_REPLY_NODES = 16;
+/// Random-target lookups per refresh, besides the self-lookup
+const DHT_REFRESH_LOOKUPS = 3;
+/// Refs a gossip message can carry (the wire count is one byte)
+const GOSSIP_MAX_REFS = 255;
+
+/// Pipeline stages timed for the Stats control command
+pub const Stage = enum {
+    /// One receive (recvmmsg round or io_uring completion) plus triage
+    /// of its datagrams
+    utcp_receive,
+    /// Parse, policy check and shard hand-off of one datagram
+    dispatch,
+    relay_forward,
+    federation,
+    qvl_sync,
+    control,
+};
+
+/// Tick counters for the periodic subsystems
+pub const TickTimers = struct {
+    discovery: usize = 0,
+    dht: usize = 0,
+    qvl_sync: usize = 0,
+};
 
 pub const AddressContext = struct {
     pub fn hash(self: AddressContext, s: std.net.Address) u64 {
@@ -44,13 +90,25 @@ pub const AddressContext = struct {
     }
 };
 
+const FrameShards = frame_shards.FrameShards(*CapsuleNode, CapsuleNode.processShardItem, CapsuleNode.flushRelay);
+
 pub const CapsuleNode = struct {
     allocator: std.mem.Allocator,
     config: NodeConfig,
 
     // Subsystems
     utcp: UTCP,
-    risk_graph: RiskGraph,
+    recv_batch: RecvBatch,
+    /// Relayed onions queued by the frame workers; sent in one sendmmsg
+    /// at the end of each worker pass (`flushRelay`)
+    relay_batch: SendBatch,
+    relay_mutex: std.Thread.Mutex = .{},
+    /// Flow-affine frame workers (fed by the event loop)
+    shards: *FrameShards,
+    /// Risk graph with its edge log and CSR checkpoints (data_dir/qvl-graph).
+    /// The node owns the directory for its lifetime (the store locks it);
+    /// an FFI context in the same process needs a different store_path.
+    graph_store: PersistentGraph,
     discovery: DiscoveryService,
     peer_table: PeerTable,
     sessions: std.HashMap(std.net.Address, PeerSession, AddressContext, std.hash_map.default_max_load_percentage),
@@ -58,6 +116,14 @@ pub const CapsuleNode = struct {
     gateway: ?Gateway,
     relay_service: ?relay_service_mod.RelayService,
     circuit_builder: ?circuit_mod.CircuitBuilder,
+    /// Gossip batches to federated sessions as IDENTITY_SIGNAL frames;
+    /// queued on `gossip_fanout`, flushed every tick
+    gossip_transport: UtcpGossip,
+    gossip_fanout: gossip.FanOut,
+    gossip_state: gossip.GossipState,
+    /// Session address -> gossip neighbor id (local numbering, not a DID)
+    gossip_neighbors: std.HashMap(std.net.Address, qvl.types.NodeId, AddressContext, std.hash_map.default_max_load_percentage),
+    next_gossip_neighbor: qvl.types.NodeId = 0,
     policy_engine: PolicyEngine,
     thread_pool: std.Thread.Pool,
     state_mutex: std.Thread.Mutex,
@@ -66,8 +132,13 @@ pub const CapsuleNode = struct {
     control_socket: std.net.Server,
     identity: SoulKey,
 
-    running: bool,
+    /// Cleared by `stop` or a control Shutdown, possibly off the loop thread
+    running: std.atomic.Value(bool),
     global_state: Quarantine.GlobalState,
+    /// Per-stage latency histograms
+    stats: metrics.StageStats(Stage) = .{},
+    /// Daemon heap counters, when the owner allocates through one
+    alloc_stats: ?*const metrics.CountingAllocator = null,
     dht_timer: i64 = 0,
     qvl_timer: i64 = 0,
 
@@ -86,9 +157,13 @@ pub const CapsuleNode = struct {
         // Initialize L0 (UTCP)
         const address = try std.net.Address.parseIp("0.0.0.0", config.port);
         const utcp_instance = try UTCP.init(allocator, address);
+        const recv_batch = try RecvBatch.init(allocator, UTCP_BATCH, 1500);
+        const relay_batch = try SendBatch.init(allocator, UTCP_BATCH, 1500);
 
-        // Initialize L1 (RiskGraph)
-        const risk_graph = RiskGraph.init(allocator);
+        // Initialize L1 (RiskGraph, reloaded from the last checkpoint + log)
+        const graph_path = try std.fs.path.join(allocator, &[_][]const u8{ config.data_dir, "qvl-graph" });
+        defer allocator.free(graph_path);
+        const graph_store = try PersistentGraph.open(graph_path, .{}, allocator);
 
         // Initialize Discovery (mDNS)
         const discovery = try DiscoveryService.init(allocator, config.port);
@@ -101,6 +176,9 @@ pub const CapsuleNode = struct {
         // Initialize Policy Engine
         const policy_engine = PolicyEngine.init(allocator);
 
+        // Initialize Gossip (dedup and coverage state; transport bound below)
+        const gossip_state = try gossip.GossipState.init(allocator, .{});
+
         // Initialize Storage
         const db_path = try std.fs.path.join(allocator, &[_][]const u8{ config.data_dir, "capsule.db" });
         defer allocator.free(db_path);
@@ -167,7 +245,10 @@ pub const CapsuleNode = struct {
             .allocator = allocator,
             .config = config,
             .utcp = utcp_instance,
-            .risk_graph = risk_graph,
+            .recv_batch = recv_batch,
+            .relay_batch = relay_batch,
+            .shards = undefined, // Started below
+            .graph_store = graph_store,
             .discovery = discovery,
             .peer_table = PeerTable.init(allocator),
             .sessions = std.HashMap(std.net.Address, PeerSession, AddressContext, 80).init(allocator),
@@ -175,6 +256,10 @@ pub const CapsuleNode = struct {
             .gateway = null, // Initialized below
             .relay_service = null, // Initialized below
             .circuit_builder = null, // Initialized below
+            .gossip_transport = undefined, // Initialized below
+            .gossip_fanout = undefined, // Initialized below
+            .gossip_state = gossip_state,
+            .gossip_neighbors = std.HashMap(std.net.Address, qvl.types.NodeId, AddressContext, 80).init(allocator),
             .policy_engine = policy_engine,
             .thread_pool = thread_pool,
             .state_mutex = .{},
@@ -182,12 +267,18 @@ pub const CapsuleNode = struct {
             .qvl_store = qvl_store,
             .control_socket = control_socket,
             .identity = identity,
-            .running = false,
+            .running = std.atomic.Value(bool).init(false),
             .global_state = Quarantine.GlobalState{},
         };
         // Initialize DHT in place
         self.dht = DhtService.init(allocator, node_id);
 
+        // Gossip sends through our own socket; both live inside `self`
+        var source_hint = [_]u8{0} ** 24;
+        @memcpy(source_hint[0..24], identity.did[0..24]);
+        self.gossip_transport = UtcpGossip.init(allocator, &self.utcp, source_hint);
+        self.gossip_fanout = gossip.FanOut.init(allocator, self.gossip_transport.transport(), gossip.FanOut.DEFAULT_MAX_BATCH);
+
         // Initialize Gateway (now safe to reference self.dht)
         if (config.gateway_enabled) {
             self.gateway = Gateway.init(allocator, &self.dht);
@@ -214,6 +305,10 @@ pub const CapsuleNode = struct {
         self.dht_timer = std.time.milliTimestamp();
         self.qvl_timer = std.time.milliTimestamp();
 
+        // Start frame workers last: they call back into the node
+        const shard_count = std.Thread.getCpuCount() catch 1;
+        self.shards = try FrameShards.init(allocator, self, shard_count, SHARD_QUEUE);
+
         // Pre-populate from storage
         const stored_peers = try storage.loadPeers(allocator);
         defer allocator.free(stored_peers);
@@ -225,14 +320,22 @@ pub const CapsuleNode = struct {
     }
 
     pub fn deinit(self: *CapsuleNode) void {
+        // Drain in-flight frames while the subsystems they touch still exist
+        self.shards.deinit();
         self.utcp.deinit();
-        self.risk_graph.deinit();
+        self.recv_batch.deinit();
+        self.relay_batch.deinit();
+        self.graph_store.close();
         self.discovery.deinit();
         self.peer_table.deinit();
         self.sessions.deinit();
         if (self.gateway) |*gw| gw.deinit();
         if (self.relay_service) |*rs| rs.deinit();
         // circuit_builder has no resources to free
+        self.gossip_fanout.deinit();
+        self.gossip_transport.deinit();
+        self.gossip_state.deinit();
+        self.gossip_neighbors.deinit();
         self.dht.deinit();
         self.storage.deinit();
         self.qvl_store.deinit();
@@ -243,68 +346,64 @@ pub const CapsuleNode = struct {
         self.allocator.destroy(self);
     }
 
+    fn processShardItem(self: *CapsuleNode, item: *frame_shards.Item) void {
+        self.processFrame(item.frame, item.sender);
+    }
+
     fn processFrame(self: *CapsuleNode, frame: l0_transport.lwf.LWFFrame, sender: std.net.Address) void {
         var f = frame;
         defer f.deinit(self.allocator);
 
-        // L2 MEMBRANE: Policy Check (Unlocked - CPU Heavy)
-        const decision = self.policy_engine.decide(&f.header);
-        if (decision == .drop) {
-            std.log.info("Policy: Dropped frame from {f}", .{sender});
-            return;
-        }
+        // Policy was applied in dispatchDatagram before the copy
 
         switch (f.header.service_type) {
             l0_transport.lwf.LWFHeader.ServiceType.RELAY_FORWARD => {
-                if (self.relay_service) |*rs| {
-                    // Unwrap (Unlocked)
-                    // Unwrap (Locked - protects Sessions Map)
-                    self.state_mutex.lock();
-                    const result = rs.forwardPacket(f.payload, self.identity.x25519_private);
-                    self.state_mutex.unlock();
-
-                    if (result) |next_hop_data| {
-                        defer self.allocator.free(next_hop_data.payload);
-
-                        const next_node_id = next_hop_data.next_hop;
-                        var is_final = true;
-                        for (next_node_id) |b| {
-                            if (b != 0) {
-                                is_final = false;
-                                break;
-                            }
-                        }
+                const span = self.stats.start(.relay_forward);
+                defer span.end();
+                // Unwrap in the frame's own payload (Locked - protects Sessions Map,
+                // and control may disable the relay from another thread)
+                self.state_mutex.lock();
+                const result = if (self.relay_service) |*rs|
+                    rs.forwardPacket(f.payload, self.identity.x25519_private)
+                else
+                    error.RelayDisabled;
+                self.state_mutex.unlock();
 
-                        if (is_final) {
-                            std.log.info("Relay: Final Packet Received for Session {x}! Size: {d}", .{ next_hop_data.session_id, next_hop_data.payload.len });
+                if (result) |hop| {
+                    if (hop.isFinal()) {
+                        std.log.debug("Relay: Final Packet Received for Session {x}! Size: {d}", .{ hop.session_id, hop.payload.len });
+                    } else {
+                        // DHT Lookup (Locked)
+                        self.state_mutex.lock();
+                        const next_remote = self.dht.routing_table.findNode(hop.next_hop);
+                        self.state_mutex.unlock();
+
+                        if (next_remote) |remote| {
+                            // Borrows the inner onion from `f`; not deinit'd
+                            var relay_frame = l0_transport.lwf.LWFFrame{
+                                .header = l0_transport.lwf.LWFHeader.init(),
+                                .payload = hop.payload,
+                                .trailer = l0_transport.lwf.LWFTrailer.init(),
+                            };
+                            relay_frame.header.service_type = l0_transport.lwf.LWFHeader.ServiceType.RELAY_FORWARD;
+                            relay_frame.header.payload_len = @intCast(hop.payload.len);
+                            relay_frame.updateChecksum();
+
+                            self.queueRelay(remote.address, &relay_frame);
                         } else {
-                            // DHT Lookup (Locked)
-                            self.state_mutex.lock();
-                            const next_remote = self.dht.routing_table.findNode(next_node_id);
-                            self.state_mutex.unlock();
-
-                            if (next_remote) |remote| {
-                                var relay_frame = l0_transport.lwf.LWFFrame.init(self.allocator, next_hop_data.payload.len) catch return;
-                                defer relay_frame.deinit(self.allocator);
-                                @memcpy(relay_frame.payload, next_hop_data.payload);
-                                relay_frame.header.service_type = l0_transport.lwf.LWFHeader.ServiceType.RELAY_FORWARD;
-
-                                self.utcp.sendFrame(remote.address, &relay_frame, self.allocator) catch |err| {
-                                    std.log.warn("Relay Send Error: {}", .{err});
-                                };
-                                std.log.info("Relay: Forwarded packet to {f}", .{remote.address});
-                            } else {
-                                std.log.warn("Relay: Next hop {x} not found", .{next_node_id[0..4]});
-                            }
+                            std.log.warn("Relay: Next hop {x} not found", .{hop.next_hop[0..4]});
                         }
-                    } else |err| {
-                        std.log.warn("Relay Forward Error: {}", .{err});
                     }
+                } else |err| switch (err) {
+                    error.RelayDisabled => {},
+                    else => std.log.warn("Relay Forward Error: {}", .{err}),
                 }
             },
             fed.SERVICE_TYPE => {
                 self.state_mutex.lock();
                 defer self.state_mutex.unlock();
+                const span = self.stats.start(.federation);
+                defer span.end();
                 self.handleFederationMessage(sender, f) catch |err| {
                     std.log.warn("Federation Error: {}", .{err});
                 };
@@ -313,11 +412,193 @@ pub const CapsuleNode = struct {
         }
     }
 
+    /// Queue a relayed frame for the end-of-pass flush (copied into the batch)
+    fn queueRelay(self: *CapsuleNode, target: std.net.Address, frame: *const l0_transport.lwf.LWFFrame) void {
+        self.relay_mutex.lock();
+        defer self.relay_mutex.unlock();
+        self.relay_batch.add(target, frame) catch |err| switch (err) {
+            error.BatchFull => {
+                self.sendRelayBatch();
+                self.relay_batch.add(target, frame) catch |retry_err| {
+                    std.log.warn("Relay Send Error: {}", .{retry_err});
+                };
+            },
+            else => std.log.warn("Relay Send Error: {}", .{err}),
+        };
+    }
+
+    /// Worker end-of-pass hook: send the relays queued during the pass
+    fn flushRelay(self: *CapsuleNode) void {
+        self.relay_mutex.lock();
+        defer self.relay_mutex.unlock();
+        if (self.relay_batch.pending() > 0) self.sendRelayBatch();
+    }
+
+    /// Caller holds relay_mutex. A failed send drops the rest of the batch:
+    /// relayed onions are best-effort, like the per-packet sends were.
+    fn sendRelayBatch(self: *CapsuleNode) void {
+        _ = self.utcp.sendBatch(&self.relay_batch) catch |err| {
+            std.log.warn("Relay Send Error: {} ({d} frames dropped)", .{ err, self.relay_batch.pending() });
+            self.relay_batch.clear();
+        };
+    }
+
+    /// Drain queued UTCP datagrams in batches (one recvmmsg per round).
+    /// Bounded so discovery and control traffic are still serviced.
+    fn drainUtcp(self: *CapsuleNode) void {
+        var rounds: usize = 0;
+        while (rounds < UTCP_MAX_ROUNDS) : (rounds += 1) {
+            const span = self.stats.start(.utcp_receive);
+            defer span.end();
+            const filled = self.utcp.receiveBatch(&self.recv_batch) catch |err| {
+                std.log.warn("UTCP receive error: {}", .{err});
+                return;
+            };
+
+            var it = self.recv_batch.iterator();
+            while (it.next()) |dg| self.dispatchDatagram(dg.data, dg.sender);
+            self.flushDispatch();
+
+            // A short batch means the socket queue is empty
+            if (filled < self.recv_batch.capacity()) return;
+        }
+    }
+
+    /// Triage one UTCP datagram in place and queue surviving frames for a worker.
+    /// Dropped and unhandled frames are never copied out of the receive buffer.
+    pub fn dispatchDatagram(self: *CapsuleNode, data: []const u8, sender: std.net.Address) void {
+        const span = self.stats.start(.dispatch);
+        defer span.end();
+        const view = UTCP.parseDatagram(data) catch |err| {
+            std.log.warn("UTCP receive error: {}", .{err});
+            return;
+        };
+
+        // L2 MEMBRANE: Policy Check (O(1), header only)
+        if (self.policy_engine.decide(&view.header) == .drop) {
+            std.log.info("Policy: Dropped frame from {f}", .{sender});
+            return;
+        }
+
+        switch (view.header.service_type) {
+            l0_transport.lwf.LWFHeader.ServiceType.RELAY_FORWARD, fed.SERVICE_TYPE => {},
+            // Decoded in the receive buffer, no copy
+            l0_transport.lwf.LWFHeader.ServiceType.IDENTITY_SIGNAL => return self.handleGossipBatch(view.payload, sender),
+            else => return,
+        }
+
+        // Workers outlive the receive buffer: take an owned copy
+        const frame = view.toOwned(self.allocator) catch |err| {
+            std.log.warn("UTCP receive error: {}", .{err});
+            return;
+        };
+        // Queued on the flow's shard; woken by flushDispatch
+        if (!self.shards.push(.{ .frame = frame, .sender = sender })) {
+            std.log.warn("Frame shard full, dropped frame from {f}", .{sender});
+            frame.deinit(self.allocator);
+        }
+    }
+
+    /// Hand frames dispatched since the last call to their workers
+    pub fn flushDispatch(self: *CapsuleNode) void {
+        self.shards.flush();
+    }
+
+    /// Feed one mDNS packet to discovery
+    pub fn handleDiscoveryDatagram(self: *CapsuleNode, data: []const u8, addr: std.net.Address) !void {
+        // Filter self-discovery
+        if (addr.getPort() == self.config.port) {
+            // Check local IPs if necessary, but port check is usually enough on same LAN for different nodes
+            // For local multi-port test, we allow it if port is different.
+            // But mDNS on host network might show our own announcement.
+        }
+        self.state_mutex.lock();
+        defer self.state_mutex.unlock();
+        try self.discovery.handlePacket(&self.peer_table, data, addr);
+    }
+
+    /// Handle one control client and close it
+    pub fn serveControlConnection(self: *CapsuleNode, conn: std.net.Server.Connection) void {
+        defer conn.stream.close();
+
+        self.state_mutex.lock();
+        defer self.state_mutex.unlock();
+        const span = self.stats.start(.control);
+        defer span.end();
+        self.handleControlConnection(conn) catch |err| {
+            std.log.warn("Control handle error: {}", .{err});
+        };
+    }
+
+    /// Periodic work, run every TICK_MS by either event loop. Runs under
+    /// `state_mutex` throughout: control connections are served on the
+    /// thread pool and read the same state.
+    pub fn onTick(self: *CapsuleNode, timers: *TickTimers) !void {
+        {
+            self.state_mutex.lock();
+            defer self.state_mutex.unlock();
+            try self.tick();
+        }
+
+        // Discovery cycle (every ~5s)
+        timers.discovery += 1;
+        if (timers.discovery >= 50) {
+            self.state_mutex.lock();
+            defer self.state_mutex.unlock();
+            self.discovery.announce() catch {};
+            self.discovery.query() catch {};
+            timers.discovery = 0;
+        }
+
+        // DHT refresh (every ~60s)
+        timers.dht += 1;
+        if (timers.dht >= 600) {
+            self.state_mutex.lock();
+            defer self.state_mutex.unlock();
+            try self.bootstrap();
+            timers.dht = 0;
+        }
+
+        // QVL sync (every ~30s)
+        timers.qvl_sync += 1;
+        if (timers.qvl_sync >= 300) {
+            std.log.info("Node: Syncing Lattice to DuckDB...", .{});
+            // compact, sync and checkpoint rebuild the arrays getQvlMetrics reads
+            self.state_mutex.lock();
+            defer self.state_mutex.unlock();
+            const span = self.stats.start(.qvl_sync);
+            defer span.end();
+            const graph = &self.graph_store.graph;
+            graph.compact(); // sync only live edges
+            try self.qvl_store.syncLattice(graph.nodes.items, graph.edges.items);
+            _ = try self.graph_store.maybeCheckpoint();
+            timers.qvl_sync = 0;
+        }
+    }
+
     pub fn start(self: *CapsuleNode) !void {
-        self.running = true;
+        self.running.store(true, .release);
         std.log.info("CapsuleNode starting on port {d}...", .{self.config.port});
         std.log.info("Data directory: {s}", .{self.config.data_dir});
 
+        if (self.config.io_uring) {
+            if (uring_loop.supported) {
+                if (uring_loop.run(self)) |_| {
+                    return;
+                } else |err| switch (err) {
+                    // Kernel too old or io_uring disabled: keep running on poll
+                    error.UringUnavailable => std.log.warn("io_uring unavailable, falling back to poll loop", .{}),
+                    else => return err,
+                }
+            } else {
+                std.log.warn("io_uring requested but not supported on this OS", .{});
+            }
+        }
+
+        try self.runPollLoop();
+    }
+
+    fn runPollLoop(self: *CapsuleNode) !void {
         // Setup polling
         var poll_fds = [_]std.posix.pollfd{
             .{
@@ -337,29 +618,16 @@ pub const CapsuleNode = struct {
             },
         };
 
-        const TICK_MS = 100; // 10Hz tick rate
         var last_tick = std.time.milliTimestamp();
-        var discovery_timer: usize = 0;
-        var dht_timer: usize = 0;
-        var qvl_sync_timer: usize = 0;
+        var timers: TickTimers = .{};
 
-        while (self.running) {
+        while (self.running.load(.acquire)) {
             const ready_count = try std.posix.poll(&poll_fds, TICK_MS);
 
             if (ready_count > 0) {
                 // 1. UTCP Traffic
                 if (poll_fds[0].revents & std.posix.POLL.IN != 0) {
-                    var buf: [1500]u8 = undefined;
-                    if (self.utcp.receiveFrame(self.allocator, &buf)) |result| {
-                        self.thread_pool.spawn(processFrame, .{ self, result.frame, result.sender }) catch |err| {
-                            std.log.warn("Failed to spawn worker: {}", .{err});
-                            // Fallback: Free resource
-                            var f = result.frame;
-                            f.deinit(self.allocator);
-                        };
-                    } else |err| {
-                        if (err != error.WouldBlock) std.log.warn("UTCP receive error: {}", .{err});
-                    }
+                    self.drainUtcp();
                 }
 
                 // 2. Discovery Traffic
@@ -372,75 +640,44 @@ pub const CapsuleNode = struct {
                         break :blk @as(usize, 0);
                     };
                     if (bytes > 0) {
-                        const addr = std.net.Address{ .any = src_addr };
-                        // Filter self-discovery
-                        if (addr.getPort() == self.config.port) {
-                            // Check local IPs if necessary, but port check is usually enough on same LAN for different nodes
-                            // For local multi-port test, we allow it if port is different.
-                            // But mDNS on host network might show our own announcement.
-                        }
-                        self.state_mutex.lock();
-                        defer self.state_mutex.unlock();
-                        try self.discovery.handlePacket(&self.peer_table, m_buf[0..bytes], addr);
+                        try self.handleDiscoveryDatagram(m_buf[0..bytes], std.net.Address{ .any = src_addr });
                     }
                 }
 
                 // 3. Control Socket Traffic
                 if (poll_fds[2].revents & std.posix.POLL.IN != 0) {
-                    var conn = self.control_socket.accept() catch |err| {
+                    const conn = self.control_socket.accept() catch |err| {
                         std.log.warn("Control Socket accept error: {}", .{err});
                         continue;
                     };
-                    defer conn.stream.close();
-
-                    self.state_mutex.lock();
-                    self.handleControlConnection(conn) catch |err| {
-                        std.log.warn("Control handle error: {}", .{err});
-                    };
-                    self.state_mutex.unlock();
+                    self.serveControlConnection(conn);
                 }
             }
 
             // 3. Periodic Ticks
             const now = std.time.milliTimestamp();
             if (now - last_tick >= TICK_MS) {
-                self.state_mutex.lock();
-                try self.tick();
-                self.state_mutex.unlock();
+                try self.onTick(&timers);
                 last_tick = now;
-
-                // Discovery cycle (every ~5s)
-                discovery_timer += 1;
-                if (discovery_timer >= 50) {
-                    self.state_mutex.lock();
-                    defer self.state_mutex.unlock();
-                    self.discovery.announce() catch {};
-                    self.discovery.query() catch {};
-                    discovery_timer = 0;
-                }
-
-                // DHT refresh (every ~60s)
-                dht_timer += 1;
-                if (dht_timer >= 600) {
-                    try self.bootstrap();
-                    dht_timer = 0;
-                }
-
-                // QVL sync (every ~30s)
-                qvl_sync_timer += 1;
-                if (qvl_sync_timer >= 300) {
-                    std.log.info("Node: Syncing Lattice to DuckDB...", .{});
-                    try self.qvl_store.syncLattice(self.risk_graph.nodes.items, self.risk_graph.edges.items);
-                    qvl_sync_timer = 0;
-                }
             }
         }
     }
 
+    /// Refresh the routing table: a self-lookup fills the near buckets and
+    /// random-target lookups the far ones, all running concurrently
     pub fn bootstrap(self: *CapsuleNode) !void {
         std.log.info("DHT: Refreshing routing table...", .{});
-        // Start self-lookup to fill buckets
-        // For now, just ping federated sessions
+        const now = std.time.milliTimestamp();
+        try self.dht.startLookup(self.dht.routing_table.self_id, now);
+        for (0..DHT_REFRESH_LOOKUPS) |_| {
+            var target: l0_transport.dht.NodeId = undefined;
+            std.crypto.random.bytes(&target);
+            try self.dht.startLookup(target, now);
+        }
+        self.driveLookups();
+
+        // Federated peers may not be in the table yet (cold start): ask
+        // them directly, their answers seed the running lookups
         var it = self.sessions.iterator();
         while (it.next()) |entry| {
             if (entry.value_ptr.state == .Federated) {
@@ -451,8 +688,42 @@ pub const CapsuleNode = struct {
         }
     }
 
+    /// Send the FIND_NODE requests the running lookups have due, and the
+    /// PINGs that decide whether stale bucket members get replaced
+    fn driveLookups(self: *CapsuleNode) void {
+        const now = std.time.milliTimestamp();
+        var queries: [l0_transport.dht.MAX_LOOKUPS * l0_transport.dht.ALPHA]l0_transport.dht.Query = undefined;
+        const n = self.dht.nextQueries(now, &queries);
+        for (queries[0..n]) |q| {
+            self.sendFederationMessage(q.node.address, .{
+                .dht_find_node = .{ .target_id = q.target, .txid = q.txid },
+            }) catch |err| {
+                std.log.warn("DHT: FIND_NODE to {f} failed: {}", .{ q.node.address, err });
+            };
+        }
+
+        var stale: [l0_transport.dht.K]l0_transport.dht.RemoteNode = undefined;
+        const pings = self.dht.nextPings(now, &stale);
+        for (stale[0..pings]) |node| {
+            self.sendFederationMessage(node.address, .{
+                .dht_ping = .{ .node_id = self.dht.routing_table.self_id },
+            }) catch |err| {
+                std.log.warn("DHT: PING to {f} failed: {}", .{ node.address, err });
+            };
+        }
+    }
+
     fn tick(self: *CapsuleNode) !void {
         self.peer_table.tick();
+        // One datagram per neighbor for everything relayed or published since
+        self.gossip_fanout.flush();
+        // Lookup timeouts and follow-up requests
+        self.driveLookups();
+        if (self.relay_service) |*rs| {
+            _ = rs.pruneSessions(RELAY_SESSION_MAX_AGE) catch |err| {
+                std.log.warn("Relay: session pruning failed: {}", .{err});
+            };
+        }
 
         // Initiate handshakes with discovered active peers
         self.peer_table.mutex.lock();
@@ -467,7 +738,7 @@ pub const CapsuleNode = struct {
     }
 
     pub fn stop(self: *CapsuleNode) void {
-        self.running = false;
+        self.running.store(false, .release);
     }
 
     pub fn updateRoutingTable(self: *CapsuleNode, node: storage_mod.RemoteNode) !void {
@@ -478,6 +749,79 @@ pub const CapsuleNode = struct {
         };
     }
 
+    /// Gossip to and from `address` once the HELLO/WELCOME exchange is done
+    /// (either side). Caller holds state_mutex.
+    fn addGossipNeighbor(self: *CapsuleNode, address: std.net.Address) !void {
+        const entry = try self.gossip_neighbors.getOrPut(address);
+        if (entry.found_existing) return;
+        errdefer self.gossip_neighbors.removeByPtr(entry.key_ptr);
+        entry.value_ptr.* = self.next_gossip_neighbor;
+        try self.gossip_transport.setPeer(self.next_gossip_neighbor, address);
+        self.next_gossip_neighbor += 1;
+    }
+
+    /// Dedup each message of a received batch and relay the new ones to
+    /// the other neighbors (decoded in place; runs on the loop thread)
+    fn handleGossipBatch(self: *CapsuleNode, payload: []const u8, sender: std.net.Address) void {
+        self.state_mutex.lock();
+        defer self.state_mutex.unlock();
+        const from = self.gossip_neighbors.get(sender) orelse {
+            std.log.debug("Gossip: batch from non-neighbor {f} dropped", .{sender});
+            return;
+        };
+        const now: u64 = @intCast(std.time.nanoTimestamp());
+
+        var it = gossip.BatchIterator{ .data = payload };
+        while (it.next() catch |err| {
+            std.log.warn("Gossip: malformed batch from {f}: {}", .{ sender, err });
+            return;
+        }) |decoded| {
+            if (!self.gossip_state.acceptsStamp(decoded.entropy_stamp, now)) continue;
+            if (!self.gossip_state.isNewMessage(decoded.id)) continue;
+
+            var refs: [GOSSIP_MAX_REFS]u64 = undefined;
+            for (refs[0..decoded.refCount()], 0..) |*ref, i| ref.* = decoded.refAt(i);
+            const msg = gossip.GossipMessage{
+                .id = decoded.id,
+                .sender = decoded.sender,
+                .refs = refs[0..decoded.refCount()],
+                .msg_type = decoded.msg_type,
+                .entropy_stamp = decoded.entropy_stamp,
+                .payload = decoded.payload,
+            };
+            self.gossip_state.recordMessage(&msg, now) catch |err| {
+                std.log.warn("Gossip: recording message {x} failed: {}", .{ msg.id, err });
+            };
+            self.relayGossip(&msg, from);
+        }
+    }
+
+    /// Originate a gossip message and queue it for every neighbor
+    pub fn publishGossip(self: *CapsuleNode, msg_type: gossip.GossipMessage.MessageType, payload: []const u8) !void {
+        self.state_mutex.lock();
+        defer self.state_mutex.unlock();
+        const now: u64 = @intCast(std.time.nanoTimestamp());
+        const origin = std.mem.readInt(u32, self.identity.did[0..4], .little);
+        const msg = try gossip.createMessage(origin, msg_type, payload, now, &self.gossip_state, std.crypto.random, self.allocator);
+        defer self.allocator.free(msg.refs);
+        try self.gossip_state.recordMessage(&msg, now);
+
+        var it = self.gossip_neighbors.valueIterator();
+        while (it.next()) |neighbor| try self.gossip_fanout.enqueue(neighbor.*, &msg);
+    }
+
+    /// Probabilistic flood of `msg` to every neighbor but the one it came from
+    fn relayGossip(self: *CapsuleNode, msg: *const gossip.GossipMessage, from: qvl.types.NodeId) void {
+        var it = self.gossip_neighbors.valueIterator();
+        while (it.next()) |neighbor| {
+            if (neighbor.* == from) continue;
+            if (std.crypto.random.float(f64) > self.gossip_state.config.forward_prob) continue;
+            self.gossip_fanout.enqueue(neighbor.*, msg) catch |err| {
+                std.log.warn("Gossip: relay to neighbor {d} failed: {}", .{ neighbor.*, err });
+            };
+        }
+    }
+
     fn handleFederationMessage(self: *CapsuleNode, sender: std.net.Address, frame: l0_transport.lwf.LWFFrame) !void {
         var fbs = std.io.fixedBufferStream(frame.payload);
         const msg = fed.FederationMessage.decode(fbs.reader(), self.allocator) catch |err| {
@@ -498,12 +842,14 @@ pub const CapsuleNode = struct {
                     .welcome = .{ .did_short = [_]u8{0} ** 8 }, // TODO: Real DID
                 };
                 try self.sendFederationMessage(sender, reply);
+                try self.addGossipNeighbor(sender);
             },
             .welcome => |w| {
                 std.log.info("Received WELCOME from {f} (ID: {x})", .{ sender, w.did_short });
                 if (self.sessions.getPtr(sender)) |session| {
                     session.state = .Federated; // In Week 28 we skip AUTH for stubbing
                     std.log.info("Node {f} is now FEDERATED", .{sender});
+                    try self.addGossipNeighbor(sender);
 
                     // After federation, also ping to join DHT
                     try self.sendFederationMessage(sender, .{
@@ -538,32 +884,35 @@ pub const CapsuleNode = struct {
             },
             .dht_find_node => |f| {
                 std.log.debug("DHT: FIND_NODE from {f}", .{sender});
-                const closest = try self.dht.routing_table.findClosest(f.target_id, 20);
-                defer self.allocator.free(closest);
+                var closest: [DHT_REPLY_NODES]l0_transport.dht.RemoteNode = undefined;
+                const count = self.dht.routing_table.closestInto(f.target_id, &closest);
 
                 // Convert to federation nodes
-                var nodes = try self.allocator.alloc(fed.DhtNode, closest.len);
-                for (closest, 0..) |node, i| {
+                var nodes: [DHT_REPLY_NODES]fed.DhtNode = undefined;
+                for (closest[0..count], 0..) |node, i| {
                     nodes[i] = .{ .id = node.id, .address = node.address, .key = [_]u8{0} ** 32 };
                 }
 
                 try self.sendFederationMessage(sender, .{
-                    .dht_nodes = .{ .nodes = nodes },
+                    .dht_nodes = .{ .txid = f.txid, .nodes = nodes[0..count] },
                 });
-                self.allocator.free(nodes);
             },
             .dht_nodes => |n| {
                 std.log.debug("DHT: Received {d} nodes from {f}", .{ n.nodes.len, sender });
+                defer self.allocator.free(n.nodes);
+                self.dht.onResponse(sender, n.txid);
                 for (n.nodes) |node| {
-                    // Update routing table with discovered nodes
-                    try self.updateRoutingTable(.{
+                    const remote = l0_transport.dht.RemoteNode{
                         .id = node.id,
                         .address = node.address,
                         .last_seen = std.time.milliTimestamp(),
-                    });
-                    // TODO: If this was part of a findNode lookup, update the lookup state
+                    };
+                    // Update routing table with discovered nodes
+                    try self.updateRoutingTable(remote);
+                    self.dht.offer(remote);
                 }
-                self.allocator.free(n.nodes);
+                // Next round goes out now rather than on the next tick
+                self.driveLookups();
             },
             .hole_punch_request => |req| {
                 if (self.gateway) |*gw| {
@@ -596,6 +945,7 @@ pub const CapsuleNode = struct {
 
         const cmd = parsed.value;
         var response: control_mod.Response = undefined;
+        var stage_buf: [@typeInfo(Stage).@"enum".fields.len]control_mod.StageStats = undefined;
 
         switch (cmd) {
             .Status => {
@@ -603,7 +953,7 @@ pub const CapsuleNode = struct {
                 response = .{
                     .NodeStatus = .{
                         .node_id = try self.allocator.dupe(u8, my_did_hex[0..12]),
-                        .state = if (self.running) "Running" else "Stopping",
+                        .state = if (self.running.load(.acquire)) "Running" else "Stopping",
                         .peers_count = self.peer_table.peers.count(),
                         .uptime_seconds = 0, // TODO: Track start time
                         .version = try self.allocator.dupe(u8, "0.15.2-voxis"),
@@ -619,8 +969,8 @@ pub const CapsuleNode = struct {
                 response = .{ .SessionList = sessions };
             },
             .QvlQuery => |args| {
-                const metrics = try self.getQvlMetrics(args);
-                response = .{ .QvlResult = metrics };
+                const qvl_metrics = try self.getQvlMetrics(args);
+                response = .{ .QvlResult = qvl_metrics };
             },
             .Dht => {
                 const dht_info = try self.getDhtInfo();
@@ -632,7 +982,7 @@ pub const CapsuleNode = struct {
             },
             .Shutdown => {
                 std.log.info("Control: Received SHUTDOWN command", .{});
-                self.running = false;
+                self.running.store(false, .release);
                 response = .{ .Ok = "Shutting down..." };
             },
             .Slash => |args| {
@@ -712,6 +1062,9 @@ pub const CapsuleNode = struct {
                     response = .{ .Ok = "Relay Service Disabled" };
                 }
             },
+            .Stats => {
+                response = .{ .StatsInfo = self.getStats(&stage_buf) };
+            },
             .RelayStats => {
                 if (self.relay_service) |*rs| {
                     const stats = rs.getStats();
@@ -858,7 +1211,7 @@ pub const CapsuleNode = struct {
 
         return control_mod.DhtInfo{
             .local_node_id = try self.allocator.dupe(u8, &node_id_hex),
-            .routing_table_size = self.dht.routing_table.buckets.len,
+            .routing_table_size = l0_transport.dht.BUCKET_COUNT,
             .known_nodes = self.dht.getKnownNodeCount(),
         };
     }
@@ -947,20 +1300,38 @@ pub const CapsuleNode = struct {
         return list;
     }
 
+    fn getStats(self: *CapsuleNode, stages: *[@typeInfo(Stage).@"enum".fields.len]control_mod.StageStats) control_mod.NodeStats {
+        const fields = @typeInfo(Stage).@"enum".fields;
+        inline for (fields, 0..) |field, i| {
+            const s = self.stats.summary(@enumFromInt(field.value));
+            stages[i] = .{
+                .name = field.name,
+                .calls = s.calls,
+                .total_ns = s.total_ns,
+                .max_ns = s.max_ns,
+                .p50_ns = s.p50_ns,
+                .p99_ns = s.p99_ns,
+            };
+        }
+        const heap: ?metrics.AllocStats = if (self.alloc_stats) |counting| counting.stats() else null;
+        return .{ .stages = stages, .heap = heap };
+    }
+
     fn getQvlMetrics(self: *CapsuleNode, args: control_mod.QvlQueryArgs) !control_mod.QvlMetrics {
         _ = args; // TODO: Use target_did for specific queries
 
         // TODO: Get actual metrics from the risk graph when API is stable
         // For now, return placeholder values
         return control_mod.QvlMetrics{
-            .total_vertices = self.risk_graph.nodeCount(),
-            .total_edges = self.risk_graph.edgeCount(),
+            .total_vertices = self.graph_store.graph.nodeCount(),
+            .total_edges = self.graph_store.graph.edgeCount(),
             .trust_rank = 0.0,
         };
     }
 
     fn sendFederationMessage(self: *CapsuleNode, target: std.net.Address, msg: fed.FederationMessage) !void {
-        var enc_buf: [128]u8 = undefined;
+        // Largest message: dht_nodes with DHT_REPLY_NODES entries
+        var enc_buf: [7 + DHT_REPLY_NODES * 70]u8 = undefined;
         var fbs = std.io.fixedBufferStream(&enc_buf);
         try msg.encode(fbs.writer());
         const payload = fbs.getWritten();
@@ -3,6 +3,10 @@
 
 const std = @import("std");
 const net = std.net;
+const timer_wheel = @import("timer_wheel.zig");
+
+/// Seconds without contact before a peer is marked inactive
+pub const PEER_TIMEOUT: i64 = 300; // 5 minutes
 
 pub const Peer = struct {
     address: net.Address,
@@ -16,16 +20,23 @@ pub const PeerTable = struct {
     allocator: std.mem.Allocator,
     peers: std.AutoHashMap([8]u8, Peer),
     mutex: std.Thread.Mutex,
+    /// One timeout timer per active peer (seconds)
+    timeouts: timer_wheel.TimerWheel([8]u8),
+    expired: std.ArrayListUnmanaged([8]u8),
 
     pub fn init(allocator: std.mem.Allocator) PeerTable {
         return PeerTable{
             .allocator = allocator,
             .peers = std.AutoHashMap([8]u8, Peer).init(allocator),
             .mutex = .{},
+            .timeouts = timer_wheel.TimerWheel([8]u8).init(allocator, @intCast(std.time.timestamp())),
+            .expired = .{},
         };
     }
 
     pub fn deinit(self: *PeerTable) void {
+        self.expired.deinit(self.allocator);
+        self.timeouts.deinit();
         self.peers.deinit();
     }
 
@@ -38,9 +49,13 @@ pub const PeerTable = struct {
         if (self.peers.getPtr(did_short)) |peer| {
             peer.address = address;
             peer.last_seen = now;
+            // Active peers already have a timer; it re-arms itself on expiry
+            if (!peer.is_active) try self.armTimeout(did_short, now);
             peer.is_active = true;
         } else {
-            try self.peers.put(did_short, Peer{
+            try self.peers.ensureUnusedCapacity(1);
+            try self.armTimeout(did_short, now);
+            self.peers.putAssumeCapacityNoClobber(did_short, Peer{
                 .address = address,
                 .did_short = did_short,
                 .last_seen = now,
@@ -49,22 +64,61 @@ pub const PeerTable = struct {
         }
     }
 
-    /// Mark peers as inactive if not seen for a while (Decay)
+    fn armTimeout(self: *PeerTable, did_short: [8]u8, last_seen: i64) !void {
+        try self.timeouts.schedule(did_short, @intCast(last_seen + PEER_TIMEOUT + 1));
+    }
+
+    /// Mark peers as inactive if not seen for a while (Decay).
+    /// Only peers whose timer is due are looked at.
     pub fn tick(self: *PeerTable) void {
+        self.tickAt(std.time.timestamp());
+    }
+
+    pub fn tickAt(self: *PeerTable, now: i64) void {
         self.mutex.lock();
         defer self.mutex.unlock();
 
-        const now = std.time.timestamp();
-        const timeout = 300; // 5 minutes
-
-        var it = self.peers.iterator();
-        while (it.next()) |entry| {
-            if (now - entry.value_ptr.last_seen > timeout) {
-                if (entry.value_ptr.is_active) {
-                    entry.value_ptr.is_active = false;
-                    std.log.debug("Peer timed out: {x}", .{entry.key_ptr.*});
-                }
+        self.expired.clearRetainingCapacity();
+        self.timeouts.advance(@intCast(now), &self.expired) catch |err| {
+            std.log.warn("Peer timeouts deferred: {}", .{err});
+            return;
+        };
+
+        for (self.expired.items) |did_short| {
+            const peer = self.peers.getPtr(did_short) orelse continue;
+            if (!peer.is_active) continue;
+
+            if (now - peer.last_seen <= PEER_TIMEOUT) {
+                // Seen again since the timer was armed
+                self.armTimeout(did_short, peer.last_seen) catch {
+                    // Without a timer it would never decay; re-armed when next seen
+                    peer.is_active = false;
+                };
+                continue;
             }
+            peer.is_active = false;
+            std.log.debug("Peer timed out: {x}", .{did_short});
         }
     }
 };
+
+test "PeerTable: peers time out via the timer wheel" {
+    const allocator = std.testing.allocator;
+    var table = PeerTable.init(allocator);
+    defer table.deinit();
+
+    const fresh = [_]u8{1} ** 8;
+    const stale = [_]u8{2} ** 8;
+    const addr = try net.Address.parseIp("127.0.0.1", 8710);
+    try table.updatePeer(fresh, addr);
+    try table.updatePeer(stale, addr);
+
+    // `fresh` is heard from again just before both timers are due
+    const later = std.time.timestamp() + PEER_TIMEOUT + 2;
+    table.peers.getPtr(fresh).?.last_seen = later - 1;
+    table.tickAt(later);
+
+    try std.testing.expect(table.peers.get(fresh).?.is_active);
+    try std.testing.expect(!table.peers.get(stale).?.is_active);
+    try std.testing.expectEqual(@as(usize, 1), table.timeouts.len);
+}
@@ -7,6 +7,7 @@ const std = @import("std");
 const l0_transport = @import("l0_transport");
 const relay_mod = l0_transport.relay;
 const dht_mod = l0_transport.dht;
+const timer_wheel = @import("timer_wheel.zig");
 
 pub const RelayService = struct {
     pub const SessionContext = struct {
@@ -21,6 +22,9 @@ pub const RelayService = struct {
     packets_forwarded: u64,
     packets_dropped: u64,
     sessions: std.AutoHashMap([16]u8, SessionContext),
+    /// One timer per session, keyed by its last_seen (seconds)
+    session_timers: timer_wheel.TimerWheel([16]u8),
+    expired: std.ArrayListUnmanaged([16]u8),
 
     pub fn init(allocator: std.mem.Allocator) RelayService {
         return .{
@@ -29,88 +33,97 @@ pub const RelayService = struct {
             .packets_forwarded = 0,
             .packets_dropped = 0,
             .sessions = std.AutoHashMap([16]u8, SessionContext).init(allocator),
+            .session_timers = timer_wheel.TimerWheel([16]u8).init(allocator, @intCast(std.time.timestamp())),
+            .expired = .{},
         };
     }
 
     pub fn deinit(self: *RelayService) void {
+        self.expired.deinit(self.allocator);
+        self.session_timers.deinit();
         self.sessions.deinit();
     }
 
+    /// Record activity on a session, starting its timer if it is new
+    pub fn touchSession(self: *RelayService, session_id: [16]u8, now: i64) !void {
+        const gop = try self.sessions.getOrPut(session_id);
+        if (gop.found_existing) {
+            gop.value_ptr.packet_count += 1;
+            gop.value_ptr.last_seen = now;
+            return;
+        }
+        self.session_timers.schedule(session_id, @intCast(now)) catch |err| {
+            self.sessions.removeByPtr(gop.key_ptr);
+            return err;
+        };
+        gop.value_ptr.* = .{ .packet_count = 1, .last_seen = now };
+        std.log.debug("Relay: New Sticky Session detected: {x}", .{session_id});
+    }
+
     /// Forward a relay packet to the next hop
-    /// Returns the next hop address and the inner payload
-    /// Forward a relay packet to the next hop
-    /// Returns the next hop address and the inner payload
+    /// Decrypts the layer inside `packet` (no allocation) and returns the
+    /// next hop with the inner onion as a slice of `packet`.
     pub fn forwardPacket(
         self: *RelayService,
-        raw_packet: []const u8,
+        packet: []u8,
         receiver_private_key: [32]u8,
-    ) !relay_mod.RelayResult {
-        // Parse the wire packet
-        var packet = try relay_mod.RelayPacket.decode(self.allocator, raw_packet);
-        defer packet.deinit(self.allocator);
-
+    ) !relay_mod.RelayView {
         // Unwrap the onion layer (using our private key + packet's ephemeral key)
-        const result = try self.onion_builder.unwrapLayer(packet, receiver_private_key, null);
-
-        // Check if next_hop is all zeros (meaning we're the final destination)
-        const is_final = blk: {
-            for (result.next_hop) |b| {
-                if (b != 0) break :blk false;
-            }
-            break :blk true;
-        };
+        const result = try relay_mod.unwrapInPlace(packet, receiver_private_key, null);
 
-        if (is_final) {
+        if (result.isFinal()) {
             // We're the final destination - deliver locally
-            std.log.info("Relay: Final destination reached for session {x}", .{result.session_id});
             self.packets_dropped += 1; // Not actually dropped, just not forwarded
             return result;
         }
 
-        // Forward to next hop
-        std.log.debug("Relay: Forwarding session {x} to next hop: {x}", .{ result.session_id, result.next_hop });
-
         // Update Sticky Session Stats
-        const now = std.time.timestamp();
-        const gop = try self.sessions.getOrPut(result.session_id);
-        if (!gop.found_existing) {
-            gop.value_ptr.* = .{ .packet_count = 1, .last_seen = now };
-            std.log.info("Relay: New Sticky Session detected: {x}", .{result.session_id});
-        } else {
-            gop.value_ptr.packet_count += 1;
-            gop.value_ptr.last_seen = now;
-        }
-
+        try self.touchSession(result.session_id, std.time.timestamp());
         self.packets_forwarded += 1;
 
-        // Result payload includes the re-wrapped inner onion?
-        // Wait, unwrapLayer returns the decrypted payload.
-        // In onion routing, the decrypted payload IS the inner onion for the next hop.
-        // We just return it. The caller (node.zig) must send it.
+        // The decrypted payload IS the inner onion for the next hop;
+        // the caller (node.zig) sends it.
         return result;
     }
 
     /// Prune inactive sessions (Garbage Collection)
     /// Removes sessions inactive for more than max_age_seconds
     /// Returns number of sessions removed
+    ///
+    /// Timers fire once a session's last_seen falls behind now - max_age;
+    /// only those sessions are examined. A live session whose timer cannot
+    /// be re-armed is dropped too (it would otherwise never be pruned); its
+    /// next packet starts it afresh. Fired timers are handled even when
+    /// advancing the wheel fails part-way, then the error is returned.
     pub fn pruneSessions(self: *RelayService, max_age_seconds: u64) !usize {
         const now = std.time.timestamp();
-        var expired_keys = std.ArrayList([16]u8).init(self.allocator);
-        defer expired_keys.deinit();
-
-        var it = self.sessions.iterator();
-        while (it.next()) |entry| {
-            const age = now - entry.value_ptr.last_seen;
-            if (age > @as(i64, @intCast(max_age_seconds))) {
-                try expired_keys.append(entry.key_ptr.*);
+        const max_age: i64 = @intCast(max_age_seconds);
+
+        self.expired.clearRetainingCapacity();
+        const advanced = self.session_timers.advance(@intCast(@max(now - max_age, 0)), &self.expired);
+
+        var removed: usize = 0;
+        var rearm_failures: usize = 0;
+        for (self.expired.items) |key| {
+            const session = self.sessions.get(key) orelse continue;
+            if (now - session.last_seen > max_age) {
+                _ = self.sessions.remove(key);
+                removed += 1;
+            } else {
+                // Active since the timer was armed
+                self.session_timers.schedule(key, @intCast(session.last_seen)) catch {
+                    _ = self.sessions.remove(key);
+                    removed += 1;
+                    rearm_failures += 1;
+                };
             }
         }
-
-        for (expired_keys.items) |key| {
-            _ = self.sessions.remove(key);
+        if (rearm_failures > 0) {
+            std.log.warn("Relay: dropped {d} sessions whose timers could not be re-armed", .{rearm_failures});
         }
 
-        return expired_keys.items.len;
+        try advanced;
+        return removed;
     }
 
     /// Get relay statistics
@@ -153,9 +166,8 @@ test "RelayService: Forward packet" {
     const encoded = try packet.encode(allocator);
     defer allocator.free(encoded);
 
-    // Forward the packet (pass encoded bytes)
+    // Forward the packet (decrypted in the encoded bytes)
     const result = try relay_service.forwardPacket(encoded, receiver_priv);
-    defer allocator.free(result.payload);
 
     try std.testing.expectEqualSlices(u8, &next_hop, &result.next_hop);
     try std.testing.expectEqualSlices(u8, payload, result.payload);
@@ -175,17 +187,11 @@ test "RelayService: Session cleanup" {
     const now = std.time.timestamp();
 
     // Add old session (2 hours ago)
-    try service.sessions.put(session_id, .{
-        .packet_count = 10,
-        .last_seen = now - 7200,
-    });
+    try service.touchSession(session_id, now - 7200);
 
     // Add fresh session (10 seconds ago)
     const fresh_id = [_]u8{0xBB} ** 16;
-    try service.sessions.put(fresh_id, .{
-        .packet_count = 5,
-        .last_seen = now - 10,
-    });
+    try service.touchSession(fresh_id, now - 10);
 
     const removed = try service.pruneSessions(3600); // 1 hour max age
     try std.testing.expectEqual(@as(usize, 1), removed);
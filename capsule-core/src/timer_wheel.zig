@@ -0,0 +1,220 @@
+//! Hierarchical timing wheel for deadline expiry
+//!
+//! Four levels of 64 slots cover 2^24 ticks; a tick is whatever unit the
+//! owner schedules in (the node uses seconds). Scheduling is O(1) and each
+//! timer is moved at most once per level before it fires, so expiring N
+//! timers costs O(N) no matter how many are pending.
+//!
+//! Timers are not cancelled. Owners keep one timer per key, re-check the
+//! key's real state when it fires and re-arm it if the deadline moved
+//! (e.g. the peer was seen again in the meantime).
+
+const std = @import("std");
+
+const slot_bits = 6;
+const slot_count = 1 << slot_bits;
+const slot_mask = slot_count - 1;
+const levels = 4;
+/// Ticks reachable without a rebase
+const horizon: u64 = 1 << (slot_bits * levels);
+
+pub fn TimerWheel(comptime Key: type) type {
+    return struct {
+        const Self = @This();
+
+        const Entry = struct {
+            key: Key,
+            deadline: u64,
+        };
+
+        allocator: std.mem.Allocator,
+        slots: [levels][slot_count]std.ArrayListUnmanaged(Entry),
+        /// Last tick processed by `advance`
+        current: u64,
+        /// Pending timers
+        len: usize,
+
+        pub fn init(allocator: std.mem.Allocator, now: u64) Self {
+            return .{
+                .allocator = allocator,
+                .slots = [_][slot_count]std.ArrayListUnmanaged(Entry){[_]std.ArrayListUnmanaged(Entry){.{}} ** slot_count} ** levels,
+                .current = now,
+                .len = 0,
+            };
+        }
+
+        pub fn deinit(self: *Self) void {
+            for (&self.slots) |*level| {
+                for (level) |*slot| slot.deinit(self.allocator);
+            }
+        }
+
+        /// Fire `key` once `advance` reaches `deadline` (past deadlines fire
+        /// on the next advance)
+        pub fn schedule(self: *Self, key: Key, deadline: u64) !void {
+            // Nothing is placed relative to `current` yet: re-anchor so old
+            // deadlines keep their order instead of collapsing into one tick
+            if (self.len == 0 and deadline <= self.current) self.current = deadline -| 1;
+
+            try self.place(.{ .key = key, .deadline = @max(deadline, self.current + 1) });
+            self.len += 1;
+        }
+
+        fn place(self: *Self, entry: Entry) !void {
+            const delta = entry.deadline - self.current;
+            var level: usize = 0;
+            while (level < levels - 1 and delta >= @as(u64, 1) << @intCast(slot_bits * (level + 1))) level += 1;
+            const index = (entry.deadline >> @intCast(slot_bits * level)) & slot_mask;
+            try self.slots[level][index].append(self.allocator, entry);
+        }
+
+        /// Process ticks up to `now`, appending the keys of expired timers to `out`.
+        /// On error no timer is lost: ticks up to the failing one are done,
+        /// that tick is retried by the next call.
+        pub fn advance(self: *Self, now: u64, out: *std.ArrayListUnmanaged(Key)) !void {
+            if (now <= self.current) return;
+            if (self.len == 0) {
+                self.current = now;
+                return;
+            }
+            if (now - self.current >= horizon) return self.rebase(now, out);
+
+            while (self.current < now) {
+                self.current += 1;
+                const t = self.current;
+                // Re-cascading a tick is harmless: entries already moved down
+                // land in the same slots again
+                errdefer self.current = t - 1;
+
+                // A lower level wrapped: spread the matching higher slot down
+                var level: usize = 1;
+                while (level < levels and t & ((@as(u64, 1) << @intCast(slot_bits * level)) - 1) == 0) : (level += 1) {
+                    const index = (t >> @intCast(slot_bits * level)) & slot_mask;
+                    try self.cascade(level, index);
+                }
+
+                const slot = &self.slots[0][t & slot_mask];
+                try out.ensureUnusedCapacity(self.allocator, slot.items.len);
+                for (slot.items) |entry| out.appendAssumeCapacity(entry.key);
+                self.len -= slot.items.len;
+                slot.clearRetainingCapacity();
+            }
+        }
+
+        /// Move a higher slot's entries down; whatever could not be placed
+        /// stays in the slot
+        fn cascade(self: *Self, level: usize, index: usize) !void {
+            var moved = self.slots[level][index];
+            self.slots[level][index] = .{};
+            // Entries always land on a lower level, never back in this slot
+            for (moved.items, 0..) |entry, i| {
+                self.place(entry) catch |err| {
+                    const rest = moved.items.len - i;
+                    std.mem.copyForwards(Entry, moved.items[0..rest], moved.items[i..]);
+                    moved.shrinkRetainingCapacity(rest);
+                    self.slots[level][index] = moved;
+                    return err;
+                };
+            }
+            moved.deinit(self.allocator);
+        }
+
+        /// Clock jumped past the horizon: fire everything due, re-place the rest.
+        /// Timers that cannot be re-placed fire early (owners re-check and
+        /// re-arm), so nothing is lost past the up-front reservations.
+        fn rebase(self: *Self, now: u64, out: *std.ArrayListUnmanaged(Key)) !void {
+            var pending = try std.ArrayListUnmanaged(Entry).initCapacity(self.allocator, self.len);
+            defer pending.deinit(self.allocator);
+            try out.ensureUnusedCapacity(self.allocator, self.len);
+
+            for (&self.slots) |*level| {
+                for (level) |*slot| {
+                    pending.appendSliceAssumeCapacity(slot.items);
+                    slot.clearRetainingCapacity();
+                }
+            }
+
+            self.current = now;
+            self.len = 0;
+            for (pending.items) |entry| {
+                if (entry.deadline <= now) {
+                    out.appendAssumeCapacity(entry.key);
+                    continue;
+                }
+                self.place(entry) catch {
+                    out.appendAssumeCapacity(entry.key);
+                    continue;
+                };
+                self.len += 1;
+            }
+        }
+    };
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+test "TimerWheel fires each timer once, in deadline order" {
+    const allocator = std.testing.allocator;
+    var wheel = TimerWheel(u32).init(allocator, 1000);
+    defer wheel.deinit();
+
+    const deadlines = [_]u64{ 1001, 1063, 1064, 1100, 5000, 1000 + 70_000, 1000 + 300_000 };
+    for (deadlines, 0..) |d, i| try wheel.schedule(@intCast(i), d);
+
+    var fired = std.ArrayListUnmanaged(u32){};
+    defer fired.deinit(allocator);
+
+    // A timer fires exactly at its tick
+    var now: u64 = 1000;
+    while (now < 1000 + 300_000) {
+        now += 1;
+        const before = fired.items.len;
+        try wheel.advance(now, &fired);
+        for (fired.items[before..]) |key| try std.testing.expectEqual(now, deadlines[key]);
+    }
+    try std.testing.expectEqual(deadlines.len, fired.items.len);
+    try std.testing.expectEqual(@as(usize, 0), wheel.len);
+    for (fired.items, 0..) |key, i| try std.testing.expectEqual(@as(u32, @intCast(i)), key);
+
+    // Clock jump past the horizon
+    fired.clearRetainingCapacity();
+    try wheel.schedule(7, wheel.current + 10);
+    try wheel.schedule(8, wheel.current + horizon * 2);
+    try wheel.advance(wheel.current + horizon + 1, &fired);
+    try std.testing.expectEqualSlices(u32, &.{7}, fired.items);
+    try std.testing.expectEqual(@as(usize, 1), wheel.len);
+}
+
+test "TimerWheel keeps timers when an advance runs out of memory" {
+    var failing = std.testing.FailingAllocator.init(std.testing.allocator, .{});
+    const allocator = failing.allocator();
+    var wheel = TimerWheel(u32).init(allocator, 0);
+    defer wheel.deinit();
+
+    // Spread over three levels so ticks cascade
+    const count = 200;
+    for (0..count) |i| try wheel.schedule(@intCast(i), 50 + i * 37);
+
+    var fired = std.ArrayListUnmanaged(u32){};
+    defer fired.deinit(allocator);
+
+    // The first attempt at every tick fails its first allocation, if any
+    var failures: usize = 0;
+    var now: u64 = 0;
+    while (wheel.len > 0) {
+        now += 1;
+        failing.fail_index = failing.alloc_index;
+        wheel.advance(now, &fired) catch {
+            failures += 1;
+            failing.fail_index = std.math.maxInt(usize);
+            try wheel.advance(now, &fired);
+        };
+    }
+    failing.fail_index = std.math.maxInt(usize);
+
+    try std.testing.expect(failures > 0);
+    try std.testing.expectEqual(@as(usize, count), fired.items.len);
+    for (fired.items, 0..) |key, i| try std.testing.expectEqual(@as(u32, @intCast(i)), key);
+}
@@ -0,0 +1,283 @@
+//! io_uring event loop for CapsuleNode (Linux 6.0+)
+//!
+//! Replaces the poll loop with completion-driven I/O:
+//! - UTCP and discovery sockets use multishot recvmsg over provided buffer
+//!   rings: one armed request yields a completion per datagram, no re-arm
+//!   or syscall per packet.
+//! - The control socket uses multishot accept; connections are served on
+//!   the thread pool so slow clients never stall the data plane.
+//! - Ticks come from a timerfd read instead of poll timeouts.
+
+const std = @import("std");
+const builtin = @import("builtin");
+const node_mod = @import("node.zig");
+const posix = std.posix;
+const linux = std.os.linux;
+
+const CapsuleNode = node_mod.CapsuleNode;
+const IoUring = linux.IoUring;
+
+pub const supported = builtin.os.tag == .linux;
+
+const ring_entries = 256;
+/// Completions reaped per wakeup
+const cqe_batch = 64;
+/// Provided buffers per socket (power of two)
+const buffer_count = 256;
+/// Largest datagram payload accepted per buffer
+const payload_space = 2048;
+const name_space = @sizeOf(posix.sockaddr.storage);
+/// Multishot recvmsg layout: RecvmsgOut | name | payload (no control data)
+const buffer_size = @sizeOf(RecvmsgOut) + name_space + payload_space;
+
+const utcp_group = 1;
+const discovery_group = 2;
+
+/// Operation tag carried in each SQE's user_data
+const Op = enum(u64) {
+    utcp,
+    discovery,
+    control,
+    tick,
+};
+
+/// Header the kernel writes at the start of each multishot recvmsg buffer
+/// (struct io_uring_recvmsg_out)
+const RecvmsgOut = extern struct {
+    namelen: u32,
+    controllen: u32,
+    payloadlen: u32,
+    flags: u32,
+};
+
+const Datagram = struct {
+    data: []const u8,
+    sender: std.net.Address,
+};
+
+/// Split a multishot recvmsg buffer into sender and payload.
+/// Returns null for truncated or malformed completions.
+fn parseRecvmsg(buf: []const u8, name_len: usize, control_len: usize) ?Datagram {
+    if (buf.len < @sizeOf(RecvmsgOut)) return null;
+    const out = std.mem.bytesToValue(RecvmsgOut, buf[0..@sizeOf(RecvmsgOut)]);
+    if (out.flags & linux.MSG.TRUNC != 0) return null;
+    if (out.namelen < @sizeOf(posix.sockaddr.in) or out.namelen > name_len) return null;
+
+    const payload_start = @sizeOf(RecvmsgOut) + name_len + control_len;
+    if (payload_start + out.payloadlen > buf.len) return null;
+
+    var storage: posix.sockaddr.storage = undefined;
+    @memcpy(std.mem.asBytes(&storage)[0..out.namelen], buf[@sizeOf(RecvmsgOut)..][0..out.namelen]);
+    return .{
+        .data = buf[payload_start..][0..out.payloadlen],
+        .sender = std.net.Address.initPosix(@ptrCast(&storage)),
+    };
+}
+
+/// Multishot-receiving datagram socket
+const Source = struct {
+    op: Op,
+    fd: posix.fd_t,
+    /// Only namelen/controllen are read by multishot recvmsg
+    msg: linux.msghdr,
+    bufs: IoUring.BufferGroup,
+    /// A completion succeeded: the kernel supports the request, so later
+    /// errors are runtime failures, not missing features
+    proven: bool,
+};
+
+const Loop = struct {
+    node: *CapsuleNode,
+    ring: IoUring,
+    utcp: Source,
+    discovery: Source,
+    timer_fd: posix.fd_t,
+    expirations: u64 = 0,
+    timers: node_mod.TickTimers = .{},
+    /// Like `Source.proven`, for multishot accept
+    accept_proven: bool = false,
+
+    /// Set up in place: buffer groups keep a pointer to `ring`
+    fn init(self: *Loop, node: *CapsuleNode) !void {
+        self.node = node;
+        self.expirations = 0;
+        self.timers = .{};
+        self.accept_proven = false;
+
+        // Single issuer + deferred task work = completions run only when we wait
+        self.ring = IoUring.init(ring_entries, linux.IORING_SETUP_SINGLE_ISSUER | linux.IORING_SETUP_DEFER_TASKRUN) catch
+            IoUring.init(ring_entries, 0) catch return error.UringUnavailable;
+        errdefer self.ring.deinit();
+
+        try self.initSource(&self.utcp, .utcp, node.utcp.fd, utcp_group);
+        errdefer self.utcp.bufs.deinit(node.allocator);
+        try self.initSource(&self.discovery, .discovery, node.discovery.fd, discovery_group);
+        errdefer self.discovery.bufs.deinit(node.allocator);
+
+        self.timer_fd = posix.timerfd_create(.MONOTONIC, .{ .CLOEXEC = true }) catch return error.UringUnavailable;
+        errdefer posix.close(self.timer_fd);
+        const interval = linux.timespec{ .sec = 0, .nsec = node_mod.TICK_MS * std.time.ns_per_ms };
+        try posix.timerfd_settime(self.timer_fd, .{}, &.{ .it_interval = interval, .it_value = interval }, null);
+    }
+
+    fn initSource(self: *Loop, src: *Source, op: Op, fd: posix.fd_t, group_id: u16) !void {
+        src.op = op;
+        src.fd = fd;
+        src.msg = std.mem.zeroes(linux.msghdr);
+        src.msg.namelen = name_space;
+        src.proven = false;
+        src.bufs = IoUring.BufferGroup.init(&self.ring, self.node.allocator, group_id, buffer_size, buffer_count) catch |err| switch (err) {
+            error.OutOfMemory => return error.OutOfMemory,
+            // Provided buffer rings need Linux 5.19
+            else => return error.UringUnavailable,
+        };
+    }
+
+    fn deinit(self: *Loop) void {
+        posix.close(self.timer_fd);
+        self.discovery.bufs.deinit(self.node.allocator);
+        self.utcp.bufs.deinit(self.node.allocator);
+        self.ring.deinit();
+    }
+
+    fn armRecv(self: *Loop, src: *Source) !void {
+        const sqe = try self.ring.recvmsg(@intFromEnum(src.op), src.fd, &src.msg, 0);
+        sqe.flags |= linux.IOSQE_BUFFER_SELECT;
+        sqe.buf_index = src.bufs.group_id;
+        sqe.ioprio |= linux.IORING_RECV_MULTISHOT;
+    }
+
+    fn armAccept(self: *Loop) !void {
+        _ = try self.ring.accept_multishot(@intFromEnum(Op.control), self.node.control_socket.stream.handle, null, null, posix.SOCK.CLOEXEC);
+    }
+
+    fn armTimer(self: *Loop) !void {
+        _ = try self.ring.read(@intFromEnum(Op.tick), self.timer_fd, .{ .buffer = std.mem.asBytes(&self.expirations) }, 0);
+    }
+
+    fn complete(self: *Loop, cqe: linux.io_uring_cqe) !void {
+        switch (@as(Op, @enumFromInt(cqe.user_data))) {
+            .utcp => try self.onRecv(&self.utcp, cqe),
+            .discovery => try self.onRecv(&self.discovery, cqe),
+            .control => try self.onAccept(cqe),
+            .tick => try self.onTimer(cqe),
+        }
+    }
+
+    fn onRecv(self: *Loop, src: *Source, cqe: linux.io_uring_cqe) !void {
+        switch (cqe.err()) {
+            .SUCCESS => {
+                src.proven = true;
+                const buf = try src.bufs.get(cqe);
+                defer src.bufs.put(cqe) catch {};
+                const dg = parseRecvmsg(buf, src.msg.namelen, src.msg.controllen) orelse return self.rearmIfDone(src, cqe);
+                switch (src.op) {
+                    .utcp => {
+                        const span = self.node.stats.start(.utcp_receive);
+                        defer span.end();
+                        self.node.dispatchDatagram(dg.data, dg.sender);
+                    },
+                    // One bad announcement must not stop the loop
+                    .discovery => self.node.handleDiscoveryDatagram(dg.data, dg.sender) catch |err| {
+                        std.log.warn("Discovery datagram from {f} dropped: {}", .{ dg.sender, err });
+                    },
+                    else => unreachable,
+                }
+            },
+            // Buffer ring ran dry: the request ended, re-armed below
+            .NOBUFS => {},
+            // Multishot recvmsg needs Linux 6.0; only a first response means that
+            .INVAL, .OPNOTSUPP => |e| {
+                if (!src.proven) return error.UringUnavailable;
+                std.log.warn("io_uring {s} recv error: {s}", .{ @tagName(src.op), @tagName(e) });
+            },
+            else => |e| std.log.warn("io_uring {s} recv error: {s}", .{ @tagName(src.op), @tagName(e) }),
+        }
+        try self.rearmIfDone(src, cqe);
+    }
+
+    fn rearmIfDone(self: *Loop, src: *Source, cqe: linux.io_uring_cqe) !void {
+        if (cqe.flags & linux.IORING_CQE_F_MORE == 0) try self.armRecv(src);
+    }
+
+    fn onAccept(self: *Loop, cqe: linux.io_uring_cqe) !void {
+        switch (cqe.err()) {
+            .SUCCESS => {
+                self.accept_proven = true;
+                const conn = std.net.Server.Connection{
+                    .stream = .{ .handle = cqe.res },
+                    .address = self.node.control_socket.listen_address,
+                };
+                // Off the loop thread so slow control clients do not stall the data plane
+                self.node.thread_pool.spawn(CapsuleNode.serveControlConnection, .{ self.node, conn }) catch
+                    self.node.serveControlConnection(conn);
+            },
+            .INVAL => {
+                if (!self.accept_proven) return error.UringUnavailable;
+                std.log.warn("Control Socket accept error: INVAL", .{});
+            },
+            else => |e| std.log.warn("Control Socket accept error: {s}", .{@tagName(e)}),
+        }
+        if (cqe.flags & linux.IORING_CQE_F_MORE == 0) try self.armAccept();
+    }
+
+    fn onTimer(self: *Loop, cqe: linux.io_uring_cqe) !void {
+        switch (cqe.err()) {
+            .SUCCESS => try self.node.onTick(&self.timers),
+            .INTR, .AGAIN => {},
+            else => |e| std.log.warn("io_uring tick error: {s}", .{@tagName(e)}),
+        }
+        try self.armTimer();
+    }
+};
+
+/// Run the node until `node.running` clears.
+/// Returns error.UringUnavailable (during setup, or as a request's first
+/// completion) when the kernel lacks the required features; the caller then
+/// falls back to poll. Later failures are logged and the request re-armed.
+pub fn run(node: *CapsuleNode) !void {
+    var loop: Loop = undefined;
+    try loop.init(node);
+    defer loop.deinit();
+
+    try loop.armRecv(&loop.utcp);
+    try loop.armRecv(&loop.discovery);
+    try loop.armAccept();
+    try loop.armTimer();
+    std.log.info("CapsuleNode event loop: io_uring", .{});
+
+    var cqes: [cqe_batch]linux.io_uring_cqe = undefined;
+    while (node.running.load(.acquire)) {
+        _ = loop.ring.submit_and_wait(1) catch |err| switch (err) {
+            error.SignalInterrupt => continue,
+            else => return err,
+        };
+        const n = try loop.ring.copy_cqes(&cqes, 0);
+        for (cqes[0..n]) |cqe| try loop.complete(cqe);
+        node.flushDispatch();
+    }
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+test "parseRecvmsg splits header, sender and payload" {
+    var buf: [@sizeOf(RecvmsgOut) + name_space + 16]u8 align(8) = undefined;
+    const addr = try std.net.Address.parseIp("10.0.0.7", 8710);
+
+    const out = RecvmsgOut{ .namelen = @sizeOf(posix.sockaddr.in), .controllen = 0, .payloadlen = 5, .flags = 0 };
+    @memcpy(buf[0..@sizeOf(RecvmsgOut)], std.mem.asBytes(&out));
+    @memcpy(buf[@sizeOf(RecvmsgOut)..][0..@sizeOf(posix.sockaddr.in)], std.mem.asBytes(&addr.in.sa));
+    @memcpy(buf[@sizeOf(RecvmsgOut) + name_space ..][0..5], "hello");
+
+    const dg = parseRecvmsg(buf[0 .. @sizeOf(RecvmsgOut) + name_space + 5], name_space, 0).?;
+    try std.testing.expectEqualStrings("hello", dg.data);
+    try std.testing.expect(dg.sender.eql(addr));
+
+    // Truncated datagrams are dropped
+    var trunc = out;
+    trunc.flags = linux.MSG.TRUNC;
+    @memcpy(buf[0..@sizeOf(RecvmsgOut)], std.mem.asBytes(&trunc));
+    try std.testing.expect(parseRecvmsg(&buf, name_space, 0) == null);
+}
@@ -46,108 +46,363 @@ pub const RemoteNode = struct {
     key: [32]u8 = [_]u8{0} ** 32, // X25519 Public Key
 };
 
-pub const KBucket = struct {
-    nodes: std.ArrayList(RemoteNode) = .{},
+pub const BUCKET_COUNT = ID_LEN * 8;
 
-    pub fn deinit(self: *KBucket, allocator: std.mem.Allocator) void {
-        self.nodes.deinit(allocator);
-    }
-};
+/// Concurrent FIND_NODE requests per lookup
+pub const ALPHA = 3;
+/// A lookup request unanswered this long (ms) counts as failed
+pub const LOOKUP_TIMEOUT_MS = 2000;
+/// Lookups running at once; further starts are ignored
+pub const MAX_LOOKUPS = 8;
+/// A stale bucket member unanswered this long (ms) after a PING is replaced
+pub const PING_TIMEOUT_MS = 2000;
+
+/// ID as a big-endian integer: XOR of keys orders like `distance`
+fn idKey(id: NodeId) u256 {
+    return std.mem.readInt(u256, &id, .big);
+}
+
+/// Top 64 bits of an ID (first limb of idKey)
+fn idPrefix(id: NodeId) u64 {
+    return std.mem.readInt(u64, id[0..8], .big);
+}
+
+fn bucketIndex(self_id: NodeId, id: NodeId) usize {
+    const cpl = commonPrefixLen(self_id, id);
+    return if (cpl == BUCKET_COUNT) BUCKET_COUNT - 1 else cpl;
+}
 
+/// Flat routing table.
+/// Nodes live in one dense array with an id index, and the top 64 bits
+/// of every ID are kept contiguously so k-closest selection runs as a
+/// vector scan over prefixes; only candidates whose prefix can beat the
+/// current k-th distance are compared in full. Buckets are just counters
+/// enforcing the K-per-bucket limit.
+///
+/// A node arriving at a full bucket does not evict anyone directly: the
+/// bucket's least recently seen member is pinged (`duePings`) and only
+/// replaced by the newcomer if it stays silent for PING_TIMEOUT_MS.
 pub const RoutingTable = struct {
+    /// Newcomer waiting on a full bucket's ping
+    const Replacement = struct {
+        candidate: RemoteNode,
+        stale: NodeId,
+        /// 0 until the PING went out
+        pinged_at: i64,
+    };
+
     self_id: NodeId,
-    buckets: [ID_LEN * 8]KBucket,
     allocator: std.mem.Allocator,
+    nodes: std.ArrayListUnmanaged(RemoteNode),
+    /// prefixes[i] = idPrefix(nodes[i].id)
+    prefixes: std.ArrayListUnmanaged(u64),
+    /// id -> index into nodes
+    index: std.AutoHashMapUnmanaged(NodeId, u32),
+    bucket_len: [BUCKET_COUNT]u8,
+    /// Bucket -> pending replacement (at most one per bucket)
+    replacements: std.AutoHashMapUnmanaged(u16, Replacement),
 
     pub fn init(allocator: std.mem.Allocator, self_id: NodeId) RoutingTable {
         return RoutingTable{
             .self_id = self_id,
-            .buckets = [_]KBucket{.{}} ** (ID_LEN * 8),
             .allocator = allocator,
+            .nodes = .{},
+            .prefixes = .{},
+            .index = .{},
+            .bucket_len = [_]u8{0} ** BUCKET_COUNT,
+            .replacements = .{},
         };
     }
 
     pub fn deinit(self: *RoutingTable) void {
-        for (0..self.buckets.len) |i| {
-            self.buckets[i].deinit(self.allocator);
-        }
+        self.nodes.deinit(self.allocator);
+        self.prefixes.deinit(self.allocator);
+        self.index.deinit(self.allocator);
+        self.replacements.deinit(self.allocator);
     }
 
     pub fn update(self: *RoutingTable, node: RemoteNode) !void {
-        const cpl = commonPrefixLen(self.self_id, node.id);
-        const bucket_idx = if (cpl == ID_LEN * 8) ID_LEN * 8 - 1 else cpl;
-        var bucket = &self.buckets[bucket_idx];
-
-        // 1. If node exists, move to end (most recent)
-        for (bucket.nodes.items, 0..) |existing, i| {
-            if (std.mem.eql(u8, &existing.id, &node.id)) {
-                _ = bucket.nodes.orderedRemove(i);
-                try bucket.nodes.append(self.allocator, node);
-                return;
+        const bucket = bucketIndex(self.self_id, node.id);
+
+        // 1. If node exists, refresh it in place; a pinged member is alive
+        if (self.index.get(node.id)) |i| {
+            self.nodes.items[i] = node;
+            if (self.replacements.get(@intCast(bucket))) |r| {
+                if (std.mem.eql(u8, &r.stale, &node.id)) _ = self.replacements.remove(@intCast(bucket));
             }
+            return;
         }
 
-        // 2. If bucket not full, add to end
-        if (bucket.nodes.items.len < K) {
-            try bucket.nodes.append(self.allocator, node);
-        } else {
-            // 3. Bucket full, ping oldest (front)
-            // For now, we just don't add. TODO: Implement ping-and-replace
+        // 2. Bucket full: queue the newcomer behind a ping of the oldest member
+        if (self.bucket_len[bucket] >= K) {
+            const entry = try self.replacements.getOrPut(self.allocator, @intCast(bucket));
+            if (entry.found_existing) {
+                // Keep the most recently seen newcomer
+                entry.value_ptr.candidate = node;
+            } else {
+                entry.value_ptr.* = .{ .candidate = node, .stale = self.oldestIn(bucket).id, .pinged_at = 0 };
+            }
+            return;
         }
+
+        try self.nodes.ensureUnusedCapacity(self.allocator, 1);
+        try self.prefixes.ensureUnusedCapacity(self.allocator, 1);
+        try self.index.put(self.allocator, node.id, @intCast(self.nodes.items.len));
+        self.nodes.appendAssumeCapacity(node);
+        self.prefixes.appendAssumeCapacity(idPrefix(node.id));
+        self.bucket_len[bucket] += 1;
     }
 
-    pub fn findNode(self: *RoutingTable, target: NodeId) ?RemoteNode {
-        const cpl = commonPrefixLen(self.self_id, target);
-        const bucket_idx = if (cpl == ID_LEN * 8) ID_LEN * 8 - 1 else cpl;
-        const bucket = &self.buckets[bucket_idx];
+    /// Least recently seen member of a (non-empty) bucket
+    fn oldestIn(self: *const RoutingTable, bucket: usize) *const RemoteNode {
+        var oldest: ?*const RemoteNode = null;
+        for (self.nodes.items) |*node| {
+            if (bucketIndex(self.self_id, node.id) != bucket) continue;
+            if (oldest == null or node.last_seen < oldest.?.last_seen) oldest = node;
+        }
+        return oldest.?;
+    }
 
-        for (bucket.nodes.items) |node| {
-            if (std.mem.eql(u8, &node.id, &target)) {
-                return node;
+    /// Stale members to PING now, written to `out`; returns how many.
+    /// Members that ignored an earlier PING for PING_TIMEOUT_MS are
+    /// replaced by their bucket's newcomer here.
+    pub fn duePings(self: *RoutingTable, now: i64, out: []RemoteNode) usize {
+        var n: usize = 0;
+        var it = self.replacements.iterator();
+        while (it.next()) |entry| {
+            const r = entry.value_ptr;
+            if (r.pinged_at == 0) {
+                if (n == out.len) continue;
+                const i = self.index.get(r.stale) orelse {
+                    self.replacements.removeByPtr(entry.key_ptr);
+                    continue;
+                };
+                out[n] = self.nodes.items[i];
+                n += 1;
+                r.pinged_at = now;
+            } else if (now - r.pinged_at >= PING_TIMEOUT_MS) {
+                // Same bucket, so the newcomer takes the stale member's slot
+                if (self.index.fetchRemove(r.stale)) |stale| {
+                    self.nodes.items[stale.value] = r.candidate;
+                    self.prefixes.items[stale.value] = idPrefix(r.candidate.id);
+                    self.index.putAssumeCapacity(r.candidate.id, stale.value);
+                }
+                self.replacements.removeByPtr(entry.key_ptr);
             }
         }
-        return null;
+        return n;
     }
 
-    pub fn findClosest(self: *RoutingTable, target: NodeId, count: usize) ![]RemoteNode {
-        var results = std.ArrayList(RemoteNode){};
-        defer results.deinit(self.allocator);
+    pub fn findNode(self: *RoutingTable, target: NodeId) ?RemoteNode {
+        const i = self.index.get(target) orelse return null;
+        return self.nodes.items[i];
+    }
 
-        // Collect all nodes from all buckets
-        for (self.buckets) |bucket| {
-            for (bucket.nodes.items) |node| {
-                try results.append(self.allocator, node);
-            }
-        }
+    /// Write the nodes closest to `target` into `out`, nearest first.
+    /// Returns how many (min(out.len, node count)).
+    pub fn closestInto(self: *const RoutingTable, target: NodeId, out: []RemoteNode) usize {
+        if (out.len == 0) return 0;
+        const target_key = idKey(target);
+        const target_prefix = idPrefix(target);
+
+        // Sorted best-so-far: distances and node indices
+        var best_dist: [K]u256 = undefined;
+        var best_index: [K]u32 = undefined;
+        const want = @min(out.len, K);
+        var len: usize = 0;
 
-        // Sort by distance to target
-        const SortContext = struct {
-            target: NodeId,
-            pub fn lessThan(ctx: @This(), a: RemoteNode, b: RemoteNode) bool {
-                const dist_a = distance(a.id, ctx.target);
-                const dist_b = distance(b.id, ctx.target);
-                for (0..ID_LEN) |i| {
-                    if (dist_a[i] < dist_b[i]) return true;
-                    if (dist_a[i] > dist_b[i]) return false;
+        const Insert = struct {
+            fn run(dist: []u256, idx: []u32, n: *usize, cap: usize, d: u256, i: u32) void {
+                if (n.* == cap and d >= dist[cap - 1]) return;
+                var pos = if (n.* < cap) n.* else cap - 1;
+                while (pos > 0 and dist[pos - 1] > d) : (pos -= 1) {
+                    dist[pos] = dist[pos - 1];
+                    idx[pos] = idx[pos - 1];
                 }
-                return false;
+                dist[pos] = d;
+                idx[pos] = i;
+                if (n.* < cap) n.* += 1;
             }
         };
 
-        std.sort.block(RemoteNode, results.items, SortContext{ .target = target }, SortContext.lessThan);
+        const lanes = 8;
+        const V = @Vector(lanes, u64);
+        const prefixes = self.prefixes.items;
+        var i: usize = 0;
+        while (i < prefixes.len) {
+            // Prefix distance bound of the current k-th best
+            const bound: u64 = if (len < want) std.math.maxInt(u64) else @truncate(best_dist[want - 1] >> 192);
+            if (i + lanes <= prefixes.len) {
+                const v: V = prefixes[i..][0..lanes].*;
+                const hit = (v ^ @as(V, @splat(target_prefix))) <= @as(V, @splat(bound));
+                if (!@reduce(.Or, hit)) {
+                    i += lanes;
+                    continue;
+                }
+                const mask: u8 = @bitCast(hit);
+                for (0..lanes) |lane| {
+                    if (mask & (@as(u8, 1) << @intCast(lane)) == 0) continue;
+                    const d = idKey(self.nodes.items[i + lane].id) ^ target_key;
+                    Insert.run(&best_dist, &best_index, &len, want, d, @intCast(i + lane));
+                }
+                i += lanes;
+            } else {
+                if (prefixes[i] ^ target_prefix <= bound) {
+                    const d = idKey(self.nodes.items[i].id) ^ target_key;
+                    Insert.run(&best_dist, &best_index, &len, want, d, @intCast(i));
+                }
+                i += 1;
+            }
+        }
+
+        for (best_index[0..len], 0..) |node_index, n| out[n] = self.nodes.items[node_index];
+        return len;
+    }
 
-        const actual_count = if (results.items.len < count) results.items.len else count;
-        const out = try self.allocator.alloc(RemoteNode, actual_count);
-        @memcpy(out, results.items[0..actual_count]);
-        return out;
+    /// Up to `count` (at most K) closest nodes; caller frees
+    pub fn findClosest(self: *RoutingTable, target: NodeId, count: usize) ![]RemoteNode {
+        var buf: [K]RemoteNode = undefined;
+        const n = self.closestInto(target, buf[0..@min(count, K)]);
+        return self.allocator.dupe(RemoteNode, buf[0..n]);
     }
 
     pub fn getNodeCount(self: *const RoutingTable) usize {
-        var count: usize = 0;
-        for (self.buckets) |bucket| {
-            count += bucket.nodes.items.len;
+        return self.nodes.items.len;
+    }
+};
+
+/// One FIND_NODE request to send; the answer must echo `txid`
+pub const Query = struct {
+    target: NodeId,
+    node: RemoteNode,
+    txid: u32,
+};
+
+/// Iterative FIND_NODE lookup (Kademlia, alpha-parallel).
+/// Keeps a distance-sorted shortlist of the best 2K candidates seen and
+/// keeps up to `alpha` requests in flight to the closest unqueried ones.
+/// Finished once the K closest live candidates have all answered.
+/// Transport-agnostic: the owner sends what `nextQueries` returns and
+/// feeds answers back. Answers match a request by transaction id (lookup
+/// id in the top 16 bits, request counter below) and by sender address.
+pub const Lookup = struct {
+    const capacity = 2 * K;
+
+    pub const State = enum { pending, in_flight, responded, failed };
+
+    const Candidate = struct {
+        node: RemoteNode,
+        dist: u256,
+        state: State,
+        sent_at: i64,
+        txid: u32,
+    };
+
+    /// Top half of every txid this lookup issues
+    id: u16 = 0,
+    next_request: u16 = 0,
+    target: NodeId,
+    self_id: NodeId,
+    alpha: usize,
+    timeout_ms: i64,
+    started_at: i64,
+    shortlist: [capacity]Candidate = undefined,
+    len: usize = 0,
+    in_flight: usize = 0,
+
+    pub fn init(target: NodeId, self_id: NodeId, alpha: usize, timeout_ms: i64, now: i64) Lookup {
+        std.debug.assert(alpha > 0);
+        return .{ .target = target, .self_id = self_id, .alpha = alpha, .timeout_ms = timeout_ms, .started_at = now };
+    }
+
+    /// Offer a candidate (seed or learned from an answer)
+    pub fn add(self: *Lookup, node: RemoteNode) void {
+        if (std.mem.eql(u8, &node.id, &self.self_id)) return;
+        const dist = idKey(node.id) ^ idKey(self.target);
+        for (self.shortlist[0..self.len]) |c| {
+            if (c.dist == dist) return;
         }
-        return count;
+        if (self.len == capacity and dist >= self.shortlist[capacity - 1].dist) return;
+
+        if (self.len == capacity) {
+            // The evicted candidate may still be in flight
+            if (self.shortlist[capacity - 1].state == .in_flight) self.in_flight -= 1;
+        } else {
+            self.len += 1;
+        }
+        var pos = self.len - 1;
+        while (pos > 0 and self.shortlist[pos - 1].dist > dist) : (pos -= 1) {
+            self.shortlist[pos] = self.shortlist[pos - 1];
+        }
+        self.shortlist[pos] = .{ .node = node, .dist = dist, .state = .pending, .sent_at = 0, .txid = 0 };
+    }
+
+    /// Expire timed-out requests and pick more to send, closest first.
+    /// Writes up to alpha - in_flight requests to `out` and marks them in flight.
+    pub fn nextQueries(self: *Lookup, now: i64, out: []Query) usize {
+        for (self.shortlist[0..self.len]) |*c| {
+            if (c.state == .in_flight and now - c.sent_at >= self.timeout_ms) {
+                c.state = .failed;
+                self.in_flight -= 1;
+            }
+        }
+
+        var n: usize = 0;
+        var live: usize = 0;
+        for (self.shortlist[0..self.len]) |*c| {
+            if (c.state == .failed) continue;
+            if (live == K) break;
+            live += 1;
+            if (c.state != .pending) continue;
+            if (self.in_flight >= self.alpha or n == out.len) break;
+            c.state = .in_flight;
+            c.sent_at = now;
+            c.txid = @as(u32, self.id) << 16 | self.next_request;
+            self.next_request +%= 1;
+            self.in_flight += 1;
+            out[n] = .{ .target = self.target, .node = c.node, .txid = c.txid };
+            n += 1;
+        }
+        return n;
+    }
+
+    /// Mark request `txid` to `from` answered. False if no such request
+    /// was in flight (late, spoofed or for another lookup).
+    pub fn onResponse(self: *Lookup, from: net.Address, txid: u32) bool {
+        for (self.shortlist[0..self.len]) |*c| {
+            if (c.state == .in_flight and c.txid == txid and c.node.address.eql(from)) {
+                c.state = .responded;
+                self.in_flight -= 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Without candidates a lookup waits one timeout for unsolicited
+    /// answers (cold start) before giving up
+    pub fn isDone(self: *const Lookup, now: i64) bool {
+        if (self.len == 0) return now - self.started_at >= self.timeout_ms;
+        var live: usize = 0;
+        for (self.shortlist[0..self.len]) |c| {
+            if (c.state == .failed) continue;
+            if (c.state != .responded) return false;
+            live += 1;
+            if (live == K) break;
+        }
+        return true;
+    }
+
+    /// Closest candidates that answered, nearest first
+    pub fn closestInto(self: *const Lookup, out: []RemoteNode) usize {
+        var n: usize = 0;
+        for (self.shortlist[0..self.len]) |c| {
+            if (n == out.len) break;
+            if (c.state != .responded) continue;
+            out[n] = c.node;
+            n += 1;
+        }
+        return n;
     }
 };
 
@@ -155,18 +410,253 @@ pub const DhtService = struct {
     allocator: std.mem.Allocator,
     routing_table: RoutingTable,
 
+    lookups: std.ArrayListUnmanaged(Lookup),
+    /// Id for the next lookup; random start so txids are hard to guess.
+    /// 0 is never used: requests outside any lookup carry txid 0.
+    next_lookup_id: u16,
+
     pub fn init(allocator: std.mem.Allocator, self_id: NodeId) DhtService {
         return .{
             .allocator = allocator,
             .routing_table = RoutingTable.init(allocator, self_id),
+            .lookups = .{},
+            .next_lookup_id = std.crypto.random.int(u16) | 1,
         };
     }
 
     pub fn deinit(self: *DhtService) void {
         self.routing_table.deinit();
+        self.lookups.deinit(self.allocator);
+    }
+
+    /// Start a lookup for `target` seeded from the routing table.
+    /// Ignored when MAX_LOOKUPS are already running.
+    pub fn startLookup(self: *DhtService, target: NodeId, now: i64) !void {
+        if (self.lookups.items.len >= MAX_LOOKUPS) return;
+        var lookup = Lookup.init(target, self.routing_table.self_id, ALPHA, LOOKUP_TIMEOUT_MS, now);
+        lookup.id = self.next_lookup_id;
+        lookup.next_request = std.crypto.random.int(u16);
+        self.next_lookup_id +%= 1;
+        if (self.next_lookup_id == 0) self.next_lookup_id = 1;
+        var seeds: [K]RemoteNode = undefined;
+        const n = self.routing_table.closestInto(target, &seeds);
+        for (seeds[0..n]) |node| lookup.add(node);
+        try self.lookups.append(self.allocator, lookup);
+    }
+
+    /// A peer answered FIND_NODE request `txid`
+    pub fn onResponse(self: *DhtService, from: net.Address, txid: u32) void {
+        const id: u16 = @intCast(txid >> 16);
+        if (id == 0) return;
+        for (self.lookups.items) |*lookup| {
+            if (lookup.id == id) {
+                _ = lookup.onResponse(from, txid);
+                return;
+            }
+        }
+    }
+
+    /// Stale routing table members to PING (see RoutingTable.duePings)
+    pub fn nextPings(self: *DhtService, now: i64, out: []RemoteNode) usize {
+        return self.routing_table.duePings(now, out);
+    }
+
+    /// A node learned from an answer: candidate for every running lookup
+    pub fn offer(self: *DhtService, node: RemoteNode) void {
+        for (self.lookups.items) |*lookup| lookup.add(node);
+    }
+
+    /// Requests due now across all lookups (out.len >= MAX_LOOKUPS * ALPHA
+    /// never truncates). Finished lookups are dropped.
+    pub fn nextQueries(self: *DhtService, now: i64, out: []Query) usize {
+        var n: usize = 0;
+        var i: usize = 0;
+        while (i < self.lookups.items.len) {
+            const lookup = &self.lookups.items[i];
+            n += lookup.nextQueries(now, out[n..][0..@min(ALPHA, out.len - n)]);
+            if (lookup.isDone(now)) {
+                _ = self.lookups.swapRemove(i);
+            } else {
+                i += 1;
+            }
+        }
+        return n;
     }
 
     pub fn getKnownNodeCount(self: *const DhtService) usize {
         return self.routing_table.getNodeCount();
     }
 };
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+fn testNode(prng: std.Random, port: u16) RemoteNode {
+    var id: NodeId = undefined;
+    prng.bytes(&id);
+    return .{ .id = id, .address = net.Address.initIp4(.{ 10, 0, @intCast(port >> 8), @truncate(port) }, port), .last_seen = 0 };
+}
+
+fn lessByDistance(target: NodeId, a: RemoteNode, b: RemoteNode) bool {
+    return (idKey(a.id) ^ idKey(target)) < (idKey(b.id) ^ idKey(target));
+}
+
+test "RoutingTable: k-closest matches a full sort" {
+    const allocator = std.testing.allocator;
+    var prng = std.Random.DefaultPrng.init(1);
+    const rand = prng.random();
+
+    var table = RoutingTable.init(allocator, [_]u8{0} ** ID_LEN);
+    defer table.deinit();
+
+    var all = std.ArrayListUnmanaged(RemoteNode){};
+    defer all.deinit(allocator);
+    for (0..500) |i| {
+        const node = testNode(rand, @intCast(i + 1));
+        const before = table.getNodeCount();
+        try table.update(node);
+        if (table.getNodeCount() > before) try all.append(allocator, node);
+    }
+    // Refresh does not duplicate
+    try table.update(all.items[0]);
+    try std.testing.expectEqual(all.items.len, table.getNodeCount());
+    try std.testing.expect(table.findNode(all.items[3].id) != null);
+
+    for (0..20) |_| {
+        var target: NodeId = undefined;
+        rand.bytes(&target);
+        std.sort.pdq(RemoteNode, all.items, target, lessByDistance);
+
+        var out: [K]RemoteNode = undefined;
+        try std.testing.expectEqual(@as(usize, K), table.closestInto(target, &out));
+        for (out, all.items[0..K]) |got, want| try std.testing.expectEqualSlices(u8, &want.id, &got.id);
+    }
+}
+
+test "Lookup: converges with alpha requests in flight and survives timeouts" {
+    const allocator = std.testing.allocator;
+    var prng = std.Random.DefaultPrng.init(2);
+    const rand = prng.random();
+
+    // Simulated network: every peer answers with the true K closest it knows
+    var network = RoutingTable.init(allocator, [_]u8{0xFF} ** ID_LEN);
+    defer network.deinit();
+    for (0..400) |i| try network.update(testNode(rand, @intCast(i + 1)));
+
+    var target: NodeId = undefined;
+    rand.bytes(&target);
+    var expected: [K]RemoteNode = undefined;
+    _ = network.closestInto(target, &expected);
+
+    var lookup = Lookup.init(target, [_]u8{0xFE} ** ID_LEN, ALPHA, 100, 0);
+    for (network.nodes.items[0..3]) |seed| lookup.add(seed);
+    // One peer never answers
+    const silent = network.nodes.items[1].address;
+
+    var now: i64 = 0;
+    var rounds: usize = 0;
+    while (!lookup.isDone(now)) : (rounds += 1) {
+        try std.testing.expect(rounds < 200);
+        var batch: [ALPHA]Query = undefined;
+        const n = lookup.nextQueries(now, &batch);
+        try std.testing.expect(lookup.in_flight <= ALPHA);
+        for (batch[0..n]) |query| {
+            const peer = query.node;
+            if (peer.address.eql(silent)) continue;
+            // Only the matching transaction from the queried address counts
+            try std.testing.expect(!lookup.onResponse(peer.address, query.txid +% 1));
+            try std.testing.expect(!lookup.onResponse(silent, query.txid));
+            try std.testing.expect(lookup.onResponse(peer.address, query.txid));
+            try std.testing.expect(!lookup.onResponse(peer.address, query.txid));
+            var answer: [K]RemoteNode = undefined;
+            const count = network.closestInto(target, &answer);
+            for (answer[0..count]) |node| lookup.add(node);
+        }
+        now += 10;
+    }
+
+    var found: [K]RemoteNode = undefined;
+    const n = lookup.closestInto(&found);
+    try std.testing.expect(n >= K - 1);
+    for (found[0..n]) |node| {
+        try std.testing.expect(!node.address.eql(silent));
+    }
+    const nearest = if (expected[0].address.eql(silent)) expected[1] else expected[0];
+    try std.testing.expectEqualSlices(u8, &nearest.id, &found[0].id);
+}
+
+test "RoutingTable: full bucket pings its oldest member before replacing it" {
+    const allocator = std.testing.allocator;
+    const self_id = [_]u8{0} ** ID_LEN;
+    var table = RoutingTable.init(allocator, self_id);
+    defer table.deinit();
+
+    // K + 2 nodes sharing bucket 0 (top bit set), oldest first
+    var members: [K + 2]RemoteNode = undefined;
+    for (&members, 0..) |*node, i| {
+        var id = [_]u8{0x80} ++ [_]u8{0} ** (ID_LEN - 1);
+        id[ID_LEN - 1] = @intCast(i);
+        node.* = .{ .id = id, .address = net.Address.initIp4(.{ 10, 1, 0, @intCast(i) }, 9000), .last_seen = @intCast(100 + i) };
+    }
+    for (members[0..K]) |node| try table.update(node);
+
+    var pings: [4]RemoteNode = undefined;
+    try std.testing.expectEqual(@as(usize, 0), table.duePings(0, &pings));
+
+    // Newcomer on a full bucket: the oldest member is pinged once
+    try table.update(members[K]);
+    try std.testing.expectEqual(@as(usize, K), table.getNodeCount());
+    try std.testing.expectEqual(@as(usize, 1), table.duePings(1000, &pings));
+    try std.testing.expectEqualSlices(u8, &members[0].id, &pings[0].id);
+    try std.testing.expectEqual(@as(usize, 0), table.duePings(1001, &pings));
+
+    // It answers: kept, newcomer discarded
+    var alive = members[0];
+    alive.last_seen = 1000;
+    try table.update(alive);
+    try std.testing.expectEqual(@as(usize, 0), table.duePings(1000 + PING_TIMEOUT_MS, &pings));
+    try std.testing.expect(table.findNode(members[K].id) == null);
+
+    // Next newcomer: the next oldest stays silent and is replaced
+    try table.update(members[K + 1]);
+    try std.testing.expectEqual(@as(usize, 1), table.duePings(5000, &pings));
+    try std.testing.expectEqualSlices(u8, &members[1].id, &pings[0].id);
+    _ = table.duePings(5000 + PING_TIMEOUT_MS, &pings);
+    try std.testing.expect(table.findNode(members[1].id) == null);
+    try std.testing.expect(table.findNode(members[K + 1].id) != null);
+    try std.testing.expectEqual(@as(usize, K), table.getNodeCount());
+
+    var closest: [1]RemoteNode = undefined;
+    _ = table.closestInto(members[K + 1].id, &closest);
+    try std.testing.expectEqualSlices(u8, &members[K + 1].id, &closest[0].id);
+}
+
+test "DhtService: answers match their lookup's transaction" {
+    const allocator = std.testing.allocator;
+    var prng = std.Random.DefaultPrng.init(3);
+    const rand = prng.random();
+
+    var dht = DhtService.init(allocator, [_]u8{0} ** ID_LEN);
+    defer dht.deinit();
+    for (0..8) |i| try dht.routing_table.update(testNode(rand, @intCast(i + 1)));
+
+    var target: NodeId = undefined;
+    rand.bytes(&target);
+    try dht.startLookup(target, 0);
+    rand.bytes(&target);
+    try dht.startLookup(target, 0);
+
+    var queries: [MAX_LOOKUPS * ALPHA]Query = undefined;
+    const n = dht.nextQueries(0, &queries);
+    try std.testing.expectEqual(@as(usize, 2 * ALPHA), n);
+    try std.testing.expect(queries[0].txid >> 16 != queries[ALPHA].txid >> 16);
+
+    // Both lookups queried the same closest peers; one answer marks one request
+    const first = &dht.lookups.items[0];
+    const second = &dht.lookups.items[1];
+    dht.onResponse(queries[0].node.address, queries[0].txid);
+    dht.onResponse(queries[0].node.address, 0);
+    try std.testing.expectEqual(@as(usize, ALPHA - 1), first.in_flight);
+    try std.testing.expectEqual(@as(usize, ALPHA), second.in_flight);
+}
@@ -276,48 +276,32 @@ pub const LWFFrame = struct {
     }
 
     pub fn encode(self: *const LWFFrame, allocator: std.mem.Allocator) ![]u8 {
+        const buffer = try allocator.alloc(u8, self.size());
+        _ = self.encodeInto(buffer) catch unreachable;
+        return buffer;
+    }
+
+    /// Encode into a caller-provided buffer (no allocation)
+    /// Returns the number of bytes written
+    pub fn encodeInto(self: *const LWFFrame, buffer: []u8) !usize {
         const total_size = self.size();
-        var buffer = try allocator.alloc(u8, total_size);
+        if (buffer.len < total_size) return error.BufferTooSmall;
 
-        var header_bytes: [88]u8 = undefined;
-        self.header.toBytes(&header_bytes);
-        @memcpy(buffer[0..88], &header_bytes);
+        self.header.toBytes(buffer[0..88]);
 
         @memcpy(buffer[88 .. 88 + self.payload.len], self.payload);
 
-        var trailer_bytes: [36]u8 = undefined;
-        self.trailer.toBytes(&trailer_bytes);
         const trailer_start = 88 + self.payload.len;
-        @memcpy(buffer[trailer_start .. trailer_start + 36], &trailer_bytes);
+        self.trailer.toBytes(buffer[trailer_start..][0..36]);
 
-        return buffer;
+        return total_size;
     }
 
+    /// Parse and copy the payload out of `data`
+    /// Use LWFFrameView.parse when the frame does not outlive the buffer.
     pub fn decode(allocator: std.mem.Allocator, data: []const u8) !LWFFrame {
-        if (data.len < 88 + 36) return error.FrameTooSmall;
-
-        var header_bytes: [88]u8 = undefined;
-        @memcpy(&header_bytes, data[0..88]);
-        const header = LWFHeader.fromBytes(&header_bytes);
-
-        if (!header.isValid()) return error.InvalidHeader;
-
-        const payload_len = @as(usize, @intCast(header.payload_len));
-        if (data.len < 88 + payload_len + 36) return error.InvalidPayloadLength;
-
-        const payload = try allocator.alloc(u8, payload_len);
-        @memcpy(payload, data[88 .. 88 + payload_len]);
-
-        const trailer_start = 88 + payload_len;
-        var trailer_bytes: [36]u8 = undefined;
-        @memcpy(&trailer_bytes, data[trailer_start .. trailer_start + 36]);
-        const trailer = LWFTrailer.fromBytes(&trailer_bytes);
-
-        return .{
-            .header = header,
-            .payload = payload,
-            .trailer = trailer,
-        };
+        const view = try LWFFrameView.parse(data);
+        return view.toOwned(allocator);
     }
 
     pub fn calculateChecksum(self: *const LWFFrame) u32 {
@@ -341,6 +325,57 @@ pub const LWFFrame = struct {
     }
 };
 
+/// Borrowed LWF frame: header and trailer parsed in place, payload aliases
+/// the receive buffer. Valid only while that buffer is; call toOwned() to
+/// keep the frame longer.
+pub const LWFFrameView = struct {
+    header: LWFHeader,
+    payload: []const u8,
+    trailer: LWFTrailer,
+    /// Encoded frame (header..trailer) within the source buffer
+    bytes: []const u8,
+
+    pub fn parse(data: []const u8) !LWFFrameView {
+        if (data.len < LWFHeader.SIZE + LWFTrailer.SIZE) return error.FrameTooSmall;
+
+        const header = LWFHeader.fromBytes(data[0..LWFHeader.SIZE]);
+        if (!header.isValid()) return error.InvalidHeader;
+
+        const payload_len = @as(usize, @intCast(header.payload_len));
+        const total = LWFHeader.SIZE + payload_len + LWFTrailer.SIZE;
+        if (data.len < total) return error.InvalidPayloadLength;
+
+        const trailer_start = LWFHeader.SIZE + payload_len;
+        return .{
+            .header = header,
+            .payload = data[LWFHeader.SIZE..trailer_start],
+            .trailer = LWFTrailer.fromBytes(data[trailer_start..][0..LWFTrailer.SIZE]),
+            .bytes = data[0..total],
+        };
+    }
+
+    /// Copy the payload into a standalone frame
+    pub fn toOwned(self: *const LWFFrameView, allocator: std.mem.Allocator) !LWFFrame {
+        return .{
+            .header = self.header,
+            .payload = try allocator.dupe(u8, self.payload),
+            .trailer = self.trailer,
+        };
+    }
+
+    /// CRC over the wire header bytes and payload (no re-serialization)
+    pub fn calculateChecksum(self: *const LWFFrameView) u32 {
+        var hasher = std.hash.Crc32.init();
+        hasher.update(self.bytes[0..LWFHeader.SIZE]);
+        hasher.update(self.payload);
+        return hasher.final();
+    }
+
+    pub fn verifyChecksum(self: *const LWFFrameView) bool {
+        return self.calculateChecksum() == std.mem.bigToNative(u32, self.trailer.checksum);
+    }
+};
+
 // ============================================================================
 // Tests
 // ============================================================================
@@ -391,3 +426,29 @@ test "FrameClass payload sizes" {
     // Big: 4096 - 124 = 3972
     try std.testing.expectEqual(@as(usize, 3972), FrameClass.big.maxPayloadSize());
 }
+
+test "LWFFrameView borrows the payload" {
+    const allocator = std.testing.allocator;
+    var frame = try LWFFrame.init(allocator, 16);
+    defer frame.deinit(allocator);
+    @memcpy(frame.payload, "zero-copy-view!!");
+    frame.header.payload_len = 16;
+    frame.updateChecksum();
+
+    var buffer: [256]u8 = undefined;
+    const len = try frame.encodeInto(&buffer);
+
+    const view = try LWFFrameView.parse(buffer[0..len]);
+    try std.testing.expectEqual(@intFromPtr(&buffer) + LWFHeader.SIZE, @intFromPtr(view.payload.ptr));
+    try std.testing.expect(view.verifyChecksum());
+    try std.testing.expectEqual(len, view.bytes.len);
+
+    var owned = try view.toOwned(allocator);
+    defer owned.deinit(allocator);
+    try std.testing.expectEqualSlices(u8, frame.payload, owned.payload);
+    try std.testing.expect(owned.verifyChecksum());
+
+    buffer[LWFHeader.SIZE] ^= 0xFF;
+    try std.testing.expect(!(try LWFFrameView.parse(buffer[0..len])).verifyChecksum());
+    try std.testing.expectError(error.InvalidPayloadLength, LWFFrameView.parse(buffer[0 .. len - 1]));
+}
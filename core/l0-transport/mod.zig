@@ -11,6 +11,7 @@ const std = @import("std");
 pub const LWFHeader = @import("lwf.zig").LWFHeader;
 pub const LWFTrailer = @import("lwf.zig").LWFTrailer;
 pub const LWFFrame = @import("lwf.zig").LWFFrame;
+pub const LWFFrameView = @import("lwf.zig").LWFFrameView;
 pub const LWFFlags = @import("lwf.zig").LWFFlags;
 pub const FrameClass = @import("lwf.zig").FrameClass;
 
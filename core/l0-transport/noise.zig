@@ -15,9 +15,14 @@
 //! - Noise_NN_25519_ChaChaPoly_BLAKE2s (no authentication, encryption only)
 //!
 //! Kenya-compliant: Minimal allocations, no heap required for handshake.
+//! Transport frames are sealed and opened in place: the payload region of
+//! an LWF frame is encrypted where it lies and the tag rides in the
+//! trailer's signature slot, so no ciphertext buffer is needed.
 
 const std = @import("std");
+const lwf = @import("lwf.zig");
 const blake2 = std.crypto.hash.blake2;
+const ChaCha20Poly1305 = std.crypto.aead.chacha_poly.ChaCha20Poly1305;
 
 /// Noise Protocol State Machine
 /// Implements the Noise state machine with symmetric and DH state
@@ -195,7 +200,12 @@ pub const NoiseState = struct {
 /// Cipher state for ChaCha20-Poly1305 encryption
 pub const CipherState = struct {
     key: [32]u8,
+    /// Stream counter for encryptWithAd/sealInPlace and their inverses
     nonce: u64,
+    /// Lowest frame sequence `sealFrame` still accepts
+    frame_seq: u64 = 0,
+    /// Frame sequences already opened
+    replay: ReplayWindow = .{},
     
     const Self = @This();
     
@@ -215,16 +225,13 @@ pub const CipherState = struct {
     ) !usize {
         if (ciphertext.len < plaintext.len + 16) return error.BufferTooSmall;
 
-        var nonce: [12]u8 = undefined;
-        std.mem.writeInt(u64, nonce[4..12], self.nonce, .little);
-
         var tag: [16]u8 = undefined;
         std.crypto.aead.chacha_poly.ChaCha20Poly1305.encrypt(
             ciphertext[0..plaintext.len],
             &tag,
             plaintext,
             ad,
-            nonce,
+            nonceBytes(self.nonce),
             self.key,
         );
 
@@ -243,9 +250,6 @@ pub const CipherState = struct {
     ) !usize {
         if (ciphertext.len < 16) return error.InvalidCiphertext;
         
-        var nonce: [12]u8 = undefined;
-        std.mem.writeInt(u64, nonce[4..12], self.nonce, .little);
-        
         const payload_len = ciphertext.len - 16;
         if (plaintext.len < payload_len) return error.BufferTooSmall;
         
@@ -256,15 +260,151 @@ pub const CipherState = struct {
             ciphertext[0..payload_len],
             tag,
             ad,
-            nonce,
+            nonceBytes(self.nonce),
             self.key,
         );
         
         self.nonce += 1;
         return payload_len;
     }
+
+    fn nonceBytes(n: u64) [ChaCha20Poly1305.nonce_length]u8 {
+        var nonce = [_]u8{0} ** ChaCha20Poly1305.nonce_length;
+        std.mem.writeInt(u64, nonce[4..12], n, .little);
+        return nonce;
+    }
+
+    /// Encrypt `data` in place; returns the tag
+    pub fn sealInPlace(self: *Self, ad: []const u8, data: []u8) [TAG_LEN]u8 {
+        var tag: [TAG_LEN]u8 = undefined;
+        ChaCha20Poly1305.encrypt(data, &tag, data, ad, nonceBytes(self.nonce), self.key);
+        self.nonce += 1;
+        return tag;
+    }
+
+    /// Decrypt `data` in place. On failure the nonce is not consumed and
+    /// `data` is garbage.
+    pub fn openInPlace(self: *Self, ad: []const u8, data: []u8, tag: [TAG_LEN]u8) !void {
+        try ChaCha20Poly1305.decrypt(data, data, tag, ad, nonceBytes(self.nonce), self.key);
+        self.nonce += 1;
+    }
+
+    /// Frame nonces: a domain prefix plus the frame's own sequence number,
+    /// so the stream counter above and frame sealing never collide and a
+    /// receiver needs no state shared with the sender beyond the key.
+    fn frameNonce(sequence: u32) [ChaCha20Poly1305.nonce_length]u8 {
+        var nonce = [_]u8{0} ** ChaCha20Poly1305.nonce_length;
+        nonce[0] = 0x01;
+        std.mem.writeInt(u32, nonce[8..12], sequence, .little);
+        return nonce;
+    }
+
+    /// Encrypt a frame's payload in place.
+    /// The nonce comes from `header.sequence` (authenticated with the rest of
+    /// the header), which must increase strictly per key: a sequence below
+    /// the last sealed one fails with error.NonceReuse.
+    /// Sets ENCRYPTED, authenticates the header as associated data, stores
+    /// the tag in the (otherwise unused) trailer signature and refreshes the
+    /// checksum. Signed frames need the signature slot: error.TrailerInUse.
+    pub fn sealFrame(self: *Self, frame: *lwf.LWFFrame) !void {
+        if (frame.header.flags & lwf.LWFFlags.SIGNED != 0) return error.TrailerInUse;
+        if (frame.header.sequence < self.frame_seq) return error.NonceReuse;
+        self.sealFrameUnchecked(frame);
+    }
+
+    fn sealFrameUnchecked(self: *Self, frame: *lwf.LWFFrame) void {
+        frame.header.flags |= lwf.LWFFlags.ENCRYPTED;
+
+        var ad: [lwf.LWFHeader.SIZE]u8 = undefined;
+        frame.header.toBytes(&ad);
+        frame.trailer.signature = [_]u8{0} ** 32;
+        var tag: [TAG_LEN]u8 = undefined;
+        ChaCha20Poly1305.encrypt(frame.payload, &tag, frame.payload, &ad, frameNonce(frame.header.sequence), self.key);
+        frame.trailer.signature[0..TAG_LEN].* = tag;
+        frame.updateChecksum();
+        self.frame_seq = @as(u64, frame.header.sequence) + 1;
+    }
+
+    /// Decrypt a frame sealed by `sealFrame` in place, clear ENCRYPTED and
+    /// refresh the checksum.
+    /// Frames may arrive lost or reordered; a sequence seen before or older
+    /// than the replay window fails with error.Replay before decryption.
+    /// On authentication failure the payload is garbage and the window is
+    /// unchanged.
+    pub fn openFrame(self: *Self, frame: *lwf.LWFFrame) !void {
+        if (frame.header.flags & lwf.LWFFlags.ENCRYPTED == 0) return error.NotEncrypted;
+        const sequence = frame.header.sequence;
+        if (!self.replay.check(sequence)) return error.Replay;
+
+        var ad: [lwf.LWFHeader.SIZE]u8 = undefined;
+        frame.header.toBytes(&ad);
+        const tag = frame.trailer.signature[0..TAG_LEN].*;
+        try ChaCha20Poly1305.decrypt(frame.payload, frame.payload, tag, &ad, frameNonce(sequence), self.key);
+        self.replay.accept(sequence);
+        frame.header.flags &= ~lwf.LWFFlags.ENCRYPTED;
+        frame.updateChecksum();
+    }
+
+    /// Seal frames in order (same result as calling `sealFrame` on each).
+    /// All frames are checked before any is touched.
+    pub fn sealFrames(self: *Self, frames: []lwf.LWFFrame) !void {
+        var next = self.frame_seq;
+        for (frames) |*frame| {
+            if (frame.header.flags & lwf.LWFFlags.SIGNED != 0) return error.TrailerInUse;
+            if (frame.header.sequence < next) return error.NonceReuse;
+            next = @as(u64, frame.header.sequence) + 1;
+        }
+        for (frames) |*frame| self.sealFrameUnchecked(frame);
+    }
+
+    /// Open every frame (same result as calling `openFrame` on each).
+    /// Returns how many were opened; rejected frames keep ENCRYPTED set
+    /// (their payload is garbage if authentication failed) and should be
+    /// dropped by the caller.
+    pub fn openFrames(self: *Self, frames: []lwf.LWFFrame) usize {
+        var opened: usize = 0;
+        for (frames) |*frame| {
+            self.openFrame(frame) catch continue;
+            opened += 1;
+        }
+        return opened;
+    }
 };
 
+/// Sliding anti-replay window over frame sequence numbers (RFC 6479 style):
+/// accepts any unseen sequence within `SIZE` of the highest one accepted.
+pub const ReplayWindow = struct {
+    pub const SIZE = 64;
+
+    /// Highest accepted sequence + 1 (0 = nothing accepted yet)
+    top: u64 = 0,
+    /// Bit i set = sequence `top - 1 - i` was accepted
+    seen: u64 = 0,
+
+    /// Whether `sequence` may still be accepted
+    pub fn check(self: *const ReplayWindow, sequence: u64) bool {
+        if (sequence >= self.top) return true;
+        const age = self.top - 1 - sequence;
+        if (age >= SIZE) return false;
+        return self.seen & (@as(u64, 1) << @intCast(age)) == 0;
+    }
+
+    /// Record an authenticated sequence (after `check` passed)
+    pub fn accept(self: *ReplayWindow, sequence: u64) void {
+        if (sequence >= self.top) {
+            const shift = sequence + 1 - self.top;
+            self.seen = if (shift >= SIZE) 0 else self.seen << @intCast(shift);
+            self.seen |= 1;
+            self.top = sequence + 1;
+        } else {
+            self.seen |= @as(u64, 1) << @intCast(self.top - 1 - sequence);
+        }
+    }
+};
+
+/// Poly1305 tag length
+pub const TAG_LEN = ChaCha20Poly1305.tag_length;
+
 /// X25519 key generation
 fn x25519KeyGen(seed: [32]u8) !NoiseState.X25519KeyPair {
     var kp: NoiseState.X25519KeyPair = undefined;
@@ -380,54 +520,54 @@ pub const NoiseHandshake = struct {
         allocator: std.mem.Allocator,
         plaintext: []const u8,
     ) ![]u8 {
-        // Encrypt with Noise
-        var ciphertext: [4096]u8 = undefined;
-        const ct_len = try self.noise.writeMessage(plaintext, &ciphertext);
-        
-        // Apply MIMIC skin camouflage
-        const skinned = try self.applySkin(allocator, ciphertext[0..ct_len]);
-        
-        return skinned;
+        const prefix = self.skinPrefixLen();
+        const buf = try allocator.alloc(u8, prefix + plaintext.len + TAG_LEN);
+        errdefer allocator.free(buf);
+
+        @memcpy(buf[prefix..][0..plaintext.len], plaintext);
+        _ = try self.wrapTransportInPlace(buf, plaintext.len);
+        return buf;
     }
-    
-    fn applySkin(self: *NoiseHandshake, allocator: std.mem.Allocator, data: []const u8) ![]u8 {
+
+    /// Skin header bytes in front of the ciphertext
+    pub fn skinPrefixLen(self: *const NoiseHandshake) usize {
         return switch (self.skin) {
-            .Raw => try allocator.dupe(u8, data),
-            .MimicHttps => try self.mimicHttps(allocator, data),
-            .MimicDns => try self.mimicDns(allocator, data),
-            .MimicQuic => try self.mimicQuic(allocator, data),
+            .Raw => 0,
+            .MimicHttps => 5,
+            .MimicDns, .MimicQuic => 1,
         };
     }
-    
-    fn mimicHttps(self: *NoiseHandshake, allocator: std.mem.Allocator, data: []const u8) ![]u8 {
-        // Wrap in WebSocket frame with TLS-like padding
-        _ = self;
-        
-        // Build fake TLS record layer
-        var result = try allocator.alloc(u8, 5 + data.len);
-        result[0] = 0x17; // Application Data
-        result[1] = 0x03; // TLS 1.2
-        result[2] = 0x03;
-        std.mem.writeInt(u16, result[3..5], @intCast(data.len), .big);
-        @memcpy(result[5..], data);
-        
-        return result;
-    }
-    
-    fn mimicDns(_: *NoiseHandshake, allocator: std.mem.Allocator, data: []const u8) ![]u8 {
-        // Encode as DNS TXT record format
-        var result = try allocator.alloc(u8, data.len + 1);
-        result[0] = @intCast(data.len);
-        @memcpy(result[1..], data);
-        return result;
-    }
-    
-    fn mimicQuic(_: *NoiseHandshake, allocator: std.mem.Allocator, data: []const u8) ![]u8 {
-        // QUIC Short Header format (simplified)
-        var result = try allocator.alloc(u8, 1 + data.len);
-        result[0] = 0x40; // Short header, 1-byte CID
-        @memcpy(result[1..], data);
-        return result;
+
+    /// Wrap transport data without allocating.
+    /// The plaintext sits at `buf[skinPrefixLen()..][0..plaintext_len]`;
+    /// it is encrypted in place, the tag appended and the skin header
+    /// written in front. Returns the wrapped length.
+    pub fn wrapTransportInPlace(self: *NoiseHandshake, buf: []u8, plaintext_len: usize) !usize {
+        const prefix = self.skinPrefixLen();
+        const ct_len = plaintext_len + TAG_LEN;
+        if (buf.len < prefix + ct_len) return error.BufferTooSmall;
+
+        switch (self.skin) {
+            .Raw => {},
+            .MimicHttps => {
+                // Fake TLS record layer
+                if (ct_len > std.math.maxInt(u16)) return error.MessageTooLarge;
+                buf[0] = 0x17; // Application Data
+                buf[1] = 0x03; // TLS 1.2
+                buf[2] = 0x03;
+                std.mem.writeInt(u16, buf[3..5], @intCast(ct_len), .big);
+            },
+            .MimicDns => {
+                // DNS TXT record length byte
+                if (ct_len > std.math.maxInt(u8)) return error.MessageTooLarge;
+                buf[0] = @intCast(ct_len);
+            },
+            .MimicQuic => buf[0] = 0x40, // Short header, 1-byte CID
+        }
+
+        const body = buf[prefix..][0..plaintext_len];
+        buf[prefix + plaintext_len ..][0..TAG_LEN].* = self.noise.c1.sealInPlace(&self.noise.hash, body);
+        return prefix + ct_len;
     }
 };
 
@@ -468,3 +608,93 @@ test "NoiseHandshake with MIMIC skin" {
     );
     _ = handshake;
 }
+
+test "CipherState in-place frame seal/open" {
+    const allocator = std.testing.allocator;
+    var tx = CipherState{ .key = [_]u8{0x42} ** 32, .nonce = 0 };
+    var rx = tx;
+
+    var frames: [3]lwf.LWFFrame = undefined;
+    for (&frames, 0..) |*frame, i| {
+        frame.* = try lwf.LWFFrame.init(allocator, 40 + i);
+        @memset(frame.payload, @intCast('a' + i));
+        frame.header.payload_len = @intCast(frame.payload.len);
+        frame.header.sequence = @intCast(i);
+    }
+    defer for (&frames) |*frame| frame.deinit(allocator);
+
+    try tx.sealFrames(&frames);
+    try std.testing.expectEqual(@as(u64, 3), tx.frame_seq);
+    try std.testing.expectEqual(@as(u64, 0), tx.nonce);
+    for (&frames, 0..) |*frame, i| {
+        try std.testing.expect(frame.header.flags & lwf.LWFFlags.ENCRYPTED != 0);
+        try std.testing.expect(frame.verifyChecksum());
+        try std.testing.expect(!std.mem.allEqual(u8, frame.payload, @intCast('a' + i)));
+    }
+
+    // Sequences must keep increasing under one key
+    try std.testing.expectError(error.NonceReuse, tx.sealFrame(&frames[0]));
+
+    // Tampered header fails; the other frames still open
+    frames[1].header.sequence ^= 1;
+    try std.testing.expectEqual(@as(usize, 2), rx.openFrames(&frames));
+    try std.testing.expectEqual(@as(u8, 'a'), frames[0].payload[0]);
+    try std.testing.expectEqual(@as(u8, 'c'), frames[2].payload[0]);
+    try std.testing.expect(frames[0].verifyChecksum());
+    try std.testing.expect(frames[1].header.flags & lwf.LWFFlags.ENCRYPTED != 0);
+}
+
+test "CipherState opens lost and reordered frames once" {
+    const allocator = std.testing.allocator;
+    var tx = CipherState{ .key = [_]u8{0x17} ** 32, .nonce = 0 };
+    var rx = tx;
+
+    // Sequences 0..4 and one far ahead; 1 is lost
+    const sequences = [_]u32{ 0, 1, 2, 3, 4, 200 };
+    var frames: [sequences.len]lwf.LWFFrame = undefined;
+    for (&frames, sequences) |*frame, seq| {
+        frame.* = try lwf.LWFFrame.init(allocator, 16);
+        frame.header.payload_len = 16;
+        frame.header.sequence = seq;
+        try tx.sealFrame(frame);
+    }
+    defer for (&frames) |*frame| frame.deinit(allocator);
+
+    var copies: [sequences.len]lwf.LWFFrame = undefined;
+    for (&copies, frames) |*copy, frame| {
+        copy.* = frame;
+        copy.payload = try allocator.dupe(u8, frame.payload);
+    }
+    defer for (&copies) |*copy| copy.deinit(allocator);
+
+    try rx.openFrame(&frames[3]);
+    try rx.openFrame(&frames[0]);
+    try rx.openFrame(&frames[4]);
+    try rx.openFrame(&frames[2]);
+    // Replays are rejected without decrypting
+    try std.testing.expectError(error.Replay, rx.openFrame(&copies[2]));
+    try std.testing.expectError(error.Replay, rx.openFrame(&copies[0]));
+
+    // A jump past the window ages out the old sequences, including the lost one
+    try rx.openFrame(&frames[5]);
+    try std.testing.expectError(error.Replay, rx.openFrame(&copies[1]));
+}
+
+test "NoiseHandshake transport opens on the receive path" {
+    const allocator = std.testing.allocator;
+    var a = try NoiseHandshake.initWithSkin(.Noise_XX, .Initiator, .MimicHttps, null, null);
+    var b = a;
+
+    const plaintext = "frame payload";
+    for (0..2) |_| {
+        const wrapped = try a.wrapTransport(allocator, plaintext);
+        defer allocator.free(wrapped);
+        try std.testing.expectEqual(@as(u8, 0x17), wrapped[0]);
+        try std.testing.expectEqual(plaintext.len + TAG_LEN, std.mem.readInt(u16, wrapped[3..5], .big));
+
+        // Strip the fake TLS record header and open with readMessage
+        var opened: [plaintext.len]u8 = undefined;
+        const len = try b.noise.readMessage(wrapped[a.skinPrefixLen()..], &opened);
+        try std.testing.expectEqualStrings(plaintext, opened[0..len]);
+    }
+}
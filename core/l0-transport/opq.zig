@@ -6,11 +6,13 @@
 
 //! Sovereign Index for OPQ
 pub const store = @import("./opq/store.zig");
+pub const segment_reader = @import("./opq/segment_reader.zig");
 pub const quota = @import("./opq/quota.zig");
 pub const manager = @import("./opq/manager.zig");
 pub const manifest = @import("./opq/manifest.zig");
 pub const merkle = @import("./opq/merkle.zig");
 pub const sequencer = @import("./opq/sequencer.zig");
+pub const recipient_queue = @import("./opq/recipient_queue.zig");
 pub const reorder_buffer = @import("./opq/reorder_buffer.zig");
 pub const trust_resolver = @import("./opq/trust_resolver.zig");
 
@@ -18,6 +20,7 @@ pub const OPQManager = manager.OPQManager;
 pub const Policy = quota.Policy;
 pub const Persona = quota.Persona;
 pub const WALStore = store.WALStore;
+pub const SegmentReader = segment_reader.SegmentReader;
 
 test {
     @import("std").testing.refAllDecls(@This());
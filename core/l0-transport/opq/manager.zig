@@ -8,31 +8,86 @@ const quota = @import("./quota.zig");
 const manifest = @import("./manifest.zig");
 const sequencer = @import("./sequencer.zig");
 const trust_resolver = @import("./trust_resolver.zig");
+const recipient_queue = @import("./recipient_queue.zig");
 const lwf = @import("lwf");
 
+/// Minimum interval between maintenance passes triggered by ingest
+pub const MAINTENANCE_INTERVAL_MS: i64 = 1000;
+
 pub const OPQManager = struct {
     allocator: std.mem.Allocator,
     policy: quota.Policy,
     store: store.WALStore,
-    index: std.ArrayListUnmanaged(manifest.PacketSummary),
+    /// Queued summaries by recipient (dest_hint)
+    queues: std.AutoHashMapUnmanaged([24]u8, recipient_queue.RecipientQueue),
+    /// Earliest expiry across all queues
+    next_expiry: i64,
+    /// When maintenance last ran (ms)
+    last_maintenance: i64,
     trust_resolver: trust_resolver.TrustResolver,
 
     pub fn init(allocator: std.mem.Allocator, base_dir: []const u8, persona: quota.Persona, resolver: trust_resolver.TrustResolver) !OPQManager {
         const policy = quota.Policy.init(persona);
-        const wal = try store.WALStore.init(allocator, base_dir, policy.segment_size);
+        var wal = try store.WALStore.init(allocator, base_dir, policy.segment_size);
+        wal.entry_ttl_seconds = policy.max_retention_seconds;
 
-        return OPQManager{
+        var self = OPQManager{
             .allocator = allocator,
             .policy = policy,
             .store = wal,
-            .index = .{},
+            .queues = .{},
+            .next_expiry = std.math.maxInt(i64),
+            .last_maintenance = 0,
             .trust_resolver = resolver,
         };
+        errdefer self.deinit();
+
+        try self.recoverIndex();
+        return self;
+    }
+
+    /// Rebuild the in-memory index from the segment sidecars
+    fn recoverIndex(self: *OPQManager) !void {
+        var records = std.ArrayListUnmanaged(store.IndexRecord){};
+        defer records.deinit(self.allocator);
+        try self.store.recoverIndex(&records);
+
+        const now = std.time.timestamp();
+        for (records.items) |rec| {
+            const e = rec.entry;
+            if (e.expires_at <= now) continue;
+
+            var q_id: [16]u8 = undefined;
+            std.crypto.random.bytes(&q_id);
+
+            try self.enqueue(e.dest_hint, .{
+                .queue_id = q_id,
+                .sender_hint = e.sender_hint,
+                .size = e.len,
+                .priority = if (e.flags & lwf.LWFFlags.PRIORITY != 0) .high else .normal,
+                .created_at = e.created_at,
+                .timestamp = e.timestamp,
+                .sequence = e.sequence,
+                .expires_at = e.expires_at,
+                .entropy_cost = e.entropy_difficulty,
+                .category = self.trust_resolver.resolve(e.sender_hint),
+                .location = rec.location,
+            });
+        }
     }
 
     pub fn deinit(self: *OPQManager) void {
         self.store.deinit();
-        self.index.deinit(self.allocator);
+        var it = self.queues.valueIterator();
+        while (it.next()) |queue| queue.deinit(self.allocator);
+        self.queues.deinit(self.allocator);
+    }
+
+    fn enqueue(self: *OPQManager, recipient: [24]u8, summary: manifest.PacketSummary) !void {
+        const entry = try self.queues.getOrPut(self.allocator, recipient);
+        if (!entry.found_existing) entry.value_ptr.* = recipient_queue.RecipientQueue.init(self.allocator);
+        try entry.value_ptr.insert(self.allocator, summary);
+        self.next_expiry = @min(self.next_expiry, summary.expires_at);
     }
 
     /// Ingest a frame into the queue
@@ -53,7 +108,7 @@ pub const OPQManager = struct {
         var q_id: [16]u8 = undefined;
         std.crypto.random.bytes(&q_id);
 
-        try self.index.append(self.allocator, .{
+        try self.enqueue(frame.header.dest_hint, .{
             .queue_id = q_id,
             .sender_hint = frame.header.source_hint,
             .size = @intCast(loc.len),
@@ -64,36 +119,83 @@ pub const OPQManager = struct {
             .expires_at = std.time.timestamp() + self.policy.max_retention_seconds,
             .entropy_cost = frame.header.entropy_difficulty,
             .category = category,
+            .location = loc,
         });
 
-        // 5. Periodic maintenance
-        try self.maintenance();
+        // 5. Periodic maintenance (the group-commit window is checked every time)
+        if (std.time.milliTimestamp() - self.last_maintenance >= MAINTENANCE_INTERVAL_MS) {
+            try self.maintenance();
+        } else {
+            _ = try self.store.pollCommit();
+        }
     }
 
+    /// Manifest of everything queued for `recipient`, in deterministic order.
+    /// Costs O(items for that recipient); the order and Merkle tree are
+    /// maintained on insert.
     pub fn generateManifest(self: *OPQManager, recipient: [24]u8) !manifest.QueueManifest {
         var qm = manifest.QueueManifest.init(self.allocator, recipient);
         errdefer qm.deinit();
 
-        for (self.index.items) |item| {
-            // In a real relay, we would filter by recipient!
-            // For now, we just add everything to the manifest.
-            try qm.items.append(self.allocator, item);
-            qm.total_count += 1;
-            qm.total_size += item.size;
-        }
+        const queue = self.queues.getPtr(recipient) orelse return qm;
+        try qm.items.appendSlice(self.allocator, queue.items.items);
+        qm.total_count = queue.items.items.len;
+        qm.total_size = queue.total_size;
+        qm.merkle_root = queue.root();
+        return qm;
+    }
 
-        sequencer.sortDeterministically(qm.items.items);
+    /// Drop expired summaries (only scans once something is due)
+    fn pruneIndex(self: *OPQManager, now: i64) void {
+        if (now < self.next_expiry) return;
 
-        try qm.calculateMerkleRoot();
-        return qm;
+        self.next_expiry = std.math.maxInt(i64);
+        var it = self.queues.iterator();
+        while (it.next()) |entry| {
+            const queue = entry.value_ptr;
+            _ = queue.pruneExpired(now);
+            if (queue.items.items.len == 0) {
+                // Removal keeps the iterator valid
+                queue.deinit(self.allocator);
+                self.queues.removeByPtr(entry.key_ptr);
+                continue;
+            }
+            self.next_expiry = @min(self.next_expiry, queue.next_expiry);
+        }
+    }
+
+    /// Drop summaries whose frames went with a pruned segment
+    fn dropPrunedSummaries(self: *OPQManager) void {
+        const Pruned = struct {
+            wal: *const store.WALStore,
+            pub fn drop(ctx: @This(), item: manifest.PacketSummary) bool {
+                const loc = item.location orelse return false;
+                return !ctx.wal.containsSegment(loc);
+            }
+        };
+        var it = self.queues.iterator();
+        while (it.next()) |entry| {
+            const queue = entry.value_ptr;
+            _ = queue.removeIf(Pruned{ .wal = &self.store });
+            if (queue.items.items.len == 0) {
+                queue.deinit(self.allocator);
+                self.queues.removeByPtr(entry.key_ptr);
+            }
+        }
     }
 
     pub fn maintenance(self: *OPQManager) !void {
+        self.last_maintenance = std.time.milliTimestamp();
+
+        // 0. Close an expired group-commit window
+        _ = try self.store.pollCommit();
+
         // 1. Prune by TTL
-        _ = try self.store.prune(self.policy.max_retention_seconds);
+        self.pruneIndex(std.time.timestamp());
+        if (try self.store.prune(self.policy.max_retention_seconds) > 0) self.dropPrunedSummaries();
 
         // 2. Prune by Size Quota
-        _ = try self.store.pruneToSize(self.policy.max_storage_bytes);
+        if (try self.store.pruneToSize(self.policy.max_storage_bytes) > 0) self.dropPrunedSummaries();
     }
 };
 
@@ -125,6 +227,58 @@ test "OPQ Manager: Policy Enforcement" {
     try std.testing.expect(!std.mem.eql(u8, &mf.merkle_root, &[_]u8{0} ** 32));
 }
 
+test "OPQ Manager: Pruned segments leave the manifest" {
+    const allocator = std.testing.allocator;
+    const test_dir = "test_opq_pruned";
+
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    var manager = try OPQManager.init(allocator, test_dir, .relay, trust_resolver.TrustResolver.noop());
+    defer manager.deinit();
+
+    const old = [_]u8{0x01} ** 24;
+    const new = [_]u8{0x02} ** 24;
+
+    // One frame per segment
+    manager.store.max_segment_size = store.SegmentHeader.SIZE + 1;
+    for ([_][24]u8{ old, new }) |recipient| {
+        var frame = try lwf.LWFFrame.init(allocator, 10);
+        defer frame.deinit(allocator);
+        frame.header.dest_hint = recipient;
+        frame.updateChecksum();
+        try manager.ingestFrame(&frame);
+    }
+
+    // Age out every finished segment; summaries themselves have not expired
+    manager.policy.max_retention_seconds = -1;
+    try manager.maintenance();
+
+    var gone = try manager.generateManifest(old);
+    defer gone.deinit();
+    try std.testing.expectEqual(@as(usize, 0), gone.total_count);
+    var kept = try manager.generateManifest(new);
+    defer kept.deinit();
+    try std.testing.expectEqual(@as(usize, 1), kept.total_count);
+
+    // Same for the size quota
+    manager.policy.max_retention_seconds = 3600;
+    manager.policy.max_storage_bytes = 1;
+    var frame = try lwf.LWFFrame.init(allocator, 10);
+    defer frame.deinit(allocator);
+    frame.header.dest_hint = old;
+    frame.updateChecksum();
+    try manager.ingestFrame(&frame);
+    try manager.maintenance();
+
+    var evicted = try manager.generateManifest(new);
+    defer evicted.deinit();
+    try std.testing.expectEqual(@as(usize, 0), evicted.total_count);
+    var active = try manager.generateManifest(old);
+    defer active.deinit();
+    try std.testing.expectEqual(@as(usize, 1), active.total_count);
+}
+
 test "OPQ Manager: Deterministic Manifest Ordering" {
     const allocator = std.testing.allocator;
     const test_dir = "test_opq_ordering";
@@ -161,3 +315,43 @@ test "OPQ Manager: Deterministic Manifest Ordering" {
     try std.testing.expectEqual(mf.items.items[0].timestamp, 100);
     try std.testing.expectEqual(mf.items.items[1].timestamp, 200);
 }
+
+test "OPQ Manager: Per-recipient Manifests" {
+    const allocator = std.testing.allocator;
+    const test_dir = "test_opq_recipients";
+
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    const alice = [_]u8{0xA} ** 24;
+    const bob = [_]u8{0xB} ** 24;
+
+    {
+        var manager = try OPQManager.init(allocator, test_dir, .relay, trust_resolver.TrustResolver.noop());
+        defer manager.deinit();
+
+        var frame = try lwf.LWFFrame.init(allocator, 10);
+        defer frame.deinit(allocator);
+        for ([_][24]u8{ alice, bob, alice }) |dest| {
+            frame.header.dest_hint = dest;
+            try manager.ingestFrame(&frame);
+        }
+
+        var mf = try manager.generateManifest(alice);
+        defer mf.deinit();
+        try std.testing.expectEqual(@as(usize, 2), mf.total_count);
+    }
+
+    // Queues come back from the index sidecars after a restart
+    var manager = try OPQManager.init(allocator, test_dir, .relay, trust_resolver.TrustResolver.noop());
+    defer manager.deinit();
+
+    var mf = try manager.generateManifest(bob);
+    defer mf.deinit();
+    try std.testing.expectEqual(@as(usize, 1), mf.total_count);
+    try std.testing.expect(mf.items.items[0].location != null);
+
+    var none = try manager.generateManifest([_]u8{0} ** 24);
+    defer none.deinit();
+    try std.testing.expectEqual(@as(usize, 0), none.total_count);
+}
@@ -5,6 +5,7 @@
 const std = @import("std");
 const merkle = @import("./merkle.zig");
 const quota = @import("./quota.zig");
+const store = @import("./store.zig");
 
 pub const Priority = enum(u8) {
     low = 0,
@@ -24,6 +25,8 @@ pub const PacketSummary = struct {
     expires_at: i64,
     entropy_cost: u16,
     category: quota.TrustCategory,
+    /// Where the frame lives in the WAL (null for remote summaries)
+    location: ?store.WALLocation = null,
 };
 
 pub const QueueManifest = struct {
@@ -54,17 +57,21 @@ pub const QueueManifest = struct {
         defer tree.deinit();
 
         for (self.items.items) |item| {
-            // Hash the summary to form a leaf
-            var hasher = std.crypto.hash.Blake3.init(.{});
-            hasher.update(&item.queue_id);
-            hasher.update(&item.sender_hint);
-            hasher.update(std.mem.asBytes(&item.size));
-            hasher.update(std.mem.asBytes(&item.created_at));
-            var leaf: [32]u8 = undefined;
-            hasher.final(&leaf);
-            try tree.insert(leaf);
+            try tree.insert(leafHash(item));
         }
 
         self.merkle_root = tree.getRoot();
     }
 };
+
+/// Merkle leaf for a summary: Blake3 over its identifying fields
+pub fn leafHash(item: PacketSummary) [32]u8 {
+    var hasher = std.crypto.hash.Blake3.init(.{});
+    hasher.update(&item.queue_id);
+    hasher.update(&item.sender_hint);
+    hasher.update(std.mem.asBytes(&item.size));
+    hasher.update(std.mem.asBytes(&item.created_at));
+    var leaf: [32]u8 = undefined;
+    hasher.final(&leaf);
+    return leaf;
+}
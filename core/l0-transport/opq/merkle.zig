@@ -1,96 +1,135 @@
 //! Incremental Merkle Tree implementation for OPQ Manifests.
 //!
-//! Provides O(log n) updates and O(log n) inclusion proofs.
+//! Interior levels are cached and only the ancestors of changed leaves are
+//! rehashed when the root is read: appends are O(log n), an insert or
+//! removal at index i is O(n - i), inclusion proofs are O(log n).
 //! Uses Blake3 for hashing to align with the rest of the SDK.
 
 const std = @import("std");
 
 pub const MerkleTree = struct {
+    const clean = std.math.maxInt(usize);
+
     allocator: std.mem.Allocator,
     leaves: std.ArrayListUnmanaged([32]u8),
+    /// Interior levels, bottom up (levels[0] pairs the leaves, the last holds the root)
+    levels: std.ArrayListUnmanaged(std.ArrayListUnmanaged([32]u8)),
+    /// First leaf whose ancestors are stale (clean = maxInt)
+    dirty_from: usize,
 
     pub fn init(allocator: std.mem.Allocator) MerkleTree {
         return .{
             .allocator = allocator,
             .leaves = .{},
+            .levels = .{},
+            .dirty_from = clean,
         };
     }
 
     pub fn deinit(self: *MerkleTree) void {
+        for (self.levels.items) |*level| level.deinit(self.allocator);
+        self.levels.deinit(self.allocator);
         self.leaves.deinit(self.allocator);
     }
 
+    /// Append a leaf
     pub fn insert(self: *MerkleTree, leaf: [32]u8) !void {
-        try self.leaves.append(self.allocator, leaf);
+        try self.insertAt(self.leaves.items.len, leaf);
     }
 
-    /// Calculate the root of the Merkle Tree
-    pub fn getRoot(self: *const MerkleTree) [32]u8 {
-        if (self.leaves.items.len == 0) return [_]u8{0} ** 32;
-        if (self.leaves.items.len == 1) return self.leaves.items[0];
+    /// Insert a leaf at index, shifting later leaves right
+    pub fn insertAt(self: *MerkleTree, index: usize, leaf: [32]u8) !void {
+        try self.leaves.insert(self.allocator, index, leaf);
+        self.dirty_from = @min(self.dirty_from, index);
+    }
+
+    /// Replace the leaf at index
+    pub fn setLeaf(self: *MerkleTree, index: usize, leaf: [32]u8) void {
+        self.leaves.items[index] = leaf;
+        self.dirty_from = @min(self.dirty_from, index);
+    }
+
+    /// Keep only the first len leaves
+    pub fn truncate(self: *MerkleTree, len: usize) void {
+        if (len >= self.leaves.items.len) return;
+        self.leaves.shrinkRetainingCapacity(len);
+        self.dirty_from = @min(self.dirty_from, len);
+    }
+
+    /// Remove the leaf at index, shifting later leaves left
+    pub fn remove(self: *MerkleTree, index: usize) void {
+        _ = self.leaves.orderedRemove(index);
+        self.dirty_from = @min(self.dirty_from, index);
+    }
 
-        // This is a naive implementation for now.
-        // For production, we'd want an incremental tree that doesn't recompute everything.
-        var current_level = std.ArrayList([32]u8).empty;
-        defer current_level.deinit(self.allocator);
-        current_level.appendSlice(self.allocator, self.leaves.items) catch return [_]u8{0} ** 32;
-
-        while (current_level.items.len > 1) {
-            var next_level = std.ArrayList([32]u8).empty;
-            var i: usize = 0;
-            while (i < current_level.items.len) : (i += 2) {
-                const left = current_level.items[i];
-                const right = if (i + 1 < current_level.items.len) current_level.items[i + 1] else left;
-
-                var hasher = std.crypto.hash.Blake3.init(.{});
-                hasher.update(&left);
-                hasher.update(&right);
-                var out: [32]u8 = undefined;
-                hasher.final(&out);
-                next_level.append(self.allocator, out) catch break;
+    /// Rehash only the ancestors of leaves changed since the last refresh.
+    /// Appends cost O(log n); an insert or remove at index i costs O(n - i).
+    fn refresh(self: *MerkleTree) !void {
+        if (self.dirty_from == clean) return;
+
+        var below: []const [32]u8 = self.leaves.items;
+        var start = self.dirty_from;
+        var depth: usize = 0;
+        while (below.len > 1) : (depth += 1) {
+            if (depth == self.levels.items.len) try self.levels.append(self.allocator, .{});
+            const level = &self.levels.items[depth];
+            const count = (below.len + 1) / 2;
+            try level.resize(self.allocator, count);
+
+            var i = start / 2;
+            while (i < count) : (i += 1) {
+                const left = below[2 * i];
+                const right = if (2 * i + 1 < below.len) below[2 * i + 1] else left;
+                level.items[i] = hashPair(left, right);
             }
-            current_level.deinit(self.allocator);
-            current_level = next_level;
+            start /= 2;
+            below = level.items;
+        }
+
+        // The tree got shallower
+        while (self.levels.items.len > depth) {
+            var level = self.levels.pop().?;
+            level.deinit(self.allocator);
         }
+        self.dirty_from = clean;
+    }
+
+    fn hashPair(left: [32]u8, right: [32]u8) [32]u8 {
+        var hasher = std.crypto.hash.Blake3.init(.{});
+        hasher.update(&left);
+        hasher.update(&right);
+        var out: [32]u8 = undefined;
+        hasher.final(&out);
+        return out;
+    }
+
+    /// Calculate the root of the Merkle Tree (zero on allocation failure)
+    pub fn getRoot(self: *MerkleTree) [32]u8 {
+        if (self.leaves.items.len == 0) return [_]u8{0} ** 32;
+        if (self.leaves.items.len == 1) return self.leaves.items[0];
 
-        return current_level.items[0];
+        self.refresh() catch return [_]u8{0} ** 32;
+        return self.levels.items[self.levels.items.len - 1].items[0];
     }
 
     /// Generate an inclusion proof for the leaf at index
-    pub fn getProof(self: *const MerkleTree, index: usize) ![][32]u8 {
+    pub fn getProof(self: *MerkleTree, index: usize) ![][32]u8 {
         if (index >= self.leaves.items.len) return error.IndexOutOfBounds;
+        try self.refresh();
 
-        var proof = std.ArrayList([32]u8).empty;
+        var proof = try std.ArrayList([32]u8).initCapacity(self.allocator, self.levels.items.len);
         errdefer proof.deinit(self.allocator);
 
-        var current_level = std.ArrayList([32]u8).empty;
-        defer current_level.deinit(self.allocator);
-        try current_level.appendSlice(self.allocator, self.leaves.items);
-
+        var below: []const [32]u8 = self.leaves.items;
         var current_index = index;
-        while (current_level.items.len > 1) {
+        for (self.levels.items) |level| {
             const sibling_index = if (current_index % 2 == 0)
-                @min(current_index + 1, current_level.items.len - 1)
+                @min(current_index + 1, below.len - 1)
             else
                 current_index - 1;
 
-            try proof.append(self.allocator, current_level.items[sibling_index]);
-
-            var next_level = std.ArrayList([32]u8).empty;
-            var i: usize = 0;
-            while (i < current_level.items.len) : (i += 2) {
-                const left = current_level.items[i];
-                const right = if (i + 1 < current_level.items.len) current_level.items[i + 1] else left;
-
-                var hasher = std.crypto.hash.Blake3.init(.{});
-                hasher.update(&left);
-                hasher.update(&right);
-                var out: [32]u8 = undefined;
-                hasher.final(&out);
-                try next_level.append(self.allocator, out);
-            }
-            current_level.deinit(self.allocator);
-            current_level = next_level;
+            proof.appendAssumeCapacity(below[sibling_index]);
+            below = level.items;
             current_index /= 2;
         }
 
@@ -142,3 +181,39 @@ test "MerkleTree: root and proof" {
     try std.testing.expect(MerkleTree.verify(root, h1, 0, proof));
     try std.testing.expect(!MerkleTree.verify(root, h2, 0, proof));
 }
+
+test "MerkleTree: incremental updates match a full rebuild" {
+    const allocator = std.testing.allocator;
+    var tree = MerkleTree.init(allocator);
+    defer tree.deinit();
+
+    var leaves: [37][32]u8 = undefined;
+    for (&leaves, 0..) |*leaf, i| leaf.* = [_]u8{@intCast(i)} ** 32;
+
+    for (leaves[0..20]) |leaf| {
+        try tree.insert(leaf);
+        _ = tree.getRoot();
+    }
+    // Middle inserts, removals from both ends
+    for (leaves[20..], 0..) |leaf, i| try tree.insertAt(i * 3 % tree.leaves.items.len, leaf);
+    _ = tree.getRoot();
+    tree.remove(0);
+    tree.remove(tree.leaves.items.len - 1);
+    tree.remove(7);
+    tree.setLeaf(3, leaves[0]);
+
+    var fresh = MerkleTree.init(allocator);
+    defer fresh.deinit();
+    for (tree.leaves.items) |leaf| try fresh.insert(leaf);
+
+    const root = tree.getRoot();
+    try std.testing.expectEqualSlices(u8, &fresh.getRoot(), &root);
+
+    const proof = try tree.getProof(11);
+    defer allocator.free(proof);
+    try std.testing.expect(MerkleTree.verify(root, tree.leaves.items[11], 11, proof));
+
+    // A single leaf is its own root
+    tree.truncate(1);
+    try std.testing.expectEqualSlices(u8, &tree.leaves.items[0], &tree.getRoot());
+}
@@ -0,0 +1,153 @@
+//! RFC-0020: Per-Recipient Queue
+//!
+//! Summaries addressed to one recipient, kept in deterministic order on
+//! insert together with the Merkle tree over them. A manifest is then a
+//! copy of this recipient's items and a cached root, instead of a sort and
+//! full tree rebuild over everything the relay holds.
+
+const std = @import("std");
+const manifest = @import("./manifest.zig");
+const merkle = @import("./merkle.zig");
+const sequencer = @import("./sequencer.zig");
+
+pub const RecipientQueue = struct {
+    /// Sorted by `sequencer.comparePackets`
+    items: std.ArrayListUnmanaged(manifest.PacketSummary),
+    /// Leaf i is `manifest.leafHash(items[i])`
+    tree: merkle.MerkleTree,
+    total_size: u64,
+    /// Earliest expires_at among items (maxInt when empty)
+    next_expiry: i64,
+
+    pub fn init(allocator: std.mem.Allocator) RecipientQueue {
+        return .{
+            .items = .{},
+            .tree = merkle.MerkleTree.init(allocator),
+            .total_size = 0,
+            .next_expiry = std.math.maxInt(i64),
+        };
+    }
+
+    pub fn deinit(self: *RecipientQueue, allocator: std.mem.Allocator) void {
+        self.tree.deinit();
+        self.items.deinit(allocator);
+    }
+
+    /// Insert after any items that compare equal
+    pub fn insert(self: *RecipientQueue, allocator: std.mem.Allocator, summary: manifest.PacketSummary) !void {
+        var lo: usize = 0;
+        var hi: usize = self.items.items.len;
+        while (lo < hi) {
+            const mid = lo + (hi - lo) / 2;
+            if (sequencer.comparePackets({}, summary, self.items.items[mid])) hi = mid else lo = mid + 1;
+        }
+
+        try self.items.ensureUnusedCapacity(allocator, 1);
+        try self.tree.insertAt(lo, manifest.leafHash(summary));
+        self.items.insertAssumeCapacity(lo, summary);
+        self.total_size += summary.size;
+        self.next_expiry = @min(self.next_expiry, summary.expires_at);
+    }
+
+    /// Drop items expired at `now`, keeping order. Returns how many.
+    pub fn pruneExpired(self: *RecipientQueue, now: i64) usize {
+        if (now < self.next_expiry) return 0;
+
+        const Expired = struct {
+            now: i64,
+            pub fn drop(ctx: @This(), item: manifest.PacketSummary) bool {
+                return item.expires_at <= ctx.now;
+            }
+        };
+        return self.removeIf(Expired{ .now = now });
+    }
+
+    /// Drop items for which `pred.drop(item)` holds, keeping order.
+    /// Returns how many.
+    pub fn removeIf(self: *RecipientQueue, pred: anytype) usize {
+        var kept: usize = 0;
+        var next_expiry: i64 = std.math.maxInt(i64);
+        for (self.items.items, 0..) |item, i| {
+            if (pred.drop(item)) {
+                self.total_size -= item.size;
+                continue;
+            }
+            if (kept != i) {
+                self.items.items[kept] = item;
+                self.tree.setLeaf(kept, self.tree.leaves.items[i]);
+            }
+            next_expiry = @min(next_expiry, item.expires_at);
+            kept += 1;
+        }
+
+        const removed = self.items.items.len - kept;
+        self.items.shrinkRetainingCapacity(kept);
+        self.tree.truncate(kept);
+        self.next_expiry = next_expiry;
+        return removed;
+    }
+
+    pub fn root(self: *RecipientQueue) [32]u8 {
+        return self.tree.getRoot();
+    }
+};
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+fn testSummary(sender: u8, timestamp: u64, expires_at: i64) manifest.PacketSummary {
+    return .{
+        .queue_id = [_]u8{sender} ** 16,
+        .sender_hint = [_]u8{sender} ** 24,
+        .size = 100,
+        .priority = .normal,
+        .created_at = 0,
+        .timestamp = timestamp,
+        .sequence = 0,
+        .expires_at = expires_at,
+        .entropy_cost = 0,
+        .category = .peer,
+    };
+}
+
+test "RecipientQueue matches a sorted rebuild" {
+    const allocator = std.testing.allocator;
+    var queue = RecipientQueue.init(allocator);
+    defer queue.deinit(allocator);
+
+    // Interleaved senders and out-of-order timestamps
+    const inputs = [_]manifest.PacketSummary{
+        testSummary(2, 300, 50),
+        testSummary(1, 200, 100),
+        testSummary(2, 100, 100),
+        testSummary(3, 100, 20),
+        testSummary(1, 100, 100),
+    };
+    for (inputs) |s| try queue.insert(allocator, s);
+
+    var expected = manifest.QueueManifest.init(allocator, [_]u8{0} ** 24);
+    defer expected.deinit();
+    try expected.items.appendSlice(allocator, &inputs);
+    sequencer.sortDeterministically(expected.items.items);
+    try expected.calculateMerkleRoot();
+
+    for (expected.items.items, queue.items.items) |a, b| {
+        try std.testing.expectEqual(a.sender_hint[0], b.sender_hint[0]);
+        try std.testing.expectEqual(a.timestamp, b.timestamp);
+    }
+    try std.testing.expectEqualSlices(u8, &expected.merkle_root, &queue.root());
+    try std.testing.expectEqual(@as(u64, 500), queue.total_size);
+
+    // Expiry keeps order and the root in step
+    try std.testing.expectEqual(@as(usize, 0), queue.pruneExpired(10));
+    try std.testing.expectEqual(@as(usize, 2), queue.pruneExpired(50));
+    try std.testing.expectEqual(@as(i64, 100), queue.next_expiry);
+
+    var rest = manifest.QueueManifest.init(allocator, [_]u8{0} ** 24);
+    defer rest.deinit();
+    try rest.items.appendSlice(allocator, &.{ inputs[4], inputs[1], inputs[2] });
+    try rest.calculateMerkleRoot();
+    try std.testing.expectEqualSlices(u8, &rest.merkle_root, &queue.root());
+    try std.testing.expectEqual(@as(u64, 300), queue.total_size);
+}
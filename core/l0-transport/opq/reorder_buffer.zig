@@ -4,135 +4,298 @@
 //! to the L1 state machine in a contiguous, monotonic sequence per sender.
 //! This prevents out-of-order execution which is the primary source of
 //! race conditions in distributed state machines.
+//!
+//! Each sender has a fixed sliding window of WINDOW slots indexed by
+//! `sequence % WINDOW` plus an occupancy bitmap, so buffering, lookup and
+//! draining are O(1) per frame. Ready frames are written to a caller
+//! buffer of at least WINDOW entries; nothing is allocated per push.
+//!
+//! Sequences are u32 and wrap: all window arithmetic is modular, and a
+//! frame is "old" when it lies within half the sequence space behind
+//! `next_seq` (RFC 1982 serial number comparison).
 
 const std = @import("std");
 const manifest = @import("./manifest.zig");
 
+/// Frames buffered per sender (sequence span of the window).
+/// Divides 2^32, so `seq % WINDOW` stays consistent across wraparound.
+pub const WINDOW: u32 = 64;
+
+/// Forward distance from `from` to `seq`, or null if `seq` is behind it
+fn ahead(from: u32, seq: u32) ?u32 {
+    const distance = seq -% from;
+    return if (distance < 1 << 31) distance else null;
+}
+
+/// What to do with a frame too far ahead of the window
+pub const Overflow = enum {
+    /// Drop the frame; the window waits for the gap to fill
+    drop,
+    /// Give up on the oldest gaps: yield buffered frames in order and slide
+    /// the window forward until the frame fits
+    advance,
+};
+
+const Window = struct {
+    next_seq: u32 = 0,
+    /// Bit `seq % WINDOW` set = slot holds that sequence
+    present: u64 = 0,
+    slots: [WINDOW]manifest.PacketSummary = undefined,
+
+    fn has(self: *const Window, seq: u32) bool {
+        return self.present & bit(seq) != 0;
+    }
+
+    fn bit(seq: u32) u64 {
+        return @as(u64, 1) << @intCast(seq % WINDOW);
+    }
+
+    fn take(self: *Window, seq: u32) manifest.PacketSummary {
+        self.present &= ~bit(seq);
+        return self.slots[seq % WINDOW];
+    }
+
+    /// Move contiguous frames from next_seq on into out
+    fn drainReady(self: *Window, out: []manifest.PacketSummary, n: *usize) void {
+        while (self.has(self.next_seq)) : (self.next_seq +%= 1) {
+            out[n.*] = self.take(self.next_seq);
+            n.* += 1;
+        }
+    }
+
+    /// Yield buffered frames below `target` in order, then start the window there
+    fn slideTo(self: *Window, target: u32, out: []manifest.PacketSummary, n: *usize) void {
+        const span = @min(target -% self.next_seq, WINDOW);
+        for (0..span) |i| {
+            const seq = self.next_seq +% @as(u32, @intCast(i));
+            if (self.has(seq)) {
+                out[n.*] = self.take(seq);
+                n.* += 1;
+            }
+        }
+        self.next_seq = target;
+    }
+};
+
 pub const ReorderBuffer = struct {
     allocator: std.mem.Allocator,
-    next_expected_seq: std.AutoHashMapUnmanaged([24]u8, u32),
-    pending_frames: std.AutoHashMapUnmanaged([24]u8, std.ArrayListUnmanaged(manifest.PacketSummary)),
+    overflow: Overflow,
+    windows: std.AutoHashMapUnmanaged([24]u8, *Window),
+    /// Frames rejected as replays, duplicates or (with .drop) overflow
+    dropped: u64,
 
-    pub fn init(allocator: std.mem.Allocator) ReorderBuffer {
+    pub fn init(allocator: std.mem.Allocator, overflow: Overflow) ReorderBuffer {
         return .{
             .allocator = allocator,
-            .next_expected_seq = .{},
-            .pending_frames = .{},
+            .overflow = overflow,
+            .windows = .{},
+            .dropped = 0,
         };
     }
 
     pub fn deinit(self: *ReorderBuffer) void {
-        self.next_expected_seq.deinit(self.allocator);
-        var it = self.pending_frames.iterator();
-        while (it.next()) |entry| {
-            entry.value_ptr.deinit(self.allocator);
+        var it = self.windows.valueIterator();
+        while (it.next()) |window| {
+            self.allocator.destroy(window.*);
         }
-        self.pending_frames.deinit(self.allocator);
+        self.windows.deinit(self.allocator);
+    }
+
+    fn windowFor(self: *ReorderBuffer, sender: [24]u8) !*Window {
+        const entry = try self.windows.getOrPut(self.allocator, sender);
+        if (!entry.found_existing) {
+            const window = self.allocator.create(Window) catch |err| {
+                self.windows.removeByPtr(entry.key_ptr);
+                return err;
+            };
+            window.* = .{};
+            entry.value_ptr.* = window;
+        }
+        return entry.value_ptr.*;
     }
 
     /// Add a frame to the buffer.
-    /// Returns a slice of frames that are now ready to be processed in order.
-    /// The caller owns the returned slice.
-    pub fn push(self: *ReorderBuffer, summary: manifest.PacketSummary) ![]manifest.PacketSummary {
-        const sender = summary.sender_hint;
+    /// Frames that are now ready are written to `out` (len >= WINDOW) in
+    /// sequence order; returns how many.
+    pub fn push(self: *ReorderBuffer, summary: manifest.PacketSummary, out: []manifest.PacketSummary) !usize {
+        std.debug.assert(out.len >= WINDOW);
+        const window = try self.windowFor(summary.sender_hint);
         const seq = summary.sequence;
 
-        const entry = try self.next_expected_seq.getOrPut(self.allocator, sender);
-        if (!entry.found_existing) entry.value_ptr.* = 0;
-        const next = entry.value_ptr.*;
-
-        if (seq < next) {
+        const distance = ahead(window.next_seq, seq) orelse {
             // Already processed or old, drop it
-            return &[_]manifest.PacketSummary{};
-        }
+            self.dropped += 1;
+            return 0;
+        };
 
-        if (seq == next) {
-            // Perfect fit! Let's see if we can drain any pending ones too.
-            var ready = std.ArrayList(manifest.PacketSummary).empty;
-            errdefer ready.deinit(self.allocator);
-
-            try ready.append(self.allocator, summary);
-            entry.value_ptr.* += 1;
-
-            // Check if we have the next ones in the pending list
-            if (self.pending_frames.getPtr(sender)) |pending| {
-                while (true) {
-                    var found = false;
-                    var i: usize = 0;
-                    while (i < pending.items.len) {
-                        if (pending.items[i].sequence == entry.value_ptr.*) {
-                            try ready.append(self.allocator, pending.swapRemove(i));
-                            entry.value_ptr.* += 1;
-                            found = true;
-                            // Reset search since we modified the list
-                            break;
-                        }
-                        i += 1;
-                    }
-                    if (!found) break;
-                }
+        var n: usize = 0;
+        if (distance >= WINDOW) {
+            switch (self.overflow) {
+                .drop => {
+                    self.dropped += 1;
+                    return 0;
+                },
+                .advance => window.slideTo(seq -% (WINDOW - 1), out, &n),
             }
-
-            return ready.toOwnedSlice(self.allocator);
+        } else if (window.has(seq)) {
+            // Duplicate of a buffered frame
+            self.dropped += 1;
+            return 0;
         }
 
-        // Ahead of sequence, buffer it
-        const pending_entry = try self.pending_frames.getOrPut(self.allocator, sender);
-        if (!pending_entry.found_existing) pending_entry.value_ptr.* = .{};
-        try pending_entry.value_ptr.append(self.allocator, summary);
-
-        return &[_]manifest.PacketSummary{};
+        window.slots[seq % WINDOW] = summary;
+        window.present |= Window.bit(seq);
+        window.drainReady(out, &n);
+        return n;
     }
 
-    /// Force yield everything for a sender (e.g. on timeout or disconnect)
-    pub fn forceFlush(self: *ReorderBuffer, sender: [24]u8) ![]manifest.PacketSummary {
-        if (self.pending_frames.getPtr(sender)) |pending| {
-            // Sort them first to ensure deterministic yield even in flush
-            const items = pending.items;
-            std.sort.pdq(manifest.PacketSummary, items, {}, compareBySeq);
-
-            const result = try self.allocator.dupe(manifest.PacketSummary, items);
-            pending.clearRetainingCapacity();
-
-            // Update next expected to avoid replaying these
-            if (result.len > 0) {
-                if (self.next_expected_seq.getPtr(sender)) |next| {
-                    next.* = result[result.len - 1].sequence + 1;
-                }
-            }
+    /// Force yield everything for a sender (e.g. on timeout or disconnect).
+    /// Writes buffered frames to `out` (len >= WINDOW) in sequence order and
+    /// skips the window past them; returns how many.
+    pub fn forceFlush(self: *ReorderBuffer, sender: [24]u8, out: []manifest.PacketSummary) usize {
+        std.debug.assert(out.len >= WINDOW);
+        const window = self.windows.get(sender) orelse return 0;
+        if (window.present == 0) return 0;
 
-            return result;
+        var n: usize = 0;
+        var last = window.next_seq;
+        for (0..WINDOW) |i| {
+            const seq = window.next_seq +% @as(u32, @intCast(i));
+            if (window.has(seq)) {
+                out[n] = window.take(seq);
+                n += 1;
+                last = seq;
+            }
         }
-        return &[_]manifest.PacketSummary{};
+
+        // Update next expected to avoid replaying these
+        window.next_seq = last +% 1;
+        return n;
     }
 };
 
-fn compareBySeq(_: void, a: manifest.PacketSummary, b: manifest.PacketSummary) bool {
-    return a.sequence < b.sequence;
+// ============================================================================
+// TESTS
+// ============================================================================
+
+fn testSummary(sender: [24]u8, sequence: u32) manifest.PacketSummary {
+    return .{ .queue_id = [_]u8{0} ** 16, .sender_hint = sender, .size = 0, .priority = .normal, .created_at = 0, .timestamp = 0, .sequence = sequence, .expires_at = 0, .entropy_cost = 0, .category = .peer };
 }
 
 test "ReorderBuffer: contiguous flow" {
     const allocator = std.testing.allocator;
-    var rb = ReorderBuffer.init(allocator);
+    var rb = ReorderBuffer.init(allocator, .drop);
     defer rb.deinit();
 
     const sender = [_]u8{0xC} ** 24;
+    var out: [WINDOW]manifest.PacketSummary = undefined;
 
     // Push 0 -> Ready [0]
-    const r1 = try rb.push(.{ .queue_id = [_]u8{0} ** 16, .sender_hint = sender, .size = 0, .priority = .normal, .created_at = 0, .timestamp = 0, .sequence = 0, .expires_at = 0, .entropy_cost = 0, .category = .peer });
-    defer allocator.free(r1);
-    try std.testing.expectEqual(r1.len, 1);
-    try std.testing.expectEqual(r1[0].sequence, 0);
+    try std.testing.expectEqual(@as(usize, 1), try rb.push(testSummary(sender, 0), &out));
+    try std.testing.expectEqual(out[0].sequence, 0);
 
     // Push 2 -> Buffered
-    const r2 = try rb.push(.{ .queue_id = [_]u8{0} ** 16, .sender_hint = sender, .size = 0, .priority = .normal, .created_at = 0, .timestamp = 0, .sequence = 2, .expires_at = 0, .entropy_cost = 0, .category = .peer });
-    defer allocator.free(r2);
-    try std.testing.expectEqual(r2.len, 0);
+    try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, 2), &out));
 
     // Push 1 -> Ready [1, 2]
-    const r3 = try rb.push(.{ .queue_id = [_]u8{0} ** 16, .sender_hint = sender, .size = 0, .priority = .normal, .created_at = 0, .timestamp = 0, .sequence = 1, .expires_at = 0, .entropy_cost = 0, .category = .peer });
-    defer allocator.free(r3);
-    try std.testing.expectEqual(r3.len, 2);
-    try std.testing.expectEqual(r3[0].sequence, 1);
-    try std.testing.expectEqual(r3[1].sequence, 2);
+    try std.testing.expectEqual(@as(usize, 2), try rb.push(testSummary(sender, 1), &out));
+    try std.testing.expectEqual(out[0].sequence, 1);
+    try std.testing.expectEqual(out[1].sequence, 2);
+
+    // Replays and duplicates are dropped
+    try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, 1), &out));
+    try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, 5), &out));
+    try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, 5), &out));
+    try std.testing.expectEqual(@as(u64, 2), rb.dropped);
+}
+
+test "ReorderBuffer: deep reordering and overflow" {
+    const allocator = std.testing.allocator;
+    const sender = [_]u8{0xD} ** 24;
+    var out: [WINDOW]manifest.PacketSummary = undefined;
+
+    {
+        var rb = ReorderBuffer.init(allocator, .drop);
+        defer rb.deinit();
+
+        // Full window in reverse: one drain of WINDOW frames
+        var seq: u32 = WINDOW - 1;
+        while (seq > 0) : (seq -= 1) {
+            try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, seq), &out));
+        }
+        try std.testing.expectEqual(@as(usize, WINDOW), try rb.push(testSummary(sender, 0), &out));
+        for (out, 0..) |s, i| try std.testing.expectEqual(@as(u32, @intCast(i)), s.sequence);
+
+        // Beyond the window: dropped
+        try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, 2 * WINDOW), &out));
+        try std.testing.expectEqual(@as(u64, 1), rb.dropped);
+    }
+
+    {
+        var rb = ReorderBuffer.init(allocator, .advance);
+        defer rb.deinit();
+
+        _ = try rb.push(testSummary(sender, 3), &out);
+        _ = try rb.push(testSummary(sender, 10), &out);
+
+        // Slides past the gap at 0..2, yielding 3 and 10 first
+        try std.testing.expectEqual(@as(usize, 2), try rb.push(testSummary(sender, 100), &out));
+        try std.testing.expectEqual(@as(u32, 3), out[0].sequence);
+        try std.testing.expectEqual(@as(u32, 10), out[1].sequence);
+
+        try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, 40), &out));
+        try std.testing.expectEqual(@as(usize, 2), rb.forceFlush(sender, &out));
+        try std.testing.expectEqual(@as(u32, 40), out[0].sequence);
+        try std.testing.expectEqual(@as(u32, 100), out[1].sequence);
+        try std.testing.expectEqual(@as(usize, 1), try rb.push(testSummary(sender, 101), &out));
+    }
+}
+
+test "ReorderBuffer: sequence wraparound" {
+    const allocator = std.testing.allocator;
+    const sender = [_]u8{0xE} ** 24;
+    var out: [WINDOW]manifest.PacketSummary = undefined;
+    const max = std.math.maxInt(u32);
+
+    {
+        var rb = ReorderBuffer.init(allocator, .drop);
+        defer rb.deinit();
+        (try rb.windowFor(sender)).next_seq = max - 1;
+
+        // 0 and 1 are ahead of maxInt - 1, not replays
+        try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, 1), &out));
+        try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, 0), &out));
+        try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, max), &out));
+        try std.testing.expectEqual(@as(usize, 4), try rb.push(testSummary(sender, max - 1), &out));
+        try std.testing.expectEqual(@as(u32, max - 1), out[0].sequence);
+        try std.testing.expectEqual(@as(u32, max), out[1].sequence);
+        try std.testing.expectEqual(@as(u32, 0), out[2].sequence);
+        try std.testing.expectEqual(@as(u32, 1), out[3].sequence);
+
+        // Pre-wrap sequences are now replays
+        try std.testing.expectEqual(@as(usize, 0), try rb.push(testSummary(sender, max), &out));
+        try std.testing.expectEqual(@as(u64, 1), rb.dropped);
+
+        // Flushing across the wrap resumes after the last frame
+        (try rb.windowFor(sender)).next_seq = max - 2;
+        _ = try rb.push(testSummary(sender, max), &out);
+        _ = try rb.push(testSummary(sender, 3), &out);
+        try std.testing.expectEqual(@as(usize, 2), rb.forceFlush(sender, &out));
+        try std.testing.expectEqual(@as(u32, max), out[0].sequence);
+        try std.testing.expectEqual(@as(u32, 3), out[1].sequence);
+        try std.testing.expectEqual(@as(usize, 1), try rb.push(testSummary(sender, 4), &out));
+    }
+
+    {
+        var rb = ReorderBuffer.init(allocator, .advance);
+        defer rb.deinit();
+        (try rb.windowFor(sender)).next_seq = max - 5;
+
+        _ = try rb.push(testSummary(sender, max - 3), &out);
+        // Far past the wrap: slides and yields the buffered frame
+        try std.testing.expectEqual(@as(usize, 1), try rb.push(testSummary(sender, 100), &out));
+        try std.testing.expectEqual(@as(u32, max - 3), out[0].sequence);
+        try std.testing.expectEqual(@as(usize, 1), rb.forceFlush(sender, &out));
+        try std.testing.expectEqual(@as(u32, 100), out[0].sequence);
+    }
 }
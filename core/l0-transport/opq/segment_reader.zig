@@ -0,0 +1,128 @@
+//! RFC-0020: OPQ (Offline Packet Queue) - Segment Reader
+//!
+//! Read path for `.opq` segments. A segment is mapped read-only and frames
+//! are served as `LWFFrameView`s pointing into the mapping, so handing a
+//! frame to a recipient (or scanning a segment to rebuild its index) never
+//! copies through read().
+//!
+//! A mapping covers the file as it was when opened; frames committed to an
+//! active segment afterwards need a reopen.
+
+const std = @import("std");
+const lwf = @import("lwf");
+const store = @import("./store.zig");
+
+const posix = std.posix;
+const SegmentHeader = store.SegmentHeader;
+const WALLocation = store.WALLocation;
+
+pub const SegmentReader = struct {
+    map: []align(std.heap.page_size_min) u8,
+
+    /// Map `name` within `dir`
+    pub fn open(dir: std.fs.Dir, name: []const u8) !SegmentReader {
+        const file = try dir.openFile(name, .{});
+        defer file.close();
+
+        const size = (try file.stat()).size;
+        if (size < SegmentHeader.SIZE) return error.InvalidSegment;
+
+        const map = try posix.mmap(null, @intCast(size), posix.PROT.READ, .{ .TYPE = .SHARED }, file.handle, 0);
+        errdefer posix.munmap(map);
+
+        const reader = SegmentReader{ .map = map };
+        if (!std.mem.eql(u8, &reader.header().magic, &store.SEGMENT_MAGIC)) return error.InvalidSegment;
+
+        // Frames are read front to back
+        posix.madvise(map.ptr, map.len, posix.MADV.SEQUENTIAL) catch {};
+        return reader;
+    }
+
+    pub fn close(self: *SegmentReader) void {
+        posix.munmap(self.map);
+    }
+
+    pub fn header(self: *const SegmentReader) SegmentHeader {
+        return std.mem.bytesToValue(SegmentHeader, self.map[0..SegmentHeader.SIZE]);
+    }
+
+    /// Zero-copy frame at `loc` (valid until close)
+    pub fn frameAt(self: *const SegmentReader, loc: WALLocation) !lwf.LWFFrameView {
+        if (loc.offset < SegmentHeader.SIZE or loc.offset + loc.len > self.map.len) return error.OutOfRange;
+        const view = try lwf.LWFFrameView.parse(self.map[loc.offset..][0..loc.len]);
+        if (view.bytes.len != loc.len) return error.LengthMismatch;
+        return view;
+    }
+
+    pub const Entry = struct {
+        offset: usize,
+        view: lwf.LWFFrameView,
+    };
+
+    /// Sequential scan; stops at the first torn or invalid frame
+    pub const Iterator = struct {
+        map: []const u8,
+        offset: usize = SegmentHeader.SIZE,
+
+        pub fn next(it: *Iterator) ?Entry {
+            if (it.offset >= it.map.len) return null;
+            const view = lwf.LWFFrameView.parse(it.map[it.offset..]) catch return null;
+            const entry = Entry{ .offset = it.offset, .view = view };
+            it.offset += view.bytes.len;
+            return entry;
+        }
+    };
+
+    pub fn iterator(self: *const SegmentReader) Iterator {
+        return .{ .map = self.map };
+    }
+};
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+test "SegmentReader serves committed frames in place" {
+    const allocator = std.testing.allocator;
+    const test_dir = "test_opq_reader";
+
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    var wal = try store.WALStore.init(allocator, test_dir, store.DEFAULT_SEGMENT_SIZE);
+    defer wal.deinit();
+
+    var locs: [3]WALLocation = undefined;
+    for (&locs, 0..) |*loc, i| {
+        var frame = try lwf.LWFFrame.init(allocator, 16 * (i + 1));
+        defer frame.deinit(allocator);
+        @memset(frame.payload, @intCast('a' + i));
+        frame.header.payload_len = @intCast(frame.payload.len);
+        frame.header.sequence = @intCast(i);
+        frame.updateChecksum();
+        loc.* = try wal.appendFrame(&frame);
+    }
+
+    var reader = try wal.openSegment(locs[0]);
+    defer reader.close();
+
+    const view = try reader.frameAt(locs[1]);
+    try std.testing.expectEqual(@as(usize, 32), view.payload.len);
+    try std.testing.expectEqual(@as(u8, 'b'), view.payload[0]);
+    try std.testing.expect(view.verifyChecksum());
+
+    var it = reader.iterator();
+    var count: u32 = 0;
+    while (it.next()) |entry| : (count += 1) {
+        try std.testing.expectEqual(locs[count].offset, entry.offset);
+        try std.testing.expectEqual(count, entry.view.header.sequence);
+    }
+    try std.testing.expectEqual(@as(u32, 3), count);
+
+    try std.testing.expectError(error.OutOfRange, reader.frameAt(.{
+        .segment_id = locs[0].segment_id,
+        .segment_seq = locs[0].segment_seq,
+        .offset = reader.map.len,
+        .len = 124,
+    }));
+}
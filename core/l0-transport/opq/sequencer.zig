@@ -17,7 +17,8 @@ pub fn sortDeterministically(items: []manifest.PacketSummary) void {
     std.sort.pdq(manifest.PacketSummary, items, {}, comparePackets);
 }
 
-fn comparePackets(_: void, a: manifest.PacketSummary, b: manifest.PacketSummary) bool {
+/// Deterministic order used by `sortDeterministically` (less-than)
+pub fn comparePackets(_: void, a: manifest.PacketSummary, b: manifest.PacketSummary) bool {
     // 1. Source Hint
     const hint_cmp = std.mem.order(u8, &a.sender_hint, &b.sender_hint);
     if (hint_cmp != .eq) return hint_cmp == .lt;
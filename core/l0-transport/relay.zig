@@ -41,6 +41,56 @@ pub const RelayResult = struct {
     session_id: [16]u8,
 };
 
+/// Wire layout: ephemeral_key (32) | nonce (24) | ciphertext | tag (16)
+pub const WIRE_HEADER_SIZE = 32 + 24;
+
+/// A layer unwrapped in place; `payload` (the inner onion) points into the
+/// packet buffer it was decrypted in.
+pub const RelayView = struct {
+    next_hop: [32]u8,
+    payload: []u8,
+    session_id: [16]u8,
+
+    /// All-zero next hop: this node is the final destination
+    pub fn isFinal(self: *const RelayView) bool {
+        return std.mem.allEqual(u8, &self.next_hop, 0);
+    }
+};
+
+/// Decrypt one layer of a wire-format packet inside its own buffer,
+/// without allocating. On error the buffer contents are unspecified.
+pub fn unwrapInPlace(
+    packet: []u8,
+    receiver_secret_key: [32]u8,
+    expected_session_id: ?[16]u8,
+) RelayError!RelayView {
+    const Aead = crypto.aead.chacha_poly.XChaCha20Poly1305;
+    if (packet.len < WIRE_HEADER_SIZE + 32 + Aead.tag_length) return error.DecryptionFailed;
+
+    const ephemeral_key = packet[0..32].*;
+    const nonce = packet[32..WIRE_HEADER_SIZE].*;
+    const session_id = nonce[0..16].*;
+
+    if (expected_session_id) |expected| {
+        if (!std.mem.eql(u8, &expected, &session_id)) return error.DecryptionFailed;
+    }
+
+    const shared_secret = crypto.dh.X25519.scalarmult(receiver_secret_key, ephemeral_key) catch return error.DecryptionFailed;
+
+    const body = packet[WIRE_HEADER_SIZE..];
+    const content = body[0 .. body.len - Aead.tag_length];
+    const tag = body[content.len..][0..Aead.tag_length].*;
+
+    // ChaCha20 is a stream cipher: decrypting over the ciphertext is safe
+    Aead.decrypt(content, content, tag, "", nonce, shared_secret) catch return error.DecryptionFailed;
+
+    return .{
+        .next_hop = content[0..32].*,
+        .payload = content[32..],
+        .session_id = session_id,
+    };
+}
+
 /// A Relay Packet as it travels on the wire.
 /// It effectively contains an encrypted blob that the receiver can decrypt
 /// to reveal the NextHopHeader and the inner Payload.
@@ -233,3 +283,41 @@ test "Relay: wrap and unwrap" {
     try std.testing.expectEqualSlices(u8, &next_hop, &result.next_hop);
     try std.testing.expectEqualSlices(u8, payload, result.payload);
 }
+
+test "Relay: unwrap nested layers in place" {
+    const allocator = std.testing.allocator;
+    var builder = OnionBuilder.init(allocator);
+
+    const relay_kp = crypto.dh.X25519.KeyPair.generate();
+    const exit_kp = crypto.dh.X25519.KeyPair.generate();
+    const session_id = [_]u8{0x5A} ** 16;
+    const final_hop = [_]u8{0} ** 32;
+    const exit_id = [_]u8{0xEE} ** 32;
+
+    // Innermost layer for the exit, wrapped again for the relay
+    var inner = try builder.wrapLayer("Deep payload", final_hop, exit_kp.public_key, session_id, null);
+    defer inner.deinit(allocator);
+    const inner_wire = try inner.encode(allocator);
+    defer allocator.free(inner_wire);
+
+    var outer = try builder.wrapLayer(inner_wire, exit_id, relay_kp.public_key, session_id, null);
+    defer outer.deinit(allocator);
+    const wire = try outer.encode(allocator);
+    defer allocator.free(wire);
+
+    const hop1 = try unwrapInPlace(wire, relay_kp.secret_key, session_id);
+    try std.testing.expect(!hop1.isFinal());
+    try std.testing.expectEqualSlices(u8, &exit_id, &hop1.next_hop);
+    try std.testing.expectEqualSlices(u8, inner_wire, hop1.payload);
+    try std.testing.expect(@intFromPtr(hop1.payload.ptr) > @intFromPtr(wire.ptr)); // No copy
+
+    const hop2 = try unwrapInPlace(hop1.payload, exit_kp.secret_key, null);
+    try std.testing.expect(hop2.isFinal());
+    try std.testing.expectEqualStrings("Deep payload", hop2.payload);
+
+    // Tampering is rejected
+    const tampered = try outer.encode(allocator);
+    defer allocator.free(tampered);
+    tampered[tampered.len - 1] ^= 1;
+    try std.testing.expectError(error.DecryptionFailed, unwrapInPlace(tampered, relay_kp.secret_key, null));
+}
@@ -37,18 +37,17 @@ pub const L0Service = struct {
     pub fn step(self: *L0Service) !bool {
         var buffer: [9000]u8 = undefined; // Jumbo MTU support
 
-        const result = self.socket.receiveFrame(self.allocator, &buffer) catch |err| {
+        const result = self.socket.receiveView(&buffer) catch |err| {
             if (err == error.WouldBlock) return false;
             return err;
         };
 
-        var frame = result.frame;
-        defer frame.deinit(self.allocator);
-
-        // 1. Verification (Deep)
-        if (!frame.verifyChecksum()) return error.ChecksumMismatch;
+        // 1. Verification (Deep) - on the borrowed view, rejects never allocate
+        if (!result.view.verifyChecksum()) return error.ChecksumMismatch;
 
         // 2. Persistence (The Queue)
+        var frame = try result.view.toOwned(self.allocator);
+        defer frame.deinit(self.allocator);
         try self.opq_manager.ingestFrame(&frame);
 
         return true;
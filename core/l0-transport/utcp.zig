@@ -7,3 +7,5 @@
 //! Sovereign Index for UTCP
 pub const socket = @import("utcp/socket.zig");
 pub const UTCP = socket.UTCP;
+pub const RecvBatch = socket.RecvBatch;
+pub const SendBatch = socket.SendBatch;
@@ -1,12 +1,44 @@
 //! RFC-0004: UTCP (Unreliable Transport Protocol) over UDP
 
 const std = @import("std");
+const builtin = @import("builtin");
 const lwf = @import("lwf");
+const entropy = @import("entropy");
 const posix = std.posix;
+const linux = std.os.linux;
+
+/// recvmmsg/sendmmsg are Linux-only; other targets loop over recvfrom/sendto
+const has_mmsg = builtin.os.tag == .linux;
+
+// UDP segmentation offload (linux/udp.h)
+const SOL_UDP = 17;
+const UDP_SEGMENT = 103;
+const UDP_GRO = 104;
+/// Kernel cap on segments per GSO send (UDP_MAX_SEGMENTS)
+const gso_max_segments = 64;
+pub const max_udp_payload = 65507;
+
+/// Control message header (struct cmsghdr)
+const Cmsg = extern struct {
+    len: usize,
+    level: c_int,
+    type: c_int,
+};
+
+/// Per-message ancillary buffer: one cmsg carrying a u16/int
+const ControlBuf = [4]usize;
+
+fn cmsgAlign(len: usize) usize {
+    return std.mem.alignForward(usize, len, @sizeOf(usize));
+}
 
 /// UTCP Socket abstraction for sending and receiving LWF frames
 pub const UTCP = struct {
     fd: posix.socket_t,
+    /// Kernel accepts UDP_SEGMENT: sendBatch coalesces same-size frames
+    gso: bool = false,
+    /// UDP_GRO enabled: receiveBatch may return coalesced datagrams
+    gro: bool = false,
 
     /// Initialize UTCP socket by binding to an address
     pub fn init(allocator: std.mem.Allocator, address: std.net.Address) !UTCP {
@@ -20,20 +52,47 @@ pub const UTCP = struct {
 
         try posix.bind(fd, &address.any, address.getOsSockLen());
 
+        // Probe GSO support: setting a zero segment size is a no-op
+        const no_segment: c_int = 0;
+        var gso = false;
+        if (has_mmsg) {
+            if (posix.setsockopt(fd, posix.IPPROTO.UDP, UDP_SEGMENT, std.mem.asBytes(&no_segment))) |_| {
+                gso = true;
+            } else |_| {}
+        }
+
         return UTCP{
             .fd = fd,
+            .gso = gso,
         };
     }
 
+    /// Ask the kernel to coalesce consecutive datagrams from one sender (GRO).
+    /// Receive batches should then use slots of `max_udp_payload` bytes.
+    /// Returns false if unsupported.
+    pub fn enableGro(self: *UTCP) bool {
+        if (!has_mmsg) return false;
+        const on: c_int = 1;
+        posix.setsockopt(self.fd, SOL_UDP, UDP_GRO, std.mem.asBytes(&on)) catch return false;
+        self.gro = true;
+        return true;
+    }
+
     /// Close the socket
     pub fn deinit(self: *UTCP) void {
         posix.close(self.fd);
     }
 
     /// Encode and send an LWF frame to a target address
+    /// Frames up to 2 KiB are encoded on the stack
     pub fn sendFrame(self: *UTCP, target: std.net.Address, frame: *const lwf.LWFFrame, allocator: std.mem.Allocator) !void {
-        const encoded = try frame.encode(allocator);
-        defer allocator.free(encoded);
+        var stack_buf: [2048]u8 = undefined;
+        const on_heap = frame.size() > stack_buf.len;
+        const encoded = if (on_heap)
+            try frame.encode(allocator)
+        else
+            stack_buf[0..try frame.encodeInto(&stack_buf)];
+        defer if (on_heap) allocator.free(encoded);
 
         const sent = try posix.sendto(
             self.fd,
@@ -51,6 +110,16 @@ pub const UTCP = struct {
     /// Receive a frame from the network
     /// Performs non-allocating header validation before processing payload
     pub fn receiveFrame(self: *UTCP, allocator: std.mem.Allocator, buffer: []u8) !ReceiveResult {
+        const result = try self.receiveView(buffer);
+        return ReceiveResult{
+            .frame = try result.view.toOwned(allocator),
+            .sender = result.sender,
+        };
+    }
+
+    /// Receive a frame without copying it out of `buffer`
+    /// The view is valid until the buffer is reused.
+    pub fn receiveView(self: *UTCP, buffer: []u8) !ReceiveViewResult {
         var src_addr: posix.sockaddr = undefined;
         var src_len: posix.socklen_t = @sizeOf(posix.sockaddr);
 
@@ -62,33 +131,130 @@ pub const UTCP = struct {
             &src_len,
         );
 
-        const data = buffer[0..bytes_received];
+        return ReceiveViewResult{
+            .view = try parseDatagram(buffer[0..bytes_received]),
+            .sender = std.net.Address{ .any = src_addr },
+        };
+    }
 
-        // 1. Fast Header Validation (No Allocation)
+    /// Validate one received datagram and view it in place (no allocation)
+    pub fn parseDatagram(data: []const u8) !lwf.LWFFrameView {
+        // 1. Fast Header Validation
         if (data.len < lwf.LWFHeader.SIZE) {
             return error.FrameUnderflow;
         }
 
-        var header_bytes: [lwf.LWFHeader.SIZE]u8 = undefined;
-        @memcpy(&header_bytes, data[0..lwf.LWFHeader.SIZE]);
-        const header = lwf.LWFHeader.fromBytes(&header_bytes);
+        // 2. Bounds-check payload and trailer
+        const view = lwf.LWFFrameView.parse(data) catch |err| switch (err) {
+            error.InvalidHeader => return error.InvalidMagic,
+            else => return err,
+        };
+
+        // 3. Entropy Fast-Path (DoS Defense)
+        if (view.header.flags & lwf.LWFFlags.HAS_ENTROPY != 0) try precheckStamp(&view);
+        return view;
+    }
+
+    /// Reject a stamped frame on its stamp fields alone (no Argon2id).
+    /// The memory-hard check is left to `entropy.BatchVerifier` for the
+    /// frames that survive.
+    pub fn precheckStamp(view: *const lwf.LWFFrameView) !void {
+        if (view.payload.len < entropy.STAMP_SIZE) return error.StampTruncated;
+        const stamp = entropy.EntropyStamp.fromBytes(view.payload[0..entropy.STAMP_SIZE]);
+        try stamp.precheck(view.header.entropy_difficulty, view.header.service_type, entropy.DEFAULT_MAX_AGE_SECONDS, std.time.timestamp());
+    }
+
+    /// Validate and decode one received datagram (allocates payload)
+    pub fn decodeDatagram(allocator: std.mem.Allocator, data: []const u8) !lwf.LWFFrame {
+        const view = try parseDatagram(data);
+        return view.toOwned(allocator);
+    }
+
+    /// Drain up to `batch.capacity()` queued datagrams without blocking
+    /// (one recvmmsg on Linux). Returns the number of messages filled;
+    /// 0 means nothing was queued. Iterate them with `batch.iterator()`.
+    pub fn receiveBatch(self: *UTCP, batch: *RecvBatch) !usize {
+        batch.filled = 0;
+        if (has_mmsg) {
+            for (batch.msgs) |*m| {
+                m.hdr.namelen = @sizeOf(posix.sockaddr.storage);
+                m.hdr.controllen = @sizeOf(ControlBuf);
+                m.hdr.flags = 0;
+                m.len = 0;
+            }
 
-        if (!header.isValid()) {
-            return error.InvalidMagic;
+            const n = while (true) {
+                const rc = linux.recvmmsg(self.fd, batch.msgs.ptr, @intCast(batch.msgs.len), linux.MSG.DONTWAIT, null);
+                switch (linux.E.init(rc)) {
+                    .SUCCESS => break rc,
+                    .INTR => continue,
+                    .AGAIN => return 0,
+                    .CONNREFUSED => return error.ConnectionRefused,
+                    .NOMEM, .NOBUFS => return error.SystemResources,
+                    else => |e| return posix.unexpectedErrno(e),
+                }
+            };
+
+            for (batch.msgs[0..n], 0..) |m, i| {
+                // Truncated datagrams cannot decode; drop them here
+                batch.lens[i] = if (m.hdr.flags & linux.MSG.TRUNC != 0) 0 else m.len;
+                batch.segs[i] = if (self.gro) groSegment(&batch.control[i], m.hdr.controllen) else 0;
+            }
+            batch.filled = n;
+        } else {
+            for (0..batch.capacity()) |i| {
+                var addr_len: posix.socklen_t = @sizeOf(posix.sockaddr.storage);
+                const len = posix.recvfrom(self.fd, batch.slot(i), posix.MSG.DONTWAIT, @ptrCast(&batch.addrs[i]), &addr_len) catch |err| switch (err) {
+                    error.WouldBlock => break,
+                    else => if (i == 0) return err else break,
+                };
+                batch.lens[i] = len;
+                batch.segs[i] = 0;
+                batch.filled = i + 1;
+            }
         }
+        return batch.filled;
+    }
 
-        // 2. Entropy Fast-Path (DoS Defense) - disabled, needs entropy module from l1_identity
-        // if (header.flags & lwf.LWFFlags.HAS_ENTROPY != 0) {
-        //     return error.NotImplemented; // Entropy validation requires l1_identity module
-        // }
+    /// Send all queued frames of `batch`, as few syscalls as possible.
+    /// With GSO, runs of equal-size frames to one target go out as a single
+    /// segmented message. Sent frames are dropped from the batch; on error
+    /// the unsent ones stay queued. Returns the number of frames sent.
+    pub fn sendBatch(self: *UTCP, batch: *SendBatch) !usize {
+        var sent: usize = 0;
+        defer batch.consume(sent);
 
-        // 3. Decode the rest (Allocates payload)
-        const frame = try lwf.LWFFrame.decode(allocator, data);
+        if (!has_mmsg) {
+            while (batch.head + sent < batch.count) {
+                const i = batch.head + sent;
+                const n = try posix.sendto(self.fd, batch.encoded(i), 0, &batch.targets[i].any, batch.targets[i].getOsSockLen());
+                if (n != batch.lens[i]) return error.PartialWrite;
+                sent += 1;
+            }
+            return sent;
+        }
 
-        return ReceiveResult{
-            .frame = frame,
-            .sender = std.net.Address{ .any = src_addr },
-        };
+        while (batch.head + sent < batch.count) {
+            const msg_count = batch.buildMessages(batch.head + sent, self.gso);
+            const rc = linux.sendmmsg(self.fd, batch.msgs.ptr, @intCast(msg_count), 0);
+            switch (linux.E.init(rc)) {
+                .SUCCESS => {},
+                .INTR => continue,
+                // Device without checksum offload rejects GSO: fall back to plain sends
+                .IO => if (self.gso) {
+                    self.gso = false;
+                    continue;
+                } else return error.InputOutput,
+                .AGAIN => return if (sent > 0) sent else error.WouldBlock,
+                .CONNREFUSED => return error.ConnectionRefused,
+                .MSGSIZE => return error.MessageTooBig,
+                .NOMEM, .NOBUFS => return error.SystemResources,
+                .NETUNREACH => return error.NetworkUnreachable,
+                else => |e| return posix.unexpectedErrno(e),
+            }
+            for (batch.spans[0..rc]) |span| sent += span;
+        }
+        return sent;
     }
 
     /// Get local address of the socket
@@ -104,6 +270,289 @@ pub const ReceiveResult = struct {
     frame: lwf.LWFFrame,
     sender: std.net.Address,
 };
+
+pub const ReceiveViewResult = struct {
+    view: lwf.LWFFrameView,
+    sender: std.net.Address,
+};
+
+/// Read the UDP_GRO segment size from received ancillary data (0 = none)
+fn groSegment(control: *const ControlBuf, controllen: usize) usize {
+    const bytes = std.mem.asBytes(control);
+    const limit = @min(controllen, bytes.len);
+    var offset: usize = 0;
+    while (offset + @sizeOf(Cmsg) <= limit) {
+        const hdr = std.mem.bytesToValue(Cmsg, bytes[offset..][0..@sizeOf(Cmsg)]);
+        if (hdr.len < @sizeOf(Cmsg)) break;
+        if (hdr.level == SOL_UDP and hdr.type == UDP_GRO and offset + @sizeOf(Cmsg) + @sizeOf(c_int) <= limit) {
+            const seg = std.mem.bytesToValue(c_int, bytes[offset + @sizeOf(Cmsg) ..][0..@sizeOf(c_int)]);
+            return if (seg > 0) @intCast(seg) else 0;
+        }
+        offset += cmsgAlign(hdr.len);
+    }
+    return 0;
+}
+
+/// Preallocated receive ring for `UTCP.receiveBatch`
+/// All buffers and kernel message headers are set up once in init.
+pub const RecvBatch = struct {
+    allocator: std.mem.Allocator,
+    slot_size: usize,
+    buffers: []u8,
+    /// Bytes received per slot (0 = dropped)
+    lens: []usize,
+    /// GRO segment size per slot (0 = single datagram)
+    segs: []usize,
+    addrs: []posix.sockaddr.storage,
+    iovecs: []posix.iovec,
+    msgs: if (has_mmsg) []linux.mmsghdr else void,
+    control: []ControlBuf,
+    filled: usize = 0,
+
+    pub const Datagram = struct {
+        data: []const u8,
+        sender: std.net.Address,
+    };
+
+    /// Yields each datagram of the last receive, splitting GRO-coalesced slots
+    pub const Iterator = struct {
+        batch: *const RecvBatch,
+        msg: usize = 0,
+        offset: usize = 0,
+
+        pub fn next(it: *Iterator) ?Datagram {
+            while (it.msg < it.batch.filled) {
+                const len = it.batch.lens[it.msg];
+                if (it.offset < len) {
+                    const seg = if (it.batch.segs[it.msg] == 0) len else it.batch.segs[it.msg];
+                    const end = @min(it.offset + seg, len);
+                    const data = it.batch.slot(it.msg)[it.offset..end];
+                    it.offset = end;
+                    return .{ .data = data, .sender = it.batch.sender(it.msg) };
+                }
+                it.msg += 1;
+                it.offset = 0;
+            }
+            return null;
+        }
+    };
+
+    pub fn init(allocator: std.mem.Allocator, count: usize, slot_size: usize) !RecvBatch {
+        std.debug.assert(count > 0 and slot_size > 0);
+
+        const buffers = try allocator.alloc(u8, count * slot_size);
+        errdefer allocator.free(buffers);
+        const lens = try allocator.alloc(usize, count);
+        errdefer allocator.free(lens);
+        const segs = try allocator.alloc(usize, count);
+        errdefer allocator.free(segs);
+        const addrs = try allocator.alloc(posix.sockaddr.storage, count);
+        errdefer allocator.free(addrs);
+        const iovecs = try allocator.alloc(posix.iovec, count);
+        errdefer allocator.free(iovecs);
+        const control = try allocator.alloc(ControlBuf, count);
+        errdefer allocator.free(control);
+
+        for (iovecs, 0..) |*iov, i| {
+            iov.* = .{ .base = buffers[i * slot_size ..].ptr, .len = slot_size };
+        }
+
+        const msgs = if (has_mmsg) try allocator.alloc(linux.mmsghdr, count) else {};
+        if (has_mmsg) {
+            for (msgs, 0..) |*m, i| {
+                m.* = .{ .hdr = std.mem.zeroes(linux.msghdr), .len = 0 };
+                m.hdr.name = @ptrCast(&addrs[i]);
+                m.hdr.iov = @ptrCast(&iovecs[i]);
+                m.hdr.iovlen = 1;
+                m.hdr.control = &control[i];
+            }
+        }
+
+        return .{
+            .allocator = allocator,
+            .slot_size = slot_size,
+            .buffers = buffers,
+            .lens = lens,
+            .segs = segs,
+            .addrs = addrs,
+            .iovecs = iovecs,
+            .msgs = msgs,
+            .control = control,
+        };
+    }
+
+    pub fn deinit(self: *RecvBatch) void {
+        if (has_mmsg) self.allocator.free(self.msgs);
+        self.allocator.free(self.control);
+        self.allocator.free(self.iovecs);
+        self.allocator.free(self.addrs);
+        self.allocator.free(self.segs);
+        self.allocator.free(self.lens);
+        self.allocator.free(self.buffers);
+    }
+
+    pub fn capacity(self: *const RecvBatch) usize {
+        return self.lens.len;
+    }
+
+    pub fn iterator(self: *const RecvBatch) Iterator {
+        return .{ .batch = self };
+    }
+
+    fn slot(self: *const RecvBatch, i: usize) []u8 {
+        return self.buffers[i * self.slot_size ..][0..self.slot_size];
+    }
+
+    fn sender(self: *const RecvBatch, i: usize) std.net.Address {
+        return std.net.Address.initPosix(@ptrCast(&self.addrs[i]));
+    }
+};
+
+/// Fixed-capacity queue of encoded frames for `UTCP.sendBatch`
+/// Frames are encoded in place on `add`; no allocation after init.
+pub const SendBatch = struct {
+    allocator: std.mem.Allocator,
+    slot_size: usize,
+    buffers: []u8,
+    lens: []usize,
+    targets: []std.net.Address,
+    /// First unsent frame
+    head: usize = 0,
+    count: usize = 0,
+    // Syscall scratch: iovecs parallel the frames, messages cover runs of them
+    iovecs: []posix.iovec_const,
+    msgs: if (has_mmsg) []linux.mmsghdr_const else void,
+    control: []ControlBuf,
+    /// Frames carried by each built message
+    spans: []usize,
+
+    pub fn init(allocator: std.mem.Allocator, count: usize, slot_size: usize) !SendBatch {
+        std.debug.assert(count > 0 and slot_size > 0);
+
+        const buffers = try allocator.alloc(u8, count * slot_size);
+        errdefer allocator.free(buffers);
+        const lens = try allocator.alloc(usize, count);
+        errdefer allocator.free(lens);
+        const targets = try allocator.alloc(std.net.Address, count);
+        errdefer allocator.free(targets);
+        const iovecs = try allocator.alloc(posix.iovec_const, count);
+        errdefer allocator.free(iovecs);
+        const control = try allocator.alloc(ControlBuf, count);
+        errdefer allocator.free(control);
+        const spans = try allocator.alloc(usize, count);
+        errdefer allocator.free(spans);
+
+        const msgs = if (has_mmsg) try allocator.alloc(linux.mmsghdr_const, count) else {};
+        if (has_mmsg) {
+            for (msgs) |*m| m.* = .{ .hdr = std.mem.zeroes(linux.msghdr_const), .len = 0 };
+        }
+
+        return .{
+            .allocator = allocator,
+            .slot_size = slot_size,
+            .buffers = buffers,
+            .lens = lens,
+            .targets = targets,
+            .iovecs = iovecs,
+            .msgs = msgs,
+            .control = control,
+            .spans = spans,
+        };
+    }
+
+    pub fn deinit(self: *SendBatch) void {
+        if (has_mmsg) self.allocator.free(self.msgs);
+        self.allocator.free(self.spans);
+        self.allocator.free(self.control);
+        self.allocator.free(self.iovecs);
+        self.allocator.free(self.targets);
+        self.allocator.free(self.lens);
+        self.allocator.free(self.buffers);
+    }
+
+    /// Encode `frame` into the next free slot
+    pub fn add(self: *SendBatch, target: std.net.Address, frame: *const lwf.LWFFrame) !void {
+        if (self.count == self.lens.len) return error.BatchFull;
+        if (frame.size() > self.slot_size) return error.FrameTooLarge;
+        const i = self.count;
+        self.lens[i] = try frame.encodeInto(self.slotBuf(i));
+        self.targets[i] = target;
+        self.count += 1;
+    }
+
+    /// Frames queued and not yet sent
+    pub fn pending(self: *const SendBatch) usize {
+        return self.count - self.head;
+    }
+
+    pub fn clear(self: *SendBatch) void {
+        self.head = 0;
+        self.count = 0;
+    }
+
+    fn slotBuf(self: *SendBatch, i: usize) []u8 {
+        return self.buffers[i * self.slot_size ..][0..self.slot_size];
+    }
+
+    fn encoded(self: *const SendBatch, i: usize) []const u8 {
+        return self.buffers[i * self.slot_size ..][0..self.lens[i]];
+    }
+
+    fn consume(self: *SendBatch, n: usize) void {
+        self.head += n;
+        if (self.head == self.count) self.clear();
+    }
+
+    /// Fill `msgs` for frames [first, count). Returns the message count.
+    fn buildMessages(self: *SendBatch, first: usize, gso: bool) usize {
+        var msg_count: usize = 0;
+        var i = first;
+        while (i < self.count) : (msg_count += 1) {
+            self.iovecs[i] = .{ .base = self.encoded(i).ptr, .len = self.lens[i] };
+
+            // A GSO run: same target, equal segment size, last one may be shorter
+            var end = i + 1;
+            if (gso) {
+                const seg = self.lens[i];
+                var total = seg;
+                while (end < self.count and end - i < gso_max_segments and
+                    self.lens[end] <= seg and total + self.lens[end] <= max_udp_payload and
+                    self.targets[end].eql(self.targets[i])) : (end += 1)
+                {
+                    self.iovecs[end] = .{ .base = self.encoded(end).ptr, .len = self.lens[end] };
+                    total += self.lens[end];
+                    if (self.lens[end] < seg) {
+                        end += 1;
+                        break;
+                    }
+                }
+            }
+
+            const m = &self.msgs[msg_count];
+            m.hdr.name = &self.targets[i].any;
+            m.hdr.namelen = self.targets[i].getOsSockLen();
+            m.hdr.iov = self.iovecs[i..end].ptr;
+            m.hdr.iovlen = @intCast(end - i);
+            m.hdr.control = null;
+            m.hdr.controllen = 0;
+            m.hdr.flags = 0;
+            m.len = 0;
+            if (end - i > 1) {
+                const ctl = &self.control[msg_count];
+                const hdr: *Cmsg = @ptrCast(ctl);
+                hdr.* = .{ .len = @sizeOf(Cmsg) + @sizeOf(u16), .level = SOL_UDP, .type = UDP_SEGMENT };
+                const seg: u16 = @intCast(self.lens[i]);
+                @memcpy(std.mem.asBytes(ctl)[@sizeOf(Cmsg)..][0..@sizeOf(u16)], std.mem.asBytes(&seg));
+                m.hdr.control = ctl;
+                m.hdr.controllen = @intCast(cmsgAlign(hdr.len));
+            }
+
+            self.spans[msg_count] = end - i;
+            i = end;
+        }
+        return msg_count;
+    }
+};
 test "UTCP socket init and loopback" {
     const allocator = std.testing.allocator;
     const addr = try std.net.Address.parseIp("127.0.0.1", 0); // Port 0 for ephemeral
@@ -137,35 +586,108 @@ test "UTCP socket init and loopback" {
     try std.testing.expect(received_frame.verifyChecksum());
 }
 
-// Note: Entropy validation test disabled - requires l1_identity module
-// test "UTCP socket DoS defense: invalid entropy stamp" {
-//     const allocator = std.testing.allocator;
-//     const addr = try std.net.Address.parseIp("127.0.0.1", 0);
-//
-//     var server = try UTCP.init(allocator, addr);
-//     defer server.deinit();
-//     const server_addr = try server.getLocalAddress();
-//
-//     var client = try UTCP.init(allocator, try std.net.Address.parseIp("127.0.0.1", 0));
-//     defer client.deinit();
-//
-//     // 1. Prepare frame with HAS_ENTROPY but garbage stamp
-//     var frame = try lwf.LWFFrame.init(allocator, 100);
-//     defer frame.deinit(allocator);
-//     frame.header.flags |= lwf.LWFFlags.HAS_ENTROPY;
-//     frame.header.entropy_difficulty = 20; // High difficulty
-//     @memset(frame.payload[0..77], 0);
-//     // Set valid timestamp (fresh)
-//     // Offset: Hash(32) + Nonce(16) + Salt(16) + Diff(1) + Mem(2) = 67
-//     const now = @as(u64, @intCast(std.time.timestamp()));
-//     std.mem.writeInt(u64, frame.payload[67..75], now, .big);
-//
-//     // 2. Send
-//     try client.sendFrame(server_addr, &frame, allocator);
-//
-//     // 3. Receive - should fail with InsufficientDifficulty
-//     var receive_buf: [1500]u8 = undefined;
-//     const result = server.receiveFrame(allocator, &receive_buf);
-//
-//     try std.testing.expectError(error.InsufficientDifficulty, result);
-// }
+test "UTCP batched send and receive" {
+    const allocator = std.testing.allocator;
+
+    var server = try UTCP.init(allocator, try std.net.Address.parseIp("127.0.0.1", 0));
+    defer server.deinit();
+    const server_addr = try server.getLocalAddress();
+
+    var client = try UTCP.init(allocator, try std.net.Address.parseIp("127.0.0.1", 0));
+    defer client.deinit();
+
+    var send_batch = try SendBatch.init(allocator, 8, 1500);
+    defer send_batch.deinit();
+
+    // Equal sizes (GSO-eligible run) followed by a shorter tail
+    const sizes = [_]usize{ 64, 64, 64, 16 };
+    for (sizes, 0..) |len, i| {
+        var frame = try lwf.LWFFrame.init(allocator, len);
+        defer frame.deinit(allocator);
+        @memset(frame.payload, @intCast(i));
+        frame.header.payload_len = @intCast(len);
+        frame.updateChecksum();
+        try send_batch.add(server_addr, &frame);
+    }
+    try std.testing.expectEqual(@as(usize, sizes.len), try client.sendBatch(&send_batch));
+    try std.testing.expectEqual(@as(usize, 0), send_batch.pending());
+
+    var recv_batch = try RecvBatch.init(allocator, 8, 1500);
+    defer recv_batch.deinit();
+
+    var received: usize = 0;
+    var attempts: usize = 0;
+    while (received < sizes.len and attempts < 100) : (attempts += 1) {
+        if (try server.receiveBatch(&recv_batch) == 0) {
+            std.Thread.sleep(std.time.ns_per_ms);
+            continue;
+        }
+        var it = recv_batch.iterator();
+        while (it.next()) |dg| : (received += 1) {
+            var frame = try UTCP.decodeDatagram(allocator, dg.data);
+            defer frame.deinit(allocator);
+            try std.testing.expectEqual(sizes[received], frame.payload.len);
+            try std.testing.expect(frame.verifyChecksum());
+            try std.testing.expectEqual(@as(u8, @intCast(received)), frame.payload[0]);
+        }
+    }
+    try std.testing.expectEqual(@as(usize, sizes.len), received);
+}
+
+test "SendBatch rejects overflow" {
+    const allocator = std.testing.allocator;
+    var batch = try SendBatch.init(allocator, 1, 256);
+    defer batch.deinit();
+
+    var big = try lwf.LWFFrame.init(allocator, 512);
+    defer big.deinit(allocator);
+    const target = try std.net.Address.parseIp("127.0.0.1", 9);
+    try std.testing.expectError(error.FrameTooLarge, batch.add(target, &big));
+
+    var small = try lwf.LWFFrame.init(allocator, 8);
+    defer small.deinit(allocator);
+    try batch.add(target, &small);
+    try std.testing.expectError(error.BatchFull, batch.add(target, &small));
+}
+
+test "UTCP socket DoS defense: invalid entropy stamp" {
+    const allocator = std.testing.allocator;
+    const addr = try std.net.Address.parseIp("127.0.0.1", 0);
+
+    var server = try UTCP.init(allocator, addr);
+    defer server.deinit();
+    const server_addr = try server.getLocalAddress();
+
+    var client = try UTCP.init(allocator, try std.net.Address.parseIp("127.0.0.1", 0));
+    defer client.deinit();
+
+    // 1. Prepare frame with HAS_ENTROPY but garbage stamp
+    var frame = try lwf.LWFFrame.init(allocator, 100);
+    defer frame.deinit(allocator);
+    frame.header.payload_len = 100;
+    frame.header.flags |= lwf.LWFFlags.HAS_ENTROPY;
+    frame.header.entropy_difficulty = 20; // High difficulty
+    @memset(frame.payload[0..77], 0);
+    // Set valid timestamp (fresh)
+    // Offset: Hash(32) + Nonce(16) + Salt(16) + Diff(1) + Mem(2) = 67
+    const now = @as(u64, @intCast(std.time.timestamp()));
+    std.mem.writeInt(u64, frame.payload[67..75], now, .big);
+
+    // 2. Send
+    try client.sendFrame(server_addr, &frame, allocator);
+
+    // 3. Receive - should fail with InsufficientDifficulty
+    var receive_buf: [1500]u8 = undefined;
+    const result = server.receiveFrame(allocator, &receive_buf);
+
+    try std.testing.expectError(error.InsufficientDifficulty, result);
+
+    // Stamp too short for the payload
+    var short = try lwf.LWFFrame.init(allocator, 16);
+    defer short.deinit(allocator);
+    short.header.payload_len = 16;
+    short.header.flags |= lwf.LWFFlags.HAS_ENTROPY;
+    var encoded: [256]u8 = undefined;
+    const len = try short.encodeInto(&encoded);
+    try std.testing.expectError(error.StampTruncated, UTCP.parseDatagram(encoded[0..len]));
+}
@@ -10,22 +10,39 @@
 //! - Configurable difficulty (leading zero bits required)
 //! - Timestamp validation (prevents replay)
 //! - Service type domain separation (prevents cross-service attacks)
+//! - Batch verification: cheap checks first, Argon2id on a worker pool
 
 const std = @import("std");
+const builtin = @import("builtin");
 const crypto = std.crypto;
 
 // C FFI for Argon2id (compiled in build.zig)
-extern "c" fn argon2id_hash_raw(
-    time_cost: u32,
-    memory_cost: u32,
-    parallelism: u32,
-    pwd: ?*const anyopaque,
-    pwd_len: usize,
-    salt: ?*const anyopaque,
-    salt_len: usize,
-    hash: ?*anyopaque,
-    hash_len: usize,
-) c_int;
+/// libargon2 `argon2_context`
+const Argon2Context = extern struct {
+    out: [*]u8,
+    outlen: u32,
+    pwd: [*]const u8,
+    pwdlen: u32,
+    salt: [*]const u8,
+    saltlen: u32,
+    secret: ?[*]u8,
+    secretlen: u32,
+    ad: ?[*]u8,
+    adlen: u32,
+    t_cost: u32,
+    m_cost: u32,
+    lanes: u32,
+    threads: u32,
+    version: u32,
+    allocate_cbk: ?*const fn (memory: *[*]u8, bytes: usize) callconv(.c) c_int,
+    free_cbk: ?*const fn (memory: [*]u8, bytes: usize) callconv(.c) void,
+    flags: u32,
+};
+
+extern "c" fn argon2id_ctx(context: *Argon2Context) c_int;
+
+const ARGON2_VERSION_13: u32 = 0x13;
+const ARGON2_MEMORY_ALLOCATION_ERROR: c_int = -22;
 
 // ============================================================================
 // Constants (Kenya Rule Compliance)
@@ -49,6 +66,24 @@ pub const HASH_LEN: usize = 32;
 /// Default stamp lifetime: 1 hour (3600 seconds)
 pub const DEFAULT_MAX_AGE_SECONDS: i64 = 3600;
 
+/// Allowed clock skew for stamps from the future
+pub const MAX_CLOCK_SKEW_SECONDS: i64 = 60;
+
+/// Serialized stamp size (payload prefix of HAS_ENTROPY frames)
+pub const STAMP_SIZE: usize = 77;
+
+/// Argon2id work area for one hash (1 KiB blocks)
+pub const WORK_MEMORY_BYTES: usize = ARGON2_MEMORY_KB * 1024;
+
+pub const StampError = error{
+    ServiceMismatch,
+    StampExpired,
+    StampFromFuture,
+    InsufficientDifficulty,
+    HashInvalid,
+    DuplicateStamp,
+};
+
 // ============================================================================
 // Entropy Stamp: Proof-of-Work Structure
 // ============================================================================
@@ -143,9 +178,8 @@ pub const EntropyStamp = struct {
     /// Verify that an entropy stamp is valid
     ///
     /// **Verification Steps:**
-    /// 1. Check timestamp freshness
-    /// 2. Check service type matches
-    /// 3. Recompute hash and verify difficulty
+    /// 1. Cheap checks (`precheck`): service, freshness, difficulty
+    /// 2. Recompute hash and compare
     ///
     /// **Parameters:**
     /// - `payload_hash`: Hash of the data (must match mining payload)
@@ -160,21 +194,34 @@ pub const EntropyStamp = struct {
         min_difficulty: u8,
         expected_service: u16,
         max_age_seconds: i64,
-    ) !void {
+    ) StampError!void {
+        try self.precheck(min_difficulty, expected_service, max_age_seconds, std.time.timestamp());
+        try self.checkWork(payload_hash);
+    }
+
+    /// Everything `verify` checks except the memory-hard hash.
+    /// A stamp failing here is rejected without running Argon2id; one
+    /// passing may still carry forged work.
+    pub fn precheck(
+        self: *const EntropyStamp,
+        min_difficulty: u8,
+        expected_service: u16,
+        max_age_seconds: i64,
+        now: i64,
+    ) StampError!void {
         // Check service type
         if (self.service_type != expected_service) {
             return error.ServiceMismatch;
         }
 
         // Check timestamp freshness
-        const now: i64 = @intCast(std.time.timestamp());
-        const age: i64 = now - @as(i64, @intCast(self.timestamp_sec));
+        const age: i64 = now - @as(i64, @intCast(@min(self.timestamp_sec, std.math.maxInt(i64))));
 
         if (age > max_age_seconds) {
             return error.StampExpired;
         }
 
-        if (age < -60) { // 60 second clock skew allowance
+        if (age < -MAX_CLOCK_SKEW_SECONDS) {
             return error.StampFromFuture;
         }
 
@@ -183,21 +230,22 @@ pub const EntropyStamp = struct {
             return error.InsufficientDifficulty;
         }
 
-        // Recompute hash and verify
+        // Check if stored hash meets difficulty
+        const zeros = countLeadingZeros(&self.hash);
+        if (zeros < self.difficulty) {
+            return error.InsufficientDifficulty;
+        }
+    }
+
+    /// Recompute the hash and compare it with the stored one
+    fn checkWork(self: *const EntropyStamp, payload_hash: *const [32]u8) StampError!void {
         // Use the nonce/salt from the stamp to reproduce the work
         var computed_hash: [HASH_LEN]u8 = undefined;
         computeStampHash(payload_hash, &self.nonce, &self.salt, self.timestamp_sec, self.service_type, &computed_hash);
 
-        // Check if computed hash matches stored hash
         if (!std.mem.eql(u8, &computed_hash, &self.hash)) {
             return error.HashInvalid;
         }
-
-        // Check if stored hash meets difficulty
-        const zeros = countLeadingZeros(&self.hash);
-        if (zeros < self.difficulty) {
-            return error.InsufficientDifficulty;
-        }
     }
 
     /// Serialize stamp to bytes (77 bytes)
@@ -275,10 +323,316 @@ pub const EntropyStamp = struct {
     }
 };
 
+// ============================================================================
+// Batch Verification
+// ============================================================================
+
+pub const VerifyPolicy = struct {
+    min_difficulty: u8,
+    expected_service: u16,
+    max_age_seconds: i64 = DEFAULT_MAX_AGE_SECONDS,
+};
+
+pub const BatchItem = struct {
+    stamp: EntropyStamp,
+    /// Hash of the stamped data
+    payload_hash: [32]u8,
+};
+
+/// Time buckets in the replay set's expiry ring
+const EXPIRY_BUCKETS = 64;
+
+/// Verifies stamps N at a time.
+///
+/// Each batch is triaged on the calling thread first: stamps failing the
+/// cheap checks or already seen (replays, also within the batch) never
+/// reach Argon2id. The remaining hashes are spread over a fixed set of
+/// worker threads, each with its own preallocated Argon2id work memory,
+/// so verification allocates nothing per stamp.
+///
+/// Accepted stamps are also filed in a ring of time buckets by timestamp,
+/// so forgetting expired ones touches only the expired keys.
+pub const BatchVerifier = struct {
+    /// Keys of accepted stamps whose timestamp_sec / expiry_span == epoch
+    const ExpiryBucket = struct {
+        epoch: u64 = 0,
+        keys: std.ArrayListUnmanaged([32]u8) = .{},
+    };
+
+    allocator: std.mem.Allocator,
+    policy: VerifyPolicy,
+    /// Accepted (or in-flight) stamps -> timestamp_sec, for replay rejection
+    seen: std.AutoHashMapUnmanaged([32]u8, u64),
+    last_prune: i64,
+    /// Ring covering every timestamp that can pass the freshness check
+    expiry: [EXPIRY_BUCKETS]ExpiryBucket = [_]ExpiryBucket{.{}} ** EXPIRY_BUCKETS,
+    /// Seconds per bucket
+    expiry_span: u64,
+    /// Buckets of earlier epochs have been emptied
+    pruned_epoch: u64 = 0,
+    /// Work memory: slot 0 for the calling thread, then one per worker
+    memory: []align(64) u8,
+    threads: []std.Thread,
+    spawned: usize,
+
+    mutex: std.Thread.Mutex = .{},
+    wake: std.Thread.Condition = .{},
+    idle: std.Thread.Condition = .{},
+    generation: u64 = 0,
+    /// Workers still on the current batch
+    active: usize = 0,
+    shutdown: bool = false,
+
+    // Current batch
+    items: []const BatchItem = &.{},
+    results: []StampError!void = &.{},
+    /// Indices of items that passed triage
+    pending: std.ArrayListUnmanaged(u32) = .{},
+    cursor: std.atomic.Value(usize) = std.atomic.Value(usize).init(0),
+
+    /// `threads`: Argon2id workers besides the caller (0 = one per CPU)
+    pub fn init(allocator: std.mem.Allocator, policy: VerifyPolicy, threads: usize) !*BatchVerifier {
+        const wanted: usize = if (builtin.single_threaded)
+            0
+        else if (threads != 0)
+            threads
+        else
+            (std.Thread.getCpuCount() catch 1) -| 1;
+
+        const self = try allocator.create(BatchVerifier);
+        errdefer allocator.destroy(self);
+
+        const memory = try allocator.alignedAlloc(u8, .@"64", (wanted + 1) * WORK_MEMORY_BYTES);
+        errdefer allocator.free(memory);
+        const thread_buf = try allocator.alloc(std.Thread, wanted);
+        errdefer allocator.free(thread_buf);
+
+        // Live timestamps span max_age + skew; leave spare buckets so an
+        // epoch is always emptied before its slot comes round again
+        const window: u64 = @intCast(@max(policy.max_age_seconds + MAX_CLOCK_SKEW_SECONDS, 1));
+        self.* = .{
+            .allocator = allocator,
+            .policy = policy,
+            .seen = .{},
+            .last_prune = std.time.timestamp(),
+            .expiry_span = std.math.divCeil(u64, window, EXPIRY_BUCKETS - 3) catch unreachable,
+            .memory = memory,
+            .threads = thread_buf,
+            .spawned = 0,
+        };
+
+        // Spawn failures just mean fewer workers
+        for (thread_buf, 0..) |*thread, i| {
+            thread.* = std.Thread.spawn(.{}, workerMain, .{ self, self.workMemory(i + 1) }) catch break;
+            self.spawned += 1;
+        }
+        return self;
+    }
+
+    pub fn deinit(self: *BatchVerifier) void {
+        self.mutex.lock();
+        self.shutdown = true;
+        self.wake.broadcast();
+        self.mutex.unlock();
+        for (self.threads[0..self.spawned]) |thread| thread.join();
+
+        const allocator = self.allocator;
+        self.pending.deinit(allocator);
+        for (&self.expiry) |*bucket| bucket.keys.deinit(allocator);
+        self.seen.deinit(allocator);
+        allocator.free(self.threads);
+        allocator.free(self.memory);
+        allocator.destroy(self);
+    }
+
+    fn workMemory(self: *BatchVerifier, slot: usize) []u8 {
+        return self.memory[slot * WORK_MEMORY_BYTES ..][0..WORK_MEMORY_BYTES];
+    }
+
+    /// Verify `items`, writing one result per item (results.len == items.len).
+    /// Returns the number of valid stamps; they are remembered and rejected
+    /// as duplicates until they expire.
+    pub fn verifyBatch(self: *BatchVerifier, items: []const BatchItem, results: []StampError!void) !usize {
+        std.debug.assert(results.len == items.len);
+        const now = std.time.timestamp();
+        if (now != self.last_prune) self.pruneSeen(now);
+
+        // 1. Triage on this thread
+        self.pending.clearRetainingCapacity();
+        try self.pending.ensureTotalCapacity(self.allocator, items.len);
+        try self.seen.ensureUnusedCapacity(self.allocator, @intCast(items.len));
+        for (items, results, 0..) |*item, *result, i| {
+            result.* = item.stamp.precheck(self.policy.min_difficulty, self.policy.expected_service, self.policy.max_age_seconds, now);
+            if (result.*) |_| {} else |_| continue;
+
+            const entry = self.seen.getOrPutAssumeCapacity(replayKey(item));
+            if (entry.found_existing) {
+                result.* = error.DuplicateStamp;
+                continue;
+            }
+            entry.value_ptr.* = item.stamp.timestamp_sec;
+            self.pending.appendAssumeCapacity(@intCast(i));
+        }
+        // Room to file every survivor, so step 3 cannot fail
+        self.reserveExpiry(items) catch |err| {
+            for (self.pending.items) |i| _ = self.seen.remove(replayKey(&items[i]));
+            return err;
+        };
+
+        // 2. Argon2id for the survivors
+        self.items = items;
+        self.results = results;
+        self.runPending();
+
+        // 3. Forged stamps must not block the genuine one later
+        var valid: usize = 0;
+        for (self.pending.items) |i| {
+            const key = replayKey(&items[i]);
+            if (results[i]) |_| {
+                valid += 1;
+                self.fileExpiry(key, items[i].stamp.timestamp_sec);
+            } else |_| {
+                _ = self.seen.remove(key);
+            }
+        }
+        return valid;
+    }
+
+    fn expiryEpoch(self: *const BatchVerifier, timestamp_sec: u64) u64 {
+        return timestamp_sec / self.expiry_span;
+    }
+
+    fn reserveExpiry(self: *BatchVerifier, items: []const BatchItem) !void {
+        var counts = [_]u32{0} ** EXPIRY_BUCKETS;
+        for (self.pending.items) |i| {
+            counts[@intCast(self.expiryEpoch(items[i].stamp.timestamp_sec) % EXPIRY_BUCKETS)] += 1;
+        }
+        for (&self.expiry, counts) |*bucket, count| {
+            if (count > 0) try bucket.keys.ensureUnusedCapacity(self.allocator, count);
+        }
+    }
+
+    fn fileExpiry(self: *BatchVerifier, key: [32]u8, timestamp_sec: u64) void {
+        const epoch = self.expiryEpoch(timestamp_sec);
+        const bucket = &self.expiry[@intCast(epoch % EXPIRY_BUCKETS)];
+        // A different epoch in the slot is long expired (clock went back
+        // or pruning lagged): forget it now
+        if (bucket.epoch != epoch) {
+            self.dropBucket(bucket);
+            bucket.epoch = epoch;
+        }
+        bucket.keys.appendAssumeCapacity(key);
+    }
+
+    fn dropBucket(self: *BatchVerifier, bucket: *ExpiryBucket) void {
+        for (bucket.keys.items) |key| _ = self.seen.remove(key);
+        bucket.keys.clearRetainingCapacity();
+    }
+
+    /// Forget stamps old enough to fail the freshness check anyway.
+    /// Empties whole buckets only, so a stamp may be kept up to
+    /// `expiry_span` seconds longer; cost is O(expired + buckets passed).
+    fn pruneSeen(self: *BatchVerifier, now: i64) void {
+        self.last_prune = now;
+        const cutoff = now - self.policy.max_age_seconds;
+        if (cutoff <= 0) return;
+        // Epochs below `limit` end before the cutoff
+        const limit = self.expiryEpoch(@intCast(cutoff));
+        if (limit <= self.pruned_epoch) return;
+
+        const steps = @min(limit - self.pruned_epoch, EXPIRY_BUCKETS);
+        for (0..steps) |k| {
+            const bucket = &self.expiry[@intCast((self.pruned_epoch + k) % EXPIRY_BUCKETS)];
+            if (bucket.epoch < limit) self.dropBucket(bucket);
+        }
+        self.pruned_epoch = limit;
+    }
+
+    fn runPending(self: *BatchVerifier) void {
+        self.cursor.store(0, .monotonic);
+        if (self.spawned == 0 or self.pending.items.len <= 1) {
+            self.drain(self.workMemory(0));
+            return;
+        }
+
+        self.mutex.lock();
+        self.generation +%= 1;
+        self.active = self.spawned;
+        self.wake.broadcast();
+        self.mutex.unlock();
+
+        // The calling thread takes a share too
+        self.drain(self.workMemory(0));
+
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        while (self.active > 0) self.idle.wait(&self.mutex);
+    }
+
+    fn drain(self: *BatchVerifier, memory: []u8) void {
+        const previous = work_memory;
+        work_memory = memory;
+        defer work_memory = previous;
+
+        while (true) {
+            const k = self.cursor.fetchAdd(1, .monotonic);
+            if (k >= self.pending.items.len) return;
+            const i = self.pending.items[k];
+            self.results[i] = self.items[i].stamp.checkWork(&self.items[i].payload_hash);
+        }
+    }
+
+    fn workerMain(self: *BatchVerifier, memory: []u8) void {
+        var generation: u64 = 0;
+        while (true) {
+            self.mutex.lock();
+            while (!self.shutdown and self.generation == generation) self.wake.wait(&self.mutex);
+            if (self.shutdown) {
+                self.mutex.unlock();
+                return;
+            }
+            generation = self.generation;
+            self.mutex.unlock();
+
+            self.drain(memory);
+
+            self.mutex.lock();
+            self.active -= 1;
+            if (self.active == 0) self.idle.signal();
+            self.mutex.unlock();
+        }
+    }
+};
+
+/// Identity of a (stamp, payload) pair for replay rejection
+fn replayKey(item: *const BatchItem) [32]u8 {
+    var key: [32]u8 = undefined;
+    var hasher = crypto.hash.sha2.Sha256.init(.{});
+    hasher.update(&item.stamp.toBytes());
+    hasher.update(&item.payload_hash);
+    hasher.final(&key);
+    return key;
+}
+
 // ============================================================================
 // Internal Helpers
 // ============================================================================
 
+/// Argon2id work memory of the current thread (empty = libargon2 allocates)
+threadlocal var work_memory: []u8 = &.{};
+
+fn allocateWorkMemory(memory: *[*]u8, bytes: usize) callconv(.c) c_int {
+    if (bytes > work_memory.len) return ARGON2_MEMORY_ALLOCATION_ERROR;
+    memory.* = work_memory.ptr;
+    return 0;
+}
+
+fn freeWorkMemory(memory: [*]u8, bytes: usize) callconv(.c) void {
+    // Owned by the thread's verifier slot
+    _ = memory;
+    _ = bytes;
+}
+
 /// Compute Argon2id hash for a stamp
 /// Input: payload_hash || nonce || timestamp || service_type
 fn computeStampHash(
@@ -304,18 +658,29 @@ fn computeStampHash(
 
     std.mem.writeInt(u16, input[offset .. offset + 2][0..2], service_type, .big);
 
-    // Call Argon2id with PROVIDED salt
-    const result = argon2id_hash_raw(
-        ARGON2_TIME_COST,
-        ARGON2_MEMORY_KB,
-        ARGON2_PARALLELISM,
-        @ptrCast(input[0..].ptr),
-        input.len,
-        @ptrCast(salt[0..].ptr),
-        salt.len,
-        @ptrCast(output),
-        HASH_LEN,
-    );
+    // Call Argon2id with PROVIDED salt (same parameters as argon2id_hash_raw)
+    const use_work_memory = work_memory.len >= WORK_MEMORY_BYTES;
+    var context = Argon2Context{
+        .out = output,
+        .outlen = HASH_LEN,
+        .pwd = &input,
+        .pwdlen = input.len,
+        .salt = salt,
+        .saltlen = salt.len,
+        .secret = null,
+        .secretlen = 0,
+        .ad = null,
+        .adlen = 0,
+        .t_cost = ARGON2_TIME_COST,
+        .m_cost = ARGON2_MEMORY_KB,
+        .lanes = ARGON2_PARALLELISM,
+        .threads = ARGON2_PARALLELISM,
+        .version = ARGON2_VERSION_13,
+        .allocate_cbk = if (use_work_memory) &allocateWorkMemory else null,
+        .free_cbk = if (use_work_memory) &freeWorkMemory else null,
+        .flags = 0,
+    };
+    const result = argon2id_ctx(&context);
 
     if (result != 0) {
         // Argon2 error - zero the output as fallback
@@ -424,3 +789,83 @@ test "entropy stamp: Kenya rule - difficulty 8 < 100ms" {
     _ = stamp;
     _ = elapsed;
 }
+
+test "entropy stamp: batch verification" {
+    const allocator = std.testing.allocator;
+    var hash_a: [32]u8 = undefined;
+    var hash_b: [32]u8 = undefined;
+    crypto.hash.sha2.Sha256.hash("payload a", &hash_a, .{});
+    crypto.hash.sha2.Sha256.hash("payload b", &hash_b, .{});
+
+    const a = try EntropyStamp.mine(&hash_a, 8, 0x0A00, 100_000);
+    const b = try EntropyStamp.mine(&hash_b, 8, 0x0A00, 100_000);
+    var forged = b;
+    forged.nonce[0] ^= 0xFF;
+    var weak = a;
+    weak.difficulty = 4;
+
+    var verifier = try BatchVerifier.init(allocator, .{ .min_difficulty = 8, .expected_service = 0x0A00 }, 2);
+    defer verifier.deinit();
+
+    const items = [_]BatchItem{
+        .{ .stamp = a, .payload_hash = hash_a },
+        .{ .stamp = forged, .payload_hash = hash_b },
+        .{ .stamp = b, .payload_hash = hash_b },
+        .{ .stamp = a, .payload_hash = hash_a },
+        .{ .stamp = weak, .payload_hash = hash_a },
+        .{ .stamp = a, .payload_hash = hash_b },
+    };
+    var results: [items.len]StampError!void = undefined;
+    try std.testing.expectEqual(@as(usize, 2), try verifier.verifyBatch(&items, &results));
+
+    try results[0];
+    try std.testing.expectError(error.HashInvalid, results[1]);
+    // A forged copy earlier in the batch does not block the genuine stamp
+    try results[2];
+    try std.testing.expectError(error.DuplicateStamp, results[3]);
+    try std.testing.expectError(error.InsufficientDifficulty, results[4]);
+    // Valid work, wrong payload
+    try std.testing.expectError(error.HashInvalid, results[5]);
+
+    // Replays across batches
+    var replay: [1]StampError!void = undefined;
+    try std.testing.expectEqual(@as(usize, 0), try verifier.verifyBatch(items[2..3], &replay));
+    try std.testing.expectError(error.DuplicateStamp, replay[0]);
+}
+
+test "entropy stamp: replay set forgets only expired buckets" {
+    const allocator = std.testing.allocator;
+    const verifier = try BatchVerifier.init(allocator, .{ .min_difficulty = 8, .expected_service = 0x0A00, .max_age_seconds = 600 }, 0);
+    defer verifier.deinit();
+    const span = verifier.expiry_span;
+
+    // One key per second over the freshness window
+    const start: u64 = 1_000_000;
+    const count = 600;
+    var counts = [_]u32{0} ** EXPIRY_BUCKETS;
+    for (0..count) |i| counts[@intCast(verifier.expiryEpoch(start + i) % EXPIRY_BUCKETS)] += 1;
+    for (&verifier.expiry, counts) |*bucket, n| try bucket.keys.ensureUnusedCapacity(allocator, n);
+    try verifier.seen.ensureUnusedCapacity(allocator, count);
+    for (0..count) |i| {
+        var key = [_]u8{0} ** 32;
+        std.mem.writeInt(u64, key[0..8], i, .little);
+        verifier.seen.putAssumeCapacity(key, start + i);
+        verifier.fileExpiry(key, start + i);
+    }
+
+    // Nothing has expired yet
+    verifier.pruneSeen(@intCast(start + 600));
+    try std.testing.expectEqual(@as(u32, count), verifier.seen.count());
+
+    // Stamps older than max_age go, up to one bucket late; fresh ones stay
+    const now: i64 = @intCast(start + 900);
+    verifier.pruneSeen(now);
+    const kept = verifier.seen.count();
+    try std.testing.expect(kept >= 300 and kept < 300 + span);
+    var it = verifier.seen.valueIterator();
+    while (it.next()) |timestamp| try std.testing.expect(timestamp.* + span >= start + 300);
+
+    // A clock jump far ahead empties every bucket
+    verifier.pruneSeen(now + 100_000);
+    try std.testing.expectEqual(@as(u32, 0), verifier.seen.count());
+}
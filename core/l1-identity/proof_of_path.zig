@@ -101,12 +101,25 @@ pub const ProofOfPath = struct {
         sender_did: [32]u8,
         receiver_did: [32]u8,
         graph: *const trust_graph.CompactTrustGraph,
+    ) !?ProofOfPath {
+        var scratch = trust_graph.PathScratch.init(allocator);
+        defer scratch.deinit();
+        return constructWith(allocator, &scratch, sender_did, receiver_did, graph);
+    }
+
+    /// Same as `construct`, reusing caller-owned search scratch
+    /// (keep one per sending thread; path search is then allocation-free).
+    pub fn constructWith(
+        allocator: std.mem.Allocator,
+        scratch: *trust_graph.PathScratch,
+        sender_did: [32]u8,
+        receiver_did: [32]u8,
+        graph: *const trust_graph.CompactTrustGraph,
     ) !?ProofOfPath {
         // Direction of Trust: Receiver -> ... -> Sender
         // Sender needs to prove: "Receiver trusts X, X trusts Y, Y trusts ME."
         // So we look for path: Receiver -> Sender
-        const path_indices = graph.findPath(receiver_did, sender_did) orelse return null;
-        defer allocator.free(path_indices);
+        const path_indices = graph.findPathWith(scratch, receiver_did, sender_did) orelse return null;
 
         var pop = ProofOfPath.init(allocator); // Default timestamp/expire
 
@@ -143,38 +156,7 @@ pub const ProofOfPath = struct {
         expected_sender: [32]u8,
         graph: *const trust_graph.CompactTrustGraph,
     ) PathVerdict {
-        if (self.hops.items.len < 2) return .invalid_endpoints;
-
-        // 1. Verify Endpoints
-        // Hops[0] should be Receiver (Trust Anchor)
-        // Hops[Last] should be Sender (Trust Target)
-        // Direction: Receiver -> A -> B -> Sender
-        if (!std.mem.eql(u8, &self.hops.items[0], &expected_receiver)) return .invalid_endpoints;
-        if (!std.mem.eql(u8, &self.hops.items[self.hops.items.len - 1], &expected_sender)) return .invalid_endpoints;
-
-        // 2. Verify Expiration
-        if (self.expires_at.isBefore(time.SovereignTimestamp.now())) return .expired;
-
-        // 3. Verify Depth
-        if (self.hops.items.len - 1 > graph.config.max_trust_depth) return .too_deep;
-
-        // 4. Verify Links (O(Depth))
-        // We walk the path provided by Sender and check if our Local Graph agrees with the edges.
-        // (Or verify signatures if we implemented full credential verification logic)
-        var i: usize = 0;
-        while (i < self.hops.items.len - 1) : (i += 1) {
-            const truster_did = self.hops.items[i];
-            const trustee_did = self.hops.items[i + 1];
-
-            // Check if Truster -> Trustee exists in our view of the graph
-            // Ideally, we verify the SIGNATURE here.
-            // For v1 Local/Chapter verification:
-            if (!graph.hasDirectTrustByDid(truster_did, trustee_did)) {
-                return .broken_link;
-            }
-        }
-
-        return .valid;
+        return verifyHops(self.hops.items, self.expires_at, expected_receiver, expected_sender, graph);
     }
 
     /// Serialize to wire byte array (simple encoding)
@@ -242,6 +224,96 @@ pub const ProofOfPath = struct {
     }
 };
 
+/// Zero-copy view over a serialized ProofOfPath (same wire format).
+/// Hops and signatures point into the input bytes; nothing is allocated,
+/// so the view is only valid while those bytes are.
+pub const ProofView = struct {
+    hops: []const [32]u8,
+    signatures: []const [64]u8,
+    timestamp: time.SovereignTimestamp,
+    expires_at: time.SovereignTimestamp,
+
+    const ts_size = time.SovereignTimestamp.SERIALIZED_SIZE;
+
+    /// Parse wire bytes (validates lengths only)
+    pub fn parse(data: []const u8) !ProofView {
+        if (data.len < 1) return error.InvalidData;
+
+        var pos: usize = 0;
+        const hop_count: usize = data[pos];
+        pos += 1;
+        if (data.len < pos + hop_count * 32 + 1) return error.EndOfStream;
+        const hops = std.mem.bytesAsSlice([32]u8, data[pos..][0 .. hop_count * 32]);
+        pos += hop_count * 32;
+
+        const sig_count: usize = data[pos];
+        pos += 1;
+        if (data.len < pos + sig_count * 64 + 2 * ts_size) return error.EndOfStream;
+        const signatures = std.mem.bytesAsSlice([64]u8, data[pos..][0 .. sig_count * 64]);
+        pos += sig_count * 64;
+
+        return .{
+            .hops = hops,
+            .signatures = signatures,
+            .timestamp = time.SovereignTimestamp.deserialize(data[pos..][0..ts_size]),
+            .expires_at = time.SovereignTimestamp.deserialize(data[pos + ts_size ..][0..ts_size]),
+        };
+    }
+
+    /// Same checks as `ProofOfPath.verify`
+    pub fn verify(
+        self: ProofView,
+        expected_receiver: [32]u8,
+        expected_sender: [32]u8,
+        graph: *const trust_graph.CompactTrustGraph,
+    ) PathVerdict {
+        return verifyHops(self.hops, self.expires_at, expected_receiver, expected_sender, graph);
+    }
+};
+
+/// Verify a received path against local Trust Graph (Receiver Side)
+/// Complexity: O(depth) - we just check the hops exist and link up.
+fn verifyHops(
+    hops: []const [32]u8,
+    expires_at: time.SovereignTimestamp,
+    expected_receiver: [32]u8,
+    expected_sender: [32]u8,
+    graph: *const trust_graph.CompactTrustGraph,
+) PathVerdict {
+    if (hops.len < 2) return .invalid_endpoints;
+
+    // 1. Verify Endpoints
+    // Hops[0] should be Receiver (Trust Anchor)
+    // Hops[Last] should be Sender (Trust Target)
+    // Direction: Receiver -> A -> B -> Sender
+    if (!std.mem.eql(u8, &hops[0], &expected_receiver)) return .invalid_endpoints;
+    if (!std.mem.eql(u8, &hops[hops.len - 1], &expected_sender)) return .invalid_endpoints;
+
+    // 2. Verify Expiration
+    if (expires_at.isBefore(time.SovereignTimestamp.now())) return .expired;
+
+    // 3. Verify Depth
+    if (hops.len - 1 > graph.config.max_trust_depth) return .too_deep;
+
+    // 4. Verify Links (O(Depth))
+    // We walk the path provided by Sender and check if our Local Graph agrees with the edges.
+    // (Or verify signatures if we implemented full credential verification logic)
+    var i: usize = 0;
+    while (i < hops.len - 1) : (i += 1) {
+        const truster_did = hops[i];
+        const trustee_did = hops[i + 1];
+
+        // Check if Truster -> Trustee exists in our view of the graph
+        // Ideally, we verify the SIGNATURE here.
+        // For v1 Local/Chapter verification:
+        if (!graph.hasDirectTrustByDid(truster_did, trustee_did)) {
+            return .broken_link;
+        }
+    }
+
+    return .valid;
+}
+
 // ============================================================================
 // TESTS
 // ============================================================================
@@ -267,7 +339,7 @@ test "ProofOfPath: construction and verification (valid flow)" {
     // Manual edge A -> S (simulate A's trust)
     const a_idx = graph.getNode(a_did).?;
     const s_idx = try graph.getOrInsertNode(s_did);
-    try graph.adjacency.items[a_idx].append(allocator, .{ .target_idx = s_idx, .level = .full, .visibility = .public, .expires_at = 0 });
+    try graph.addEdge(a_idx, .{ .target_idx = s_idx, .level = .full, .visibility = .public, .expires_at = 0 });
 
     // 2. Sender constructs proof
     var pop = try ProofOfPath.construct(allocator, s_did, r_did, &graph);
@@ -332,3 +404,33 @@ test "ProofOfPath: serialization roundtrip" {
     try std.testing.expectEqualSlices(u8, &pop.hops.items[0], &restored.hops.items[0]);
     try std.testing.expectEqual(pop.signatures.items.len, restored.signatures.items.len);
 }
+
+test "ProofView: zero-copy parse matches deserialize" {
+    const allocator = std.testing.allocator;
+
+    var r_did: [32]u8 = undefined;
+    @memset(&r_did, 0x11);
+    var s_did: [32]u8 = undefined;
+    @memset(&s_did, 0x99);
+
+    var graph = try trust_graph.CompactTrustGraph.init(allocator, r_did, .{});
+    defer graph.deinit();
+    try graph.grantTrust(s_did, .full, .friends, 0);
+
+    var pop = (try ProofOfPath.construct(allocator, s_did, r_did, &graph)).?;
+    defer pop.deinit();
+
+    const bytes = try pop.serialize(allocator);
+    defer allocator.free(bytes);
+
+    const view = try ProofView.parse(bytes);
+    try std.testing.expectEqual(@as(usize, 2), view.hops.len);
+    try std.testing.expectEqual(@as(usize, 1), view.signatures.len);
+    try std.testing.expectEqualSlices(u8, &s_did, &view.hops[1]);
+    try std.testing.expectEqual(pop.expires_at.raw, view.expires_at.raw);
+    try std.testing.expectEqual(PathVerdict.valid, view.verify(r_did, s_did, &graph));
+
+    // Truncated input is rejected, never over-read
+    try std.testing.expectError(error.EndOfStream, ProofView.parse(bytes[0 .. bytes.len - 1]));
+    try std.testing.expectError(error.EndOfStream, ProofView.parse(bytes[0..10]));
+}
@@ -4,7 +4,10 @@
  * C ABI for L1 identity/trust layer. Enables Rust Membrane Agents
  * and other C-compatible languages to consume QVL functions.
  *
- * Thread Safety: Single-threaded only (initial version)
+ * Thread Safety: Context calls are serialized internally (one at a time).
+ *                Concurrent readers should query published snapshots
+ *                (qvl_snapshot_*), which never block the writer.
+ *                qvl_detect_betrayal_all fans out internally over worker threads.
  * Memory Management: Caller owns context via qvl_init/qvl_deinit
  */
 
@@ -28,6 +31,16 @@ extern "C" {
  */
 typedef struct QvlContext QvlContext;
 
+/**
+ * Opaque handle to an immutable, reference-counted state snapshot
+ */
+typedef struct QvlSnapshot QvlSnapshot;
+
+/**
+ * Opaque handle to a columnar GQL query result
+ */
+typedef struct QvlQueryResult QvlQueryResult;
+
 /* ========================================================================
  * ENUMS
  * ======================================================================== */
@@ -53,6 +66,41 @@ typedef enum {
     QVL_ANOMALY_BP_DIVERGENCE = 3   /**< Belief Propagation divergence */
 } QvlAnomalyReason;
 
+/**
+ * Value type of a query result column
+ */
+typedef enum {
+    QVL_COLUMN_U32 = 0,             /**< uint32_t values (node ids, degrees) */
+    QVL_COLUMN_F64 = 1              /**< double values (reputation, risk) */
+} QvlColumnKind;
+
+/**
+ * qvl_query error codes (negative return values)
+ */
+typedef enum {
+    QVL_QUERY_ERROR_ARGS = -1,        /**< NULL context/query/out pointer */
+    QVL_QUERY_ERROR_NO_MEMORY = -2,   /**< Allocation failed */
+    QVL_QUERY_ERROR_PARSE = -3,       /**< Query text does not parse */
+    QVL_QUERY_ERROR_UNSUPPORTED = -4, /**< Unknown label/property or unsupported clause */
+    QVL_QUERY_ERROR_TOO_LARGE = -5    /**< Result exceeds the row limit */
+} QvlQueryError;
+
+/**
+ * Instrumented entry points (index into QvlStats.stages)
+ */
+typedef enum {
+    QVL_STAGE_DETECT_BETRAYAL = 0,     /**< qvl_detect_betrayal */
+    QVL_STAGE_DETECT_BETRAYAL_ALL = 1, /**< qvl_detect_betrayal_all */
+    QVL_STAGE_VERIFY_POP = 2,          /**< qvl_verify_pop */
+    QVL_STAGE_VERIFY_POP_BATCH = 3,    /**< qvl_verify_pop_batch (whole batch) */
+    QVL_STAGE_QUERY = 4,               /**< qvl_query */
+    QVL_STAGE_ADD_EDGES = 5,           /**< qvl_add_trust_edge(s) */
+    QVL_STAGE_REVOKE_EDGE = 6,         /**< qvl_revoke_trust_edge */
+    QVL_STAGE_SNAPSHOT_PUBLISH = 7,    /**< qvl_snapshot_publish */
+    QVL_STAGE_CHECKPOINT = 8,          /**< qvl_checkpoint */
+    QVL_STAGE_COUNT = 9
+} QvlStage;
+
 /* ========================================================================
  * STRUCTS
  * ======================================================================== */
@@ -79,6 +127,63 @@ typedef struct {
     uint64_t expires_at_ns; /**< Expiration timestamp (ns) */
 } QvlRiskEdge;
 
+/**
+ * One serialized proof for batch verification
+ */
+typedef struct {
+    const uint8_t* proof_bytes; /**< Serialized proof data */
+    size_t proof_len;           /**< Length of proof bytes */
+    const uint8_t* sender_did;  /**< 32-byte sender DID */
+    const uint8_t* receiver_did;/**< 32-byte receiver DID */
+} QvlPopProof;
+
+/**
+ * Context allocation and storage options (zero-initialize for defaults)
+ *
+ * The last qvl_snapshot_release frees a snapshot on the calling thread, so
+ * alloc_fn/free_fn may run on any reader thread, also after qvl_deinit.
+ */
+typedef struct {
+    size_t scratch_bytes;   /**< > 0: per-query scratch arena, keeping up to this many bytes between calls */
+    void* (*alloc_fn)(void* user_data, size_t size, size_t alignment);              /**< NULL = C heap; must be thread-safe */
+    void (*free_fn)(void* user_data, void* ptr, size_t size, size_t alignment);     /**< Required with alloc_fn; must be thread-safe */
+    void* user_data;        /**< Passed to alloc_fn/free_fn; must stay valid until the context and its last snapshot are released */
+    const char* store_path; /**< NUL-terminated directory persisting the risk graph; NULL = memory only */
+} QvlOptions;
+
+/**
+ * One column of a query result (valid until the result is freed)
+ */
+typedef struct {
+    const char* name;       /**< Column name (RETURN alias or expression), not NUL-terminated */
+    size_t name_len;        /**< Length of name */
+    uint8_t kind;           /**< QvlColumnKind enum */
+    const void* values;     /**< Row-count values: uint32_t or double per kind */
+} QvlQueryColumn;
+
+/**
+ * Latency of one stage since qvl_init (excluding context lock waits;
+ * percentiles are histogram bucket bounds, within 2x)
+ */
+typedef struct {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+} QvlStageStats;
+
+/**
+ * Counters filled by qvl_get_stats
+ */
+typedef struct {
+    QvlStageStats stages[QVL_STAGE_COUNT]; /**< Indexed by QvlStage */
+    uint64_t allocations;     /**< Heap allocations made by the context */
+    uint64_t frees;           /**< Heap frees */
+    uint64_t bytes_allocated; /**< Cumulative bytes allocated */
+    uint64_t live_bytes;      /**< Bytes currently held */
+} QvlStats;
+
 /* ========================================================================
  * CONTEXT MANAGEMENT
  * ======================================================================== */
@@ -90,6 +195,25 @@ typedef struct {
  */
 QvlContext* qvl_init(void);
 
+/**
+ * Initialize QVL context with allocation options
+ *
+ * With scratch_bytes set, temporaries of each call (detection snapshots,
+ * sweep state, evidence buffers) come from an arena that is reset after
+ * the call, so steady-state queries do not touch the heap.
+ *
+ * With store_path set, every mutation is appended to an edge log in that
+ * directory and the graph is reloaded from the last checkpoint plus the
+ * log on the next init (see qvl_checkpoint). The context owns that
+ * directory until qvl_deinit: init fails while another context or a
+ * capsule node (in any process) has the same store open.
+ *
+ * @param options Options, or NULL for qvl_init defaults
+ * @return Opaque context handle, or NULL on allocation failure / invalid
+ *         options / unreadable store
+ */
+QvlContext* qvl_init_with_options(const QvlOptions* options);
+
 /**
  * Cleanup and free QVL context
  *
@@ -97,6 +221,18 @@ QvlContext* qvl_init(void);
  */
 void qvl_deinit(QvlContext* ctx);
 
+/**
+ * Copy per-stage latency and heap counters
+ *
+ * Lock-free and cheap: safe to poll from a metrics thread while other
+ * threads use the context.
+ *
+ * @param ctx QVL context
+ * @param out Receives the counters
+ * @return 0 on success, -1 on NULL arguments
+ */
+int qvl_get_stats(QvlContext* ctx, QvlStats* out);
+
 /* ========================================================================
  * TRUST SCORING
  * ======================================================================== */
@@ -131,6 +267,10 @@ double qvl_get_reputation(QvlContext* ctx, uint32_t node_id);
 /**
  * Verify a serialized Proof-of-Path
  *
+ * Verdicts are cached per (proof, endpoints) until the trust graph changes
+ * or an edge touching one of the endpoints is revoked; the proof is read in
+ * place without allocating.
+ *
  * @param ctx QVL context
  * @param proof_bytes Serialized proof data
  * @param proof_len Length of proof bytes
@@ -146,6 +286,133 @@ QvlPopVerdict qvl_verify_pop(
     const uint8_t* receiver_did
 );
 
+/**
+ * Verify N serialized Proof-of-Paths in one call (no per-proof allocation)
+ *
+ * @param ctx QVL context
+ * @param proofs Array of count proofs
+ * @param count Number of proofs
+ * @param out_verdicts Output array of count verdicts
+ * @return Number of valid proofs, or -1 on error
+ */
+int qvl_verify_pop_batch(
+    QvlContext* ctx,
+    const QvlPopProof* proofs,
+    size_t count,
+    QvlPopVerdict* out_verdicts
+);
+
+/* ========================================================================
+ * SNAPSHOTS (lock-free readers)
+ * ======================================================================== */
+
+/**
+ * Freeze current graph/reputation state and publish it to readers
+ *
+ * Readers holding older snapshots keep them until they release.
+ *
+ * @param ctx QVL context
+ * @return New snapshot version (> 0), or 0 on error
+ */
+uint64_t qvl_snapshot_publish(QvlContext* ctx);
+
+/**
+ * Take a reference to the latest published snapshot (lock-free)
+ *
+ * Hold one handle across a batch of queries for a consistent view.
+ *
+ * @param ctx QVL context
+ * @return Snapshot handle (release with qvl_snapshot_release), or NULL if none published
+ */
+QvlSnapshot* qvl_snapshot_acquire(QvlContext* ctx);
+
+/**
+ * Drop a snapshot reference (NULL-safe, may outlive qvl_deinit)
+ */
+void qvl_snapshot_release(QvlSnapshot* snap);
+
+/**
+ * Version of a snapshot (0 for NULL)
+ */
+uint64_t qvl_snapshot_version(const QvlSnapshot* snap);
+
+/**
+ * Reputation score as of the snapshot
+ *
+ * @return Reputation score 0.0-1.0, or -1.0 on error
+ */
+double qvl_snapshot_get_reputation(const QvlSnapshot* snap, uint32_t node_id);
+
+/**
+ * Verify a serialized Proof-of-Path against the snapshot's trust graph
+ *
+ * Same parameters and verdicts as qvl_verify_pop.
+ */
+QvlPopVerdict qvl_snapshot_verify_pop(
+    const QvlSnapshot* snap,
+    const uint8_t* proof_bytes,
+    size_t proof_len,
+    const uint8_t* sender_did,
+    const uint8_t* receiver_did
+);
+
+/**
+ * Betrayal detection from source node against the snapshot (not cached)
+ *
+ * @return Anomaly score (0.0 = clean, 0.9+ = critical)
+ */
+QvlAnomalyScore qvl_snapshot_detect_betrayal(const QvlSnapshot* snap, uint32_t source_node);
+
+/* ========================================================================
+ * GQL QUERIES
+ * ======================================================================== */
+
+/**
+ * Run a GQL query against a snapshot
+ *
+ * Supported: one MATCH path of (Identity) nodes and TRUST / BETRAYAL
+ * edges (optionally *min..max), WHERE comparisons joined by AND/OR, and
+ * RETURN of node variables or the properties id, out_degree, in_degree,
+ * reputation (nodes) and risk (edges). Plans are compiled once per query
+ * text and cached in the context.
+ *
+ * @param ctx QVL context (owns the plan cache)
+ * @param snap Snapshot to query, or NULL for the latest (published first if none exists)
+ * @param query GQL text
+ * @param query_len Length of query
+ * @param out_result Receives the result (free with qvl_query_result_free)
+ * @return Row count, or a QvlQueryError code (*out_result is NULL)
+ */
+int qvl_query(
+    QvlContext* ctx,
+    QvlSnapshot* snap,
+    const char* query,
+    size_t query_len,
+    QvlQueryResult** out_result
+);
+
+/**
+ * Column count of a query result (0 for NULL)
+ */
+size_t qvl_query_result_columns(const QvlQueryResult* res);
+
+/**
+ * Row count of a query result (0 for NULL)
+ */
+size_t qvl_query_result_rows(const QvlQueryResult* res);
+
+/**
+ * Describe column `index` of a query result
+ *
+ * @return 0 on success, -1 on NULL arguments or index out of range
+ */
+int qvl_query_result_column(const QvlQueryResult* res, size_t index, QvlQueryColumn* out);
+
+/**
+ * Free a query result (NULL-safe, may outlive qvl_deinit)
+ */
+void qvl_query_result_free(QvlQueryResult* res);
+
 /* ========================================================================
  * BETRAYAL DETECTION
  * ======================================================================== */
@@ -153,12 +420,35 @@ QvlPopVerdict qvl_verify_pop(
 /**
  * Run Bellman-Ford betrayal detection from source node
  *
+ * The source becomes "watched": its result is cached in the context and
+ * updated incrementally by qvl_add_trust_edge(s)/qvl_revoke_trust_edge,
+ * so repeated detection after small mutations does not rerun from scratch.
+ *
  * @param ctx QVL context
  * @param source_node Starting node for detection
  * @return Anomaly score (0.0 = clean, 0.9+ = critical)
  */
 QvlAnomalyScore qvl_detect_betrayal(QvlContext* ctx, uint32_t source_node);
 
+/**
+ * Run betrayal detection from every registered node in parallel
+ *
+ * Freezes the graph once and splits sources across worker threads.
+ * Rings found from several sources are reported once.
+ *
+ * @param ctx QVL context
+ * @param threads Worker threads (0 = one per CPU)
+ * @param out_scores Output array (one entry per node on a ring, sorted by node), may be NULL
+ * @param max_scores Capacity of out_scores
+ * @return Total number of flagged nodes (may exceed max_scores), or < 0 on error
+ */
+int qvl_detect_betrayal_all(
+    QvlContext* ctx,
+    uint32_t threads,
+    QvlAnomalyScore* out_scores,
+    size_t max_scores
+);
+
 /* ========================================================================
  * GRAPH MUTATIONS
  * ======================================================================== */
@@ -168,20 +458,67 @@ QvlAnomalyScore qvl_detect_betrayal(QvlContext* ctx, uint32_t source_node);
  *
  * @param ctx QVL context
  * @param edge Edge to add
- * @return 0 on success, non-zero on error
+ * @return 0 on success, QVL_EDGE_INVALID_RISK if the risk is NaN or outside
+ *         [-1.0, 1.0], other non-zero values on error
  */
 int qvl_add_trust_edge(QvlContext* ctx, const QvlRiskEdge* edge);
 
 /**
- * Revoke trust edge
+ * Per-edge status codes for qvl_add_trust_edges
+ */
+#define QVL_EDGE_OK            0   /**< Edge inserted */
+#define QVL_EDGE_NO_MEMORY    -2   /**< Batch failed; edge not inserted */
+#define QVL_EDGE_INVALID_RISK -3   /**< Risk NaN or outside [-1.0, 1.0] */
+
+/**
+ * Add a batch of trust edges to risk graph
+ *
+ * Reserves storage once and updates adjacency per source node rather than
+ * per edge. Prefer this over repeated qvl_add_trust_edge when replaying a
+ * peer's edge set.
+ *
+ * @param ctx QVL context
+ * @param edges Array of edges to add
+ * @param count Number of edges in array
+ * @param out_status Optional array of count status codes (QVL_EDGE_*), may be
+ *        NULL; filled on failure too
+ * @return Number of edges inserted (saturating at INT_MAX), or < 0 on error
+ *         (nothing inserted)
+ */
+int qvl_add_trust_edges(
+    QvlContext* ctx,
+    const QvlRiskEdge* edges,
+    size_t count,
+    int* out_status
+);
+
+/**
+ * Revoke trust edge (constant time; the oldest matching edge is removed)
+ *
+ * The edge is removed from both the risk graph and the trust graph that
+ * Proof-of-Path verification walks, and every cached PoP verdict is
+ * dropped.
  *
  * @param ctx QVL context
  * @param from Source node ID
  * @param to Target node ID
- * @return 0 on success, -2 if not found
+ * @return 0 on success, -2 if in neither graph, -3 if the edge log write failed
  */
 int qvl_revoke_trust_edge(QvlContext* ctx, uint32_t from, uint32_t to);
 
+/**
+ * Write the risk graph to a new checkpoint and truncate the edge log
+ *
+ * The checkpoint is a CSR file. On the next init the risk graph is rebuilt
+ * from its columns (one bulk insert) and only the log written since is
+ * replayed. While nothing has been mutated since the checkpoint, published
+ * snapshots map the file directly instead of building their own CSR.
+ *
+ * @param ctx QVL context opened with QvlOptions.store_path
+ * @return 0 on success, -1 without a store, -2 on I/O error
+ */
+int qvl_checkpoint(QvlContext* ctx);
+
 #ifdef __cplusplus
 }
 #endif
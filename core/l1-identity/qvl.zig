@@ -3,24 +3,34 @@
 //! RFC-0120 Extension: Betrayal Detection, Pathfinding, Gossip, and Inference
 //!
 //! This module extends the CompactTrustGraph with:
+//! - Frozen CSR snapshots for cache-friendly traversal
+//! - RCU state snapshots for lock-free concurrent readers
+//! - Proof-of-Path verdict caching
 //! - Bellman-Ford negative-cycle detection (betrayal rings)
 //! - A* reputation-guided pathfinding
 //! - Aleph-style probabilistic gossip
 //! - Loopy Belief Propagation for edge inference
+//! - Latency histograms and allocation counters for hot paths
 
 pub const types = @import("qvl/types.zig");
+pub const csr = @import("qvl/csr.zig");
 pub const betrayal = @import("qvl/betrayal.zig");
+pub const detection_cache = @import("qvl/detection_cache.zig");
+pub const pop_cache = @import("qvl/pop_cache.zig");
 pub const pathfinding = @import("qvl/pathfinding.zig");
 pub const gossip = @import("qvl/gossip.zig");
 pub const inference = @import("qvl/inference.zig");
 pub const pop = @import("qvl/pop_integration.zig");
 pub const storage = @import("qvl/storage.zig");
+pub const snapshot = @import("qvl/snapshot.zig");
 pub const integration = @import("qvl/integration.zig");
 pub const gql = @import("qvl/gql.zig");
+pub const metrics = @import("qvl/metrics.zig");
 
 pub const RiskEdge = types.RiskEdge;
 pub const NodeId = types.NodeId;
 pub const AnomalyScore = types.AnomalyScore;
+pub const CsrGraph = csr.CsrGraph;
 pub const PersistentGraph = storage.PersistentGraph;
 pub const HybridGraph = integration.HybridGraph;
 pub const GraphTransaction = integration.GraphTransaction;
@@ -29,6 +39,7 @@ pub const GraphTransaction = integration.GraphTransaction;
 pub const GQLQuery = gql.Query;
 pub const GQLStatement = gql.Statement;
 pub const parseGQL = gql.parse;
+pub const compileGQL = gql.compile;
 
 test {
     @import("std").testing.refAllDecls(@This());
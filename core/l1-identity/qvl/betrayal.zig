@@ -6,15 +6,27 @@
 //! - Cartel behavior (coordinated false vouches)
 //!
 //! Complexity: O(|V| × |E|) with early exit optimization.
+//!
+//! Two engines share one result type:
+//! - `detectBetrayal`: reference edge-list Bellman-Ford over hash maps.
+//! - `detectBetrayalFast`: queue-based (SPFA) relaxation over a frozen CSR
+//!   snapshot with Tarjan subtree disassembly for early cycle detection.
+//!   Same worst case, but only rescans edges out of nodes whose distance
+//!   changed, so typical graphs finish in near-linear time.
 
 const std = @import("std");
+const builtin = @import("builtin");
 const time = @import("time");
 const types = @import("types.zig");
+const csr_mod = @import("csr.zig");
 
 const NodeId = types.NodeId;
 const RiskGraph = types.RiskGraph;
 const RiskEdge = types.RiskEdge;
 const AnomalyScore = types.AnomalyScore;
+const CsrGraph = csr_mod.CsrGraph;
+const DenseId = csr_mod.DenseId;
+const no_node = csr_mod.no_node;
 
 /// Result of Bellman-Ford betrayal detection.
 pub const BellmanFordResult = struct {
@@ -130,7 +142,8 @@ pub fn detectBetrayal(
     for (0..n - 1) |_| {
         var improved = false;
 
-        for (graph.edges.items) |edge| {
+        for (graph.edges.items, 0..) |edge, edge_idx| {
+            if (!graph.isLive(edge_idx)) continue;
             const d_from = dist.get(edge.from) orelse continue;
             if (d_from == std.math.inf(f64)) continue;
 
@@ -152,7 +165,8 @@ pub fn detectBetrayal(
     var in_cycle = std.AutoHashMapUnmanaged(NodeId, bool){};
     defer in_cycle.deinit(allocator);
 
-    for (graph.edges.items) |edge| {
+    for (graph.edges.items, 0..) |edge, edge_idx| {
+        if (!graph.isLive(edge_idx)) continue;
         const d_from = dist.get(edge.from) orelse continue;
         if (d_from == std.math.inf(f64)) continue;
 
@@ -180,6 +194,579 @@ pub fn detectBetrayal(
     };
 }
 
+/// Run betrayal detection with the queue-based engine.
+///
+/// Freezes `graph` into a CSR snapshot and runs `SpfaEngine` from `source`.
+/// Result layout matches `detectBetrayal`: every registered node has a
+/// distance/predecessor entry (inf/null when unreachable), reachable
+/// unregistered endpoints are added, and cycles are reported in
+/// predecessor order. Rings are reported once each (disjoint).
+pub fn detectBetrayalFast(
+    graph: *const RiskGraph,
+    source: NodeId,
+    allocator: std.mem.Allocator,
+) !BellmanFordResult {
+    return detectBetrayalWith(graph, source, allocator, allocator);
+}
+
+/// `detectBetrayalFast` with the snapshot and engine arrays taken from
+/// `scratch` (e.g. an arena reset between queries); only the returned
+/// result lives in `allocator`.
+pub fn detectBetrayalWith(
+    graph: *const RiskGraph,
+    source: NodeId,
+    allocator: std.mem.Allocator,
+    scratch: std.mem.Allocator,
+) !BellmanFordResult {
+    if (graph.nodeCount() == 0) {
+        return BellmanFordResult{
+            .allocator = allocator,
+            .distances = .{},
+            .predecessors = .{},
+            .betrayal_cycles = .{},
+        };
+    }
+
+    var snapshot = try CsrGraph.fromRiskGraph(graph, scratch);
+    defer snapshot.deinit();
+
+    var engine = try SpfaEngine.init(scratch, snapshot.nodeCount());
+    defer engine.deinit();
+
+    if (snapshot.denseIndex(source)) |src| {
+        try engine.run(&snapshot, src);
+    } else {
+        engine.reset();
+    }
+
+    return engine.toResult(&snapshot, source, graph.nodes.items, allocator);
+}
+
+/// Queue-based betrayal detection against an existing CSR snapshot.
+/// Every snapshot node gets a distance/predecessor entry.
+pub fn detectBetrayalCsr(
+    snapshot: *const CsrGraph,
+    source: NodeId,
+    allocator: std.mem.Allocator,
+) !BellmanFordResult {
+    return runOnSnapshot(snapshot, source, null, allocator);
+}
+
+fn runOnSnapshot(
+    snapshot: *const CsrGraph,
+    source: NodeId,
+    registered: ?[]const NodeId,
+    allocator: std.mem.Allocator,
+) !BellmanFordResult {
+    var engine = try SpfaEngine.init(allocator, snapshot.nodeCount());
+    defer engine.deinit();
+
+    if (snapshot.denseIndex(source)) |src| {
+        try engine.run(snapshot, src);
+    } else {
+        engine.reset();
+    }
+
+    return engine.toResult(snapshot, source, registered, allocator);
+}
+
+/// Dense-array single-source shortest paths with negative-cycle detection.
+///
+/// Queue-based relaxation (SPFA / Goldberg-Radzik family): only nodes whose
+/// distance improved are rescanned. The shortest-path tree is kept as a
+/// preorder thread with depths; when `v` improves via `u`, the subtree of `v`
+/// is walked and detached (Tarjan subtree disassembly). Meeting `u` in that
+/// subtree means edge u->v closes a negative cycle, which is recorded and
+/// excluded so the search can continue to find disjoint rings.
+/// Since each tree edge is tight, any such cycle is provably negative.
+///
+/// Scratch arrays are sized once; `run` may be called repeatedly.
+pub const SpfaEngine = struct {
+    allocator: std.mem.Allocator,
+    /// Distance from source per dense node
+    dist: []f64,
+    /// Predecessor in the shortest-path tree (no_node for root/unreached)
+    parent: []DenseId,
+    /// Depth in the shortest-path tree (valid while state == .in_tree)
+    depth: []u32,
+    /// Preorder thread over in-tree nodes
+    thread_next: []DenseId,
+    thread_prev: []DenseId,
+    state: []NodeState,
+    queued: std.DynamicBitSetUnmanaged,
+    /// FIFO ring (each node queued at most once, so capacity n suffices)
+    queue: []DenseId,
+    queue_head: usize,
+    queue_len: usize,
+    /// Nodes removed by the last subtree disassembly
+    detached: []DenseId,
+    detached_len: usize,
+    /// Detected cycles (dense ids, predecessor order)
+    cycles: std.ArrayListUnmanaged([]DenseId),
+
+    pub const NodeState = enum(u8) {
+        unreached,
+        in_tree,
+        /// Removed from the tree by subtree disassembly; distance still valid
+        detached,
+        /// Member of a recorded negative cycle; ignored from then on
+        poisoned,
+    };
+
+    pub fn init(allocator: std.mem.Allocator, n: usize) !SpfaEngine {
+        const dist = try allocator.alloc(f64, n);
+        errdefer allocator.free(dist);
+        const parent = try allocator.alloc(DenseId, n);
+        errdefer allocator.free(parent);
+        const depth = try allocator.alloc(u32, n);
+        errdefer allocator.free(depth);
+        const thread_next = try allocator.alloc(DenseId, n);
+        errdefer allocator.free(thread_next);
+        const thread_prev = try allocator.alloc(DenseId, n);
+        errdefer allocator.free(thread_prev);
+        const state = try allocator.alloc(NodeState, n);
+        errdefer allocator.free(state);
+        var queued = try std.DynamicBitSetUnmanaged.initEmpty(allocator, n);
+        errdefer queued.deinit(allocator);
+        const queue = try allocator.alloc(DenseId, n);
+        errdefer allocator.free(queue);
+        const detached = try allocator.alloc(DenseId, n);
+
+        return .{
+            .allocator = allocator,
+            .dist = dist,
+            .parent = parent,
+            .depth = depth,
+            .thread_next = thread_next,
+            .thread_prev = thread_prev,
+            .state = state,
+            .queued = queued,
+            .queue = queue,
+            .queue_head = 0,
+            .queue_len = 0,
+            .detached = detached,
+            .detached_len = 0,
+            .cycles = .{},
+        };
+    }
+
+    pub fn deinit(self: *SpfaEngine) void {
+        self.clearCycles();
+        self.cycles.deinit(self.allocator);
+        self.allocator.free(self.dist);
+        self.allocator.free(self.parent);
+        self.allocator.free(self.depth);
+        self.allocator.free(self.thread_next);
+        self.allocator.free(self.thread_prev);
+        self.allocator.free(self.state);
+        self.queued.deinit(self.allocator);
+        self.allocator.free(self.queue);
+        self.allocator.free(self.detached);
+    }
+
+    pub fn reset(self: *SpfaEngine) void {
+        @memset(self.dist, std.math.inf(f64));
+        @memset(self.parent, no_node);
+        @memset(self.state, .unreached);
+        self.queued.unsetAll();
+        self.queue_head = 0;
+        self.queue_len = 0;
+        self.detached_len = 0;
+        self.clearCycles();
+    }
+
+    fn clearCycles(self: *SpfaEngine) void {
+        for (self.cycles.items) |cycle| self.allocator.free(cycle);
+        self.cycles.clearRetainingCapacity();
+    }
+
+    /// Solve from dense source `src`. Results stay in the engine arrays.
+    pub fn run(self: *SpfaEngine, snapshot: *const CsrGraph, src: DenseId) !void {
+        std.debug.assert(snapshot.nodeCount() == self.dist.len);
+        self.reset();
+
+        self.dist[src] = 0.0;
+        self.makeRoot(src);
+        self.push(src);
+
+        while (self.pop()) |u| {
+            // Poisoned nodes get one final scan with their frozen distance so
+            // everything downstream of a ring is still explored (and rings
+            // hanging off it can still be found).
+            const frozen = self.state[u] == .poisoned;
+            if (!frozen and self.state[u] != .in_tree) continue;
+
+            const row = snapshot.outEdges(u);
+            for (row.start..row.end) |slot| {
+                // u is poisoned mid-scan when one of its edges closes a cycle;
+                // the frozen rescan picks up the remaining edges.
+                if (!frozen and self.state[u] != .in_tree) break;
+
+                const v = snapshot.targets[slot];
+                if (self.state[v] == .poisoned) continue;
+
+                const new_dist = self.dist[u] + snapshot.risk[slot];
+                if (!(new_dist < self.dist[v])) continue;
+
+                var closes_cycle = (u == v);
+                if (self.state[v] == .in_tree) {
+                    closes_cycle = self.detachSubtree(v, u) or closes_cycle;
+                }
+
+                self.dist[v] = new_dist;
+                self.parent[v] = u;
+                if (closes_cycle) {
+                    try self.recordCycle(u, v);
+                    continue;
+                }
+
+                if (frozen) self.makeRoot(v) else self.attach(v, u);
+                if (!self.queued.isSet(v)) self.push(v);
+            }
+        }
+    }
+
+    fn push(self: *SpfaEngine, v: DenseId) void {
+        const tail = (self.queue_head + self.queue_len) % self.queue.len;
+        self.queue[tail] = v;
+        self.queue_len += 1;
+        self.queued.set(v);
+    }
+
+    fn pop(self: *SpfaEngine) ?DenseId {
+        if (self.queue_len == 0) return null;
+        const v = self.queue[self.queue_head];
+        self.queue_head = (self.queue_head + 1) % self.queue.len;
+        self.queue_len -= 1;
+        self.queued.unset(v);
+        return v;
+    }
+
+    /// Detach `v` and its whole subtree from the preorder thread.
+    /// Detached nodes are remembered in `detached` until the next call.
+    /// Returns true if `probe` was found inside the subtree (negative cycle).
+    fn detachSubtree(self: *SpfaEngine, v: DenseId, probe: DenseId) bool {
+        const d = self.depth[v];
+        var found = false;
+        self.detached[0] = v;
+        self.detached_len = 1;
+
+        var x = self.thread_next[v];
+        while (x != no_node and self.depth[x] > d) : (x = self.thread_next[x]) {
+            if (x == probe) found = true;
+            self.state[x] = .detached;
+            self.detached[self.detached_len] = x;
+            self.detached_len += 1;
+        }
+
+        const before = self.thread_prev[v];
+        if (before != no_node) self.thread_next[before] = x;
+        if (x != no_node) self.thread_prev[x] = before;
+        self.state[v] = .detached;
+        return found;
+    }
+
+    /// Insert `v` (a singleton) as first child of `u` in the preorder thread.
+    fn attach(self: *SpfaEngine, v: DenseId, u: DenseId) void {
+        const after = self.thread_next[u];
+        self.depth[v] = self.depth[u] + 1;
+        self.thread_prev[v] = u;
+        self.thread_next[v] = after;
+        if (after != no_node) self.thread_prev[after] = v;
+        self.thread_next[u] = v;
+        self.state[v] = .in_tree;
+    }
+
+    /// Make `v` a singleton tree of its own (the forest stays tight:
+    /// every tree edge satisfies dist[child] == dist[parent] + risk).
+    fn makeRoot(self: *SpfaEngine, v: DenseId) void {
+        self.depth[v] = 0;
+        self.thread_prev[v] = no_node;
+        self.thread_next[v] = no_node;
+        self.state[v] = .in_tree;
+    }
+
+    /// Collect tree path u -> ... -> v (predecessor order) and poison it.
+    /// Survivors of the disassembly keep their (valid) distances and are
+    /// re-rooted so their out-edges are not lost with the ring.
+    fn recordCycle(self: *SpfaEngine, u: DenseId, v: DenseId) !void {
+        var len: usize = 1;
+        var x = u;
+        while (x != v) : (len += 1) x = self.parent[x];
+
+        const cycle = try self.allocator.alloc(DenseId, len);
+        errdefer self.allocator.free(cycle);
+        try self.cycles.ensureUnusedCapacity(self.allocator, 1);
+
+        x = u;
+        for (cycle) |*slot| {
+            slot.* = x;
+            self.state[x] = .poisoned;
+            if (!self.queued.isSet(x)) self.push(x);
+            x = self.parent[x];
+        }
+        self.cycles.appendAssumeCapacity(cycle);
+
+        for (self.detached[0..self.detached_len]) |d| {
+            if (self.state[d] != .detached) continue;
+            self.makeRoot(d);
+            if (!self.queued.isSet(d)) self.push(d);
+        }
+    }
+
+    /// Materialize the engine state as a `BellmanFordResult`.
+    /// `registered` lists nodes that always get an entry (all snapshot nodes if null).
+    pub fn toResult(
+        self: *const SpfaEngine,
+        snapshot: *const CsrGraph,
+        source: NodeId,
+        registered: ?[]const NodeId,
+        allocator: std.mem.Allocator,
+    ) !BellmanFordResult {
+        var result = BellmanFordResult{
+            .allocator = allocator,
+            .distances = .{},
+            .predecessors = .{},
+            .betrayal_cycles = .{},
+        };
+        errdefer result.deinit();
+
+        const base = registered orelse snapshot.node_ids;
+        try result.distances.ensureTotalCapacity(allocator, @intCast(snapshot.nodeCount() + 1));
+        try result.predecessors.ensureTotalCapacity(allocator, @intCast(snapshot.nodeCount()));
+
+        for (base) |node| {
+            result.distances.putAssumeCapacity(node, std.math.inf(f64));
+            result.predecessors.putAssumeCapacity(node, null);
+        }
+        result.distances.putAssumeCapacity(source, 0.0);
+
+        for (self.state, 0..) |st, i| {
+            if (st == .unreached) continue;
+            const node = snapshot.nodeId(@intCast(i));
+            result.distances.putAssumeCapacity(node, self.dist[i]);
+            const p = self.parent[i];
+            result.predecessors.putAssumeCapacity(node, if (p == no_node) null else snapshot.nodeId(p));
+        }
+
+        try result.betrayal_cycles.ensureTotalCapacity(allocator, self.cycles.items.len);
+        for (self.cycles.items) |dense_cycle| {
+            const cycle = try allocator.alloc(NodeId, dense_cycle.len);
+            for (dense_cycle, cycle) |d, *out| out.* = snapshot.nodeId(d);
+            result.betrayal_cycles.appendAssumeCapacity(cycle);
+        }
+
+        return result;
+    }
+};
+
+/// Options for the all-sources sweep.
+pub const SweepOptions = struct {
+    /// Worker threads (0 = one per logical CPU)
+    threads: usize = 0,
+};
+
+/// Result of an all-sources betrayal sweep.
+pub const SweepResult = struct {
+    allocator: std.mem.Allocator,
+    /// Unique betrayal rings (predecessor order, canonical rotation)
+    cycles: [][]NodeId,
+    /// One entry per node on any ring, sorted by node
+    anomalies: []AnomalyScore,
+    /// Number of sources that were scanned
+    sources_scanned: usize,
+
+    pub fn deinit(self: *SweepResult) void {
+        for (self.cycles) |cycle| self.allocator.free(cycle);
+        self.allocator.free(self.cycles);
+        self.allocator.free(self.anomalies);
+    }
+};
+
+/// Run betrayal detection from every registered node in parallel.
+///
+/// The graph is frozen once into a CSR snapshot that all workers share
+/// read-only; each worker owns an `SpfaEngine` and pulls sources from an
+/// atomic cursor. Rings found from several sources are deduplicated.
+/// `allocator` must be thread-safe.
+///
+/// Helpers are spawned per call and joined before returning, like the BP
+/// engine's. A sweep is one SPFA run per source, so thread start-up is noise
+/// next to it, and no idle threads are pinned to each context between runs.
+/// The calling thread always works, and `threads = 1` spawns nothing.
+pub fn detectAll(
+    graph: *const RiskGraph,
+    allocator: std.mem.Allocator,
+    options: SweepOptions,
+) !SweepResult {
+    var snapshot = try CsrGraph.fromRiskGraph(graph, allocator);
+    defer snapshot.deinit();
+
+    // Registered nodes, deduplicated, as dense sources
+    var seen = try std.DynamicBitSetUnmanaged.initEmpty(allocator, snapshot.nodeCount());
+    defer seen.deinit(allocator);
+    var sources = std.ArrayListUnmanaged(DenseId){};
+    defer sources.deinit(allocator);
+    for (graph.nodes.items) |node| {
+        const d = snapshot.denseIndex(node).?;
+        if (seen.isSet(d)) continue;
+        seen.set(d);
+        try sources.append(allocator, d);
+    }
+
+    return detectAllCsr(&snapshot, sources.items, allocator, options);
+}
+
+/// All-sources sweep against an existing snapshot.
+pub fn detectAllCsr(
+    snapshot: *const CsrGraph,
+    sources: []const DenseId,
+    allocator: std.mem.Allocator,
+    options: SweepOptions,
+) !SweepResult {
+    var sweep = Sweep{
+        .snapshot = snapshot,
+        .sources = sources,
+        .allocator = allocator,
+        .cursor = std.atomic.Value(usize).init(0),
+    };
+
+    const wanted = if (options.threads != 0) options.threads else std.Thread.getCpuCount() catch 1;
+    const n_workers: usize = if (builtin.single_threaded) 1 else @max(1, @min(wanted, sources.len));
+
+    const outputs = try allocator.alloc(SweepWorker, n_workers);
+    defer allocator.free(outputs);
+    for (outputs) |*out| out.* = .{ .cycles = .{} };
+    defer {
+        for (outputs) |*out| {
+            for (out.cycles.items) |cycle| allocator.free(cycle);
+            out.cycles.deinit(allocator);
+        }
+    }
+
+    const threads = try allocator.alloc(std.Thread, n_workers - 1);
+    defer allocator.free(threads);
+
+    // The calling thread is worker 0; spawn failures just mean fewer helpers
+    var spawned: usize = 0;
+    for (threads, outputs[1..]) |*thread, *out| {
+        thread.* = std.Thread.spawn(.{}, Sweep.work, .{ &sweep, out }) catch break;
+        spawned += 1;
+    }
+    sweep.work(&outputs[0]);
+    for (threads[0..spawned]) |thread| thread.join();
+
+    for (outputs) |out| {
+        if (out.err) |err| return err;
+    }
+
+    return sweep.merge(outputs);
+}
+
+const SweepWorker = struct {
+    /// Canonicalized rings (dense ids), possibly duplicated across workers
+    cycles: std.ArrayListUnmanaged([]DenseId),
+    err: ?std.mem.Allocator.Error = null,
+};
+
+const Sweep = struct {
+    snapshot: *const CsrGraph,
+    sources: []const DenseId,
+    allocator: std.mem.Allocator,
+    cursor: std.atomic.Value(usize),
+
+    fn work(self: *Sweep, out: *SweepWorker) void {
+        self.workInner(out) catch |err| {
+            out.err = err;
+        };
+    }
+
+    fn workInner(self: *Sweep, out: *SweepWorker) !void {
+        var engine = try SpfaEngine.init(self.allocator, self.snapshot.nodeCount());
+        defer engine.deinit();
+
+        while (true) {
+            const i = self.cursor.fetchAdd(1, .monotonic);
+            if (i >= self.sources.len) break;
+
+            try engine.run(self.snapshot, self.sources[i]);
+
+            // Take ownership of the engine's rings instead of copying
+            try out.cycles.ensureUnusedCapacity(self.allocator, engine.cycles.items.len);
+            for (engine.cycles.items) |cycle| {
+                const min_idx = std.mem.indexOfMin(DenseId, cycle);
+                std.mem.rotate(DenseId, cycle, min_idx);
+                out.cycles.appendAssumeCapacity(cycle);
+            }
+            engine.cycles.clearRetainingCapacity();
+        }
+    }
+
+    fn merge(self: *const Sweep, outputs: []const SweepWorker) !SweepResult {
+        const allocator = self.allocator;
+
+        var unique = std.HashMapUnmanaged([]const DenseId, void, CycleContext, std.hash_map.default_max_load_percentage){};
+        defer unique.deinit(allocator);
+        var flagged = try std.DynamicBitSetUnmanaged.initEmpty(allocator, self.snapshot.nodeCount());
+        defer flagged.deinit(allocator);
+
+        var cycles = std.ArrayListUnmanaged([]NodeId){};
+        errdefer {
+            for (cycles.items) |cycle| allocator.free(cycle);
+            cycles.deinit(allocator);
+        }
+
+        for (outputs) |out| {
+            for (out.cycles.items) |dense_cycle| {
+                const entry = try unique.getOrPut(allocator, dense_cycle);
+                if (entry.found_existing) continue;
+
+                const cycle = try allocator.alloc(NodeId, dense_cycle.len);
+                errdefer allocator.free(cycle);
+                for (dense_cycle, cycle) |d, *node| {
+                    node.* = self.snapshot.nodeId(d);
+                    flagged.set(d);
+                }
+                try cycles.append(allocator, cycle);
+            }
+        }
+
+        const anomalies = try allocator.alloc(AnomalyScore, flagged.count());
+        errdefer allocator.free(anomalies);
+        var it = flagged.iterator(.{});
+        var i: usize = 0;
+        while (it.next()) |d| : (i += 1) {
+            anomalies[i] = .{
+                .node = self.snapshot.nodeId(@intCast(d)),
+                .score = 1.0, // Any negative cycle is critical (see computeAnomalyScore)
+                .reason = .negative_cycle,
+            };
+        }
+        std.mem.sort(AnomalyScore, anomalies, {}, struct {
+            fn lessThan(_: void, a: AnomalyScore, b: AnomalyScore) bool {
+                return a.node < b.node;
+            }
+        }.lessThan);
+
+        return SweepResult{
+            .allocator = allocator,
+            .cycles = try cycles.toOwnedSlice(allocator),
+            .anomalies = anomalies,
+            .sources_scanned = self.sources.len,
+        };
+    }
+};
+
+const CycleContext = struct {
+    pub fn hash(_: CycleContext, key: []const DenseId) u64 {
+        return std.hash.Wyhash.hash(0, std.mem.sliceAsBytes(key));
+    }
+
+    pub fn eql(_: CycleContext, a: []const DenseId, b: []const DenseId) bool {
+        return std.mem.eql(DenseId, a, b);
+    }
+};
+
 /// Trace a cycle starting from a node in a negative cycle.
 fn traceCycle(
     start: NodeId,
@@ -270,3 +857,143 @@ test "Bellman-Ford: Detect negative cycle (betrayal ring)" {
     try std.testing.expect(evidence.len > 0);
     try std.testing.expectEqual(evidence[0], 0x01); // Version
 }
+
+fn ringEdge(from: NodeId, to: NodeId, risk: f64) RiskEdge {
+    const ts = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+    return .{ .from = from, .to = to, .risk = risk, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts };
+}
+
+test "Bellman-Ford (SPFA): distances match reference engine" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    var prng = std.Random.DefaultPrng.init(0x5EED);
+    const rand = prng.random();
+
+    const n: NodeId = 64;
+    for (0..n) |i| try graph.addNode(@intCast(i));
+    for (0..512) |_| {
+        const from = rand.intRangeLessThan(NodeId, 0, n);
+        const to = rand.intRangeLessThan(NodeId, 0, n);
+        // Non-negative weights: no cycles, unique shortest distances
+        try graph.addEdge(ringEdge(from, to, rand.float(f64)));
+    }
+
+    var reference = try detectBetrayal(&graph, 0, allocator);
+    defer reference.deinit();
+    var fast = try detectBetrayalFast(&graph, 0, allocator);
+    defer fast.deinit();
+
+    try std.testing.expectEqual(@as(usize, 0), fast.betrayal_cycles.items.len);
+    try std.testing.expectEqual(reference.distances.count(), fast.distances.count());
+
+    var it = reference.distances.iterator();
+    while (it.next()) |entry| {
+        const got = fast.distances.get(entry.key_ptr.*).?;
+        if (std.math.isInf(entry.value_ptr.*)) {
+            try std.testing.expect(std.math.isInf(got));
+        } else {
+            try std.testing.expectApproxEqAbs(entry.value_ptr.*, got, 1e-9);
+        }
+    }
+}
+
+test "Bellman-Ford (SPFA): detects ring, self-loop and disjoint rings" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    for (0..8) |i| try graph.addNode(@intCast(i));
+
+    // Ring 1: 0 -> 1 -> 2 -> 0 (total -0.4), same as reference test
+    try graph.addEdge(ringEdge(0, 1, 0.2));
+    try graph.addEdge(ringEdge(1, 2, 0.2));
+    try graph.addEdge(ringEdge(2, 0, -0.8));
+    // Ring 2 (reachable via 1 -> 4): 4 -> 5 -> 4 (total -0.1)
+    try graph.addEdge(ringEdge(1, 4, 0.3));
+    try graph.addEdge(ringEdge(4, 5, 0.4));
+    try graph.addEdge(ringEdge(5, 4, -0.5));
+    // Self-loop betrayal on 6 (reachable via 2 -> 6)
+    try graph.addEdge(ringEdge(2, 6, 0.1));
+    try graph.addEdge(ringEdge(6, 6, -0.1));
+
+    var result = try detectBetrayalFast(&graph, 0, allocator);
+    defer result.deinit();
+
+    try std.testing.expectEqual(@as(usize, 3), result.betrayal_cycles.items.len);
+    try std.testing.expectEqual(@as(f64, 1.0), result.computeAnomalyScore());
+
+    var lens = [_]usize{ 0, 0, 0, 0 };
+    for (result.betrayal_cycles.items) |cycle| lens[cycle.len] += 1;
+    try std.testing.expectEqual(@as(usize, 1), lens[1]);
+    try std.testing.expectEqual(@as(usize, 1), lens[2]);
+    try std.testing.expectEqual(@as(usize, 1), lens[3]);
+
+    const compromised = try result.getCompromisedNodes(allocator);
+    defer allocator.free(compromised);
+    try std.testing.expectEqual(@as(usize, 6), compromised.len);
+
+    const evidence = try result.generateEvidence(&graph, allocator);
+    defer allocator.free(evidence);
+    try std.testing.expectEqual(evidence[0], 0x01);
+}
+
+test "Bellman-Ford (SPFA): unknown source and empty graph" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    var empty = try detectBetrayalFast(&graph, 0, allocator);
+    defer empty.deinit();
+    try std.testing.expectEqual(@as(u32, 0), empty.distances.count());
+
+    try graph.addNode(1);
+    try graph.addEdge(ringEdge(1, 2, 0.5));
+
+    var result = try detectBetrayalFast(&graph, 99, allocator);
+    defer result.deinit();
+    try std.testing.expectEqual(@as(usize, 0), result.betrayal_cycles.items.len);
+    try std.testing.expectEqual(@as(f64, 0.0), result.distances.get(99).?);
+    try std.testing.expect(std.math.isInf(result.distances.get(1).?));
+}
+
+test "Bellman-Ford: all-sources sweep deduplicates rings" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    for (0..10) |i| try graph.addNode(@intCast(i));
+
+    // Ring A: 1 -> 2 -> 3 -> 1, entered from 0
+    try graph.addEdge(ringEdge(0, 1, 0.1));
+    try graph.addEdge(ringEdge(1, 2, 0.2));
+    try graph.addEdge(ringEdge(2, 3, 0.2));
+    try graph.addEdge(ringEdge(3, 1, -0.9));
+    // Ring B: 6 -> 7 -> 6, entered from 5; unreachable from ring A
+    try graph.addEdge(ringEdge(5, 6, 0.3));
+    try graph.addEdge(ringEdge(6, 7, 0.1));
+    try graph.addEdge(ringEdge(7, 6, -0.4));
+    // Clean tail
+    try graph.addEdge(ringEdge(8, 9, 0.5));
+
+    for ([_]usize{ 1, 4 }) |threads| {
+        var result = try detectAll(&graph, allocator, .{ .threads = threads });
+        defer result.deinit();
+
+        try std.testing.expectEqual(@as(usize, 10), result.sources_scanned);
+        try std.testing.expectEqual(@as(usize, 2), result.cycles.len);
+        try std.testing.expectEqual(@as(usize, 5), result.anomalies.len);
+
+        const expected = [_]NodeId{ 1, 2, 3, 6, 7 };
+        for (result.anomalies, expected) |score, node| {
+            try std.testing.expectEqual(node, score.node);
+            try std.testing.expect(score.isCritical());
+            try std.testing.expectEqual(AnomalyScore.Reason.negative_cycle, score.reason);
+        }
+        // Dense ids follow registration order here, so rotation starts at the min node
+        for (result.cycles) |cycle| {
+            try std.testing.expectEqual(std.mem.min(NodeId, cycle), cycle[0]);
+        }
+    }
+}
@@ -0,0 +1,301 @@
+//! RFC-0120 Extension: Frozen CSR Snapshot of RiskGraph
+//!
+//! Immutable compressed-sparse-row view for the graph algorithms.
+//! `RiskGraph` is optimized for mutation (hash-map adjacency into an
+//! array of 60+ byte `RiskEdge`s); this layout is optimized for traversal:
+//! - Node ids remapped to a dense `0..n` range
+//! - Out-edges stored as contiguous `targets`/`risk` columns per row
+//! - Reverse (incoming) index for pull-style algorithms (BP)
+//!
+//! Build once per graph version, share read-only across queries/threads.
+//! Complexity: O(|V| + |E|) to build (counting sort, stable in edge order).
+
+const std = @import("std");
+const time = @import("time");
+const types = @import("types.zig");
+
+const NodeId = types.NodeId;
+const RiskGraph = types.RiskGraph;
+const RiskEdge = types.RiskEdge;
+
+/// Dense node index into a CsrGraph (0..nodeCount())
+pub const DenseId = u32;
+
+/// Sentinel for "no node" in dense index arrays
+pub const no_node: DenseId = std.math.maxInt(DenseId);
+
+pub const CsrGraph = struct {
+    allocator: std.mem.Allocator,
+    /// Dense index -> original NodeId
+    node_ids: []NodeId,
+    /// Original NodeId -> dense index
+    dense: std.AutoHashMapUnmanaged(NodeId, DenseId),
+    /// Row offsets into the edge columns (len = nodeCount() + 1)
+    offsets: []u32,
+    /// Edge column: dense source (lets edge-list passes avoid a row search)
+    sources: []DenseId,
+    /// Edge column: dense target
+    targets: []DenseId,
+    /// Edge column: risk weight
+    risk: []f64,
+    /// Edge column: index of the edge in `RiskGraph.edges` at build time
+    /// (tombstoned edges are skipped, so indices may have gaps)
+    edge_index: []u32,
+    /// Incoming row offsets (len = nodeCount() + 1)
+    in_offsets: []u32,
+    /// Edge slots (into the columns above) grouped by target
+    in_edges: []u32,
+    /// Checkpoint file mapping the columns point into (storage.zig);
+    /// null when they are heap-allocated
+    mapping: ?[]align(std.heap.page_size_min) u8 = null,
+
+    pub const Range = struct {
+        start: u32,
+        end: u32,
+
+        pub fn len(self: Range) usize {
+            return self.end - self.start;
+        }
+    };
+
+    /// Freeze a RiskGraph into CSR form.
+    /// Every node in `graph.nodes` and every edge endpoint gets a dense id
+    /// (duplicates in `graph.nodes` collapse). Dense ids follow first
+    /// appearance, edges within a row keep `graph.edges` order.
+    pub fn fromRiskGraph(graph: *const RiskGraph, allocator: std.mem.Allocator) !CsrGraph {
+        const m = graph.edgeCount();
+        if (graph.edges.items.len > std.math.maxInt(u32)) return error.GraphTooLarge;
+
+        var dense = std.AutoHashMapUnmanaged(NodeId, DenseId){};
+        errdefer dense.deinit(allocator);
+        var ids = std.ArrayListUnmanaged(NodeId){};
+        errdefer ids.deinit(allocator);
+
+        try dense.ensureTotalCapacity(allocator, @intCast(graph.nodeCount()));
+        for (graph.nodes.items) |node| {
+            _ = try internNode(&dense, &ids, node, allocator);
+        }
+
+        const sources = try allocator.alloc(DenseId, m);
+        errdefer allocator.free(sources);
+        const targets = try allocator.alloc(DenseId, m);
+        errdefer allocator.free(targets);
+        const risk = try allocator.alloc(f64, m);
+        errdefer allocator.free(risk);
+        const edge_index = try allocator.alloc(u32, m);
+        errdefer allocator.free(edge_index);
+
+        // Resolve endpoints once so the scatter passes below never re-hash;
+        // tombstoned edges are dropped here (`live` maps back to edge index)
+        const from_d = try allocator.alloc(DenseId, m);
+        defer allocator.free(from_d);
+        const to_d = try allocator.alloc(DenseId, m);
+        defer allocator.free(to_d);
+        const live = try allocator.alloc(u32, m);
+        defer allocator.free(live);
+        var k: usize = 0;
+        for (graph.edges.items, 0..) |edge, i| {
+            if (!graph.isLive(i)) continue;
+            from_d[k] = try internNode(&dense, &ids, edge.from, allocator);
+            to_d[k] = try internNode(&dense, &ids, edge.to, allocator);
+            live[k] = @intCast(i);
+            k += 1;
+        }
+
+        const n = ids.items.len;
+        const offsets = try allocator.alloc(u32, n + 1);
+        errdefer allocator.free(offsets);
+        const in_offsets = try allocator.alloc(u32, n + 1);
+        errdefer allocator.free(in_offsets);
+        const in_edges = try allocator.alloc(u32, m);
+        errdefer allocator.free(in_edges);
+
+        countingOffsets(offsets, from_d);
+        countingOffsets(in_offsets, to_d);
+
+        const cursor = try allocator.alloc(u32, n);
+        defer allocator.free(cursor);
+
+        // Scatter out-edges into rows (stable in edge order)
+        @memcpy(cursor, offsets[0..n]);
+        for (live, 0..) |edge_idx, i| {
+            const slot = cursor[from_d[i]];
+            cursor[from_d[i]] += 1;
+            sources[slot] = from_d[i];
+            targets[slot] = to_d[i];
+            risk[slot] = graph.edges.items[edge_idx].risk;
+            edge_index[slot] = edge_idx;
+        }
+
+        // Scatter slot ids into incoming rows
+        @memcpy(cursor, in_offsets[0..n]);
+        for (targets, 0..) |t, slot| {
+            in_edges[cursor[t]] = @intCast(slot);
+            cursor[t] += 1;
+        }
+
+        return CsrGraph{
+            .allocator = allocator,
+            .node_ids = try ids.toOwnedSlice(allocator),
+            .dense = dense,
+            .offsets = offsets,
+            .sources = sources,
+            .targets = targets,
+            .risk = risk,
+            .edge_index = edge_index,
+            .in_offsets = in_offsets,
+            .in_edges = in_edges,
+        };
+    }
+
+    pub fn deinit(self: *CsrGraph) void {
+        self.dense.deinit(self.allocator);
+        if (self.mapping) |map| {
+            std.posix.munmap(map);
+            return;
+        }
+        self.allocator.free(self.node_ids);
+        self.allocator.free(self.offsets);
+        self.allocator.free(self.sources);
+        self.allocator.free(self.targets);
+        self.allocator.free(self.risk);
+        self.allocator.free(self.edge_index);
+        self.allocator.free(self.in_offsets);
+        self.allocator.free(self.in_edges);
+    }
+
+    pub fn nodeCount(self: *const CsrGraph) usize {
+        return self.node_ids.len;
+    }
+
+    pub fn edgeCount(self: *const CsrGraph) usize {
+        return self.targets.len;
+    }
+
+    /// Dense index for an original NodeId (null if not in snapshot)
+    pub fn denseIndex(self: *const CsrGraph, node: NodeId) ?DenseId {
+        return self.dense.get(node);
+    }
+
+    /// Original NodeId for a dense index
+    pub fn nodeId(self: *const CsrGraph, idx: DenseId) NodeId {
+        return self.node_ids[idx];
+    }
+
+    /// Slot range of out-edges of `u` in `targets`/`risk`
+    pub fn outEdges(self: *const CsrGraph, u: DenseId) Range {
+        return .{ .start = self.offsets[u], .end = self.offsets[u + 1] };
+    }
+
+    /// Range into `in_edges` of the edge slots pointing at `v`
+    pub fn inEdges(self: *const CsrGraph, v: DenseId) Range {
+        return .{ .start = self.in_offsets[v], .end = self.in_offsets[v + 1] };
+    }
+
+    pub fn outDegree(self: *const CsrGraph, u: DenseId) usize {
+        return self.offsets[u + 1] - self.offsets[u];
+    }
+};
+
+fn internNode(
+    dense: *std.AutoHashMapUnmanaged(NodeId, DenseId),
+    ids: *std.ArrayListUnmanaged(NodeId),
+    node: NodeId,
+    allocator: std.mem.Allocator,
+) !DenseId {
+    const entry = try dense.getOrPut(allocator, node);
+    if (!entry.found_existing) {
+        errdefer dense.removeByPtr(entry.key_ptr);
+        entry.value_ptr.* = @intCast(ids.items.len);
+        try ids.append(allocator, node);
+    }
+    return entry.value_ptr.*;
+}
+
+/// Exclusive prefix sum of per-row counts (offsets.len = rows + 1)
+fn countingOffsets(offsets: []u32, rows: []const DenseId) void {
+    @memset(offsets, 0);
+    for (rows) |r| offsets[r + 1] += 1;
+    for (1..offsets.len) |i| offsets[i] += offsets[i - 1];
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+fn testEdge(from: NodeId, to: NodeId, risk: f64) RiskEdge {
+    const ts = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+    return .{ .from = from, .to = to, .risk = risk, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts };
+}
+
+test "CSR: rows, columns and reverse index" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    // Sparse ids, one duplicate registration, one endpoint never registered
+    try graph.addNode(100);
+    try graph.addNode(7);
+    try graph.addNode(100);
+    try graph.addEdge(testEdge(7, 100, 0.5));
+    try graph.addEdge(testEdge(100, 7, -0.2));
+    try graph.addEdge(testEdge(7, 42, 0.1));
+
+    var csr = try CsrGraph.fromRiskGraph(&graph, allocator);
+    defer csr.deinit();
+
+    try std.testing.expectEqual(@as(usize, 3), csr.nodeCount());
+    try std.testing.expectEqual(@as(usize, 3), csr.edgeCount());
+    try std.testing.expectEqual(@as(NodeId, 100), csr.nodeId(0));
+    try std.testing.expectEqual(@as(NodeId, 7), csr.nodeId(1));
+    try std.testing.expectEqual(@as(NodeId, 42), csr.nodeId(2));
+
+    const seven = csr.denseIndex(7).?;
+    const r = csr.outEdges(seven);
+    try std.testing.expectEqual(@as(usize, 2), r.len());
+    // Row keeps edge insertion order
+    try std.testing.expectEqual(csr.denseIndex(100).?, csr.targets[r.start]);
+    try std.testing.expectEqual(csr.denseIndex(42).?, csr.targets[r.start + 1]);
+    try std.testing.expectEqual(@as(u32, 2), csr.edge_index[r.start + 1]);
+    try std.testing.expectEqual(seven, csr.sources[r.start]);
+
+    const in_r = csr.inEdges(seven);
+    try std.testing.expectEqual(@as(usize, 1), in_r.len());
+    try std.testing.expectApproxEqAbs(@as(f64, -0.2), csr.risk[csr.in_edges[in_r.start]], 1e-12);
+
+    try std.testing.expect(csr.denseIndex(999) == null);
+}
+
+test "CSR: tombstoned edges are skipped" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    try graph.addEdge(testEdge(0, 1, 0.5));
+    try graph.addEdge(testEdge(0, 2, 0.2));
+    try graph.addEdge(testEdge(1, 2, 0.3));
+    _ = graph.removeEdge(0, 1).?;
+
+    var csr = try CsrGraph.fromRiskGraph(&graph, allocator);
+    defer csr.deinit();
+
+    try std.testing.expectEqual(@as(usize, 2), csr.edgeCount());
+    const r = csr.outEdges(csr.denseIndex(0).?);
+    try std.testing.expectEqual(@as(usize, 1), r.len());
+    try std.testing.expectEqual(csr.denseIndex(2).?, csr.targets[r.start]);
+    try std.testing.expectEqual(@as(u32, 1), csr.edge_index[r.start]);
+    try std.testing.expectEqual(@as(usize, 0), csr.inEdges(csr.denseIndex(1).?).len());
+}
+
+test "CSR: empty graph" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    var csr = try CsrGraph.fromRiskGraph(&graph, allocator);
+    defer csr.deinit();
+
+    try std.testing.expectEqual(@as(usize, 0), csr.nodeCount());
+    try std.testing.expectEqual(@as(usize, 0), csr.edgeCount());
+    try std.testing.expectEqual(@as(usize, 1), csr.offsets.len);
+}
@@ -0,0 +1,324 @@
+//! RFC-0120 Extension: Incremental Betrayal Detection
+//!
+//! Caches the last `BellmanFordResult` per watched source and keeps it
+//! current across graph mutations instead of rerunning detection from scratch:
+//! - Edge insert that satisfies the triangle inequality: nothing to do
+//!   (cached distances are still a feasible potential => no new cycle).
+//! - Edge insert that improves a distance: local decrease-only propagation
+//!   from the edge target. Reaching the edge source again proves a new
+//!   negative cycle; the entry then falls back to full recomputation.
+//! - Edge removal off the shortest-path tree: nothing to do.
+//! - Edge removal on the tree, or any change near a known ring: invalidate.
+//!
+//! Invalidated entries are recomputed lazily on the next `get`.
+
+const std = @import("std");
+const time = @import("time");
+const types = @import("types.zig");
+const betrayal = @import("betrayal.zig");
+
+const NodeId = types.NodeId;
+const RiskGraph = types.RiskGraph;
+const RiskEdge = types.RiskEdge;
+const BellmanFordResult = betrayal.BellmanFordResult;
+
+pub const DetectionCache = struct {
+    allocator: std.mem.Allocator,
+    entries: std.AutoHashMapUnmanaged(NodeId, Entry),
+    /// Maximum number of watched sources (least recently used is evicted)
+    max_sources: usize,
+    /// Logical clock for LRU
+    tick: u64,
+    stats: Stats,
+    /// Temporaries of recomputation/repair (null = `allocator`).
+    /// Cached results always live in `allocator`.
+    scratch: ?std.mem.Allocator = null,
+
+    pub const default_max_sources: usize = 64;
+
+    pub const Entry = struct {
+        /// Null once invalidated; recomputed on next `get`
+        result: ?BellmanFordResult,
+        last_used: u64,
+    };
+
+    pub const Stats = struct {
+        /// `get` served from a valid entry
+        hits: u64 = 0,
+        /// Full detection runs
+        recomputes: u64 = 0,
+        /// Inserts repaired by local propagation
+        incremental_updates: u64 = 0,
+        /// Entries dropped by a mutation
+        invalidations: u64 = 0,
+    };
+
+    pub fn init(allocator: std.mem.Allocator, max_sources: usize) DetectionCache {
+        return .{
+            .allocator = allocator,
+            .entries = .{},
+            .max_sources = @max(max_sources, 1),
+            .tick = 0,
+            .stats = .{},
+        };
+    }
+
+    pub fn deinit(self: *DetectionCache) void {
+        self.clear();
+        self.entries.deinit(self.allocator);
+    }
+
+    /// Drop every cached result (e.g. after a bulk graph rebuild).
+    pub fn clear(self: *DetectionCache) void {
+        var it = self.entries.valueIterator();
+        while (it.next()) |entry| {
+            if (entry.result) |*r| r.deinit();
+        }
+        self.entries.clearRetainingCapacity();
+    }
+
+    /// Current detection result for `source`, recomputing only if needed.
+    /// The pointer is valid until the next mutation notification or `get`.
+    pub fn get(self: *DetectionCache, graph: *const RiskGraph, source: NodeId) !*const BellmanFordResult {
+        self.tick += 1;
+
+        if (self.entries.getPtr(source)) |entry| {
+            entry.last_used = self.tick;
+            if (entry.result) |*r| {
+                self.stats.hits += 1;
+                return r;
+            }
+        } else {
+            if (self.entries.count() >= self.max_sources) self.evictLru();
+            try self.entries.put(self.allocator, source, .{ .result = null, .last_used = self.tick });
+        }
+
+        const entry = self.entries.getPtr(source).?;
+        entry.result = try betrayal.detectBetrayalWith(graph, source, self.allocator, self.scratch orelse self.allocator);
+        self.stats.recomputes += 1;
+        return &entry.result.?;
+    }
+
+    /// Notify that `edge` has been added to `graph` (already inserted).
+    pub fn onEdgeAdded(self: *DetectionCache, graph: *const RiskGraph, edge: RiskEdge) void {
+        var it = self.entries.valueIterator();
+        while (it.next()) |entry| {
+            const result = if (entry.result) |*r| r else continue;
+            const outcome = applyInsert(result, graph, edge, self.allocator, self.scratch orelse self.allocator) catch .invalidated;
+            switch (outcome) {
+                .unchanged => {},
+                .updated => self.stats.incremental_updates += 1,
+                .invalidated => self.invalidate(entry),
+            }
+        }
+    }
+
+    /// Notify that `edge` has been removed from the graph.
+    pub fn onEdgeRemoved(self: *DetectionCache, edge: RiskEdge) void {
+        var it = self.entries.valueIterator();
+        while (it.next()) |entry| {
+            const result = if (entry.result) |*r| r else continue;
+            if (removalAffects(result, edge)) self.invalidate(entry);
+        }
+    }
+
+    fn invalidate(self: *DetectionCache, entry: *Entry) void {
+        if (entry.result) |*r| r.deinit();
+        entry.result = null;
+        self.stats.invalidations += 1;
+    }
+
+    fn evictLru(self: *DetectionCache) void {
+        var oldest: ?NodeId = null;
+        var oldest_tick: u64 = std.math.maxInt(u64);
+        var it = self.entries.iterator();
+        while (it.next()) |kv| {
+            if (kv.value_ptr.last_used < oldest_tick) {
+                oldest_tick = kv.value_ptr.last_used;
+                oldest = kv.key_ptr.*;
+            }
+        }
+        if (oldest) |key| {
+            if (self.entries.fetchRemove(key)) |kv| {
+                var removed = kv.value;
+                if (removed.result) |*r| r.deinit();
+            }
+        }
+    }
+};
+
+const InsertOutcome = enum { unchanged, updated, invalidated };
+
+/// Repair `result` in place after `edge` was inserted into `graph`.
+fn applyInsert(
+    result: *BellmanFordResult,
+    graph: *const RiskGraph,
+    edge: RiskEdge,
+    allocator: std.mem.Allocator,
+    scratch: std.mem.Allocator,
+) !InsertOutcome {
+    const d_from = result.distances.get(edge.from) orelse return .unchanged;
+    if (d_from == std.math.inf(f64)) return .unchanged;
+
+    // Distances around a known ring are not meaningful; recompute
+    if (result.betrayal_cycles.items.len > 0) return .invalidated;
+
+    const first = d_from + edge.risk;
+    if (!(first < (result.distances.get(edge.to) orelse std.math.inf(f64)))) return .unchanged;
+    if (edge.to == edge.from) return .invalidated; // negative self-loop
+
+    var queue = std.ArrayListUnmanaged(NodeId){};
+    defer queue.deinit(scratch);
+
+    try result.distances.put(allocator, edge.to, first);
+    try result.predecessors.put(allocator, edge.to, edge.from);
+    try queue.append(scratch, edge.to);
+
+    // Converged graphs need at most |E| relaxations here; more means the
+    // batch formed a cycle not through `edge.from`. Let the full run report it.
+    var budget = graph.edgeCount() + 1;
+    var head: usize = 0;
+    while (head < queue.items.len) : (head += 1) {
+        const x = queue.items[head];
+        const d_x = result.distances.get(x).?;
+
+        for (graph.neighbors(x)) |edge_idx| {
+            const e = graph.edges.items[edge_idx];
+            const new_dist = d_x + e.risk;
+            if (!(new_dist < (result.distances.get(e.to) orelse std.math.inf(f64)))) continue;
+
+            if (e.to == edge.from) return .invalidated; // new negative cycle through `edge`
+            if (budget == 0) return .invalidated;
+            budget -= 1;
+
+            try result.distances.put(allocator, e.to, new_dist);
+            try result.predecessors.put(allocator, e.to, x);
+            try queue.append(scratch, e.to);
+        }
+    }
+
+    return .updated;
+}
+
+/// Whether removing `edge` can change `result`.
+fn removalAffects(result: *const BellmanFordResult, edge: RiskEdge) bool {
+    const d_from = result.distances.get(edge.from) orelse return false;
+    if (d_from == std.math.inf(f64)) return false; // unreachable source side
+
+    if (result.betrayal_cycles.items.len > 0) return true;
+
+    // Off-tree edges never carry a shortest path
+    const pred = result.predecessors.get(edge.to) orelse return false;
+    return pred != null and pred.? == edge.from;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+fn testEdge(from: NodeId, to: NodeId, risk: f64) RiskEdge {
+    const ts = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+    return .{ .from = from, .to = to, .risk = risk, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts };
+}
+
+fn expectSameDistances(a: *const BellmanFordResult, b: *const BellmanFordResult) !void {
+    try std.testing.expectEqual(a.distances.count(), b.distances.count());
+    var it = a.distances.iterator();
+    while (it.next()) |kv| {
+        const other = b.distances.get(kv.key_ptr.*).?;
+        if (std.math.isInf(kv.value_ptr.*)) {
+            try std.testing.expect(std.math.isInf(other));
+        } else {
+            try std.testing.expectApproxEqAbs(kv.value_ptr.*, other, 1e-9);
+        }
+    }
+}
+
+test "DetectionCache: reuses result and repairs inserts locally" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    for (0..5) |i| try graph.addNode(@intCast(i));
+    try graph.addEdge(testEdge(0, 1, 0.5));
+    try graph.addEdge(testEdge(1, 2, 0.5));
+    try graph.addEdge(testEdge(2, 3, 0.5));
+
+    var cache = DetectionCache.init(allocator, 4);
+    defer cache.deinit();
+
+    _ = try cache.get(&graph, 0);
+    _ = try cache.get(&graph, 0);
+    try std.testing.expectEqual(@as(u64, 1), cache.stats.recomputes);
+    try std.testing.expectEqual(@as(u64, 1), cache.stats.hits);
+
+    // Non-improving edge: untouched
+    const slow = testEdge(0, 3, 2.0);
+    try graph.addEdge(slow);
+    cache.onEdgeAdded(&graph, slow);
+    try std.testing.expectEqual(@as(u64, 0), cache.stats.incremental_updates);
+
+    // Improving shortcut: repaired in place, matches a fresh run
+    const shortcut = testEdge(0, 2, 0.1);
+    try graph.addEdge(shortcut);
+    cache.onEdgeAdded(&graph, shortcut);
+    try std.testing.expectEqual(@as(u64, 1), cache.stats.incremental_updates);
+
+    const cached = try cache.get(&graph, 0);
+    try std.testing.expectEqual(@as(u64, 1), cache.stats.recomputes);
+    var fresh = try betrayal.detectBetrayalFast(&graph, 0, allocator);
+    defer fresh.deinit();
+    try expectSameDistances(cached, &fresh);
+    try std.testing.expectEqual(@as(NodeId, 2), cached.predecessors.get(3).?.?);
+
+    // Off-tree removal keeps the entry, tree-edge removal drops it
+    cache.onEdgeRemoved(slow);
+    try std.testing.expectEqual(@as(u64, 0), cache.stats.invalidations);
+    cache.onEdgeRemoved(shortcut);
+    try std.testing.expectEqual(@as(u64, 1), cache.stats.invalidations);
+}
+
+test "DetectionCache: insert closing a negative cycle falls back to full run" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    for (0..3) |i| try graph.addNode(@intCast(i));
+    try graph.addEdge(testEdge(0, 1, 0.2));
+    try graph.addEdge(testEdge(1, 2, 0.2));
+
+    var cache = DetectionCache.init(allocator, 4);
+    defer cache.deinit();
+
+    const clean = try cache.get(&graph, 0);
+    try std.testing.expectEqual(@as(usize, 0), clean.betrayal_cycles.items.len);
+
+    const betrayal_edge = testEdge(2, 0, -0.8);
+    try graph.addEdge(betrayal_edge);
+    cache.onEdgeAdded(&graph, betrayal_edge);
+    try std.testing.expectEqual(@as(u64, 1), cache.stats.invalidations);
+
+    const ring = try cache.get(&graph, 0);
+    try std.testing.expectEqual(@as(usize, 1), ring.betrayal_cycles.items.len);
+    try std.testing.expectEqual(@as(u64, 2), cache.stats.recomputes);
+}
+
+test "DetectionCache: evicts least recently used source" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    for (0..3) |i| try graph.addNode(@intCast(i));
+
+    var cache = DetectionCache.init(allocator, 2);
+    defer cache.deinit();
+
+    _ = try cache.get(&graph, 0);
+    _ = try cache.get(&graph, 1);
+    _ = try cache.get(&graph, 0);
+    _ = try cache.get(&graph, 2); // evicts 1
+
+    try std.testing.expectEqual(@as(u32, 2), cache.entries.count());
+    try std.testing.expect(cache.entries.get(1) == null);
+    try std.testing.expect(cache.entries.get(0) != null);
+}
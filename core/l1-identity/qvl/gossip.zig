@@ -8,6 +8,12 @@
 //!
 //! Design: Each gossip message references k random prior messages,
 //! creating a DAG structure resilient to packet loss.
+//!
+//! Memory and bandwidth stay bounded on large meshes:
+//! - Dedup uses a rotating, time-bucketed Bloom filter (fixed size; ids
+//!   age out after `dedup_buckets * dedup_bucket_span`)
+//! - Coverage is kept incrementally in sliding-window bucket counters
+//! - `FanOut` coalesces messages per neighbor into one datagram payload
 
 const std = @import("std");
 const types = @import("types.zig");
@@ -37,6 +43,32 @@ pub const GossipMessage = struct {
         heartbeat = 3, // Liveness check
     };
 
+    /// Encoded size on the wire
+    pub fn wireSize(self: *const GossipMessage) usize {
+        return WIRE_FIXED + self.refs.len * 8 + self.payload.len;
+    }
+
+    /// Append the wire encoding to `out` (out.len >= wireSize())
+    /// Layout: id u64 | sender u32 | type u8 | stamp u64 | ref count u8 |
+    /// refs u64* | payload len u16 | payload (big-endian)
+    pub fn encodeInto(self: *const GossipMessage, out: []u8) usize {
+        std.debug.assert(self.refs.len <= std.math.maxInt(u8) and self.payload.len <= std.math.maxInt(u16));
+        std.mem.writeInt(u64, out[0..8], self.id, .big);
+        std.mem.writeInt(u32, out[8..12], self.sender, .big);
+        out[12] = @intFromEnum(self.msg_type);
+        std.mem.writeInt(u64, out[13..21], self.entropy_stamp, .big);
+        out[21] = @intCast(self.refs.len);
+        var offset: usize = 22;
+        for (self.refs) |ref| {
+            std.mem.writeInt(u64, out[offset..][0..8], ref, .big);
+            offset += 8;
+        }
+        std.mem.writeInt(u16, out[offset..][0..2], @intCast(self.payload.len), .big);
+        offset += 2;
+        @memcpy(out[offset..][0..self.payload.len], self.payload);
+        return offset + self.payload.len;
+    }
+
     /// Compute message ID from content.
     pub fn computeId(sender: NodeId, entropy_stamp: u64, payload: []const u8) u64 {
         var hasher = std.hash.Wyhash.init(0);
@@ -47,15 +79,229 @@ pub const GossipMessage = struct {
     }
 };
 
+/// Fixed part of an encoded message (everything but refs and payload)
+const WIRE_FIXED = 8 + 4 + 1 + 8 + 1 + 2;
+
+/// Messages in one batch payload. Decoded messages alias `data`; refs
+/// stay encoded (see `Decoded.refAt`).
+pub const BatchIterator = struct {
+    data: []const u8,
+    offset: usize = 0,
+
+    pub const Decoded = struct {
+        id: u64,
+        sender: NodeId,
+        msg_type: GossipMessage.MessageType,
+        entropy_stamp: u64,
+        /// Encoded refs (8 bytes each, big-endian)
+        refs_bytes: []const u8,
+        payload: []const u8,
+
+        pub fn refCount(self: *const Decoded) usize {
+            return self.refs_bytes.len / 8;
+        }
+
+        pub fn refAt(self: *const Decoded, i: usize) u64 {
+            return std.mem.readInt(u64, self.refs_bytes[i * 8 ..][0..8], .big);
+        }
+    };
+
+    /// Next message; error.Malformed on a truncated or invalid entry
+    pub fn next(it: *BatchIterator) !?Decoded {
+        const rest = it.data[it.offset..];
+        if (rest.len == 0) return null;
+        if (rest.len < WIRE_FIXED) return error.Malformed;
+
+        const msg_type = std.meta.intToEnum(GossipMessage.MessageType, rest[12]) catch return error.Malformed;
+        const refs_len = @as(usize, rest[21]) * 8;
+        if (rest.len < WIRE_FIXED + refs_len) return error.Malformed;
+        const payload_len = std.mem.readInt(u16, rest[22 + refs_len ..][0..2], .big);
+        const total = WIRE_FIXED + refs_len + payload_len;
+        if (rest.len < total) return error.Malformed;
+
+        it.offset += total;
+        return .{
+            .id = std.mem.readInt(u64, rest[0..8], .big),
+            .sender = std.mem.readInt(u32, rest[8..12], .big),
+            .msg_type = msg_type,
+            .entropy_stamp = std.mem.readInt(u64, rest[13..21], .big),
+            .refs_bytes = rest[22..][0..refs_len],
+            .payload = rest[24 + refs_len ..][0..payload_len],
+        };
+    }
+};
+
+/// Rotating Bloom filter over time buckets.
+/// Inserts go to the newest generation; lookups check all of them. When
+/// time moves past a bucket boundary the oldest generation is cleared and
+/// reused, so memory is fixed and ids are forgotten after roughly
+/// `generations * bucket_span`.
+pub const DedupFilter = struct {
+    /// Bloom hash functions per id
+    const hashes = 4;
+
+    allocator: std.mem.Allocator,
+    /// generations * words_per_gen words
+    bits: []u64,
+    words_per_gen: usize,
+    generations: usize,
+    bucket_span: u64,
+    /// Bucket number of the newest generation
+    epoch: u64,
+
+    /// `bits_per_gen` is rounded up to a power of two
+    pub fn init(allocator: std.mem.Allocator, generations: usize, bits_per_gen: usize, bucket_span: u64) !DedupFilter {
+        std.debug.assert(generations > 0 and bucket_span > 0);
+        const words = std.math.ceilPowerOfTwo(usize, @max(bits_per_gen, 64) / 64) catch unreachable;
+        const bits = try allocator.alloc(u64, generations * words);
+        @memset(bits, 0);
+        return .{
+            .allocator = allocator,
+            .bits = bits,
+            .words_per_gen = words,
+            .generations = generations,
+            .bucket_span = bucket_span,
+            .epoch = 0,
+        };
+    }
+
+    pub fn deinit(self: *DedupFilter) void {
+        self.allocator.free(self.bits);
+    }
+
+    fn generation(self: *DedupFilter, epoch: u64) []u64 {
+        const g: usize = @intCast(epoch % self.generations);
+        return self.bits[g * self.words_per_gen ..][0..self.words_per_gen];
+    }
+
+    /// Move the newest generation to the bucket of `now`, clearing expired ones
+    pub fn advance(self: *DedupFilter, now: u64) void {
+        const target = now / self.bucket_span;
+        if (target <= self.epoch) return;
+        const steps = @min(target - self.epoch, self.generations);
+        for (0..steps) |i| @memset(self.generation(target - i), 0);
+        self.epoch = target;
+    }
+
+    fn probe(self: *const DedupFilter, id: u64, i: u64) usize {
+        // Double hashing; id is already a hash
+        const h2 = (std.hash.int(id) | 1);
+        return @intCast((id +% i *% h2) & (self.words_per_gen * 64 - 1));
+    }
+
+    /// True if `id` was (probably) inserted within the retention span
+    pub fn contains(self: *DedupFilter, id: u64) bool {
+        for (0..self.generations) |g| {
+            const words = self.bits[g * self.words_per_gen ..][0..self.words_per_gen];
+            var all = true;
+            for (0..hashes) |i| {
+                const bit = self.probe(id, i);
+                if (words[bit / 64] & (@as(u64, 1) << @intCast(bit % 64)) == 0) {
+                    all = false;
+                    break;
+                }
+            }
+            if (all) return true;
+        }
+        return false;
+    }
+
+    pub fn insert(self: *DedupFilter, id: u64) void {
+        const words = self.generation(self.epoch);
+        for (0..hashes) |i| {
+            const bit = self.probe(id, i);
+            words[bit / 64] |= @as(u64, 1) << @intCast(bit % 64);
+        }
+    }
+
+    /// Insert `id`; false if it was already present
+    pub fn testAndSet(self: *DedupFilter, id: u64) bool {
+        if (self.contains(id)) return false;
+        self.insert(id);
+        return true;
+    }
+};
+
+/// Nodes heard from within a sliding window, in bucket counters.
+/// Each node counts in the bucket of its latest stamp; buckets leaving the
+/// window are subtracted from `active`, so a coverage query is O(1)
+/// amortized instead of a scan over every node ever heard.
+pub const CoverageWindow = struct {
+    const buckets = 16;
+
+    /// node -> latest stamp
+    last_heard: std.AutoHashMapUnmanaged(NodeId, u64),
+    counts: [buckets]usize,
+    bucket_span: u64,
+    /// Newest bucket number seen
+    epoch: u64,
+    active: usize,
+
+    pub fn init(window: u64) CoverageWindow {
+        return .{
+            .last_heard = .{},
+            .counts = [_]usize{0} ** buckets,
+            .bucket_span = @max(window / buckets, 1),
+            .epoch = 0,
+            .active = 0,
+        };
+    }
+
+    pub fn deinit(self: *CoverageWindow, allocator: std.mem.Allocator) void {
+        self.last_heard.deinit(allocator);
+    }
+
+    fn live(self: *const CoverageWindow, bucket: u64) bool {
+        return bucket <= self.epoch and self.epoch - bucket < buckets;
+    }
+
+    /// Slide the window to `now`
+    pub fn advance(self: *CoverageWindow, now: u64) void {
+        const target = now / self.bucket_span;
+        if (target <= self.epoch) return;
+        const steps = @min(target - self.epoch, buckets);
+        for (0..steps) |i| {
+            // Slots reused by the new buckets held the oldest ones
+            const slot: usize = @intCast((target - i) % buckets);
+            self.active -= self.counts[slot];
+            self.counts[slot] = 0;
+        }
+        self.epoch = target;
+    }
+
+    /// Record that `node` was heard at `stamp`
+    pub fn note(self: *CoverageWindow, allocator: std.mem.Allocator, node: NodeId, stamp: u64) !void {
+        self.advance(stamp);
+        const entry = try self.last_heard.getOrPut(allocator, node);
+        if (entry.found_existing) {
+            if (stamp <= entry.value_ptr.*) return;
+            const old = entry.value_ptr.* / self.bucket_span;
+            if (self.live(old)) {
+                self.counts[@intCast(old % buckets)] -= 1;
+                self.active -= 1;
+            }
+        }
+        entry.value_ptr.* = stamp;
+
+        const bucket = stamp / self.bucket_span;
+        if (self.live(bucket)) {
+            self.counts[@intCast(bucket % buckets)] += 1;
+            self.active += 1;
+        }
+    }
+};
+
 /// Gossip state tracker for a node.
 pub const GossipState = struct {
     allocator: std.mem.Allocator,
-    /// Recent message IDs (for reference sampling)
+    /// Recent message IDs (for reference sampling), a ring of max_recent
     recent_messages: std.ArrayListUnmanaged(u64),
+    /// Next ring slot to overwrite once recent_messages is full
+    recent_head: usize,
     /// Seen message IDs (for deduplication)
-    seen_messages: std.AutoHashMapUnmanaged(u64, void),
+    seen: DedupFilter,
     /// Coverage tracking: which nodes have we heard from recently
-    heard_from: std.AutoHashMapUnmanaged(NodeId, u64), // node -> last_entropy_stamp
+    coverage: CoverageWindow,
     /// Configuration
     config: Config,
 
@@ -68,46 +314,78 @@ pub const GossipState = struct {
         forward_prob: f64 = 0.7,
         /// Coverage window (entropy stamp delta)
         coverage_window: u64 = 60_000_000_000, // 60 seconds in nanoseconds
+        /// Dedup filter generations and the stamp span each one covers
+        dedup_buckets: usize = 4,
+        dedup_bucket_span: u64 = 60_000_000_000,
+        /// Bloom bits per generation (64 KiB: ~1% false positives at 50k ids)
+        dedup_bits: usize = 1 << 19,
+        /// Furthest a sender's stamp may run ahead of the local clock
+        max_clock_skew: u64 = 5_000_000_000,
     };
 
-    pub fn init(allocator: std.mem.Allocator, config: Config) GossipState {
+    pub fn init(allocator: std.mem.Allocator, config: Config) !GossipState {
         return .{
             .allocator = allocator,
             .recent_messages = .{},
-            .seen_messages = .{},
-            .heard_from = .{},
+            .recent_head = 0,
+            .seen = try DedupFilter.init(allocator, config.dedup_buckets, config.dedup_bits, config.dedup_bucket_span),
+            .coverage = CoverageWindow.init(config.coverage_window),
             .config = config,
         };
     }
 
     pub fn deinit(self: *GossipState) void {
         self.recent_messages.deinit(self.allocator);
-        self.seen_messages.deinit(self.allocator);
-        self.heard_from.deinit(self.allocator);
+        self.seen.deinit();
+        self.coverage.deinit(self.allocator);
     }
 
-    /// Check if message is new (not seen before).
-    pub fn isNewMessage(self: *GossipState, msg_id: u64) !bool {
-        if (self.seen_messages.get(msg_id)) |_| {
-            return false;
-        }
-        try self.seen_messages.put(self.allocator, msg_id, {});
-        return true;
+    /// Check if message is new (not seen before), marking it seen.
+    pub fn isNewMessage(self: *GossipState, msg_id: u64) bool {
+        return self.seen.testAndSet(msg_id);
+    }
+
+    /// Move time forward (rotates the dedup filter, slides coverage)
+    pub fn advance(self: *GossipState, now: u64) void {
+        self.seen.advance(now);
+        self.coverage.advance(now);
+    }
+
+    /// Record that `node` was heard at `entropy_stamp`
+    pub fn noteHeard(self: *GossipState, node: NodeId, entropy_stamp: u64) !void {
+        try self.coverage.note(self.allocator, node, entropy_stamp);
+    }
+
+    /// Whether a stamp is one the dedup filter can vouch for at `now`:
+    /// at most `max_clock_skew` ahead, and not older than the filter's
+    /// memory (a replay from before then would look new)
+    pub fn acceptsStamp(self: *const GossipState, stamp: u64, now: u64) bool {
+        if (stamp > now) return stamp - now <= self.config.max_clock_skew;
+        const horizon = @as(u64, self.config.dedup_buckets - 1) * self.config.dedup_bucket_span;
+        return now - stamp <= horizon;
     }
 
-    /// Record a message as seen.
-    pub fn recordMessage(self: *GossipState, msg: *const GossipMessage) !void {
+    /// Record a message as seen at local time `now` (same clock as the
+    /// stamps). Time only moves with `now`: a sender's stamp never rotates
+    /// the dedup filter or slides coverage, and one outside `acceptsStamp`
+    /// is rejected with error.StampOutOfRange.
+    pub fn recordMessage(self: *GossipState, msg: *const GossipMessage, now: u64) !void {
+        if (!self.acceptsStamp(msg.entropy_stamp, now)) return error.StampOutOfRange;
+        self.advance(now);
+
         // Add to seen set
-        try self.seen_messages.put(self.allocator, msg.id, {});
+        self.seen.insert(msg.id);
 
         // Add to recent messages (for future refs)
         if (self.recent_messages.items.len >= self.config.max_recent) {
-            _ = self.recent_messages.orderedRemove(0);
+            self.recent_messages.items[self.recent_head] = msg.id;
+            self.recent_head = (self.recent_head + 1) % self.recent_messages.items.len;
+        } else {
+            try self.recent_messages.append(self.allocator, msg.id);
         }
-        try self.recent_messages.append(self.allocator, msg.id);
 
-        // Update heard_from
-        try self.heard_from.put(self.allocator, msg.sender, msg.entropy_stamp);
+        // Update heard_from (a stamp slightly ahead counts as now)
+        try self.noteHeard(msg.sender, @min(msg.entropy_stamp, now));
     }
 
     /// Sample k random references from recent messages.
@@ -132,19 +410,122 @@ pub const GossipState = struct {
     }
 
     /// Compute coverage ratio: fraction of nodes heard from recently.
-    pub fn computeCoverage(self: *const GossipState, total_nodes: usize, current_entropy: u64) f64 {
+    pub fn computeCoverage(self: *GossipState, total_nodes: usize, current_entropy: u64) f64 {
         if (total_nodes == 0) return 1.0;
+        self.coverage.advance(current_entropy);
+        return @as(f64, @floatFromInt(self.coverage.active)) / @as(f64, @floatFromInt(total_nodes));
+    }
+};
 
-        var active_count: usize = 0;
-        var it = self.heard_from.iterator();
-        while (it.next()) |entry| {
-            const last_stamp = entry.value_ptr.*;
-            if (current_entropy - last_stamp <= self.config.coverage_window) {
-                active_count += 1;
-            }
+/// Datagram sink for gossip batches (e.g. UTCP.sendFrame behind a
+/// NodeId -> address lookup, with the payload in an LWF frame)
+pub const Transport = struct {
+    context: ?*anyopaque,
+    send_fn: *const fn (ctx: ?*anyopaque, neighbor: NodeId, payload: []const u8) void,
+
+    pub fn send(self: Transport, neighbor: NodeId, payload: []const u8) void {
+        self.send_fn(self.context, neighbor, payload);
+    }
+};
+
+/// Per-neighbor batching: messages for one neighbor are coalesced into a
+/// single payload of up to `max_batch` bytes, sent when the next message
+/// would not fit or on `flush`.
+pub const FanOut = struct {
+    /// Fits one UTCP datagram with the LWF header and trailer (1500 MTU)
+    pub const DEFAULT_MAX_BATCH = 1200;
+
+    allocator: std.mem.Allocator,
+    transport: Transport,
+    max_batch: usize,
+    /// neighbor -> index into `batches`
+    slots: std.AutoHashMapUnmanaged(NodeId, u32),
+    batches: std.ArrayListUnmanaged(Batch),
+    /// Batch indices that may hold pending bytes
+    dirty: std.ArrayListUnmanaged(u32),
+
+    /// Datagrams and messages handed to the transport
+    datagrams_sent: u64 = 0,
+    messages_sent: u64 = 0,
+
+    const Batch = struct {
+        neighbor: NodeId,
+        buf: []u8,
+        len: usize = 0,
+        messages: usize = 0,
+        /// Listed in `dirty`
+        queued: bool = false,
+    };
+
+    pub fn init(allocator: std.mem.Allocator, transport: Transport, max_batch: usize) FanOut {
+        return .{
+            .allocator = allocator,
+            .transport = transport,
+            .max_batch = max_batch,
+            .slots = .{},
+            .batches = .{},
+            .dirty = .{},
+        };
+    }
+
+    pub fn deinit(self: *FanOut) void {
+        for (self.batches.items) |batch| self.allocator.free(batch.buf);
+        self.batches.deinit(self.allocator);
+        self.slots.deinit(self.allocator);
+        self.dirty.deinit(self.allocator);
+    }
+
+    /// Queue `msg` for `neighbor`. Messages larger than a batch go out alone.
+    pub fn enqueue(self: *FanOut, neighbor: NodeId, msg: *const GossipMessage) !void {
+        const size = msg.wireSize();
+        const entry = try self.slots.getOrPut(self.allocator, neighbor);
+        if (!entry.found_existing) {
+            errdefer self.slots.removeByPtr(entry.key_ptr);
+            const buf = try self.allocator.alloc(u8, self.max_batch);
+            errdefer self.allocator.free(buf);
+            try self.batches.append(self.allocator, .{ .neighbor = neighbor, .buf = buf });
+            entry.value_ptr.* = @intCast(self.batches.items.len - 1);
+        }
+        const index = entry.value_ptr.*;
+        const batch = &self.batches.items[index];
+
+        if (size > self.max_batch) {
+            // Keep per-neighbor order: pending messages go first
+            self.sendBatch(batch);
+            const big = try self.allocator.alloc(u8, size);
+            defer self.allocator.free(big);
+            self.transport.send(neighbor, big[0..msg.encodeInto(big)]);
+            self.datagrams_sent += 1;
+            self.messages_sent += 1;
+            return;
+        }
+
+        if (batch.len + size > self.max_batch) self.sendBatch(batch);
+        if (!batch.queued) {
+            try self.dirty.append(self.allocator, index);
+            batch.queued = true;
         }
+        batch.len += msg.encodeInto(batch.buf[batch.len..]);
+        batch.messages += 1;
+    }
 
-        return @as(f64, @floatFromInt(active_count)) / @as(f64, @floatFromInt(total_nodes));
+    fn sendBatch(self: *FanOut, batch: *Batch) void {
+        if (batch.len == 0) return;
+        self.transport.send(batch.neighbor, batch.buf[0..batch.len]);
+        self.datagrams_sent += 1;
+        self.messages_sent += batch.messages;
+        batch.len = 0;
+        batch.messages = 0;
+    }
+
+    /// Send every pending batch
+    pub fn flush(self: *FanOut) void {
+        for (self.dirty.items) |index| {
+            const batch = &self.batches.items[index];
+            self.sendBatch(batch);
+            batch.queued = false;
+        }
+        self.dirty.clearRetainingCapacity();
     }
 };
 
@@ -159,31 +540,34 @@ pub const FloodResult = struct {
 };
 
 /// Probabilistic flood of a gossip message to neighbors.
+/// Messages are queued on `fanout`; call `fanout.flush()` once per round
+/// so several floods share one datagram per neighbor. Coverage is read at
+/// local time `now`.
 pub fn floodMessage(
     graph: *const RiskGraph,
     sender: NodeId,
     message: *const GossipMessage,
     state: *GossipState,
+    fanout: *FanOut,
+    now: u64,
     rand: std.Random,
-    // In real impl, this would be a transport callback
-    // send_fn: *const fn(NodeId, []const u8) void,
-) FloodResult {
+) !FloodResult {
     var sent_count: usize = 0;
     const neighbors = graph.neighbors(sender);
 
     for (neighbors) |edge_idx| {
-        // In real impl: extract neighbor ID and send
-        _ = edge_idx; // Will be used when UTCP transport is integrated
+        if (!graph.isLive(edge_idx)) continue;
+        const neighbor = graph.edges.items[edge_idx].to;
+        if (neighbor == message.sender) continue;
 
-        // Probabilistic drop (simulates lossy network)
+        // Probabilistic forwarding
         if (rand.float(f64) <= state.config.forward_prob) {
-            // In real impl: send_fn(neighbor, serialize(message));
-            // TODO: Integrate with UTCP transport layer
+            try fanout.enqueue(neighbor, message);
             sent_count += 1;
         }
     }
 
-    const coverage = state.computeCoverage(graph.nodeCount(), message.entropy_stamp);
+    const coverage = state.computeCoverage(graph.nodeCount(), now);
 
     return FloodResult{
         .sent_count = sent_count,
@@ -221,36 +605,74 @@ pub fn createMessage(
 
 test "GossipState: message deduplication" {
     const allocator = std.testing.allocator;
-    var state = GossipState.init(allocator, .{});
+    var state = try GossipState.init(allocator, .{ .dedup_buckets = 2, .dedup_bucket_span = 100 });
     defer state.deinit();
 
     const msg_id: u64 = 12345;
 
     // First time: new
-    try std.testing.expect(try state.isNewMessage(msg_id));
+    try std.testing.expect(state.isNewMessage(msg_id));
     // Second time: duplicate
-    try std.testing.expect(!(try state.isNewMessage(msg_id)));
+    try std.testing.expect(!state.isNewMessage(msg_id));
+
+    // Still remembered one bucket later, forgotten after the filter rotates out
+    state.advance(150);
+    try std.testing.expect(!state.isNewMessage(msg_id));
+    state.advance(350);
+    try std.testing.expect(state.isNewMessage(msg_id));
+}
+
+test "GossipState: time follows the local clock" {
+    const allocator = std.testing.allocator;
+    var state = try GossipState.init(allocator, .{ .dedup_buckets = 2, .dedup_bucket_span = 100, .coverage_window = 1000, .max_clock_skew = 50 });
+    defer state.deinit();
+
+    const now: u64 = 10_000;
+    var msg = GossipMessage{ .id = 1, .sender = 0, .refs = &.{}, .msg_type = .heartbeat, .entropy_stamp = now, .payload = "" };
+    try state.recordMessage(&msg, now);
+
+    // A stamp far ahead would rotate the filter and forget message 1
+    msg = .{ .id = 2, .sender = 1, .refs = &.{}, .msg_type = .heartbeat, .entropy_stamp = now + 1_000_000, .payload = "" };
+    try std.testing.expectError(error.StampOutOfRange, state.recordMessage(&msg, now));
+    try std.testing.expect(!state.isNewMessage(1));
+    // Older than the dedup horizon: could be a replay the filter forgot
+    msg.id = 3;
+    msg.entropy_stamp = now - 500;
+    try std.testing.expectError(error.StampOutOfRange, state.recordMessage(&msg, now));
+
+    // Slightly ahead is accepted and counted at the local time
+    msg.id = 4;
+    msg.entropy_stamp = now + 40;
+    try state.recordMessage(&msg, now);
+    try std.testing.expectApproxEqAbs(state.computeCoverage(2, now), 1.0, 0.01);
+    try std.testing.expectEqual(@as(usize, 2), state.recent_messages.items.len);
 }
 
 test "GossipState: coverage tracking" {
     const allocator = std.testing.allocator;
-    var state = GossipState.init(allocator, .{ .coverage_window = 1000 });
+    var state = try GossipState.init(allocator, .{ .coverage_window = 1000 });
     defer state.deinit();
 
     const now: u64 = 5000;
 
     // Record messages from 2 nodes
-    try state.heard_from.put(allocator, 0, now - 500); // Recent
-    try state.heard_from.put(allocator, 1, now - 2000); // Stale
+    try state.noteHeard(1, now - 2000); // Stale
+    try state.noteHeard(0, now - 500); // Recent
 
     const coverage = state.computeCoverage(3, now);
     // 1 out of 3 nodes heard from recently
     try std.testing.expectApproxEqAbs(coverage, 0.333, 0.01);
+
+    // Hearing node 0 again does not count it twice; node 1 comes back
+    try state.noteHeard(0, now - 100);
+    try state.noteHeard(1, now);
+    try std.testing.expectApproxEqAbs(state.computeCoverage(3, now), 0.667, 0.01);
+    try std.testing.expectApproxEqAbs(state.computeCoverage(3, now + 2000), 0.0, 0.01);
 }
 
 test "GossipState: reference sampling" {
     const allocator = std.testing.allocator;
-    var state = GossipState.init(allocator, .{ .ref_k = 2 });
+    var state = try GossipState.init(allocator, .{ .ref_k = 2 });
     defer state.deinit();
 
     // Add some recent messages
@@ -273,3 +695,48 @@ test "GossipMessage: ID computation" {
     try std.testing.expectEqual(id1, id2); // Same input, same ID
     try std.testing.expect(id1 != id3); // Different entropy, different ID
 }
+
+test "Gossip: fan-out coalesces messages per neighbor" {
+    const allocator = std.testing.allocator;
+    const time = @import("time");
+
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+    const ts = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+    for (0..3) |i| try graph.addNode(@intCast(i));
+    try graph.addEdge(.{ .from = 0, .to = 1, .risk = 0.5, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts });
+    try graph.addEdge(.{ .from = 0, .to = 2, .risk = 0.5, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts });
+
+    const Sink = struct {
+        datagrams: [3]usize = .{ 0, 0, 0 },
+        messages: [3]usize = .{ 0, 0, 0 },
+
+        fn send(ctx: ?*anyopaque, neighbor: NodeId, payload: []const u8) void {
+            const self: *@This() = @ptrCast(@alignCast(ctx.?));
+            self.datagrams[neighbor] += 1;
+            var it = BatchIterator{ .data = payload };
+            while (it.next() catch unreachable) |_| self.messages[neighbor] += 1;
+        }
+    };
+    var sink = Sink{};
+
+    var state = try GossipState.init(allocator, .{ .forward_prob = 1.0 });
+    defer state.deinit();
+    var fanout = FanOut.init(allocator, .{ .context = &sink, .send_fn = Sink.send }, 200);
+    defer fanout.deinit();
+    var prng = std.Random.DefaultPrng.init(7);
+
+    // 8 messages of 40 bytes: 5 fit a 200-byte batch, so two datagrams each
+    const refs = [_]u64{ 1, 2 };
+    for (0..8) |i| {
+        const msg = GossipMessage{ .id = i, .sender = 0, .refs = &refs, .msg_type = .heartbeat, .entropy_stamp = i, .payload = "" };
+        const result = try floodMessage(&graph, 0, &msg, &state, &fanout, 8, prng.random());
+        try std.testing.expectEqual(@as(usize, 2), result.sent_count);
+    }
+    fanout.flush();
+
+    try std.testing.expectEqual(@as(usize, 2), sink.datagrams[1]);
+    try std.testing.expectEqual(@as(usize, 8), sink.messages[1]);
+    try std.testing.expectEqual(@as(usize, 8), sink.messages[2]);
+    try std.testing.expectEqual(@as(u64, 4), fanout.datagrams_sent);
+}
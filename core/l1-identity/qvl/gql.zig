@@ -9,6 +9,7 @@ pub const ast = @import("gql/ast.zig");
 pub const lexer = @import("gql/lexer.zig");
 pub const parser = @import("gql/parser.zig");
 pub const codegen = @import("gql/codegen.zig");
+pub const engine = @import("gql/engine.zig");
 
 /// Parse GQL query string into AST
 pub fn parse(allocator: std.mem.Allocator, query: []const u8) !ast.Query {
@@ -44,3 +45,9 @@ pub const EdgePattern = ast.EdgePattern;
 
 // Re-export code generator
 pub const generateZig = codegen.generate;
+
+// Re-export execution engine
+pub const Plan = engine.Plan;
+pub const PlanCache = engine.PlanCache;
+pub const compile = engine.compile;
+pub const execute = engine.execute;
@@ -0,0 +1,990 @@
+//! GQL Execution Engine
+//!
+//! Runs queries in process against a frozen CSR graph instead of
+//! transpiling them to Zig. A query compiles once into a physical plan,
+//! a linear pipeline of batch operators:
+//!   NodeScan -> (Expand | ExpandVar | Filter)* -> Project
+//! Bindings flow between operators in columnar batches of BATCH rows.
+//! Predicates are evaluated column-wise with SIMD compares and pushed
+//! down to the first operator after which all their variables are bound.
+//!
+//! Graph model: every node is an `Identity`, every edge a `TRUST` edge and
+//! `BETRAYAL` matches edges with negative risk.
+//! Properties: nodes `id`, `out_degree`, `in_degree`, `reputation`;
+//! edges `risk`.
+
+const std = @import("std");
+const ast = @import("ast.zig");
+const lexer = @import("lexer.zig");
+const parser = @import("parser.zig");
+const csr_mod = @import("../csr.zig");
+const pop_integration = @import("../pop_integration.zig");
+
+const CsrGraph = csr_mod.CsrGraph;
+const DenseId = csr_mod.DenseId;
+const ReputationMap = pop_integration.ReputationMap;
+
+/// Rows per batch
+pub const BATCH = 1024;
+/// Pattern variables per query (named and anonymous)
+pub const MAX_VARS = 16;
+/// Upper bound on variable-length edges (`*min..max`)
+pub const MAX_VAR_HOPS = 8;
+
+pub const CompileError = error{
+    UnsupportedQuery,
+    UnknownLabel,
+    UnknownProperty,
+    UnknownVariable,
+    TypeMismatch,
+    TooManyVariables,
+};
+
+pub const NodeProp = enum { id, out_degree, in_degree, reputation };
+pub const EdgeProp = enum { risk };
+
+pub const Operand = union(enum) {
+    constant: f64,
+    node: struct { slot: u8, prop: NodeProp },
+    edge: struct { slot: u8, prop: EdgeProp },
+
+    fn slots(self: Operand) u16 {
+        return switch (self) {
+            .constant => 0,
+            .node => |n| @as(u16, 1) << @intCast(n.slot),
+            .edge => |e| @as(u16, 1) << @intCast(e.slot),
+        };
+    }
+};
+
+pub const Predicate = union(enum) {
+    compare: struct { left: Operand, op: ast.ComparisonOperator, right: Operand },
+    all: []const Predicate,
+    any: []const Predicate,
+    constant: bool,
+
+    fn slots(self: Predicate) u16 {
+        return switch (self) {
+            .compare => |c| c.left.slots() | c.right.slots(),
+            .all, .any => |children| blk: {
+                var mask: u16 = 0;
+                for (children) |child| mask |= child.slots();
+                break :blk mask;
+            },
+            .constant => 0,
+        };
+    }
+
+    fn depth(self: Predicate) usize {
+        return switch (self) {
+            .compare, .constant => 1,
+            .all, .any => |children| blk: {
+                var d: usize = 0;
+                for (children) |child| d = @max(d, child.depth());
+                break :blk d + 1;
+            },
+        };
+    }
+};
+
+pub const EdgeKind = enum {
+    /// Every edge
+    trust,
+    /// Negative risk only
+    betrayal,
+};
+
+pub const Operator = union(enum) {
+    scan: struct { slot: u8, seek: ?u32 },
+    expand: struct { from: u8, to: u8, edge: ?u8, direction: ast.EdgeDirection, kind: EdgeKind },
+    expand_var: struct { from: u8, to: u8, direction: ast.EdgeDirection, kind: EdgeKind, min: u32, max: u32 },
+    filter: Predicate,
+};
+
+pub const ColumnKind = enum(u8) { u32 = 0, f64 = 1 };
+
+pub const Output = struct {
+    name: []const u8,
+    value: Operand,
+    kind: ColumnKind,
+};
+
+/// Compiled query, immutable and shared between threads.
+/// Reference-counted so the cache can evict it while a query still runs.
+pub const Plan = struct {
+    allocator: std.mem.Allocator,
+    /// Owns the query text, its AST and everything below
+    arena: std.heap.ArenaAllocator,
+    text: []const u8,
+    operators: []const Operator,
+    /// Slot mask bound after operators[i]
+    bound: []const u16,
+    outputs: []const Output,
+    /// Deepest predicate nesting (mask scratch needed per filter)
+    predicate_depth: usize,
+    refs: std.atomic.Value(u32),
+
+    pub fn retain(self: *Plan) void {
+        _ = self.refs.fetchAdd(1, .monotonic);
+    }
+
+    pub fn release(self: *Plan) void {
+        if (self.refs.fetchSub(1, .acq_rel) != 1) return;
+        const allocator = self.allocator;
+        self.arena.deinit();
+        allocator.destroy(self);
+    }
+};
+
+/// Compile query text into a plan holding one reference
+pub fn compile(allocator: std.mem.Allocator, text: []const u8) !*Plan {
+    const plan = try allocator.create(Plan);
+    errdefer allocator.destroy(plan);
+    plan.arena = std.heap.ArenaAllocator.init(allocator);
+    errdefer plan.arena.deinit();
+    const arena = plan.arena.allocator();
+
+    plan.allocator = allocator;
+    plan.text = try arena.dupe(u8, text);
+    plan.refs = std.atomic.Value(u32).init(1);
+
+    var lex = lexer.Lexer.init(plan.text, arena);
+    const tokens = try lex.tokenize();
+    var par = parser.Parser.init(tokens, arena);
+    const query = try par.parse();
+
+    var compiler = Compiler{ .arena = arena };
+    try compiler.run(query);
+    plan.operators = compiler.operators.items;
+    plan.bound = compiler.bound.items;
+    plan.outputs = compiler.outputs.items;
+    plan.predicate_depth = compiler.predicate_depth;
+    return plan;
+}
+
+const Variable = struct {
+    slot: u8,
+    kind: enum { node, edge },
+};
+
+const Compiler = struct {
+    arena: std.mem.Allocator,
+    vars: std.StringHashMapUnmanaged(Variable) = .{},
+    slot_count: u8 = 0,
+    operators: std.ArrayListUnmanaged(Operator) = .{},
+    bound: std.ArrayListUnmanaged(u16) = .{},
+    outputs: std.ArrayListUnmanaged(Output) = .{},
+    /// WHERE conjuncts and pattern properties not yet placed
+    conjuncts: std.ArrayListUnmanaged(Predicate) = .{},
+    predicate_depth: usize = 0,
+
+    fn run(self: *Compiler, query: ast.Query) !void {
+        if (query.statements.len != 2 or query.statements[0] != .match or query.statements[1] != .return_stmt) {
+            return error.UnsupportedQuery;
+        }
+        const match = query.statements[0].match;
+        if (match.pattern.paths.len != 1) return error.UnsupportedQuery;
+        const elements = match.pattern.paths[0].elements;
+
+        // Bind the pattern first so WHERE can refer to any variable
+        var stages = std.ArrayListUnmanaged(Operator){};
+        try stages.append(self.arena, try self.startNode(elements[0].node));
+        var prev = stages.items[0].scan.slot;
+        var i: usize = 1;
+        while (i + 1 < elements.len) : (i += 2) {
+            const op = try self.step(elements[i].edge, elements[i + 1].node, prev);
+            try stages.append(self.arena, op);
+            prev = switch (op) {
+                .expand => |e| e.to,
+                .expand_var => |e| e.to,
+                else => unreachable,
+            };
+        }
+
+        if (match.where) |where| try self.addConjuncts(where);
+
+        // Place every conjunct right after the stage binding its variables
+        var bound: u16 = 0;
+        for (stages.items) |op| {
+            bound |= switch (op) {
+                .scan => |s| bit(s.slot),
+                .expand => |e| bit(e.to) | (if (e.edge) |slot| bit(slot) else 0),
+                .expand_var => |e| bit(e.to),
+                .filter => unreachable,
+            };
+            try self.operators.append(self.arena, op);
+            try self.bound.append(self.arena, bound);
+
+            var ready = std.ArrayListUnmanaged(Predicate){};
+            var j: usize = 0;
+            while (j < self.conjuncts.items.len) {
+                const pred = self.conjuncts.items[j];
+                if (pred.slots() & ~bound == 0) {
+                    try ready.append(self.arena, pred);
+                    _ = self.conjuncts.orderedRemove(j);
+                } else {
+                    j += 1;
+                }
+            }
+            if (ready.items.len > 0) {
+                const pred: Predicate = if (ready.items.len == 1) ready.items[0] else .{ .all = ready.items };
+                self.predicate_depth = @max(self.predicate_depth, pred.depth());
+                try self.operators.append(self.arena, .{ .filter = pred });
+                try self.bound.append(self.arena, bound);
+            }
+        }
+        std.debug.assert(self.conjuncts.items.len == 0);
+
+        for (query.statements[1].return_stmt.items) |item| {
+            const value = try self.operand(item.expression);
+            const name = if (item.alias) |alias| alias.name else switch (item.expression) {
+                .identifier => |ident| ident.name,
+                .property_access => |p| try std.fmt.allocPrint(self.arena, "{s}.{s}", .{ p.object.name, p.property.name }),
+                else => return error.UnsupportedQuery,
+            };
+            const kind: ColumnKind = switch (value) {
+                .constant => return error.UnsupportedQuery,
+                .node => |n| if (n.prop == .reputation) .f64 else .u32,
+                .edge => .f64,
+            };
+            try self.outputs.append(self.arena, .{ .name = name, .value = value, .kind = kind });
+        }
+    }
+
+    fn bit(slot: u8) u16 {
+        return @as(u16, 1) << @intCast(slot);
+    }
+
+    fn newSlot(self: *Compiler) !u8 {
+        if (self.slot_count == MAX_VARS) return error.TooManyVariables;
+        self.slot_count += 1;
+        return self.slot_count - 1;
+    }
+
+    fn checkNodeLabels(labels: []const ast.Identifier) !void {
+        for (labels) |label| {
+            if (!std.mem.eql(u8, label.name, "Identity")) return error.UnknownLabel;
+        }
+    }
+
+    fn edgeKind(types: []const ast.Identifier) !EdgeKind {
+        var kind: ?EdgeKind = null;
+        for (types) |t| {
+            const this: EdgeKind = if (std.mem.eql(u8, t.name, "TRUST"))
+                .trust
+            else if (std.mem.eql(u8, t.name, "BETRAYAL"))
+                .betrayal
+            else
+                return error.UnknownLabel;
+            // TRUST | BETRAYAL is every edge
+            kind = if (kind == null or kind.? == this) this else .trust;
+        }
+        return kind orelse .trust;
+    }
+
+    fn startNode(self: *Compiler, node: ast.NodePattern) !Operator {
+        try checkNodeLabels(node.labels);
+        const slot = try self.newSlot();
+        if (node.variable) |v| try self.vars.put(self.arena, v.name, .{ .slot = slot, .kind = .node });
+
+        // `{id: N}` on the first node turns the scan into a seek
+        var seek: ?u32 = null;
+        if (node.properties) |props| {
+            for (props.entries) |entry| {
+                if (seek == null and std.mem.eql(u8, entry.key.name, "id") and entry.value == .literal and entry.value.literal == .integer) {
+                    seek = std.math.cast(u32, entry.value.literal.integer) orelse return error.TypeMismatch;
+                    continue;
+                }
+                try self.propertyConjunct(.{ .node = .{ .slot = slot, .prop = try nodeProp(entry.key.name) } }, entry.value);
+            }
+        }
+        return .{ .scan = .{ .slot = slot, .seek = seek } };
+    }
+
+    fn step(self: *Compiler, edge: ast.EdgePattern, node: ast.NodePattern, from: u8) !Operator {
+        try checkNodeLabels(node.labels);
+        const kind = try edgeKind(edge.types);
+
+        const to = try self.newSlot();
+        if (node.variable) |v| {
+            if (self.vars.get(v.name)) |existing| {
+                // Revisited variable (cycle): expand into a fresh slot and join on id
+                if (existing.kind != .node) return error.TypeMismatch;
+                try self.conjuncts.append(self.arena, .{ .compare = .{
+                    .left = .{ .node = .{ .slot = to, .prop = .id } },
+                    .op = .eq,
+                    .right = .{ .node = .{ .slot = existing.slot, .prop = .id } },
+                } });
+            } else {
+                try self.vars.put(self.arena, v.name, .{ .slot = to, .kind = .node });
+            }
+        }
+        if (node.properties) |props| {
+            for (props.entries) |entry| {
+                try self.propertyConjunct(.{ .node = .{ .slot = to, .prop = try nodeProp(entry.key.name) } }, entry.value);
+            }
+        }
+
+        if (edge.quantifier) |q| {
+            if (edge.variable != null or edge.properties != null) return error.UnsupportedQuery;
+            const min = q.min orelse 1;
+            const max = q.max orelse MAX_VAR_HOPS;
+            if (max > MAX_VAR_HOPS or min > max) return error.UnsupportedQuery;
+            return .{ .expand_var = .{ .from = from, .to = to, .direction = edge.direction, .kind = kind, .min = min, .max = max } };
+        }
+
+        var edge_slot: ?u8 = null;
+        if (edge.variable != null or edge.properties != null) {
+            const slot = try self.newSlot();
+            edge_slot = slot;
+            if (edge.variable) |v| {
+                if (self.vars.contains(v.name)) return error.UnsupportedQuery;
+                try self.vars.put(self.arena, v.name, .{ .slot = slot, .kind = .edge });
+            }
+            if (edge.properties) |props| {
+                for (props.entries) |entry| {
+                    try self.propertyConjunct(.{ .edge = .{ .slot = slot, .prop = try edgeProp(entry.key.name) } }, entry.value);
+                }
+            }
+        }
+        return .{ .expand = .{ .from = from, .to = to, .edge = edge_slot, .direction = edge.direction, .kind = kind } };
+    }
+
+    fn propertyConjunct(self: *Compiler, left: Operand, value: ast.Expression) !void {
+        try self.conjuncts.append(self.arena, .{ .compare = .{ .left = left, .op = .eq, .right = try self.operand(value) } });
+    }
+
+    /// Split top-level ANDs so each part can be pushed down on its own
+    fn addConjuncts(self: *Compiler, expr: ast.Expression) !void {
+        if (expr == .binary_op and expr.binary_op.op == .and_op) {
+            try self.addConjuncts(expr.binary_op.left.*);
+            try self.addConjuncts(expr.binary_op.right.*);
+            return;
+        }
+        try self.conjuncts.append(self.arena, try self.predicate(expr));
+    }
+
+    fn predicate(self: *Compiler, expr: ast.Expression) !Predicate {
+        return switch (expr) {
+            .comparison => |c| .{ .compare = .{
+                .left = try self.operand(c.left.*),
+                .op = c.op,
+                .right = try self.operand(c.right.*),
+            } },
+            .binary_op => |b| blk: {
+                const children = try self.arena.alloc(Predicate, 2);
+                children[0] = try self.predicate(b.left.*);
+                children[1] = try self.predicate(b.right.*);
+                break :blk switch (b.op) {
+                    .and_op => .{ .all = children },
+                    .or_op => .{ .any = children },
+                    else => error.UnsupportedQuery,
+                };
+            },
+            .literal => |l| if (l == .boolean) .{ .constant = l.boolean } else error.TypeMismatch,
+            else => error.TypeMismatch,
+        };
+    }
+
+    fn operand(self: *Compiler, expr: ast.Expression) !Operand {
+        return switch (expr) {
+            .literal => |l| switch (l) {
+                .integer => |v| .{ .constant = @floatFromInt(v) },
+                .float => |v| .{ .constant = v },
+                else => error.TypeMismatch,
+            },
+            .identifier => |ident| blk: {
+                const v = self.vars.get(ident.name) orelse return error.UnknownVariable;
+                if (v.kind != .node) return error.TypeMismatch;
+                break :blk .{ .node = .{ .slot = v.slot, .prop = .id } };
+            },
+            .property_access => |p| blk: {
+                const v = self.vars.get(p.object.name) orelse return error.UnknownVariable;
+                break :blk switch (v.kind) {
+                    .node => .{ .node = .{ .slot = v.slot, .prop = try nodeProp(p.property.name) } },
+                    .edge => .{ .edge = .{ .slot = v.slot, .prop = try edgeProp(p.property.name) } },
+                };
+            },
+            else => error.UnsupportedQuery,
+        };
+    }
+
+    fn nodeProp(name: []const u8) !NodeProp {
+        return std.meta.stringToEnum(NodeProp, name) orelse error.UnknownProperty;
+    }
+
+    fn edgeProp(name: []const u8) !EdgeProp {
+        return std.meta.stringToEnum(EdgeProp, name) orelse error.UnknownProperty;
+    }
+};
+
+// ============================================================================
+// EXECUTION
+// ============================================================================
+
+pub const Graph = struct {
+    csr: *const CsrGraph,
+    /// Source of `reputation` (null: every node is neutral, 0.5)
+    reputation: ?*const ReputationMap = null,
+};
+
+pub const Limits = struct {
+    /// Queries producing more rows fail with error.ResultTooLarge
+    max_rows: usize = 1 << 20,
+};
+
+pub const Column = struct {
+    name: []const u8,
+    kind: ColumnKind,
+    /// Values for .u32 columns
+    u32s: std.ArrayListUnmanaged(u32) = .{},
+    /// Values for .f64 columns
+    f64s: std.ArrayListUnmanaged(f64) = .{},
+};
+
+/// Columnar query result
+pub const Result = struct {
+    allocator: std.mem.Allocator,
+    columns: []Column,
+    rows: usize,
+
+    pub fn deinit(self: *Result) void {
+        for (self.columns) |*col| {
+            self.allocator.free(col.name);
+            col.u32s.deinit(self.allocator);
+            col.f64s.deinit(self.allocator);
+        }
+        self.allocator.free(self.columns);
+    }
+};
+
+const Batch = struct {
+    len: usize,
+    cols: [MAX_VARS][BATCH]u32,
+};
+
+const V = @Vector(8, f64);
+const M = @Vector(8, bool);
+
+/// BFS state of one variable-length expansion. Each operator owns its own:
+/// a full output batch runs the downstream stages mid-traversal, and a
+/// later expand_var there must not clobber this one's frontier or stamps.
+const VarState = struct {
+    /// Visit stamps per node
+    stamps: []u32,
+    stamp: u32 = 0,
+    frontier: std.ArrayListUnmanaged(DenseId) = .{},
+    next_frontier: std.ArrayListUnmanaged(DenseId) = .{},
+
+    fn deinit(self: *VarState, allocator: std.mem.Allocator) void {
+        allocator.free(self.stamps);
+        self.frontier.deinit(allocator);
+        self.next_frontier.deinit(allocator);
+    }
+
+    fn visit(self: *VarState, allocator: std.mem.Allocator, v: DenseId) !void {
+        if (self.stamps[v] == self.stamp) return;
+        self.stamps[v] = self.stamp;
+        try self.next_frontier.append(allocator, v);
+    }
+};
+
+const Executor = struct {
+    allocator: std.mem.Allocator,
+    plan: *const Plan,
+    graph: Graph,
+    limits: Limits,
+    result: *Result,
+    /// Output batch of each operator
+    batches: []Batch,
+    masks: [][BATCH]bool,
+    left: *[BATCH]f64,
+    right: *[BATCH]f64,
+    /// BFS state per operator (empty stamps unless it is expand_var)
+    vars: []VarState,
+
+    fn scan(self: *Executor, op: @FieldType(Operator, "scan")) !void {
+        const batch = &self.batches[0];
+        const csr = self.graph.csr;
+        if (op.seek) |id| {
+            const dense = csr.denseIndex(id) orelse return;
+            batch.cols[op.slot][0] = dense;
+            batch.len = 1;
+            return self.push(1, batch);
+        }
+        var start: usize = 0;
+        while (start < csr.nodeCount()) : (start += BATCH) {
+            const n = @min(BATCH, csr.nodeCount() - start);
+            for (batch.cols[op.slot][0..n], start..) |*col, d| col.* = @intCast(d);
+            batch.len = n;
+            try self.push(1, batch);
+        }
+    }
+
+    /// Feed `batch` (output of operator `stage - 1`) to operator `stage`
+    fn push(self: *Executor, stage: usize, batch: *Batch) anyerror!void {
+        if (stage == self.plan.operators.len) return self.project(batch);
+        switch (self.plan.operators[stage]) {
+            .scan => unreachable,
+            .filter => |pred| {
+                const mask = &self.masks[0];
+                self.evaluate(pred, batch, 0);
+                var kept: usize = 0;
+                var bound = self.plan.bound[stage];
+                while (bound != 0) : (bound &= bound - 1) {
+                    const col = &batch.cols[@ctz(bound)];
+                    kept = 0;
+                    for (0..batch.len) |i| {
+                        col[kept] = col[i];
+                        kept += @intFromBool(mask[i]);
+                    }
+                }
+                batch.len = kept;
+                if (kept > 0) try self.push(stage + 1, batch);
+            },
+            .expand => |op| {
+                const out = &self.batches[stage];
+                out.len = 0;
+                const carry = self.plan.bound[stage - 1];
+                const csr = self.graph.csr;
+                for (0..batch.len) |row| {
+                    const u = batch.cols[op.from][row];
+                    if (op.direction != .incoming) {
+                        const range = csr.outEdges(u);
+                        for (range.start..range.end) |s| {
+                            if (op.kind == .betrayal and !(csr.risk[s] < 0)) continue;
+                            try self.emit(stage, out, batch, row, carry, op.to, csr.targets[s], op.edge, @intCast(s));
+                        }
+                    }
+                    if (op.direction != .outgoing) {
+                        const range = csr.inEdges(u);
+                        for (csr.in_edges[range.start..range.end]) |s| {
+                            if (op.kind == .betrayal and !(csr.risk[s] < 0)) continue;
+                            try self.emit(stage, out, batch, row, carry, op.to, csr.sources[s], op.edge, s);
+                        }
+                    }
+                }
+                if (out.len > 0) try self.push(stage + 1, out);
+            },
+            .expand_var => |op| {
+                const out = &self.batches[stage];
+                out.len = 0;
+                const carry = self.plan.bound[stage - 1];
+                for (0..batch.len) |row| try self.expandVar(stage, out, batch, row, carry, op);
+                if (out.len > 0) try self.push(stage + 1, out);
+            },
+        }
+    }
+
+    fn emit(self: *Executor, stage: usize, out: *Batch, in: *const Batch, row: usize, carry: u16, to: u8, node: DenseId, edge: ?u8, slot: u32) !void {
+        var bound = carry;
+        while (bound != 0) : (bound &= bound - 1) {
+            const c = @ctz(bound);
+            out.cols[c][out.len] = in.cols[c][row];
+        }
+        out.cols[to][out.len] = node;
+        if (edge) |e| out.cols[e][out.len] = slot;
+        out.len += 1;
+        if (out.len == BATCH) {
+            try self.push(stage + 1, out);
+            out.len = 0;
+        }
+    }
+
+    /// Breadth-first expansion; each node reachable within min..max hops
+    /// is emitted once per input row (at its shortest distance)
+    fn expandVar(self: *Executor, stage: usize, out: *Batch, in: *const Batch, row: usize, carry: u16, op: @FieldType(Operator, "expand_var")) !void {
+        const csr = self.graph.csr;
+        const bfs = &self.vars[stage];
+        bfs.stamp +%= 1;
+        if (bfs.stamp == 0) {
+            @memset(bfs.stamps, 0);
+            bfs.stamp = 1;
+        }
+        const start = in.cols[op.from][row];
+        bfs.stamps[start] = bfs.stamp;
+        bfs.frontier.clearRetainingCapacity();
+        try bfs.frontier.append(self.allocator, start);
+        if (op.min == 0) try self.emit(stage, out, in, row, carry, op.to, start, null, 0);
+
+        var hop: u32 = 1;
+        while (hop <= op.max and bfs.frontier.items.len > 0) : (hop += 1) {
+            bfs.next_frontier.clearRetainingCapacity();
+            for (bfs.frontier.items) |u| {
+                if (op.direction != .incoming) {
+                    const range = csr.outEdges(u);
+                    for (range.start..range.end) |s| {
+                        if (op.kind == .betrayal and !(csr.risk[s] < 0)) continue;
+                        try bfs.visit(self.allocator, csr.targets[s]);
+                    }
+                }
+                if (op.direction != .outgoing) {
+                    const range = csr.inEdges(u);
+                    for (csr.in_edges[range.start..range.end]) |s| {
+                        if (op.kind == .betrayal and !(csr.risk[s] < 0)) continue;
+                        try bfs.visit(self.allocator, csr.sources[s]);
+                    }
+                }
+            }
+            if (hop >= op.min) {
+                for (bfs.next_frontier.items) |v| try self.emit(stage, out, in, row, carry, op.to, v, null, 0);
+            }
+            std.mem.swap(std.ArrayListUnmanaged(DenseId), &bfs.frontier, &bfs.next_frontier);
+        }
+    }
+
+    /// Evaluate `pred` over the batch into masks[level]
+    fn evaluate(self: *Executor, pred: Predicate, batch: *const Batch, level: usize) void {
+        const mask = &self.masks[level];
+        const n = batch.len;
+        switch (pred) {
+            .constant => |v| @memset(mask[0..n], v),
+            .compare => |c| {
+                self.load(c.left, batch, self.left[0..n]);
+                self.load(c.right, batch, self.right[0..n]);
+                var i: usize = 0;
+                while (i + 8 <= n) : (i += 8) {
+                    const a: V = self.left[i..][0..8].*;
+                    const b: V = self.right[i..][0..8].*;
+                    const m: M = switch (c.op) {
+                        .eq => a == b,
+                        .neq => a != b,
+                        .lt => a < b,
+                        .lte => a <= b,
+                        .gt => a > b,
+                        .gte => a >= b,
+                    };
+                    mask[i..][0..8].* = m;
+                }
+                while (i < n) : (i += 1) {
+                    const a = self.left[i];
+                    const b = self.right[i];
+                    mask[i] = switch (c.op) {
+                        .eq => a == b,
+                        .neq => a != b,
+                        .lt => a < b,
+                        .lte => a <= b,
+                        .gt => a > b,
+                        .gte => a >= b,
+                    };
+                }
+            },
+            .all, .any => |children| {
+                const is_all = pred == .all;
+                @memset(mask[0..n], is_all);
+                const tmp = &self.masks[level + 1];
+                for (children) |child| {
+                    self.evaluate(child, batch, level + 1);
+                    for (mask[0..n], tmp[0..n]) |*m, t| m.* = if (is_all) m.* and t else m.* or t;
+                }
+            },
+        }
+    }
+
+    fn load(self: *Executor, operand: Operand, batch: *const Batch, out: []f64) void {
+        const csr = self.graph.csr;
+        switch (operand) {
+            .constant => |v| @memset(out, v),
+            .node => |n| {
+                const col = batch.cols[n.slot][0..out.len];
+                switch (n.prop) {
+                    .id => for (out, col) |*o, d| {
+                        o.* = @floatFromInt(csr.nodeId(d));
+                    },
+                    .out_degree => for (out, col) |*o, d| {
+                        o.* = @floatFromInt(csr.outDegree(d));
+                    },
+                    .in_degree => for (out, col) |*o, d| {
+                        o.* = @floatFromInt(csr.inEdges(d).len());
+                    },
+                    .reputation => for (out, col) |*o, d| {
+                        o.* = if (self.graph.reputation) |rep| rep.get(csr.nodeId(d)) else 0.5;
+                    },
+                }
+            },
+            .edge => |e| {
+                const col = batch.cols[e.slot][0..out.len];
+                switch (e.prop) {
+                    .risk => for (out, col) |*o, s| {
+                        o.* = csr.risk[s];
+                    },
+                }
+            },
+        }
+    }
+
+    fn project(self: *Executor, batch: *const Batch) !void {
+        if (self.result.rows + batch.len > self.limits.max_rows) return error.ResultTooLarge;
+        const csr = self.graph.csr;
+        for (self.plan.outputs, self.result.columns) |output, *col| {
+            const values = self.left[0..batch.len];
+            switch (output.kind) {
+                .u32 => {
+                    const n = output.value.node;
+                    const dst = try col.u32s.addManyAsSlice(self.allocator, batch.len);
+                    const src = batch.cols[n.slot][0..batch.len];
+                    switch (n.prop) {
+                        .id => for (dst, src) |*o, d| {
+                            o.* = csr.nodeId(d);
+                        },
+                        .out_degree => for (dst, src) |*o, d| {
+                            o.* = @intCast(csr.outDegree(d));
+                        },
+                        .in_degree => for (dst, src) |*o, d| {
+                            o.* = @intCast(csr.inEdges(d).len());
+                        },
+                        .reputation => unreachable,
+                    }
+                },
+                .f64 => {
+                    self.load(output.value, batch, values);
+                    try col.f64s.appendSlice(self.allocator, values);
+                },
+            }
+        }
+        self.result.rows += batch.len;
+    }
+};
+
+/// Run a compiled plan. The result is owned by the caller.
+pub fn execute(allocator: std.mem.Allocator, plan: *const Plan, graph: Graph, limits: Limits) !Result {
+    var result = Result{ .allocator = allocator, .columns = try allocator.alloc(Column, plan.outputs.len), .rows = 0 };
+    for (plan.outputs, result.columns) |output, *col| col.* = .{ .name = "", .kind = output.kind };
+    errdefer result.deinit();
+    for (plan.outputs, result.columns) |output, *col| col.name = try allocator.dupe(u8, output.name);
+
+    const batches = try allocator.alloc(Batch, plan.operators.len);
+    defer allocator.free(batches);
+    const masks = try allocator.alloc([BATCH]bool, plan.predicate_depth + 1);
+    defer allocator.free(masks);
+    const scratch = try allocator.alloc([BATCH]f64, 2);
+    defer allocator.free(scratch);
+
+    const vars = try allocator.alloc(VarState, plan.operators.len);
+    defer allocator.free(vars);
+    var vars_ready: usize = 0;
+    defer for (vars[0..vars_ready]) |*bfs| bfs.deinit(allocator);
+    for (plan.operators, vars) |op, *bfs| {
+        bfs.* = .{ .stamps = try allocator.alloc(u32, if (op == .expand_var) graph.csr.nodeCount() else 0) };
+        @memset(bfs.stamps, 0);
+        vars_ready += 1;
+    }
+
+    var exec = Executor{
+        .allocator = allocator,
+        .plan = plan,
+        .graph = graph,
+        .limits = limits,
+        .result = &result,
+        .batches = batches,
+        .masks = masks,
+        .left = &scratch[0],
+        .right = &scratch[1],
+        .vars = vars,
+    };
+
+    try exec.scan(plan.operators[0].scan);
+    return result;
+}
+
+// ============================================================================
+// PLAN CACHE
+// ============================================================================
+
+/// Compiled plans keyed by query text, evicted oldest-first.
+/// Thread-safe; plans handed out stay valid until released.
+pub const PlanCache = struct {
+    pub const default_capacity = 64;
+
+    allocator: std.mem.Allocator,
+    mutex: std.Thread.Mutex = .{},
+    /// Keys are the plans' own text
+    map: std.StringHashMapUnmanaged(*Plan),
+    /// Insertion ring; `next` is the slot the next insert evicts
+    order: []?*Plan,
+    next: usize,
+    hits: u64 = 0,
+    misses: u64 = 0,
+
+    pub fn init(allocator: std.mem.Allocator, capacity: usize) !PlanCache {
+        std.debug.assert(capacity > 0);
+        const order = try allocator.alloc(?*Plan, capacity);
+        @memset(order, null);
+        return .{ .allocator = allocator, .map = .{}, .order = order, .next = 0 };
+    }
+
+    pub fn deinit(self: *PlanCache) void {
+        for (self.order) |entry| {
+            if (entry) |plan| plan.release();
+        }
+        self.allocator.free(self.order);
+        self.map.deinit(self.allocator);
+    }
+
+    /// Plan for `text`, compiled on a miss. Release it when done.
+    pub fn acquire(self: *PlanCache, text: []const u8) !*Plan {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        if (self.map.get(text)) |plan| {
+            self.hits += 1;
+            plan.retain();
+            return plan;
+        }
+        self.misses += 1;
+
+        const plan = try compile(self.allocator, text);
+        errdefer plan.release();
+        try self.map.ensureUnusedCapacity(self.allocator, 1);
+
+        if (self.order[self.next]) |old| {
+            _ = self.map.remove(old.text);
+            old.release();
+        }
+        self.order[self.next] = plan;
+        self.next = (self.next + 1) % self.order.len;
+        self.map.putAssumeCapacity(plan.text, plan);
+
+        plan.retain();
+        return plan;
+    }
+};
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+const types = @import("../types.zig");
+
+fn testGraph(allocator: std.mem.Allocator) !types.RiskGraph {
+    const time = @import("time");
+    const ts = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+    var graph = types.RiskGraph.init(allocator);
+    errdefer graph.deinit();
+    // 0 -> 1 (0.9), 0 -> 2 (0.2), 1 -> 3 (0.5), 2 -> 3 (-0.4), 3 -> 0 (0.7)
+    const edges = [_]struct { u32, u32, f64 }{ .{ 0, 1, 0.9 }, .{ 0, 2, 0.2 }, .{ 1, 3, 0.5 }, .{ 2, 3, -0.4 }, .{ 3, 0, 0.7 } };
+    for (0..4) |i| try graph.addNode(@intCast(i));
+    for (edges, 0..) |e, i| {
+        try graph.addEdge(.{ .from = e[0], .to = e[1], .risk = e[2], .timestamp = ts, .nonce = i, .level = 3, .expires_at = ts });
+    }
+    return graph;
+}
+
+fn runQuery(allocator: std.mem.Allocator, csr: *const CsrGraph, text: []const u8) !Result {
+    const plan = try compile(allocator, text);
+    defer plan.release();
+    return execute(allocator, plan, .{ .csr = csr }, .{});
+}
+
+test "Engine: expand, filter pushdown and projection" {
+    const allocator = std.testing.allocator;
+    var graph = try testGraph(allocator);
+    defer graph.deinit();
+    var csr = try CsrGraph.fromRiskGraph(&graph, allocator);
+    defer csr.deinit();
+
+    var result = try runQuery(allocator, &csr, "MATCH (a:Identity)-[r:TRUST]->(b) WHERE r.risk > 0.4 RETURN a, b, r.risk AS risk");
+    defer result.deinit();
+    try std.testing.expectEqual(@as(usize, 3), result.rows);
+    try std.testing.expectEqualStrings("risk", result.columns[2].name);
+    try std.testing.expectEqualSlices(u32, &.{ 0, 1, 3 }, result.columns[0].u32s.items);
+    try std.testing.expectEqualSlices(u32, &.{ 1, 3, 0 }, result.columns[1].u32s.items);
+    try std.testing.expectEqualSlices(f64, &.{ 0.9, 0.5, 0.7 }, result.columns[2].f64s.items);
+
+    // Seek, two hops, incoming BETRAYAL edge
+    var two_hop = try runQuery(allocator, &csr, "MATCH (a {id: 0})-->(b)-->(c) RETURN c");
+    defer two_hop.deinit();
+    try std.testing.expectEqualSlices(u32, &.{ 3, 3 }, two_hop.columns[0].u32s.items);
+
+    var betrayed = try runQuery(allocator, &csr, "MATCH (v)<-[r:BETRAYAL]-(x) WHERE r.risk < -0.1 OR x.id = 99 RETURN v, x, r.risk");
+    defer betrayed.deinit();
+    try std.testing.expectEqualSlices(u32, &.{3}, betrayed.columns[0].u32s.items);
+    try std.testing.expectEqualSlices(u32, &.{2}, betrayed.columns[1].u32s.items);
+
+    // Cycle back to the start binds by id
+    var cycles = try runQuery(allocator, &csr, "MATCH (a)-->(b)-->(c)-->(a) RETURN a.id, b.out_degree");
+    defer cycles.deinit();
+    try std.testing.expectEqualStrings("a.id", cycles.columns[0].name);
+    try std.testing.expectEqualSlices(u32, &.{ 0, 0, 1, 2, 3, 3 }, cycles.columns[0].u32s.items);
+    try std.testing.expectEqualSlices(u32, &.{ 1, 1, 1, 1, 2, 2 }, cycles.columns[1].u32s.items);
+
+    // Variable length: distinct nodes within 1..2 hops of 0
+    var reach = try runQuery(allocator, &csr, "MATCH (a {id: 0})-[*1..2]->(b) RETURN b");
+    defer reach.deinit();
+    try std.testing.expectEqualSlices(u32, &.{ 1, 2, 3 }, reach.columns[0].u32s.items);
+
+    try std.testing.expectError(error.UnsupportedQuery, runQuery(allocator, &csr, "CREATE (a) RETURN a"));
+    try std.testing.expectError(error.UnknownProperty, runQuery(allocator, &csr, "MATCH (a) WHERE a.name = 1 RETURN a"));
+}
+
+test "Engine: batches larger than BATCH and the plan cache" {
+    const allocator = std.testing.allocator;
+    const time = @import("time");
+    const ts = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+
+    // Star: 0 -> 1..3000
+    var graph = types.RiskGraph.init(allocator);
+    defer graph.deinit();
+    for (0..3001) |i| try graph.addNode(@intCast(i));
+    for (1..3001) |i| {
+        try graph.addEdge(.{ .from = 0, .to = @intCast(i), .risk = 0.1, .timestamp = ts, .nonce = i, .level = 3, .expires_at = ts });
+    }
+    var csr = try CsrGraph.fromRiskGraph(&graph, allocator);
+    defer csr.deinit();
+
+    var cache = try PlanCache.init(allocator, 2);
+    defer cache.deinit();
+
+    const text = "MATCH (a {id: 0})-->(b) WHERE b.id >= 1000 AND b.in_degree = 1 RETURN b";
+    for (0..2) |_| {
+        const plan = try cache.acquire(text);
+        defer plan.release();
+        var result = try execute(allocator, plan, .{ .csr = &csr }, .{});
+        defer result.deinit();
+        try std.testing.expectEqual(@as(usize, 2001), result.rows);
+        try std.testing.expectEqual(@as(u32, 1000), result.columns[0].u32s.items[0]);
+    }
+    try std.testing.expectEqual(@as(u64, 1), cache.hits);
+
+    // Eviction while a plan is held keeps it alive
+    const held = try cache.acquire(text);
+    defer held.release();
+    for ([_][]const u8{ "MATCH (a) RETURN a", "MATCH (a)-->(b) RETURN b" }) |other| {
+        const plan = try cache.acquire(other);
+        plan.release();
+    }
+    var still = try execute(allocator, held, .{ .csr = &csr }, .{ .max_rows = 5000 });
+    defer still.deinit();
+    try std.testing.expectError(error.ResultTooLarge, execute(allocator, held, .{ .csr = &csr }, .{ .max_rows = 10 }));
+}
+
+test "Engine: chained variable-length hops across full batches" {
+    const allocator = std.testing.allocator;
+    const time = @import("time");
+    const ts = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+    const leaves = 1500;
+
+    // 0 -> i -> leaves + i for i in 1..leaves: the first BFS fills a batch
+    // mid-traversal and runs the second one before it finishes
+    var graph = types.RiskGraph.init(allocator);
+    defer graph.deinit();
+    for (0..2 * leaves + 1) |i| try graph.addNode(@intCast(i));
+    for (1..leaves + 1) |i| {
+        try graph.addEdge(.{ .from = 0, .to = @intCast(i), .risk = 0.1, .timestamp = ts, .nonce = i, .level = 3, .expires_at = ts });
+        try graph.addEdge(.{ .from = @intCast(i), .to = @intCast(leaves + i), .risk = 0.1, .timestamp = ts, .nonce = leaves + i, .level = 3, .expires_at = ts });
+    }
+    var csr = try CsrGraph.fromRiskGraph(&graph, allocator);
+    defer csr.deinit();
+
+    var result = try runQuery(allocator, &csr, "MATCH (a {id: 0})-[*1..1]->(b)-[*1..2]->(c) RETURN b, c");
+    defer result.deinit();
+    try std.testing.expectEqual(@as(usize, leaves), result.rows);
+    var seen = try std.DynamicBitSet.initEmpty(allocator, leaves + 1);
+    defer seen.deinit();
+    for (result.columns[0].u32s.items, result.columns[1].u32s.items) |b, c| {
+        try std.testing.expect(b >= 1 and b <= leaves);
+        try std.testing.expectEqual(b + leaves, c);
+        try std.testing.expect(!seen.isSet(b));
+        seen.set(b);
+    }
+}
@@ -453,6 +453,20 @@ pub const Parser = struct {
             const val = try self.parseInteger();
             return ast.Expression{ .literal = ast.Literal{ .integer = @intCast(val) } };
         }
+        if (self.match(.float_literal)) {
+            const val = try std.fmt.parseFloat(f64, self.previous().text);
+            return ast.Expression{ .literal = ast.Literal{ .float = val } };
+        }
+        // Negative numeric literal (e.g. r.risk < -0.5)
+        if (self.match(.minus)) {
+            const operand = try self.parsePrimary();
+            if (operand == .literal) switch (operand.literal) {
+                .integer => |v| return ast.Expression{ .literal = ast.Literal{ .integer = -v } },
+                .float => |v| return ast.Expression{ .literal = ast.Literal{ .float = -v } },
+                else => {},
+            };
+            return error.UnexpectedToken;
+        }
         
         // Property access or identifier
         if (self.check(.identifier)) {
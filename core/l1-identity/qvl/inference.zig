@@ -7,11 +7,18 @@
 //!
 //! Design: Treat DAG as factor graph; nodes send belief messages
 //! until convergence (delta < epsilon). Output: per-node anomaly scores.
+//! Runs over a frozen CSR snapshot with flat arrays, SIMD message updates,
+//! node-range parallelism and residual scheduling, so it is cheap enough
+//! to run on the full graph every epoch.
 
 const std = @import("std");
+const builtin = @import("builtin");
 const time = @import("time");
 const types = @import("types.zig");
+const csr_mod = @import("csr.zig");
 
+const CsrGraph = csr_mod.CsrGraph;
+const DenseId = csr_mod.DenseId;
 const NodeId = types.NodeId;
 const RiskGraph = types.RiskGraph;
 const RiskEdge = types.RiskEdge;
@@ -27,6 +34,11 @@ pub const BPConfig = struct {
     damping: f64 = 0.5,
     /// Prior belief (uniform assumption)
     prior: f64 = 0.5,
+    /// Worker threads (0 = one per CPU, scaled down for small graphs)
+    threads: usize = 1,
+    /// Recompute only nodes whose belief or incoming messages still move by
+    /// epsilon or more; converged = nothing left to recompute
+    residual: bool = true,
 };
 
 /// Result of Belief Propagation inference.
@@ -78,12 +90,35 @@ pub const BPResult = struct {
 ///    b. Update beliefs based on incoming messages.
 ///    c. Check for convergence.
 /// 3. Convert low beliefs to anomaly scores.
+///
+/// Freezes `graph` into a CSR snapshot and runs `runInferenceCsr`.
 pub fn runInference(
     graph: *const RiskGraph,
     config: BPConfig,
     allocator: std.mem.Allocator,
 ) !BPResult {
-    const n = graph.nodeCount();
+    var snapshot = try CsrGraph.fromRiskGraph(graph, allocator);
+    defer snapshot.deinit();
+    return runInferenceCsr(&snapshot, config, allocator);
+}
+
+/// Belief Propagation against an existing CSR snapshot.
+///
+/// Beliefs and messages live in flat arrays: beliefs are double-buffered
+/// and each node pulls its incoming messages (stored in in-row order, so
+/// the update is a contiguous SIMD pass plus a gather of source beliefs).
+/// Workers take node-range chunks from a shared cursor and meet at a
+/// barrier between iterations; results do not depend on the thread count.
+/// With `config.residual`, only nodes whose belief or incoming messages
+/// still move by epsilon or more are recomputed.
+/// All allocation happens on the calling thread, before workers start and
+/// after they finish, so `allocator` need not be thread-safe.
+pub fn runInferenceCsr(
+    snapshot: *const CsrGraph,
+    config: BPConfig,
+    allocator: std.mem.Allocator,
+) !BPResult {
+    const n = snapshot.nodeCount();
     if (n == 0) {
         return BPResult{
             .allocator = allocator,
@@ -94,110 +129,316 @@ pub fn runInference(
         };
     }
 
-    // Initialize beliefs to prior
+    var engine = try Engine.init(snapshot, config, allocator);
+    defer engine.deinit();
+    try engine.run();
+
+    const final = engine.beliefs[engine.final];
+
+    // Step 3: Convert beliefs to anomaly scores
     var beliefs = std.AutoHashMapUnmanaged(NodeId, f64){};
-    var new_beliefs = std.AutoHashMapUnmanaged(NodeId, f64){};
-    defer new_beliefs.deinit(allocator);
+    errdefer beliefs.deinit(allocator);
+    try beliefs.ensureTotalCapacity(allocator, @intCast(n));
+    var anomaly_scores = std.ArrayListUnmanaged(AnomalyScore){};
+    errdefer anomaly_scores.deinit(allocator);
 
-    for (graph.nodes.items) |node| {
-        try beliefs.put(allocator, node, config.prior);
-        try new_beliefs.put(allocator, node, config.prior);
+    for (final, 0..) |belief, v| {
+        const node = snapshot.nodeId(@intCast(v));
+        beliefs.putAssumeCapacity(node, belief);
+        const score = 1.0 - belief; // Low belief = high anomaly
+        if (score > 0.3) { // Only track notable anomalies
+            try anomaly_scores.append(allocator, .{
+                .node = node,
+                .score = score,
+                .reason = .bp_divergence,
+            });
+        }
     }
 
-    // Message storage: edge -> belief contribution
-    var messages = std.AutoHashMapUnmanaged(usize, f64){}; // edge_idx -> message
-    defer messages.deinit(allocator);
+    return BPResult{
+        .allocator = allocator,
+        .beliefs = beliefs,
+        .anomaly_scores = anomaly_scores,
+        .iterations = engine.iterations,
+        .converged = engine.converged,
+    };
+}
 
-    for (0..graph.edgeCount()) |edge_idx| {
-        try messages.put(allocator, edge_idx, config.prior);
+/// Nodes per work unit taken from the shared cursor
+const chunk_nodes = 1024;
+/// Automatic thread count keeps at least this many nodes per worker
+const min_nodes_per_thread = 16 * 1024;
+
+const lanes = std.simd.suggestVectorLength(f64) orelse 4;
+const Vec = @Vector(lanes, f64);
+
+/// Reusable thread barrier
+const Barrier = struct {
+    mutex: std.Thread.Mutex = .{},
+    cond: std.Thread.Condition = .{},
+    count: usize = 1,
+    waiting: usize = 0,
+    generation: u64 = 0,
+
+    fn wait(self: *Barrier) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const generation = self.generation;
+        self.waiting += 1;
+        if (self.waiting == self.count) {
+            self.waiting = 0;
+            self.generation +%= 1;
+            self.cond.broadcast();
+            return;
+        }
+        while (generation == self.generation) self.cond.wait(&self.mutex);
     }
+};
 
-    var iteration: usize = 0;
-    var converged = false;
-
-    while (iteration < config.max_iterations) : (iteration += 1) {
-        var max_delta: f64 = 0.0;
+const Worker = struct {
+    /// Largest belief change this iteration
+    max_delta: f64 = 0,
+    /// Scheduled any node for the next iteration
+    marked: bool = false,
+};
 
-        // Step 1: Compute messages from each edge
-        for (graph.edges.items, 0..) |edge, edge_idx| {
-            const sender_belief = beliefs.get(edge.from) orelse config.prior;
+const Engine = struct {
+    allocator: std.mem.Allocator,
+    snapshot: *const CsrGraph,
+    config: BPConfig,
 
-            // Message: sender's belief modulated by edge risk
+    /// Per incoming edge, in in-row order: dense source and risk factor
+    in_src: []DenseId,
+    in_factor: []f64,
+    /// Per incoming edge message (same order)
+    messages: []f64,
+    /// Double-buffered beliefs: iteration t reads [t % 2], writes the other
+    beliefs: [2][]f64,
+    /// Residual schedule: node must be recomputed in iteration t ([t % 2])
+    active: [2][]u8,
+
+    barrier: Barrier = .{},
+    start: std.Thread.ResetEvent = .{},
+    cursor: std.atomic.Value(usize) = std.atomic.Value(usize).init(0),
+    workers: []Worker = &.{},
+    stop: bool = false,
+
+    iterations: usize = 0,
+    converged: bool = false,
+    /// Buffer holding the final beliefs
+    final: usize = 0,
+
+    fn init(snapshot: *const CsrGraph, config: BPConfig, allocator: std.mem.Allocator) !Engine {
+        const n = snapshot.nodeCount();
+        const m = snapshot.edgeCount();
+
+        const in_src = try allocator.alloc(DenseId, m);
+        errdefer allocator.free(in_src);
+        const in_factor = try allocator.alloc(f64, m);
+        errdefer allocator.free(in_factor);
+        const messages = try allocator.alloc(f64, m);
+        errdefer allocator.free(messages);
+        const beliefs_a = try allocator.alloc(f64, n);
+        errdefer allocator.free(beliefs_a);
+        const beliefs_b = try allocator.alloc(f64, n);
+        errdefer allocator.free(beliefs_b);
+        const active_a = try allocator.alloc(u8, n);
+        errdefer allocator.free(active_a);
+        const active_b = try allocator.alloc(u8, n);
+        errdefer allocator.free(active_b);
+
+        for (snapshot.in_edges, in_src, in_factor) |slot, *src, *factor| {
+            src.* = snapshot.sources[slot];
             // High risk (negative) = low trust propagation
             // Low risk (positive) = high trust propagation
-            const risk_factor = (1.0 - @abs(edge.risk)) * @as(f64, if (edge.risk >= 0) 1.0 else 0.5);
-            const new_msg = sender_belief * risk_factor;
+            const risk = snapshot.risk[slot];
+            factor.* = (1.0 - @abs(risk)) * @as(f64, if (risk >= 0) 1.0 else 0.5);
+        }
+        @memset(messages, config.prior);
+        @memset(beliefs_a, config.prior);
+        @memset(beliefs_b, config.prior);
+        @memset(active_a, 1);
+        @memset(active_b, 0);
+
+        return .{
+            .allocator = allocator,
+            .snapshot = snapshot,
+            .config = config,
+            .in_src = in_src,
+            .in_factor = in_factor,
+            .messages = messages,
+            .beliefs = .{ beliefs_a, beliefs_b },
+            .active = .{ active_a, active_b },
+        };
+    }
+
+    fn deinit(self: *Engine) void {
+        self.allocator.free(self.active[1]);
+        self.allocator.free(self.active[0]);
+        self.allocator.free(self.beliefs[1]);
+        self.allocator.free(self.beliefs[0]);
+        self.allocator.free(self.messages);
+        self.allocator.free(self.in_factor);
+        self.allocator.free(self.in_src);
+    }
+
+    fn threadCount(self: *const Engine) usize {
+        if (builtin.single_threaded) return 1;
+        const n = self.snapshot.nodeCount();
+        const chunks = (n + chunk_nodes - 1) / chunk_nodes;
+        if (self.config.threads != 0) return @max(1, @min(self.config.threads, chunks));
+        const cpus = std.Thread.getCpuCount() catch 1;
+        return @max(1, @min(cpus, n / min_nodes_per_thread));
+    }
 
-            const old_msg = messages.get(edge_idx) orelse config.prior;
-            // Apply damping
-            const damped_msg = config.damping * old_msg + (1.0 - config.damping) * new_msg;
-            try messages.put(allocator, edge_idx, damped_msg);
+    fn run(self: *Engine) !void {
+        const wanted = self.threadCount();
+        const workers = try self.allocator.alloc(Worker, wanted);
+        defer self.allocator.free(workers);
+        for (workers) |*w| w.* = .{};
+
+        const threads = try self.allocator.alloc(std.Thread, wanted - 1);
+        defer self.allocator.free(threads);
+
+        // The calling thread is worker 0; spawn failures just mean fewer helpers
+        var spawned: usize = 0;
+        for (threads, workers[1..]) |*thread, *w| {
+            thread.* = std.Thread.spawn(.{}, Engine.work, .{ self, w }) catch break;
+            spawned += 1;
         }
+        self.workers = workers[0 .. spawned + 1];
+        self.barrier.count = spawned + 1;
+        self.start.set();
 
-        // Step 2: Update beliefs based on incoming messages
-        for (graph.nodes.items) |node| {
-            var incoming_sum: f64 = 0.0;
-            var incoming_count: usize = 0;
+        self.work(&self.workers[0]);
+        for (threads[0..spawned]) |thread| thread.join();
+    }
+
+    fn work(self: *Engine, w: *Worker) void {
+        self.start.wait();
+        const leader = w == &self.workers[0];
+        while (true) {
+            const cur = self.iterations % 2;
+            w.* = .{};
+            while (true) {
+                const chunk = self.cursor.fetchAdd(1, .monotonic);
+                const lo = chunk * chunk_nodes;
+                if (lo >= self.beliefs[0].len) break;
+                self.sweep(w, cur, lo, @min(lo + chunk_nodes, self.beliefs[0].len));
+            }
 
-            // Find all edges TO this node
-            for (graph.edges.items, 0..) |edge, edge_idx| {
-                if (edge.to == node) {
-                    incoming_sum += messages.get(edge_idx) orelse config.prior;
-                    incoming_count += 1;
+            self.barrier.wait();
+            if (leader) self.finishIteration(cur);
+            self.barrier.wait();
+            if (self.stop) return;
+        }
+    }
+
+    /// Leader only, between barriers
+    fn finishIteration(self: *Engine, cur: usize) void {
+        var max_delta: f64 = 0;
+        var marked = false;
+        for (self.workers) |w| {
+            max_delta = @max(max_delta, w.max_delta);
+            marked = marked or w.marked;
+        }
+
+        self.iterations += 1;
+        self.final = 1 - cur;
+        self.cursor.store(0, .monotonic);
+
+        // Check convergence
+        self.converged = if (self.config.residual) !marked else max_delta < self.config.epsilon;
+        self.stop = self.converged or self.iterations >= self.config.max_iterations;
+    }
+
+    fn sweep(self: *Engine, w: *Worker, cur: usize, lo: usize, hi: usize) void {
+        const cur_b = self.beliefs[cur];
+        const next_b = self.beliefs[1 - cur];
+        const residual = self.config.residual;
+        const eps = self.config.epsilon;
+        const damping = self.config.damping;
+
+        for (lo..hi) |v| {
+            if (residual) {
+                if (@atomicLoad(u8, &self.active[cur][v], .monotonic) == 0) {
+                    next_b[v] = cur_b[v];
+                    continue;
                 }
+                @atomicStore(u8, &self.active[cur][v], 0, .monotonic);
             }
 
-            const old_belief = beliefs.get(node) orelse config.prior;
-            const new_belief = if (incoming_count > 0)
-                incoming_sum / @as(f64, @floatFromInt(incoming_count))
+            const in_r = self.snapshot.inEdges(@intCast(v));
+            var msg_residual: f64 = 0;
+            const sum = self.pullMessages(cur_b, in_r.start, in_r.end, &msg_residual);
+
+            const old_belief = cur_b[v];
+            const new_belief = if (in_r.len() > 0)
+                sum / @as(f64, @floatFromInt(in_r.len()))
             else
-                config.prior;
+                self.config.prior;
 
-            // Apply damping
-            const damped_belief = config.damping * old_belief + (1.0 - config.damping) * new_belief;
-            // Clamp to [0, 1]
+            // Apply damping, clamp to [0, 1]
+            const damped_belief = damping * old_belief + (1.0 - damping) * new_belief;
             const clamped_belief = @max(0.0, @min(1.0, damped_belief));
-            try new_beliefs.put(allocator, node, clamped_belief);
+            next_b[v] = clamped_belief;
 
             const delta = @abs(clamped_belief - old_belief);
-            max_delta = @max(max_delta, delta);
+            w.max_delta = @max(w.max_delta, delta);
+
+            if (!residual) continue;
+            if (delta >= eps) {
+                // Our belief feeds every out-neighbor's messages
+                self.schedule(1 - cur, @intCast(v));
+                const out_r = self.snapshot.outEdges(@intCast(v));
+                for (self.snapshot.targets[out_r.start..out_r.end]) |t| self.schedule(1 - cur, t);
+                w.marked = true;
+            } else if (msg_residual >= eps) {
+                self.schedule(1 - cur, @intCast(v));
+                w.marked = true;
+            }
         }
+    }
 
-        // Copy new beliefs to beliefs
-        var it = new_beliefs.iterator();
-        while (it.next()) |entry| {
-            try beliefs.put(allocator, entry.key_ptr.*, entry.value_ptr.*);
-        }
+    fn schedule(self: *Engine, next: usize, v: DenseId) void {
+        @atomicStore(u8, &self.active[next][v], 1, .monotonic);
+    }
 
-        // Check convergence
-        if (max_delta < config.epsilon) {
-            converged = true;
-            break;
+    /// Update in-edge messages [start, end) from source beliefs `b`.
+    /// Returns their sum; `max_residual` gets the largest message change.
+    fn pullMessages(self: *Engine, b: []const f64, start: u32, end: u32, max_residual: *f64) f64 {
+        const keep: Vec = @splat(self.config.damping);
+        const take: Vec = @splat(1.0 - self.config.damping);
+
+        var acc: Vec = @splat(0);
+        var res: Vec = @splat(0);
+        var k: usize = start;
+        while (k + lanes <= end) : (k += lanes) {
+            var src: Vec = undefined;
+            inline for (0..lanes) |j| src[j] = b[self.in_src[k + j]];
+            const old: Vec = self.messages[k..][0..lanes].*;
+            const factor: Vec = self.in_factor[k..][0..lanes].*;
+            // Message: sender's belief modulated by edge risk, damped
+            const msg = keep * old + take * (src * factor);
+            self.messages[k..][0..lanes].* = msg;
+            acc += msg;
+            res = @max(res, @abs(msg - old));
         }
-    }
 
-    // Step 3: Convert beliefs to anomaly scores
-    var anomaly_scores = std.ArrayListUnmanaged(AnomalyScore){};
-    for (graph.nodes.items) |node| {
-        const belief = beliefs.get(node) orelse config.prior;
-        const score = 1.0 - belief; // Low belief = high anomaly
-        if (score > 0.3) { // Only track notable anomalies
-            try anomaly_scores.append(allocator, .{
-                .node = node,
-                .score = score,
-                .reason = .bp_divergence,
-            });
+        var sum = @reduce(.Add, acc);
+        var residual = @reduce(.Max, res);
+        while (k < end) : (k += 1) {
+            const old = self.messages[k];
+            const msg = self.config.damping * old + (1.0 - self.config.damping) * (b[self.in_src[k]] * self.in_factor[k]);
+            self.messages[k] = msg;
+            sum += msg;
+            residual = @max(residual, @abs(msg - old));
         }
+        max_residual.* = residual;
+        return sum;
     }
-
-    return BPResult{
-        .allocator = allocator,
-        .beliefs = beliefs,
-        .anomaly_scores = anomaly_scores,
-        .iterations = iteration,
-        .converged = converged,
-    };
-}
+};
 
 /// Update edge risks in graph based on BP beliefs.
 /// This feeds BP output into Bellman-Ford for "probabilistic betrayal detection".
@@ -205,7 +446,8 @@ pub fn updateGraphFromBP(
     graph: *RiskGraph,
     result: *const BPResult,
 ) void {
-    for (graph.edges.items) |*edge| {
+    for (graph.edges.items, 0..) |*edge, edge_idx| {
+        if (!graph.isLive(edge_idx)) continue;
         const from_belief = result.beliefs.get(edge.from) orelse 0.5;
         const to_belief = result.beliefs.get(edge.to) orelse 0.5;
 
@@ -276,3 +518,44 @@ test "BP: Empty graph" {
     try std.testing.expect(result.converged);
     try std.testing.expectEqual(result.iterations, 0);
 }
+
+fn testEdge(from: NodeId, to: NodeId, risk: f64) RiskEdge {
+    const ts = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+    return .{ .from = from, .to = to, .risk = risk, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts };
+}
+
+test "BP: threads and residual scheduling agree with the full sweep" {
+    const allocator = std.testing.allocator;
+    var graph = types.RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    var prng = std.Random.DefaultPrng.init(0xB9);
+    const random = prng.random();
+    const n = 3000;
+    for (0..n) |i| try graph.addNode(@intCast(i));
+    for (0..4 * n) |_| {
+        const from = random.uintLessThan(NodeId, n);
+        const to = random.uintLessThan(NodeId, n);
+        try graph.addEdge(testEdge(from, to, random.float(f64) * 2.0 - 1.0));
+    }
+
+    var snapshot = try CsrGraph.fromRiskGraph(&graph, allocator);
+    defer snapshot.deinit();
+
+    const eps = 1e-9;
+    var full = try runInferenceCsr(&snapshot, .{ .epsilon = eps, .residual = false, .max_iterations = 500 }, allocator);
+    defer full.deinit();
+    var single = try runInferenceCsr(&snapshot, .{ .epsilon = eps, .max_iterations = 500 }, allocator);
+    defer single.deinit();
+    var parallel = try runInferenceCsr(&snapshot, .{ .epsilon = eps, .max_iterations = 500, .threads = 3 }, allocator);
+    defer parallel.deinit();
+
+    try std.testing.expect(full.converged and single.converged and parallel.converged);
+    try std.testing.expectEqual(single.iterations, parallel.iterations);
+    for (0..n) |i| {
+        const node: NodeId = @intCast(i);
+        // Same schedule, same arithmetic: bit-identical across thread counts
+        try std.testing.expectEqual(single.beliefs.get(node).?, parallel.beliefs.get(node).?);
+        try std.testing.expectApproxEqAbs(full.beliefs.get(node).?, single.beliefs.get(node).?, 1e-6);
+    }
+}
@@ -1,9 +1,9 @@
 //! QVL Integration Layer
 //! 
-//! Bridges PersistentGraph (libmdbx) with in-memory algorithms:
-//! - Load RiskGraph from disk for computation
-//! - Save results back to persistent storage
-//! - Hybrid: Cold data on disk, hot data in memory
+//! Runs the in-memory algorithms over a PersistentGraph:
+//! - The store keeps its RiskGraph live, so algorithms borrow it directly
+//! - Mutations go through the store (edge log)
+//! - save() folds the log into a new checkpoint
 
 const std = @import("std");
 const types = @import("types.zig");
@@ -19,11 +19,9 @@ const PersistentGraph = storage.PersistentGraph;
 const BellmanFordResult = betrayal.BellmanFordResult;
 const PathResult = pathfinding.PathResult;
 
-/// Hybrid graph: persistent backing + in-memory cache
+/// Hybrid graph: persistent backing, algorithms on the live graph
 pub const HybridGraph = struct {
     persistent: *PersistentGraph,
-    cache: RiskGraph,
-    cache_valid: bool,
     allocator: std.mem.Allocator,
     
     const Self = @This();
@@ -32,54 +30,34 @@ pub const HybridGraph = struct {
     pub fn init(persistent: *PersistentGraph, allocator: std.mem.Allocator) Self {
         return Self{
             .persistent = persistent,
-            .cache = RiskGraph.init(allocator),
-            .cache_valid = false,
             .allocator = allocator,
         };
     }
     
-    /// Deinitialize
+    /// Deinitialize (the store stays open)
     pub fn deinit(self: *Self) void {
-        self.cache.deinit();
-    }
-    
-    /// Load from persistent storage into cache
-    pub fn load(self: *Self) !void {
-        if (self.cache_valid) return; // Already loaded
-        
-        // Clear existing cache
-        self.cache.deinit();
-        self.cache = try self.persistent.toRiskGraph(self.allocator);
-        self.cache_valid = true;
+        _ = self;
     }
     
-    /// Save cache back to persistent storage
+    /// Checkpoint the store: reopening rebuilds the graph from the
+    /// checkpoint columns and has no log to replay
     pub fn save(self: *Self) !void {
-        // TODO: Implement incremental save (only changed edges)
-        // For now, full rewrite
-        _ = self;
+        try self.persistent.checkpoint();
     }
     
-    /// Add edge: both cache and persistent
+    /// Add edge (logged by the store)
     pub fn addEdge(self: *Self, edge: RiskEdge) !void {
-        // Add to persistent storage
         try self.persistent.addEdge(edge);
-        
-        // Add to cache if loaded
-        if (self.cache_valid) {
-            try self.cache.addEdge(edge);
-        }
     }
     
-    /// Get outgoing neighbors (uses cache if available)
+    /// Add a batch of edges with one log write
+    pub fn addEdges(self: *Self, batch: []const RiskEdge) !void {
+        try self.persistent.addEdges(batch);
+    }
+    
+    /// Get outgoing edge indices
     pub fn getOutgoing(self: *Self, node: NodeId) ![]const usize {
-        if (self.cache_valid) {
-            return self.cache.neighbors(node);
-        } else {
-            // Ensure cache is loaded, then return neighbors
-            try self.load();
-            return self.cache.neighbors(node);
-        }
+        return self.persistent.graph.neighbors(node);
     }
     
     // =========================================================================
@@ -88,8 +66,7 @@ pub const HybridGraph = struct {
     
     /// Run Bellman-Ford betrayal detection on persistent graph
     pub fn detectBetrayal(self: *Self, source: NodeId) !BellmanFordResult {
-        try self.load(); // Ensure cache is ready
-        return betrayal.detectBetrayal(&self.cache, source, self.allocator);
+        return betrayal.detectBetrayal(&self.persistent.graph, source, self.allocator);
     }
     
     /// Find trust path using A*
@@ -100,9 +77,8 @@ pub const HybridGraph = struct {
         heuristic: pathfinding.HeuristicFn,
         heuristic_ctx: *const anyopaque,
     ) !PathResult {
-        try self.load();
         return pathfinding.findTrustPath(
-            &self.cache, source, target, heuristic, heuristic_ctx, self.allocator);
+            &self.persistent.graph, source, target, heuristic, heuristic_ctx, self.allocator);
     }
     
     /// Verify Proof-of-Path and update reputation
@@ -130,17 +106,11 @@ pub const HybridGraph = struct {
     // =========================================================================
     
     pub fn nodeCount(self: *Self) usize {
-        if (self.cache_valid) {
-            return self.cache.nodeCount();
-        }
-        return 0; // TODO: Query from persistent
+        return self.persistent.graph.nodeCount();
     }
     
     pub fn edgeCount(self: *Self) usize {
-        if (self.cache_valid) {
-            return self.cache.edgeCount();
-        }
-        return 0; // TODO: Query from persistent
+        return self.persistent.graph.edgeCount();
     }
 };
 
@@ -169,10 +139,8 @@ pub const GraphTransaction = struct {
     }
     
     pub fn commit(self: *Self) !void {
-        // Add all pending edges atomically
-        for (self.pending_edges.items) |edge| {
-            try self.hybrid.addEdge(edge);
-        }
+        // One log write: all pending edges or none
+        try self.hybrid.addEdges(self.pending_edges.items);
         self.pending_edges.clearRetainingCapacity();
     }
     
@@ -189,8 +157,10 @@ test "HybridGraph: load and detect betrayal" {
     const allocator = std.testing.allocator;
     const time = @import("time");
     
-    const path = "/tmp/test_hybrid_db";
-    defer std.fs.deleteFileAbsolute(path) catch {};
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const path = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(path);
     
     // Create persistent graph
     var persistent = try PersistentGraph.open(path, .{}, allocator);
@@ -221,8 +191,10 @@ test "GraphTransaction: commit and rollback" {
     const allocator = std.testing.allocator;
     const time = @import("time");
     
-    const path = "/tmp/test_tx_db";
-    defer std.fs.deleteFileAbsolute(path) catch {};
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const path = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(path);
     
     var persistent = try PersistentGraph.open(path, .{}, allocator);
     defer persistent.close();
@@ -244,6 +216,11 @@ test "GraphTransaction: commit and rollback" {
     try txn.commit();
     
     // Verify edges exist
-    try hybrid.load();
+    try std.testing.expectEqual(hybrid.edgeCount(), 2);
+    
+    // Rolled-back edges never reach the store
+    try txn.addEdge(.{ .from = 2, .to = 3, .risk = -0.3, .timestamp = ts, .nonce = 2, .level = 3, .expires_at = expires });
+    txn.rollback();
+    try txn.commit();
     try std.testing.expectEqual(hybrid.edgeCount(), 2);
 }
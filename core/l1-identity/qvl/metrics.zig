@@ -0,0 +1,222 @@
+//! Low-overhead counters and latency histograms
+//!
+//! Histograms bucket nanosecond durations by powers of two, so recording
+//! is a few relaxed atomic adds and reported percentiles are the upper
+//! bound of their bucket (within 2x, capped at the observed maximum).
+//! Everything can be read while other threads record.
+
+const std = @import("std");
+
+const Counter = std.atomic.Value(u64);
+
+/// Aggregates of one histogram, as reported to callers
+pub const Summary = struct {
+    calls: u64 = 0,
+    total_ns: u64 = 0,
+    max_ns: u64 = 0,
+    p50_ns: u64 = 0,
+    p99_ns: u64 = 0,
+};
+
+pub const Histogram = struct {
+    /// Bucket b counts durations in [2^(b-1), 2^b); bucket 0 is 0ns
+    pub const bucket_count = 64;
+
+    buckets: [bucket_count]Counter = [_]Counter{.init(0)} ** bucket_count,
+    sum_ns: Counter = .init(0),
+    max_ns: Counter = .init(0),
+
+    pub fn record(self: *Histogram, ns: u64) void {
+        const bucket = @min(@as(usize, 64 - @clz(ns)), bucket_count - 1);
+        _ = self.buckets[bucket].fetchAdd(1, .monotonic);
+        _ = self.sum_ns.fetchAdd(ns, .monotonic);
+        _ = self.max_ns.fetchMax(ns, .monotonic);
+    }
+
+    pub fn summary(self: *const Histogram) Summary {
+        var counts: [bucket_count]u64 = undefined;
+        var total: u64 = 0;
+        for (&counts, &self.buckets) |*count, *bucket| {
+            count.* = bucket.load(.monotonic);
+            total += count.*;
+        }
+        const max = self.max_ns.load(.monotonic);
+        return .{
+            .calls = total,
+            .total_ns = self.sum_ns.load(.monotonic),
+            .max_ns = max,
+            .p50_ns = @min(quantile(&counts, total, 50), max),
+            .p99_ns = @min(quantile(&counts, total, 99), max),
+        };
+    }
+
+    fn quantile(counts: *const [bucket_count]u64, total: u64, percent: u64) u64 {
+        if (total == 0) return 0;
+        const rank = (total * percent + 99) / 100;
+        var seen: u64 = 0;
+        for (counts, 0..) |count, bucket| {
+            seen += count;
+            if (seen >= rank) return upperBound(bucket);
+        }
+        return upperBound(bucket_count - 1);
+    }
+
+    fn upperBound(bucket: usize) u64 {
+        if (bucket == 0) return 0;
+        if (bucket == bucket_count - 1) return std.math.maxInt(u64);
+        return (@as(u64, 1) << @intCast(bucket)) - 1;
+    }
+};
+
+/// Measures one call; `end` records the elapsed time
+pub const Span = struct {
+    histogram: *Histogram,
+    started: ?std.time.Instant,
+
+    pub fn end(self: Span) void {
+        const started = self.started orelse return;
+        const now = std.time.Instant.now() catch return;
+        self.histogram.record(now.since(started));
+    }
+};
+
+/// One latency histogram per value of the `Stage` enum
+pub fn StageStats(comptime Stage: type) type {
+    return struct {
+        const Self = @This();
+
+        stages: std.EnumArray(Stage, Histogram) = .initFill(.{}),
+
+        /// `const span = stats.start(.stage); defer span.end();`
+        pub fn start(self: *Self, stage: Stage) Span {
+            return .{
+                .histogram = self.stages.getPtr(stage),
+                .started = std.time.Instant.now() catch null,
+            };
+        }
+
+        pub fn record(self: *Self, stage: Stage, ns: u64) void {
+            self.stages.getPtr(stage).record(ns);
+        }
+
+        pub fn summary(self: *const Self, stage: Stage) Summary {
+            return self.stages.getPtrConst(stage).summary();
+        }
+    };
+}
+
+/// Heap traffic seen by a CountingAllocator
+pub const AllocStats = struct {
+    allocations: u64,
+    frees: u64,
+    /// Cumulative bytes handed out (including growth in place)
+    bytes_allocated: u64,
+    live_bytes: u64,
+};
+
+/// Counts calls and bytes going to `child` (thread-safe if `child` is)
+pub const CountingAllocator = struct {
+    child: std.mem.Allocator,
+    allocations: Counter = .init(0),
+    frees: Counter = .init(0),
+    bytes_allocated: Counter = .init(0),
+    live_bytes: Counter = .init(0),
+
+    pub fn allocator(self: *CountingAllocator) std.mem.Allocator {
+        return .{
+            .ptr = self,
+            .vtable = &.{
+                .alloc = alloc,
+                .resize = resize,
+                .remap = remap,
+                .free = free,
+            },
+        };
+    }
+
+    pub fn stats(self: *const CountingAllocator) AllocStats {
+        return .{
+            .allocations = self.allocations.load(.monotonic),
+            .frees = self.frees.load(.monotonic),
+            .bytes_allocated = self.bytes_allocated.load(.monotonic),
+            .live_bytes = self.live_bytes.load(.monotonic),
+        };
+    }
+
+    fn alloc(ptr: *anyopaque, len: usize, alignment: std.mem.Alignment, ret_addr: usize) ?[*]u8 {
+        const self: *CountingAllocator = @ptrCast(@alignCast(ptr));
+        const mem = self.child.rawAlloc(len, alignment, ret_addr) orelse return null;
+        _ = self.allocations.fetchAdd(1, .monotonic);
+        self.grow(0, len);
+        return mem;
+    }
+
+    fn resize(ptr: *anyopaque, memory: []u8, alignment: std.mem.Alignment, new_len: usize, ret_addr: usize) bool {
+        const self: *CountingAllocator = @ptrCast(@alignCast(ptr));
+        if (!self.child.rawResize(memory, alignment, new_len, ret_addr)) return false;
+        self.grow(memory.len, new_len);
+        return true;
+    }
+
+    fn remap(ptr: *anyopaque, memory: []u8, alignment: std.mem.Alignment, new_len: usize, ret_addr: usize) ?[*]u8 {
+        const self: *CountingAllocator = @ptrCast(@alignCast(ptr));
+        const mem = self.child.rawRemap(memory, alignment, new_len, ret_addr) orelse return null;
+        self.grow(memory.len, new_len);
+        return mem;
+    }
+
+    fn free(ptr: *anyopaque, memory: []u8, alignment: std.mem.Alignment, ret_addr: usize) void {
+        const self: *CountingAllocator = @ptrCast(@alignCast(ptr));
+        self.child.rawFree(memory, alignment, ret_addr);
+        _ = self.frees.fetchAdd(1, .monotonic);
+        _ = self.live_bytes.fetchSub(memory.len, .monotonic);
+    }
+
+    fn grow(self: *CountingAllocator, old_len: usize, new_len: usize) void {
+        if (new_len >= old_len) {
+            _ = self.bytes_allocated.fetchAdd(new_len - old_len, .monotonic);
+            _ = self.live_bytes.fetchAdd(new_len - old_len, .monotonic);
+        } else {
+            _ = self.live_bytes.fetchSub(old_len - new_len, .monotonic);
+        }
+    }
+};
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+test "Histogram percentiles stay within their bucket" {
+    var hist = Histogram{};
+    for (0..98) |_| hist.record(1000);
+    hist.record(50_000);
+    hist.record(2_000_000);
+
+    const s = hist.summary();
+    try std.testing.expectEqual(@as(u64, 100), s.calls);
+    try std.testing.expectEqual(@as(u64, 98 * 1000 + 50_000 + 2_000_000), s.total_ns);
+    try std.testing.expectEqual(@as(u64, 2_000_000), s.max_ns);
+    // 1000ns lands in [512, 1024)
+    try std.testing.expectEqual(@as(u64, 1023), s.p50_ns);
+    try std.testing.expect(s.p99_ns >= 50_000 and s.p99_ns < 2 * 50_000);
+
+    const empty = (Histogram{}).summary();
+    try std.testing.expectEqual(@as(u64, 0), empty.p99_ns);
+}
+
+test "CountingAllocator tracks calls and live bytes" {
+    var counting = CountingAllocator{ .child = std.testing.allocator };
+    const allocator = counting.allocator();
+
+    const a = try allocator.alloc(u8, 100);
+    var b = try allocator.alloc(u32, 10);
+    b = try allocator.realloc(b, 20);
+    allocator.free(a);
+
+    const s = counting.stats();
+    try std.testing.expect(s.allocations >= 2);
+    try std.testing.expectEqual(@as(u64, 80), s.live_bytes);
+    try std.testing.expect(s.bytes_allocated >= 100 + 80);
+    allocator.free(b);
+    try std.testing.expectEqual(@as(u64, 0), counting.stats().live_bytes);
+}
@@ -9,10 +9,13 @@
 const std = @import("std");
 const time = @import("time");
 const types = @import("types.zig");
+const csr_mod = @import("csr.zig");
 
 const NodeId = types.NodeId;
 const RiskGraph = types.RiskGraph;
 const RiskEdge = types.RiskEdge;
+const CsrGraph = csr_mod.CsrGraph;
+const DenseId = csr_mod.DenseId;
 
 /// A* search node with priority scoring.
 const AStarNode = struct {
@@ -153,6 +156,100 @@ pub fn findTrustPath(
     };
 }
 
+/// A* over a frozen CSR snapshot.
+/// Same contract as `findTrustPath`, but g-scores, predecessors and the
+/// closed set are dense arrays indexed by `DenseId`, and neighbor expansion
+/// is a contiguous scan of `targets`/`risk` instead of a hash lookup per edge.
+pub fn findTrustPathCsr(
+    graph: *const CsrGraph,
+    source: NodeId,
+    target: NodeId,
+    heuristic: HeuristicFn,
+    heuristic_ctx: *const anyopaque,
+    allocator: std.mem.Allocator,
+) !PathResult {
+    if (source == target) {
+        const path = try allocator.alloc(NodeId, 1);
+        path[0] = source;
+        return PathResult{
+            .allocator = allocator,
+            .path = path,
+            .total_cost = 0.0,
+        };
+    }
+
+    const no_path = PathResult{
+        .allocator = allocator,
+        .path = null,
+        .total_cost = std.math.inf(f64),
+    };
+    const src = graph.denseIndex(source) orelse return no_path;
+    const dst = graph.denseIndex(target) orelse return no_path;
+
+    const n = graph.nodeCount();
+    const g_score = try allocator.alloc(f64, n);
+    defer allocator.free(g_score);
+    @memset(g_score, std.math.inf(f64));
+
+    const came_from = try allocator.alloc(DenseId, n);
+    defer allocator.free(came_from);
+    @memset(came_from, csr_mod.no_node);
+
+    var closed = try std.DynamicBitSetUnmanaged.initEmpty(allocator, n);
+    defer closed.deinit(allocator);
+
+    var open_set = std.PriorityQueue(AStarNode, void, AStarNode.lessThan).init(allocator, {});
+    defer open_set.deinit();
+
+    g_score[src] = 0.0;
+    try open_set.add(.{ .id = src, .g_score = 0.0, .f_score = heuristic(source, target, heuristic_ctx) });
+
+    while (open_set.count() > 0) {
+        const current = open_set.remove();
+        const u: DenseId = current.id;
+
+        if (u == dst) {
+            var hops: usize = 1;
+            var walk = u;
+            while (came_from[walk] != csr_mod.no_node) : (hops += 1) walk = came_from[walk];
+
+            const path = try allocator.alloc(NodeId, hops);
+            walk = u;
+            var i = hops;
+            while (i > 0) {
+                i -= 1;
+                path[i] = graph.nodeId(walk);
+                walk = came_from[walk];
+            }
+            return PathResult{
+                .allocator = allocator,
+                .path = path,
+                .total_cost = current.g_score,
+            };
+        }
+
+        if (closed.isSet(u)) continue;
+        closed.set(u);
+
+        const row = graph.outEdges(u);
+        for (row.start..row.end) |slot| {
+            const v = graph.targets[slot];
+            if (closed.isSet(v)) continue;
+
+            const tentative_g = g_score[u] + graph.risk[slot];
+            if (tentative_g < g_score[v]) {
+                came_from[v] = u;
+                g_score[v] = tentative_g;
+
+                const h = heuristic(graph.nodeId(v), target, heuristic_ctx);
+                try open_set.add(.{ .id = v, .g_score = tentative_g, .f_score = tentative_g + h });
+            }
+        }
+    }
+
+    return no_path;
+}
+
 fn reconstructPath(
     target: NodeId,
     came_from: *std.AutoHashMapUnmanaged(NodeId, NodeId),
@@ -256,3 +353,35 @@ test "A* Pathfinding: Multiple paths, chooses shortest" {
     try std.testing.expectEqual(result.pathLength(), 2); // Direct path
     try std.testing.expectApproxEqAbs(result.total_cost, 0.5, 0.001);
 }
+
+test "A* Pathfinding (CSR): matches hash-map engine" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    // A -> B -> C (cost 0.8), A -> C directly (cost 0.5), D isolated
+    try graph.addNode(10);
+    try graph.addNode(20);
+    try graph.addNode(30);
+    try graph.addNode(40);
+
+    try graph.addEdge(.{ .from = 10, .to = 20, .risk = 0.4, .timestamp = time.SovereignTimestamp.fromSeconds(0, .system_boot), .nonce = 0, .level = 3, .expires_at = time.SovereignTimestamp.fromSeconds(0, .system_boot) });
+    try graph.addEdge(.{ .from = 20, .to = 30, .risk = 0.4, .timestamp = time.SovereignTimestamp.fromSeconds(0, .system_boot), .nonce = 0, .level = 3, .expires_at = time.SovereignTimestamp.fromSeconds(0, .system_boot) });
+    try graph.addEdge(.{ .from = 10, .to = 30, .risk = 0.5, .timestamp = time.SovereignTimestamp.fromSeconds(0, .system_boot), .nonce = 0, .level = 3, .expires_at = time.SovereignTimestamp.fromSeconds(0, .system_boot) });
+
+    var csr = try CsrGraph.fromRiskGraph(&graph, allocator);
+    defer csr.deinit();
+
+    const dummy_ctx: u8 = 0;
+    var result = try findTrustPathCsr(&csr, 10, 30, zeroHeuristic, @ptrCast(&dummy_ctx), allocator);
+    defer result.deinit();
+
+    try std.testing.expectEqual(@as(usize, 2), result.pathLength());
+    try std.testing.expectEqual(@as(NodeId, 10), result.path.?[0]);
+    try std.testing.expectEqual(@as(NodeId, 30), result.path.?[1]);
+    try std.testing.expectApproxEqAbs(result.total_cost, 0.5, 0.001);
+
+    var none = try findTrustPathCsr(&csr, 10, 40, zeroHeuristic, @ptrCast(&dummy_ctx), allocator);
+    defer none.deinit();
+    try std.testing.expect(none.path == null);
+}
@@ -0,0 +1,158 @@
+//! RFC-0120 Extension: Proof-of-Path Verdict Cache
+//!
+//! Relays verify the same sender->receiver proofs over and over. Verdicts
+//! are a pure function of (proof bytes, endpoints, trust graph), so they
+//! are memoized in a fixed-size direct-mapped table:
+//! - Key: BLAKE3 over proof bytes + receiver + sender (collision-resistant,
+//!   a forged proof cannot alias a cached `valid`)
+//! - Tag: `CompactTrustGraph.version` at verification time; any edge grant
+//!   or revocation bumps it, so stale verdicts never hit
+//! - `valid` hits re-check the proof expiry against the current time
+//!
+//! No allocation after `init`; a colliding insert simply replaces the slot.
+
+const std = @import("std");
+const time = @import("time");
+const pop = @import("../proof_of_path.zig");
+
+const PathVerdict = pop.PathVerdict;
+const SovereignTimestamp = time.SovereignTimestamp;
+const Blake3 = std.crypto.hash.Blake3;
+
+pub const PopVerifyCache = struct {
+    allocator: std.mem.Allocator,
+    /// Power-of-two slot table
+    entries: []Entry,
+    /// Bumped by `invalidateAll`; entries from older generations never hit
+    generation: u32,
+    stats: Stats,
+
+    pub const default_capacity: usize = 4096;
+
+    pub const Key = [32]u8;
+
+    const Entry = struct {
+        key: Key,
+        graph_version: u64,
+        /// 0 = empty slot
+        generation: u32,
+        verdict: PathVerdict,
+        expires_at: SovereignTimestamp,
+    };
+
+    pub const Stats = struct {
+        hits: u64 = 0,
+        misses: u64 = 0,
+    };
+
+    pub fn init(allocator: std.mem.Allocator, capacity: usize) !PopVerifyCache {
+        const slots = std.math.ceilPowerOfTwo(usize, @max(capacity, 1)) catch return error.OutOfMemory;
+        const entries = try allocator.alloc(Entry, slots);
+        for (entries) |*e| e.generation = 0;
+        return .{
+            .allocator = allocator,
+            .entries = entries,
+            .generation = 1,
+            .stats = .{},
+        };
+    }
+
+    pub fn deinit(self: *PopVerifyCache) void {
+        self.allocator.free(self.entries);
+    }
+
+    /// Cache key for one verification request
+    pub fn keyFor(proof_bytes: []const u8, receiver: [32]u8, sender: [32]u8) Key {
+        var hasher = Blake3.init(.{});
+        hasher.update(&receiver);
+        hasher.update(&sender);
+        hasher.update(proof_bytes);
+        var key: Key = undefined;
+        hasher.final(&key);
+        return key;
+    }
+
+    /// Cached verdict for `key` under `graph_version`, if still current
+    pub fn lookup(self: *PopVerifyCache, key: Key, graph_version: u64, now: SovereignTimestamp) ?PathVerdict {
+        const entry = &self.entries[self.slot(key)];
+        if (entry.generation != self.generation or
+            entry.graph_version != graph_version or
+            !std.mem.eql(u8, &entry.key, &key))
+        {
+            self.stats.misses += 1;
+            return null;
+        }
+
+        self.stats.hits += 1;
+        if (entry.verdict == .valid and entry.expires_at.isBefore(now)) {
+            entry.verdict = .expired; // expiry is permanent
+        }
+        return entry.verdict;
+    }
+
+    pub fn insert(
+        self: *PopVerifyCache,
+        key: Key,
+        graph_version: u64,
+        verdict: PathVerdict,
+        expires_at: SovereignTimestamp,
+    ) void {
+        self.entries[self.slot(key)] = .{
+            .key = key,
+            .graph_version = graph_version,
+            .generation = self.generation,
+            .verdict = verdict,
+            .expires_at = expires_at,
+        };
+    }
+
+    /// Drop every entry in O(1) (e.g. after a slashing revocation)
+    pub fn invalidateAll(self: *PopVerifyCache) void {
+        self.generation +%= 1;
+        if (self.generation == 0) {
+            for (self.entries) |*e| e.generation = 0;
+            self.generation = 1;
+        }
+    }
+
+    fn slot(self: *const PopVerifyCache, key: Key) usize {
+        return std.mem.readInt(u64, key[0..8], .little) & (self.entries.len - 1);
+    }
+};
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+test "PopVerifyCache: hit, version miss, expiry and invalidation" {
+    const allocator = std.testing.allocator;
+    var cache = try PopVerifyCache.init(allocator, 8);
+    defer cache.deinit();
+
+    var did_a: [32]u8 = undefined;
+    @memset(&did_a, 0xAA);
+    var did_b: [32]u8 = undefined;
+    @memset(&did_b, 0xBB);
+
+    const bytes = "proof-bytes";
+    const key = PopVerifyCache.keyFor(bytes, did_a, did_b);
+    // Endpoints are part of the key
+    try std.testing.expect(!std.mem.eql(u8, &key, &PopVerifyCache.keyFor(bytes, did_b, did_a)));
+
+    const now = SovereignTimestamp.fromSeconds(100, .system_boot);
+    const later = SovereignTimestamp.fromSeconds(200, .system_boot);
+
+    try std.testing.expect(cache.lookup(key, 1, now) == null);
+    cache.insert(key, 1, .valid, SovereignTimestamp.fromSeconds(150, .system_boot));
+    try std.testing.expectEqual(PathVerdict.valid, cache.lookup(key, 1, now).?);
+
+    // Graph changed since verification
+    try std.testing.expect(cache.lookup(key, 2, now) == null);
+
+    // Valid verdict ages into expired
+    try std.testing.expectEqual(PathVerdict.expired, cache.lookup(key, 1, later).?);
+
+    cache.invalidateAll();
+    try std.testing.expect(cache.lookup(key, 1, now) == null);
+    try std.testing.expectEqual(@as(u64, 2), cache.stats.hits);
+}
@@ -100,6 +100,15 @@ pub const ReputationMap = struct {
         self.scores.deinit(self.allocator);
     }
 
+    /// Deep copy (used to freeze a read-only snapshot for concurrent readers)
+    pub fn clone(self: *const ReputationMap, allocator: std.mem.Allocator) !ReputationMap {
+        return .{
+            .allocator = allocator,
+            .scores = try self.scores.clone(allocator),
+            .decay_half_life = self.decay_half_life,
+        };
+    }
+
     /// Get reputation score for a node (default: 0.5 if unknown).
     pub fn get(self: *const ReputationMap, node: NodeId) f64 {
         if (self.scores.get(node)) |score| {
@@ -0,0 +1,280 @@
+//! RFC-0120 Extension: Read-Copy-Update Graph Snapshots
+//!
+//! Lets many reader threads query QVL state while a writer mutates it:
+//! - The writer mutates the live `RiskGraph`/`CompactTrustGraph` under its
+//!   own lock, then freezes an immutable `GraphSnapshot` and publishes it
+//!   with a single atomic pointer swap.
+//! - Readers `acquire` the current snapshot without taking any lock
+//!   (two atomic increments), query it for as long as they like, and
+//!   `release` it. The last release frees a superseded snapshot.
+//!
+//! Grace period: a reader announces itself on one of two in-flight counters
+//! (selected by epoch parity) and re-checks the epoch before loading the
+//! pointer. After swapping, the writer flips the epoch and waits only for
+//! the old-parity counter to drain, so a steady stream of new readers
+//! cannot starve it.
+
+const std = @import("std");
+const time = @import("time");
+const types = @import("types.zig");
+const csr_mod = @import("csr.zig");
+const pop_integration = @import("pop_integration.zig");
+const trust_graph = @import("../trust_graph.zig");
+
+const RiskGraph = types.RiskGraph;
+const CsrGraph = csr_mod.CsrGraph;
+const ReputationMap = pop_integration.ReputationMap;
+const CompactTrustGraph = trust_graph.CompactTrustGraph;
+
+/// Keeps a snapshot's allocator alive until the snapshot is freed (e.g. a
+/// refcounted heap that may outlive the context that published it)
+pub const Holder = struct {
+    ptr: *anyopaque,
+    retain: *const fn (*anyopaque) void,
+    release: *const fn (*anyopaque) void,
+};
+
+/// Immutable, reference-counted view of QVL state at one version.
+pub const GraphSnapshot = struct {
+    allocator: std.mem.Allocator,
+    /// Released after the snapshot's memory is freed
+    holder: ?Holder = null,
+    /// Monotonic publish counter
+    version: u64,
+    /// Risk graph frozen for the graph algorithms
+    risk: CsrGraph,
+    reputation: ReputationMap,
+    trust: CompactTrustGraph,
+    refs: std.atomic.Value(u32),
+
+    /// Freeze the given live state. The returned snapshot holds one reference.
+    pub fn create(
+        allocator: std.mem.Allocator,
+        version: u64,
+        risk_graph: *const RiskGraph,
+        reputation: *const ReputationMap,
+        trust: *const CompactTrustGraph,
+    ) !*GraphSnapshot {
+        const risk = try CsrGraph.fromRiskGraph(risk_graph, allocator);
+        return adopt(allocator, version, risk, reputation, trust);
+    }
+
+    /// Like `create`, with the risk graph already frozen (e.g. a mapped
+    /// checkpoint). Takes ownership of `risk`, also on error.
+    pub fn adopt(
+        allocator: std.mem.Allocator,
+        version: u64,
+        risk: CsrGraph,
+        reputation: *const ReputationMap,
+        trust: *const CompactTrustGraph,
+    ) !*GraphSnapshot {
+        var owned = risk;
+        errdefer owned.deinit();
+        const self = try allocator.create(GraphSnapshot);
+        errdefer allocator.destroy(self);
+
+        var rep = try reputation.clone(allocator);
+        errdefer rep.deinit();
+        const trust_copy = try trust.clone(allocator);
+
+        self.* = .{
+            .allocator = allocator,
+            .version = version,
+            .risk = owned,
+            .reputation = rep,
+            .trust = trust_copy,
+            .refs = std.atomic.Value(u32).init(1),
+        };
+        return self;
+    }
+
+    pub fn retain(self: *GraphSnapshot) void {
+        _ = self.refs.fetchAdd(1, .monotonic);
+    }
+
+    /// Drop one reference; frees the snapshot when it was the last one.
+    pub fn release(self: *GraphSnapshot) void {
+        if (self.refs.fetchSub(1, .acq_rel) != 1) return;
+        self.risk.deinit();
+        self.reputation.deinit();
+        self.trust.deinit();
+        const holder = self.holder;
+        self.allocator.destroy(self);
+        if (holder) |h| h.release(h.ptr);
+    }
+};
+
+/// Publication point for snapshots (one per context).
+pub const SnapshotCell = struct {
+    current: std.atomic.Value(?*GraphSnapshot),
+    epoch: std.atomic.Value(u32),
+    in_flight: [2]std.atomic.Value(u32),
+    /// Version of the next publish (writer-only)
+    next_version: u64,
+    /// Retained once per published snapshot
+    holder: ?Holder = null,
+
+    pub fn init() SnapshotCell {
+        return .{
+            .current = std.atomic.Value(?*GraphSnapshot).init(null),
+            .epoch = std.atomic.Value(u32).init(0),
+            .in_flight = .{ std.atomic.Value(u32).init(0), std.atomic.Value(u32).init(0) },
+            .next_version = 1,
+        };
+    }
+
+    /// Release the published snapshot. Outstanding reader handles stay valid.
+    pub fn deinit(self: *SnapshotCell) void {
+        if (self.current.swap(null, .seq_cst)) |snap| snap.release();
+    }
+
+    /// Lock-free: returns the current snapshot with a reference held,
+    /// or null if nothing was published yet.
+    pub fn acquire(self: *SnapshotCell) ?*GraphSnapshot {
+        while (true) {
+            const epoch = self.epoch.load(.seq_cst);
+            const counter = &self.in_flight[epoch & 1];
+            _ = counter.fetchAdd(1, .seq_cst);
+            defer _ = counter.fetchSub(1, .seq_cst);
+
+            // A flip between reading the epoch and announcing means the
+            // writer may already be past waiting on this counter: retry.
+            if (self.epoch.load(.seq_cst) != epoch) continue;
+
+            const snap = self.current.load(.seq_cst) orelse return null;
+            snap.retain();
+            return snap;
+        }
+    }
+
+    /// Freeze the live state and make it current.
+    /// Must be called with the writer lock held (publishes are serialized).
+    pub fn publish(
+        self: *SnapshotCell,
+        allocator: std.mem.Allocator,
+        risk_graph: *const RiskGraph,
+        reputation: *const ReputationMap,
+        trust: *const CompactTrustGraph,
+    ) !u64 {
+        const snap = try GraphSnapshot.create(allocator, self.next_version, risk_graph, reputation, trust);
+        return self.install(snap);
+    }
+
+    /// `publish` with an already frozen risk graph (ownership moves in)
+    pub fn publishCsr(
+        self: *SnapshotCell,
+        allocator: std.mem.Allocator,
+        risk: CsrGraph,
+        reputation: *const ReputationMap,
+        trust: *const CompactTrustGraph,
+    ) !u64 {
+        const snap = try GraphSnapshot.adopt(allocator, self.next_version, risk, reputation, trust);
+        return self.install(snap);
+    }
+
+    fn install(self: *SnapshotCell, snap: *GraphSnapshot) u64 {
+        if (self.holder) |h| {
+            h.retain(h.ptr);
+            snap.holder = h;
+        }
+        const version = self.next_version;
+        self.next_version += 1;
+
+        const old = self.current.swap(snap, .seq_cst);
+        if (old) |prev| {
+            // Readers that may have loaded `prev` but not retained it yet are
+            // all counted under the pre-flip parity.
+            const parity = self.epoch.fetchAdd(1, .seq_cst) & 1;
+            while (self.in_flight[parity].load(.seq_cst) != 0) {
+                std.atomic.spinLoopHint();
+            }
+            prev.release();
+        }
+        return version;
+    }
+};
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+fn testEdge(from: types.NodeId, to: types.NodeId, risk: f64) types.RiskEdge {
+    const ts = time.SovereignTimestamp.fromSeconds(0, .system_boot);
+    return .{ .from = from, .to = to, .risk = risk, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts };
+}
+
+test "Snapshot: readers keep their version across publishes" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+    var reputation = ReputationMap.init(allocator);
+    defer reputation.deinit();
+    var trust = try CompactTrustGraph.init(allocator, [_]u8{0} ** 32, .{});
+    defer trust.deinit();
+
+    var cell = SnapshotCell.init();
+    defer cell.deinit();
+    try std.testing.expect(cell.acquire() == null);
+
+    try graph.addEdge(testEdge(0, 1, 0.5));
+    try std.testing.expectEqual(@as(u64, 1), try cell.publish(allocator, &graph, &reputation, &trust));
+
+    const v1 = cell.acquire().?;
+    defer v1.release();
+
+    try graph.addEdge(testEdge(1, 2, 0.5));
+    try reputation.recordVerification(7, .valid, 1);
+    try std.testing.expectEqual(@as(u64, 2), try cell.publish(allocator, &graph, &reputation, &trust));
+
+    const v2 = cell.acquire().?;
+    defer v2.release();
+
+    try std.testing.expectEqual(@as(u64, 1), v1.version);
+    try std.testing.expectEqual(@as(usize, 1), v1.risk.edgeCount());
+    try std.testing.expectEqual(@as(f64, 0.5), v1.reputation.get(7));
+    try std.testing.expectEqual(@as(usize, 2), v2.risk.edgeCount());
+    try std.testing.expect(v2.reputation.get(7) > 0.5);
+}
+
+test "Snapshot: concurrent readers during publishes" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+    var reputation = ReputationMap.init(allocator);
+    defer reputation.deinit();
+    var trust = try CompactTrustGraph.init(allocator, [_]u8{0} ** 32, .{});
+    defer trust.deinit();
+
+    var cell = SnapshotCell.init();
+    defer cell.deinit();
+    _ = try cell.publish(allocator, &graph, &reputation, &trust);
+
+    const Reader = struct {
+        fn run(c: *SnapshotCell, stop: *std.atomic.Value(bool), failures: *std.atomic.Value(u32)) void {
+            var last: u64 = 0;
+            while (!stop.load(.acquire)) {
+                const snap = c.acquire() orelse continue;
+                defer snap.release();
+                // Versions never go backwards and edge count tracks version
+                if (snap.version < last or snap.risk.edgeCount() != snap.version - 1) {
+                    _ = failures.fetchAdd(1, .monotonic);
+                }
+                last = snap.version;
+            }
+        }
+    };
+
+    var stop = std.atomic.Value(bool).init(false);
+    var failures = std.atomic.Value(u32).init(0);
+    var readers: [4]std.Thread = undefined;
+    for (&readers) |*t| t.* = try std.Thread.spawn(.{}, Reader.run, .{ &cell, &stop, &failures });
+
+    for (0..50) |i| {
+        try graph.addEdge(testEdge(@intCast(i), @intCast(i + 1), 0.1));
+        _ = try cell.publish(allocator, &graph, &reputation, &trust);
+    }
+
+    stop.store(true, .release);
+    for (readers) |t| t.join();
+    try std.testing.expectEqual(@as(u32, 0), failures.load(.monotonic));
+}
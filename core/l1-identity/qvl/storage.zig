@@ -1,130 +1,775 @@
-//! QVL Storage Layer - Stub Implementation
-//! 
-//! This is a stub/mock implementation for testing without libmdbx.
-//! Replace with real libmdbx implementation when available.
+//! QVL Persistent Graph Store
+//!
+//! Owns the live `RiskGraph` (the only in-memory copy) and backs it with
+//! two files in one directory:
+//! - `edges.log`: append-only mutation log of fixed-size, checksummed records
+//! - `graph.csr`: compact CSR checkpoint laid out column for column like
+//!   `CsrGraph`, so it can be mmapped straight into the algorithms
+//!
+//! Opening maps the checkpoint, rebuilds the graph from its columns with one
+//! bulk insert and replays only the log written since; a torn log tail
+//! (crash mid-append) is truncated. `checkpoint` writes a new CSR file aside,
+//! syncs and renames it, then starts an empty log of the next generation.
+//! A log older than the checkpoint is discarded on open, so a crash between
+//! the two renames loses nothing.
+//!
+//! Mutate the graph only through the store so every change is logged.
+//!
+//! One store owns a directory: `open` takes an exclusive lock on `LOCK`
+//! and fails with `error.StoreLocked` while another store (in this or any
+//! other process) has it open. Share the store instead of opening it twice.
 
 const std = @import("std");
+const time = @import("time");
 const types = @import("types.zig");
+const csr_mod = @import("csr.zig");
 
+const posix = std.posix;
 const NodeId = types.NodeId;
 const RiskEdge = types.RiskEdge;
 const RiskGraph = types.RiskGraph;
+const CsrGraph = csr_mod.CsrGraph;
+const DenseId = csr_mod.DenseId;
+const SovereignTimestamp = time.SovereignTimestamp;
 
-/// Mock persistent storage using in-memory HashMap
-pub const PersistentGraph = struct {
-    allocator: std.mem.Allocator,
-    nodes: std.AutoHashMap(NodeId, void),
-    edges: std.AutoHashMap(EdgeKey, RiskEdge),
-    adjacency: std.AutoHashMap(NodeId, std.ArrayList(NodeId)),
-    path: []const u8,
-    
-    const EdgeKey = struct {
-        from: NodeId,
-        to: NodeId,
-        
-        pub fn hash(self: EdgeKey) u64 {
-            return @as(u64, self.from) << 32 | self.to;
+pub const LOG_MAGIC: [4]u8 = "QVLL".*;
+pub const SNAPSHOT_MAGIC: [4]u8 = "QVLC".*;
+pub const FORMAT_VERSION: u8 = 1;
+
+const log_name = "edges.log";
+const log_tmp_name = "edges.log.tmp";
+const snapshot_name = "graph.csr";
+const snapshot_tmp_name = "graph.csr.tmp";
+const lock_name = "LOCK";
+
+/// Store configuration
+pub const DBConfig = struct {
+    /// Log records after which `maybeCheckpoint` writes a checkpoint
+    checkpoint_records: u64 = 64 * 1024,
+    /// fdatasync the log after every mutation
+    sync: bool = false,
+};
+
+/// Log file header (records start right after it)
+pub const LogHeader = extern struct {
+    magic: [4]u8 = LOG_MAGIC,
+    version: u8 = FORMAT_VERSION,
+    reserved: [3]u8 = [_]u8{0} ** 3,
+    /// Checkpoint generation the log extends
+    generation: u64,
+
+    pub const SIZE = @sizeOf(LogHeader); // 16 bytes
+};
+
+pub const LogOp = enum(u8) {
+    add_node = 1,
+    add_edge = 2,
+    remove_edge = 3,
+};
+
+/// One logged mutation
+pub const LogRecord = extern struct {
+    op: u8,
+    level: u8,
+    timestamp_anchor: u8,
+    expires_anchor: u8,
+    from: NodeId,
+    to: NodeId,
+    /// CRC32 of the record with this field zeroed
+    checksum: u32,
+    risk: f64,
+    nonce: u64,
+    timestamp: [2]u64,
+    expires_at: [2]u64,
+
+    pub const SIZE = @sizeOf(LogRecord); // 64 bytes
+
+    fn init(op: LogOp, edge: RiskEdge) LogRecord {
+        var rec = LogRecord{
+            .op = @intFromEnum(op),
+            .level = edge.level,
+            .timestamp_anchor = @intFromEnum(edge.timestamp.anchor),
+            .expires_anchor = @intFromEnum(edge.expires_at.anchor),
+            .from = edge.from,
+            .to = edge.to,
+            .checksum = 0,
+            .risk = edge.risk,
+            .nonce = edge.nonce,
+            .timestamp = splitTimestamp(edge.timestamp),
+            .expires_at = splitTimestamp(edge.expires_at),
+        };
+        rec.checksum = std.hash.Crc32.hash(std.mem.asBytes(&rec));
+        return rec;
+    }
+
+    fn node(id: NodeId) LogRecord {
+        var rec = std.mem.zeroes(LogRecord);
+        rec.op = @intFromEnum(LogOp.add_node);
+        rec.from = id;
+        rec.checksum = std.hash.Crc32.hash(std.mem.asBytes(&rec));
+        return rec;
+    }
+
+    fn isValid(self: LogRecord) bool {
+        var copy = self;
+        copy.checksum = 0;
+        if (std.hash.Crc32.hash(std.mem.asBytes(&copy)) != self.checksum) return false;
+        _ = std.meta.intToEnum(LogOp, self.op) catch return false;
+        return true;
+    }
+
+    fn toEdge(self: LogRecord) !RiskEdge {
+        return .{
+            .from = self.from,
+            .to = self.to,
+            .risk = self.risk,
+            .timestamp = try joinTimestamp(self.timestamp, self.timestamp_anchor),
+            .nonce = self.nonce,
+            .level = self.level,
+            .expires_at = try joinTimestamp(self.expires_at, self.expires_anchor),
+        };
+    }
+};
+
+/// Per-slot edge fields the CSR columns do not carry
+pub const EdgeMeta = extern struct {
+    nonce: u64,
+    timestamp: [2]u64,
+    expires_at: [2]u64,
+    level: u8,
+    timestamp_anchor: u8,
+    expires_anchor: u8,
+    reserved: [5]u8 = [_]u8{0} ** 5,
+
+    pub const SIZE = @sizeOf(EdgeMeta); // 48 bytes
+};
+
+/// Checkpoint columns, in file order
+pub const Section = enum(u8) {
+    node_ids,
+    offsets,
+    sources,
+    targets,
+    risk,
+    edge_index,
+    in_offsets,
+    in_edges,
+    meta,
+};
+
+const section_count = @typeInfo(Section).@"enum".fields.len;
+
+/// Checkpoint file header
+pub const SnapshotHeader = extern struct {
+    magic: [4]u8 = SNAPSHOT_MAGIC,
+    version: u8 = FORMAT_VERSION,
+    reserved: [3]u8 = [_]u8{0} ** 3,
+    generation: u64,
+    node_count: u64,
+    edge_count: u64,
+    /// File offset of each Section (8-byte aligned)
+    sections: [section_count]u64,
+    /// Bytes covered by header and sections
+    size: u64,
+    /// CRC32 of the header with this field zeroed
+    checksum: u32 = 0,
+    reserved2: [4]u8 = [_]u8{0} ** 4,
+
+    pub const SIZE = @sizeOf(SnapshotHeader);
+
+    fn seal(self: *SnapshotHeader) void {
+        self.checksum = 0;
+        self.checksum = std.hash.Crc32.hash(std.mem.asBytes(self));
+    }
+
+    fn isValid(self: SnapshotHeader) bool {
+        var copy = self;
+        copy.checksum = 0;
+        return std.mem.eql(u8, &self.magic, &SNAPSHOT_MAGIC) and
+            self.version == FORMAT_VERSION and
+            std.hash.Crc32.hash(std.mem.asBytes(&copy)) == self.checksum;
+    }
+};
+
+fn sectionBytes(section: Section, n: u64, m: u64) u64 {
+    return switch (section) {
+        .node_ids => 4 * n,
+        .offsets, .in_offsets => 4 * (n + 1),
+        .sources, .targets, .edge_index, .in_edges => 4 * m,
+        .risk => 8 * m,
+        .meta => EdgeMeta.SIZE * m,
+    };
+}
+
+/// Section offsets and total size for a graph of n nodes and m edges
+fn layout(n: u64, m: u64) struct { sections: [section_count]u64, size: u64 } {
+    var sections: [section_count]u64 = undefined;
+    var offset: u64 = std.mem.alignForward(u64, SnapshotHeader.SIZE, 8);
+    for (&sections, 0..) |*s, i| {
+        s.* = offset;
+        offset = std.mem.alignForward(u64, offset + sectionBytes(@enumFromInt(i), n, m), 8);
+    }
+    return .{ .sections = sections, .size = offset };
+}
+
+fn splitTimestamp(ts: SovereignTimestamp) [2]u64 {
+    return .{ @truncate(ts.raw), @truncate(ts.raw >> 64) };
+}
+
+fn joinTimestamp(parts: [2]u64, anchor: u8) !SovereignTimestamp {
+    const epoch = std.meta.intToEnum(time.AnchorEpoch, anchor) catch return error.CorruptStore;
+    return SovereignTimestamp.fromAttoseconds(@as(u128, parts[1]) << 64 | parts[0], epoch);
+}
+
+/// Mapped checkpoint file (copy-on-write, so columns are plain slices)
+const Checkpoint = struct {
+    map: []align(std.heap.page_size_min) u8,
+    header: SnapshotHeader,
+
+    fn open(dir: std.fs.Dir) !?Checkpoint {
+        const file = dir.openFile(snapshot_name, .{}) catch |err| switch (err) {
+            error.FileNotFound => return null,
+            else => return err,
+        };
+        defer file.close();
+
+        const size = (try file.stat()).size;
+        if (size < SnapshotHeader.SIZE) return error.CorruptStore;
+        const map = try posix.mmap(null, @intCast(size), posix.PROT.READ | posix.PROT.WRITE, .{ .TYPE = .PRIVATE }, file.handle, 0);
+        errdefer posix.munmap(map);
+
+        const header = std.mem.bytesToValue(SnapshotHeader, map[0..SnapshotHeader.SIZE]);
+        if (!header.isValid()) return error.CorruptStore;
+        const expected = layout(header.node_count, header.edge_count);
+        if (header.size != expected.size or header.size > size or
+            !std.mem.eql(u64, &header.sections, &expected.sections)) return error.CorruptStore;
+
+        const cp = Checkpoint{ .map = map, .header = header };
+        try cp.validate();
+        return cp;
+    }
+
+    fn close(self: *const Checkpoint) void {
+        posix.munmap(self.map);
+    }
+
+    fn column(self: *const Checkpoint, comptime T: type, section: Section, len: u64) []T {
+        const ptr: [*]T = @ptrCast(@alignCast(self.map.ptr + self.header.sections[@intFromEnum(section)]));
+        return ptr[0..@intCast(len)];
+    }
+
+    fn nodeCount(self: *const Checkpoint) usize {
+        return @intCast(self.header.node_count);
+    }
+
+    fn edgeCount(self: *const Checkpoint) usize {
+        return @intCast(self.header.edge_count);
+    }
+
+    /// Bounds the algorithms rely on: monotonic rows, in-range ids
+    fn validate(self: *const Checkpoint) !void {
+        const n = self.nodeCount();
+        const m = self.edgeCount();
+        for ([_][]const u32{ self.column(u32, .offsets, n + 1), self.column(u32, .in_offsets, n + 1) }) |offsets| {
+            if (offsets[0] != 0 or offsets[n] != m) return error.CorruptStore;
+            for (offsets[0..n], offsets[1..]) |a, b| {
+                if (a > b) return error.CorruptStore;
+            }
         }
-        
-        pub fn eql(self: EdgeKey, other: EdgeKey) bool {
-            return self.from == other.from and self.to == other.to;
+        for ([_][]const u32{ self.column(u32, .sources, m), self.column(u32, .targets, m) }) |ids| {
+            for (ids) |d| {
+                if (d >= n) return error.CorruptStore;
+            }
         }
-    };
-    
+        for ([_][]const u32{ self.column(u32, .in_edges, m), self.column(u32, .edge_index, m) }) |slots| {
+            for (slots) |s| {
+                if (s >= m) return error.CorruptStore;
+            }
+        }
+    }
+
+    /// CsrGraph over the mapping; takes ownership of it
+    fn toCsr(self: *const Checkpoint, allocator: std.mem.Allocator) !CsrGraph {
+        const n = self.nodeCount();
+        const m = self.edgeCount();
+        const node_ids = self.column(NodeId, .node_ids, n);
+
+        var dense = std.AutoHashMapUnmanaged(NodeId, DenseId){};
+        errdefer dense.deinit(allocator);
+        try dense.ensureTotalCapacity(allocator, @intCast(n));
+        for (node_ids, 0..) |id, d| dense.putAssumeCapacity(id, @intCast(d));
+
+        return .{
+            .allocator = allocator,
+            .node_ids = node_ids,
+            .dense = dense,
+            .offsets = self.column(u32, .offsets, n + 1),
+            .sources = self.column(DenseId, .sources, m),
+            .targets = self.column(DenseId, .targets, m),
+            .risk = self.column(f64, .risk, m),
+            .edge_index = self.column(u32, .edge_index, m),
+            .in_offsets = self.column(u32, .in_offsets, n + 1),
+            .in_edges = self.column(u32, .in_edges, m),
+            .mapping = self.map,
+        };
+    }
+};
+
+pub const PersistentGraph = struct {
+    allocator: std.mem.Allocator,
+    config: DBConfig,
+    /// The live graph (read freely; mutate through the store)
+    graph: RiskGraph,
+    /// Store directory (null = memory only, nothing is logged)
+    dir: ?std.fs.Dir,
+    /// Held exclusively while the store is open
+    lock: ?std.fs.File,
+    log: ?std.fs.File,
+    /// End of the valid log
+    log_end: u64,
+    /// Records in the log (mutations since the last checkpoint)
+    log_records: u64,
+    /// Generation of the current checkpoint (0 = none written yet)
+    generation: u64,
+
     const Self = @This();
-    
-    /// Open or create persistent graph (mock: in-memory)
-    pub fn open(path: []const u8, config: DBConfig, allocator: std.mem.Allocator) !Self {
-        _ = config;
-        return Self{
+
+    /// Graph with no backing files
+    pub fn initInMemory(allocator: std.mem.Allocator) Self {
+        return .{
             .allocator = allocator,
-            .nodes = std.AutoHashMap(NodeId, void).init(allocator),
-            .edges = std.AutoHashMap(EdgeKey, RiskEdge).init(allocator),
-            .adjacency = std.AutoHashMap(NodeId, std.ArrayList(NodeId)).init(allocator),
-            .path = try allocator.dupe(u8, path),
+            .config = .{},
+            .graph = RiskGraph.init(allocator),
+            .dir = null,
+            .lock = null,
+            .log = null,
+            .log_end = 0,
+            .log_records = 0,
+            .generation = 0,
         };
     }
-    
-    /// Close database
+
+    /// Open or create the store in directory `path`
+    pub fn open(path: []const u8, config: DBConfig, allocator: std.mem.Allocator) !Self {
+        try std.fs.cwd().makePath(path);
+        var self = initInMemory(allocator);
+        self.config = config;
+        self.dir = try std.fs.cwd().openDir(path, .{});
+        errdefer self.close();
+        // flock: a second open conflicts even from the same process
+        self.lock = self.dir.?.createFile(lock_name, .{
+            .truncate = false,
+            .lock = .exclusive,
+            .lock_nonblocking = true,
+        }) catch |err| switch (err) {
+            error.WouldBlock => return error.StoreLocked,
+            else => return err,
+        };
+
+        if (try Checkpoint.open(self.dir.?)) |cp| {
+            defer cp.close();
+            try self.loadCheckpoint(&cp);
+            self.generation = cp.header.generation;
+        }
+        try self.replayLog();
+        return self;
+    }
+
+    /// Close the files (unsynced log writes are left to the OS)
     pub fn close(self: *Self) void {
-        // Clean up adjacency lists
-        var it = self.adjacency.valueIterator();
-        while (it.next()) |list| {
-            list.deinit(self.allocator);
+        if (self.log) |file| file.close();
+        if (self.lock) |file| file.close();
+        if (self.dir) |*dir| dir.close();
+        self.graph.deinit();
+    }
+
+    /// Rebuild the graph from checkpoint columns with one bulk insert
+    fn loadCheckpoint(self: *Self, cp: *const Checkpoint) !void {
+        const n = cp.nodeCount();
+        const m = cp.edgeCount();
+        const node_ids = cp.column(NodeId, .node_ids, n);
+        const sources = cp.column(DenseId, .sources, m);
+        const targets = cp.column(DenseId, .targets, m);
+        const risk = cp.column(f64, .risk, m);
+        const edge_index = cp.column(u32, .edge_index, m);
+        const meta = cp.column(EdgeMeta, .meta, m);
+
+        // Slots back to graph order (edge_index must be a permutation)
+        const edges = try self.allocator.alloc(RiskEdge, m);
+        defer self.allocator.free(edges);
+        var seen = try std.DynamicBitSetUnmanaged.initEmpty(self.allocator, m);
+        defer seen.deinit(self.allocator);
+        for (0..m) |s| {
+            const idx = edge_index[s];
+            if (seen.isSet(idx)) return error.CorruptStore;
+            seen.set(idx);
+            edges[idx] = .{
+                .from = node_ids[sources[s]],
+                .to = node_ids[targets[s]],
+                .risk = risk[s],
+                .timestamp = try joinTimestamp(meta[s].timestamp, meta[s].timestamp_anchor),
+                .nonce = meta[s].nonce,
+                .level = meta[s].level,
+                .expires_at = try joinTimestamp(meta[s].expires_at, meta[s].expires_anchor),
+            };
+        }
+
+        try self.graph.nodes.appendSlice(self.allocator, node_ids);
+        try self.graph.addEdges(edges);
+    }
+
+    fn replayLog(self: *Self) !void {
+        const dir = self.dir.?;
+        const file = dir.openFile(log_name, .{ .mode = .read_write }) catch |err| switch (err) {
+            error.FileNotFound => return self.resetLog(self.generation),
+            else => return err,
+        };
+        var adopted = false;
+        defer if (!adopted) file.close();
+
+        var header: LogHeader = undefined;
+        if (try file.preadAll(std.mem.asBytes(&header), 0) != LogHeader.SIZE or
+            !std.mem.eql(u8, &header.magic, &LOG_MAGIC) or header.version != FORMAT_VERSION) return error.CorruptStore;
+        // Already folded into the checkpoint (crash before the log reset)
+        if (header.generation < self.generation) return self.resetLog(self.generation);
+        if (header.generation > self.generation) return error.CorruptStore;
+
+        var pending = std.ArrayListUnmanaged(RiskEdge){};
+        defer pending.deinit(self.allocator);
+
+        var buf: [256]LogRecord = undefined;
+        var offset: u64 = LogHeader.SIZE;
+        replay: while (true) {
+            const got = try file.preadAll(std.mem.sliceAsBytes(&buf), offset);
+            const count = got / LogRecord.SIZE;
+            for (buf[0..count]) |rec| {
+                // Torn or garbled tail: everything from here on is dropped
+                if (!rec.isValid()) break :replay;
+                try self.apply(rec, &pending);
+                offset += LogRecord.SIZE;
+                self.log_records += 1;
+            }
+            if (count < buf.len) break;
         }
-        self.adjacency.deinit();
-        self.edges.deinit();
-        self.nodes.deinit();
-        self.allocator.free(self.path);
+        try self.flushPending(&pending);
+
+        if (try file.getEndPos() != offset) try file.setEndPos(offset);
+        self.log = file;
+        self.log_end = offset;
+        adopted = true;
     }
-    
+
+    /// Replay one record; runs of edge additions are inserted in bulk
+    fn apply(self: *Self, rec: LogRecord, pending: *std.ArrayListUnmanaged(RiskEdge)) !void {
+        switch (@as(LogOp, @enumFromInt(rec.op))) {
+            .add_edge => try pending.append(self.allocator, try rec.toEdge()),
+            .add_node => {
+                try self.flushPending(pending);
+                try self.graph.addNode(rec.from);
+            },
+            .remove_edge => {
+                try self.flushPending(pending);
+                _ = self.graph.removeEdge(rec.from, rec.to);
+            },
+        }
+    }
+
+    fn flushPending(self: *Self, pending: *std.ArrayListUnmanaged(RiskEdge)) !void {
+        if (pending.items.len == 0) return;
+        try self.graph.addEdges(pending.items);
+        pending.clearRetainingCapacity();
+    }
+
+    /// Replace the log with an empty one of `generation`
+    fn resetLog(self: *Self, generation: u64) !void {
+        const dir = self.dir.?;
+        const file = try dir.createFile(log_tmp_name, .{ .truncate = true, .read = true });
+        errdefer file.close();
+        try file.writeAll(std.mem.asBytes(&LogHeader{ .generation = generation }));
+        try file.sync();
+        try dir.rename(log_tmp_name, log_name);
+        try posix.fsync(dir.fd);
+
+        if (self.log) |old| old.close();
+        self.log = file;
+        self.log_end = LogHeader.SIZE;
+        self.log_records = 0;
+    }
+
+    /// Write records at the log end without committing them; `commitLog`
+    /// makes them part of the log once the in-memory change succeeded.
+    /// A failed (possibly partial) write or sync is cut back to `log_end`.
+    fn stageLog(self: *Self, records: []const LogRecord) !void {
+        const file = self.log orelse return;
+        errdefer self.abortLog();
+        try file.pwriteAll(std.mem.sliceAsBytes(records), self.log_end);
+        if (self.config.sync) try posix.fdatasync(file.handle);
+    }
+
+    fn commitLog(self: *Self, count: usize) void {
+        if (self.log == null) return;
+        self.log_end += count * LogRecord.SIZE;
+        self.log_records += count;
+    }
+
+    /// Drop staged records after a failed in-memory change
+    fn abortLog(self: *Self) void {
+        const file = self.log orelse return;
+        file.setEndPos(self.log_end) catch {};
+    }
+
     /// Add node
     pub fn addNode(self: *Self, node: NodeId) !void {
-        try self.nodes.put(node, {});
+        try self.stageLog(&.{LogRecord.node(node)});
+        errdefer self.abortLog();
+        try self.graph.addNode(node);
+        self.commitLog(1);
     }
-    
+
     /// Add edge
     pub fn addEdge(self: *Self, edge: RiskEdge) !void {
-        // Register nodes first
-        try self.nodes.put(edge.from, {});
-        try self.nodes.put(edge.to, {});
-        
-        const key = EdgeKey{ .from = edge.from, .to = edge.to };
-        try self.edges.put(key, edge);
-        
-        // Update adjacency
-        const entry = try self.adjacency.getOrPut(edge.from);
-        if (!entry.found_existing) {
-            entry.value_ptr.* = .{}; // Empty ArrayList, allocator passed on append
+        try self.stageLog(&.{LogRecord.init(.add_edge, edge)});
+        errdefer self.abortLog();
+        try self.graph.addEdge(edge);
+        self.commitLog(1);
+    }
+
+    /// Add a batch of edges with one log write and one bulk insert
+    pub fn addEdges(self: *Self, batch: []const RiskEdge) !void {
+        if (batch.len == 0) return;
+        if (self.log != null) {
+            const records = try self.allocator.alloc(LogRecord, batch.len);
+            defer self.allocator.free(records);
+            for (records, batch) |*rec, edge| rec.* = LogRecord.init(.add_edge, edge);
+            try self.stageLog(records);
         }
-        try entry.value_ptr.append(self.allocator, edge.to);
+        errdefer self.abortLog();
+        try self.graph.addEdges(batch);
+        self.commitLog(batch.len);
     }
-    
+
+    /// Remove the oldest live edge `from -> to` (see RiskGraph.removeEdge)
+    pub fn removeEdge(self: *Self, from: NodeId, to: NodeId) !?RiskEdge {
+        const edge = self.graph.getEdge(from, to) orelse return null;
+        try self.stageLog(&.{LogRecord.init(.remove_edge, edge)});
+        self.commitLog(1);
+        return self.graph.removeEdge(from, to);
+    }
+
     /// Get outgoing neighbors
     pub fn getOutgoing(self: *Self, node: NodeId, allocator: std.mem.Allocator) ![]NodeId {
-        if (self.adjacency.get(node)) |list| {
-            // Copy to new slice with provided allocator
-            return allocator.dupe(NodeId, list.items);
-        }
-        return allocator.dupe(NodeId, &[_]NodeId{});
+        const edge_indices = self.graph.neighbors(node);
+        const out = try allocator.alloc(NodeId, edge_indices.len);
+        for (out, edge_indices) |*to, idx| to.* = self.graph.edges.items[idx].to;
+        return out;
     }
-    
+
     /// Get specific edge
     pub fn getEdge(self: *Self, from: NodeId, to: NodeId) !?RiskEdge {
-        const key = EdgeKey{ .from = from, .to = to };
-        return self.edges.get(key);
+        return self.graph.getEdge(from, to);
     }
-    
-    /// Load in-memory RiskGraph
+
+    /// Independent copy of the live graph
     pub fn toRiskGraph(self: *Self, allocator: std.mem.Allocator) !RiskGraph {
         var graph = RiskGraph.init(allocator);
         errdefer graph.deinit();
-        
-        // First add all nodes
-        var node_it = self.nodes.keyIterator();
-        while (node_it.next()) |node| {
-            try graph.addNode(node.*);
-        }
-        
-        // Then add all edges
-        var edge_it = self.edges.valueIterator();
-        while (edge_it.next()) |edge| {
-            try graph.addEdge(edge.*);
+        try graph.nodes.appendSlice(allocator, self.graph.nodes.items);
+
+        var live = std.ArrayListUnmanaged(RiskEdge){};
+        defer live.deinit(allocator);
+        try live.ensureTotalCapacity(allocator, self.graph.edgeCount());
+        for (self.graph.edges.items, 0..) |edge, i| {
+            if (self.graph.isLive(i)) live.appendAssumeCapacity(edge);
         }
-        
+        try graph.addEdges(live.items);
         return graph;
     }
-};
 
-/// Database configuration (mock accepts same config for API compatibility)
-pub const DBConfig = struct {
-    max_readers: u32 = 64,
-    max_dbs: u32 = 8,
-    map_size: usize = 10 * 1024 * 1024,
-    page_size: u32 = 4096,
-};
+    /// Fold the log into a new checkpoint and start an empty log
+    pub fn checkpoint(self: *Self) !void {
+        const dir = self.dir orelse return error.NotPersistent;
+        self.graph.compact();
+
+        var csr = try CsrGraph.fromRiskGraph(&self.graph, self.allocator);
+        defer csr.deinit();
+        const n = csr.nodeCount();
+        const m = csr.edgeCount();
+
+        const meta = try self.allocator.alloc(EdgeMeta, m);
+        defer self.allocator.free(meta);
+        for (meta, csr.edge_index) |*out, idx| {
+            const edge = self.graph.edges.items[idx];
+            out.* = .{
+                .nonce = edge.nonce,
+                .timestamp = splitTimestamp(edge.timestamp),
+                .expires_at = splitTimestamp(edge.expires_at),
+                .level = edge.level,
+                .timestamp_anchor = @intFromEnum(edge.timestamp.anchor),
+                .expires_anchor = @intFromEnum(edge.expires_at.anchor),
+            };
+        }
+
+        const lay = layout(n, m);
+        var header = SnapshotHeader{
+            .generation = self.generation + 1,
+            .node_count = n,
+            .edge_count = m,
+            .sections = lay.sections,
+            .size = lay.size,
+        };
+        header.seal();
+
+        const columns = [section_count][]const u8{
+            std.mem.sliceAsBytes(csr.node_ids),
+            std.mem.sliceAsBytes(csr.offsets),
+            std.mem.sliceAsBytes(csr.sources),
+            std.mem.sliceAsBytes(csr.targets),
+            std.mem.sliceAsBytes(csr.risk),
+            std.mem.sliceAsBytes(csr.edge_index),
+            std.mem.sliceAsBytes(csr.in_offsets),
+            std.mem.sliceAsBytes(csr.in_edges),
+            std.mem.sliceAsBytes(meta),
+        };
+
+        {
+            const file = try dir.createFile(snapshot_tmp_name, .{ .truncate = true });
+            defer file.close();
+            try file.pwriteAll(std.mem.asBytes(&header), 0);
+            for (columns, lay.sections) |bytes, offset| try file.pwriteAll(bytes, offset);
+            try file.setEndPos(lay.size);
+            try file.sync();
+        }
+        try dir.rename(snapshot_tmp_name, snapshot_name);
+        try posix.fsync(dir.fd);
+
+        self.generation += 1;
+        try self.resetLog(self.generation);
+    }
+
+    /// Checkpoint once the log holds `config.checkpoint_records` records.
+    /// Returns true if a checkpoint was written.
+    pub fn maybeCheckpoint(self: *Self) !bool {
+        if (self.log == null or self.log_records < self.config.checkpoint_records) return false;
+        try self.checkpoint();
+        return true;
+    }
 
-// Re-export for integration.zig
-pub const lmdb = struct {
-    // Stub exports
+    /// The checkpoint mapped as a CsrGraph, if it is exactly the live graph
+    /// (nothing logged since). Only the id index is built; the columns are
+    /// the file's pages. Null when the log is not empty or nothing was
+    /// checkpointed yet.
+    pub fn mapCsr(self: *Self) !?CsrGraph {
+        const dir = self.dir orelse return null;
+        if (self.log_records != 0 or self.generation == 0) return null;
+        const cp = try Checkpoint.open(dir) orelse return null;
+        errdefer cp.close();
+        return try cp.toCsr(self.allocator);
+    }
 };
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+fn testEdge(from: NodeId, to: NodeId, risk: f64, nonce: u64) RiskEdge {
+    const ts = SovereignTimestamp.fromSeconds(1234567890, .unix_1970);
+    return .{ .from = from, .to = to, .risk = risk, .timestamp = ts, .nonce = nonce, .level = 2, .expires_at = ts.addSeconds(86400) };
+}
+
+test "PersistentGraph: checkpoint, log replay and torn tail" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const path = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(path);
+
+    {
+        var store = try PersistentGraph.open(path, .{}, allocator);
+        defer store.close();
+        try store.addNode(7);
+        try store.addEdges(&.{ testEdge(0, 1, 0.5, 0), testEdge(1, 2, -0.3, 1), testEdge(2, 0, 0.1, 2) });
+        _ = try store.removeEdge(1, 2);
+        try store.checkpoint();
+        try std.testing.expectEqual(@as(u64, 0), store.log_records);
+
+        // Checkpoint is the live graph: the mapping matches a fresh CSR
+        var mapped = (try store.mapCsr()).?;
+        defer mapped.deinit();
+        var built = try CsrGraph.fromRiskGraph(&store.graph, allocator);
+        defer built.deinit();
+        try std.testing.expectEqualSlices(NodeId, built.node_ids, mapped.node_ids);
+        try std.testing.expectEqualSlices(u32, built.in_edges, mapped.in_edges);
+        try std.testing.expectEqualSlices(f64, built.risk, mapped.risk);
+
+        // Logged after the checkpoint
+        try store.addEdge(testEdge(2, 1, -0.9, 3));
+        try std.testing.expect(try store.mapCsr() == null);
+    }
+
+    // Torn append: half a record at the end of the log
+    {
+        var dir = try std.fs.cwd().openDir(path, .{});
+        defer dir.close();
+        const log = try dir.openFile(log_name, .{ .mode = .read_write });
+        defer log.close();
+        const end = try log.getEndPos();
+        try log.pwriteAll(&[_]u8{0xAB} ** (LogRecord.SIZE / 2), end);
+    }
+
+    var store = try PersistentGraph.open(path, .{}, allocator);
+    defer store.close();
+    try std.testing.expectEqual(@as(usize, 3), store.graph.edgeCount());
+    try std.testing.expectEqual(@as(u64, 1), store.log_records);
+    try std.testing.expect(store.graph.getEdge(1, 2) == null);
+    const back = store.graph.getEdge(2, 1).?;
+    try std.testing.expectEqual(@as(f64, -0.9), back.risk);
+    try std.testing.expectEqual(@as(u64, 3), back.nonce);
+    try std.testing.expectEqual(testEdge(0, 1, 0.5, 0).expires_at.raw, store.graph.getEdge(0, 1).?.expires_at.raw);
+    try std.testing.expectEqual(LogHeader.SIZE + LogRecord.SIZE, try store.log.?.getEndPos());
+}
+
+test "PersistentGraph: a directory has one owner" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const path = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(path);
+
+    {
+        var store = try PersistentGraph.open(path, .{}, allocator);
+        defer store.close();
+        try std.testing.expectError(error.StoreLocked, PersistentGraph.open(path, .{}, allocator));
+    }
+    // Released on close
+    var store = try PersistentGraph.open(path, .{}, allocator);
+    store.close();
+}
+
+test "PersistentGraph: stale log after an interrupted checkpoint is discarded" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const path = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(path);
+
+    var saved_log: []u8 = undefined;
+    {
+        var store = try PersistentGraph.open(path, .{ .checkpoint_records = 2 }, allocator);
+        defer store.close();
+        try store.addEdge(testEdge(0, 1, 0.5, 0));
+        try std.testing.expect(!try store.maybeCheckpoint());
+        try store.addEdge(testEdge(1, 0, 0.5, 1));
+        saved_log = try tmp.dir.readFileAlloc(allocator, log_name, 1 << 20);
+        try std.testing.expect(try store.maybeCheckpoint());
+    }
+    defer allocator.free(saved_log);
+
+    // Crash between the checkpoint rename and the log reset
+    try tmp.dir.writeFile(.{ .sub_path = log_name, .data = saved_log });
+
+    var store = try PersistentGraph.open(path, .{}, allocator);
+    defer store.close();
+    try std.testing.expectEqual(@as(usize, 2), store.graph.edgeCount());
+    try std.testing.expectEqual(@as(u64, 0), store.log_records);
+    try std.testing.expectEqual(@as(u64, 1), store.generation);
+}
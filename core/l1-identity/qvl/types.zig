@@ -72,12 +72,44 @@ pub const AnomalyScore = struct {
 
 /// Graph structure for QVL algorithms.
 /// Wraps edges and provides adjacency lookup.
+///
+/// Removal is O(1): the edge is tombstoned in `edges` (indices stay stable)
+/// and swap-removed from its adjacency bucket, so `neighbors` only ever
+/// yields live edges. Passes over `edges.items` must skip `!isLive(i)`.
+/// Tombstones are compacted away once they make up half the edge array.
 pub const RiskGraph = struct {
     allocator: std.mem.Allocator,
     nodes: std.ArrayListUnmanaged(NodeId),
     edges: std.ArrayListUnmanaged(RiskEdge),
-    /// Adjacency: node -> list of edge indices
+    /// Adjacency: node -> list of edge indices (live edges only)
     adjacency: std.AutoHashMapUnmanaged(NodeId, std.ArrayListUnmanaged(usize)),
+    /// Per-edge bookkeeping, parallel to `edges`
+    slots: std.ArrayListUnmanaged(EdgeSlot),
+    /// (from, to) -> live edges with that key, oldest first
+    index: std.AutoHashMapUnmanaged(u64, DupChain),
+    /// Tombstoned entries in `edges`
+    dead_edges: usize,
+
+    /// Compaction never runs below this many tombstones
+    pub const compact_min_dead: usize = 64;
+
+    const no_edge = std.math.maxInt(usize);
+
+    const EdgeSlot = struct {
+        /// Position in the adjacency bucket of `from` (`no_edge` = tombstone)
+        bucket_pos: usize,
+        /// Next newer live edge with the same (from, to)
+        next_dup: usize,
+    };
+
+    const DupChain = struct {
+        head: usize,
+        tail: usize,
+    };
+
+    fn edgeKey(from: NodeId, to: NodeId) u64 {
+        return @as(u64, from) << 32 | to;
+    }
 
     pub fn init(allocator: std.mem.Allocator) RiskGraph {
         return .{
@@ -85,6 +117,9 @@ pub const RiskGraph = struct {
             .nodes = .{},
             .edges = .{},
             .adjacency = .{},
+            .slots = .{},
+            .index = .{},
+            .dead_edges = 0,
         };
     }
 
@@ -96,6 +131,8 @@ pub const RiskGraph = struct {
             entry.value_ptr.deinit(self.allocator);
         }
         self.adjacency.deinit(self.allocator);
+        self.slots.deinit(self.allocator);
+        self.index.deinit(self.allocator);
     }
 
     pub fn addNode(self: *RiskGraph, node: NodeId) !void {
@@ -103,15 +140,174 @@ pub const RiskGraph = struct {
     }
 
     pub fn addEdge(self: *RiskGraph, edge: RiskEdge) !void {
-        const edge_idx = self.edges.items.len;
-        try self.edges.append(self.allocator, edge);
+        try self.edges.ensureUnusedCapacity(self.allocator, 1);
+        try self.slots.ensureUnusedCapacity(self.allocator, 1);
+        try self.index.ensureUnusedCapacity(self.allocator, 1);
 
         // Update adjacency
         const entry = try self.adjacency.getOrPut(self.allocator, edge.from);
         if (!entry.found_existing) {
             entry.value_ptr.* = .{};
         }
-        try entry.value_ptr.append(self.allocator, edge_idx);
+        // A failed grow of a fresh bucket allocated nothing
+        errdefer if (!entry.found_existing) self.adjacency.removeByPtr(entry.key_ptr);
+        try entry.value_ptr.ensureUnusedCapacity(self.allocator, 1);
+
+        const edge_idx = self.edges.items.len;
+        self.edges.appendAssumeCapacity(edge);
+        self.slots.appendAssumeCapacity(.{ .bucket_pos = entry.value_ptr.items.len, .next_dup = no_edge });
+        entry.value_ptr.appendAssumeCapacity(edge_idx);
+        self.linkIndex(edge_idx);
+    }
+
+    /// Append a batch of edges in one pass.
+    /// Edge storage is reserved once and edges are grouped by `from`, so each
+    /// adjacency bucket is looked up and grown once per batch instead of once
+    /// per edge. Edges are only committed once every allocation has succeeded,
+    /// so a failed batch leaves `edges` and existing bucket contents untouched,
+    /// and drops the buckets it created. Within a bucket, edge indices keep
+    /// batch order.
+    pub fn addEdges(self: *RiskGraph, batch: []const RiskEdge) !void {
+        if (batch.len == 0) return;
+
+        // Stable sort a permutation of the batch by source node
+        const order = try self.allocator.alloc(usize, batch.len);
+        defer self.allocator.free(order);
+        for (order, 0..) |*slot, i| slot.* = i;
+        std.sort.block(usize, order, batch, struct {
+            fn lessThan(ctx: []const RiskEdge, a: usize, b: usize) bool {
+                return ctx[a].from < ctx[b].from;
+            }
+        }.lessThan);
+
+        var distinct: usize = 1;
+        for (order[1..], 1..) |idx, i| {
+            if (batch[idx].from != batch[order[i - 1]].from) distinct += 1;
+        }
+
+        const Run = struct {
+            from: NodeId,
+            bucket: *std.ArrayListUnmanaged(usize),
+            created: bool,
+        };
+        const runs = try self.allocator.alloc(Run, distinct);
+        defer self.allocator.free(runs);
+
+        try self.edges.ensureUnusedCapacity(self.allocator, batch.len);
+        try self.slots.ensureUnusedCapacity(self.allocator, batch.len);
+        try self.index.ensureUnusedCapacity(self.allocator, @intCast(batch.len));
+        try self.adjacency.ensureUnusedCapacity(self.allocator, @intCast(distinct));
+
+        // Pass 1: resolve and grow one adjacency bucket per source run
+        var run_start: usize = 0;
+        var run: usize = 0;
+        errdefer for (runs[0..run]) |r| {
+            if (!r.created) continue;
+            r.bucket.deinit(self.allocator);
+            _ = self.adjacency.remove(r.from);
+        };
+        while (run_start < order.len) {
+            const from = batch[order[run_start]].from;
+            var run_end = run_start + 1;
+            while (run_end < order.len and batch[order[run_end]].from == from) run_end += 1;
+
+            const entry = self.adjacency.getOrPutAssumeCapacity(from);
+            if (!entry.found_existing) {
+                entry.value_ptr.* = .{};
+            }
+            runs[run] = .{ .from = from, .bucket = entry.value_ptr, .created = !entry.found_existing };
+            run += 1;
+            try entry.value_ptr.ensureUnusedCapacity(self.allocator, run_end - run_start);
+            run_start = run_end;
+        }
+
+        // Pass 2: commit (cannot fail)
+        const base = self.edges.items.len;
+        self.edges.appendSliceAssumeCapacity(batch);
+        self.slots.appendNTimesAssumeCapacity(.{ .bucket_pos = 0, .next_dup = no_edge }, batch.len);
+
+        run = 0;
+        for (order, 0..) |idx, i| {
+            if (i > 0 and batch[idx].from != batch[order[i - 1]].from) run += 1;
+            self.slots.items[base + idx].bucket_pos = runs[run].bucket.items.len;
+            runs[run].bucket.appendAssumeCapacity(base + idx);
+        }
+
+        // Duplicate chains follow insertion order
+        for (base..self.edges.items.len) |edge_idx| self.linkIndex(edge_idx);
+    }
+
+    /// Remove the oldest live edge `from -> to` in O(1).
+    /// Returns the removed edge, or null if there is none.
+    /// May compact, which renumbers edge indices.
+    pub fn removeEdge(self: *RiskGraph, from: NodeId, to: NodeId) ?RiskEdge {
+        const chain = self.index.getEntry(edgeKey(from, to)) orelse return null;
+        const edge_idx = chain.value_ptr.head;
+        const slot = &self.slots.items[edge_idx];
+
+        if (slot.next_dup == no_edge) {
+            self.index.removeByPtr(chain.key_ptr);
+        } else {
+            chain.value_ptr.head = slot.next_dup;
+        }
+
+        const bucket = self.adjacency.getPtr(from).?;
+        _ = bucket.swapRemove(slot.bucket_pos);
+        if (slot.bucket_pos < bucket.items.len) {
+            self.slots.items[bucket.items[slot.bucket_pos]].bucket_pos = slot.bucket_pos;
+        }
+
+        slot.* = .{ .bucket_pos = no_edge, .next_dup = no_edge };
+        self.dead_edges += 1;
+        const removed = self.edges.items[edge_idx];
+
+        if (self.dead_edges >= compact_min_dead and self.dead_edges * 2 >= self.edges.items.len) {
+            self.compact();
+        }
+        return removed;
+    }
+
+    /// Drop tombstones from `edges`, renumbering edge indices.
+    /// Runs in place; bucket and index capacity already covers the live set.
+    pub fn compact(self: *RiskGraph) void {
+        if (self.dead_edges == 0) return;
+
+        var it = self.adjacency.valueIterator();
+        while (it.next()) |bucket| bucket.clearRetainingCapacity();
+        self.index.clearRetainingCapacity();
+
+        var live: usize = 0;
+        for (self.edges.items, self.slots.items) |edge, slot| {
+            if (slot.bucket_pos == no_edge) continue;
+            const bucket = self.adjacency.getPtr(edge.from).?;
+            self.edges.items[live] = edge;
+            self.slots.items[live] = .{ .bucket_pos = bucket.items.len, .next_dup = no_edge };
+            bucket.appendAssumeCapacity(live);
+            self.linkIndex(live);
+            live += 1;
+        }
+
+        self.edges.shrinkRetainingCapacity(live);
+        self.slots.shrinkRetainingCapacity(live);
+        self.dead_edges = 0;
+    }
+
+    /// Append edge `edge_idx` to the duplicate chain of its key
+    /// (capacity must be reserved).
+    fn linkIndex(self: *RiskGraph, edge_idx: usize) void {
+        const edge = self.edges.items[edge_idx];
+        const entry = self.index.getOrPutAssumeCapacity(edgeKey(edge.from, edge.to));
+        if (entry.found_existing) {
+            self.slots.items[entry.value_ptr.tail].next_dup = edge_idx;
+            entry.value_ptr.tail = edge_idx;
+        } else {
+            entry.value_ptr.* = .{ .head = edge_idx, .tail = edge_idx };
+        }
+    }
+
+    /// Whether `edges.items[edge_idx]` is live (not tombstoned)
+    pub fn isLive(self: *const RiskGraph, edge_idx: usize) bool {
+        return self.slots.items[edge_idx].bucket_pos != no_edge;
     }
 
     pub fn neighbors(self: *const RiskGraph, node: NodeId) []const usize {
@@ -125,18 +321,15 @@ pub const RiskGraph = struct {
         return self.nodes.items.len;
     }
 
+    /// Number of live edges
     pub fn edgeCount(self: *const RiskGraph) usize {
-        return self.edges.items.len;
+        return self.edges.items.len - self.dead_edges;
     }
 
+    /// Oldest live edge `from -> to`
     pub fn getEdge(self: *const RiskGraph, from: NodeId, to: NodeId) ?RiskEdge {
-        if (self.adjacency.get(from)) |indices| {
-            for (indices.items) |idx| {
-                const edge = self.edges.items[idx];
-                if (edge.to == to) return edge;
-            }
-        }
-        return null;
+        const chain = self.index.get(edgeKey(from, to)) orelse return null;
+        return self.edges.items[chain.head];
     }
 };
 
@@ -158,3 +351,139 @@ test "RiskGraph: basic operations" {
     try std.testing.expectEqual(graph.neighbors(0).len, 1);
     try std.testing.expect(graph.edges.items[1].isBetrayal());
 }
+
+test "RiskGraph: batched edge insertion" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    const ts = SovereignTimestamp.fromSeconds(0, .system_boot);
+    try graph.addEdge(.{ .from = 1, .to = 0, .risk = 0.1, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts });
+
+    const batch = [_]RiskEdge{
+        .{ .from = 2, .to = 0, .risk = 0.2, .timestamp = ts, .nonce = 1, .level = 3, .expires_at = ts },
+        .{ .from = 1, .to = 2, .risk = 0.3, .timestamp = ts, .nonce = 2, .level = 3, .expires_at = ts },
+        .{ .from = 2, .to = 1, .risk = -0.4, .timestamp = ts, .nonce = 3, .level = 1, .expires_at = ts },
+        .{ .from = 1, .to = 3, .risk = 0.5, .timestamp = ts, .nonce = 4, .level = 3, .expires_at = ts },
+    };
+    try graph.addEdges(&batch);
+
+    try std.testing.expectEqual(@as(usize, 5), graph.edgeCount());
+
+    // Existing bucket extended in batch order
+    const n1 = graph.neighbors(1);
+    try std.testing.expectEqual(@as(usize, 3), n1.len);
+    try std.testing.expectEqual(@as(usize, 0), n1[0]);
+    try std.testing.expectEqual(@as(NodeId, 2), graph.edges.items[n1[1]].to);
+    try std.testing.expectEqual(@as(NodeId, 3), graph.edges.items[n1[2]].to);
+
+    // New bucket created once
+    const n2 = graph.neighbors(2);
+    try std.testing.expectEqual(@as(usize, 2), n2.len);
+    try std.testing.expectEqual(@as(NodeId, 0), graph.edges.items[n2[0]].to);
+    try std.testing.expectEqual(@as(NodeId, 1), graph.edges.items[n2[1]].to);
+
+    try std.testing.expect(graph.getEdge(2, 1).?.isBetrayal());
+
+    // Empty batch is a no-op
+    try graph.addEdges(&[_]RiskEdge{});
+    try std.testing.expectEqual(@as(usize, 5), graph.edgeCount());
+}
+
+test "RiskGraph: failed batch drops the buckets it created" {
+    const ts = SovereignTimestamp.fromSeconds(0, .system_boot);
+    const batch = [_]RiskEdge{
+        .{ .from = 2, .to = 0, .risk = 0.2, .timestamp = ts, .nonce = 1, .level = 3, .expires_at = ts },
+        .{ .from = 1, .to = 2, .risk = 0.3, .timestamp = ts, .nonce = 2, .level = 3, .expires_at = ts },
+        .{ .from = 3, .to = 1, .risk = 0.4, .timestamp = ts, .nonce = 3, .level = 3, .expires_at = ts },
+    };
+
+    // Fail each allocation in turn until the batch goes through
+    var fail_index: usize = 0;
+    while (true) : (fail_index += 1) {
+        var graph = RiskGraph.init(std.testing.allocator);
+        defer graph.deinit();
+        try graph.addEdge(.{ .from = 1, .to = 0, .risk = 0.1, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts });
+        // Frees pass through to the testing allocator
+        var failing = std.testing.FailingAllocator.init(std.testing.allocator, .{ .fail_index = fail_index });
+        graph.allocator = failing.allocator();
+
+        if (graph.addEdges(&batch)) |_| {
+            try std.testing.expectEqual(@as(u32, 3), graph.adjacency.count());
+            break;
+        } else |err| {
+            try std.testing.expectEqual(error.OutOfMemory, err);
+            try std.testing.expectEqual(@as(u32, 1), graph.adjacency.count());
+            try std.testing.expectEqual(@as(usize, 1), graph.neighbors(1).len);
+            try std.testing.expectEqual(@as(usize, 1), graph.edgeCount());
+        }
+    }
+}
+
+test "RiskGraph: O(1) removal keeps adjacency and index consistent" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    const ts = SovereignTimestamp.fromSeconds(0, .system_boot);
+    try graph.addEdge(.{ .from = 0, .to = 1, .risk = 0.1, .timestamp = ts, .nonce = 0, .level = 3, .expires_at = ts });
+    try graph.addEdge(.{ .from = 0, .to = 2, .risk = 0.2, .timestamp = ts, .nonce = 1, .level = 3, .expires_at = ts });
+    try graph.addEdge(.{ .from = 0, .to = 1, .risk = 0.3, .timestamp = ts, .nonce = 2, .level = 3, .expires_at = ts });
+    try graph.addEdge(.{ .from = 0, .to = 3, .risk = 0.4, .timestamp = ts, .nonce = 3, .level = 3, .expires_at = ts });
+
+    // Oldest duplicate goes first; the newer one takes over the key
+    try std.testing.expectEqual(@as(u64, 0), graph.removeEdge(0, 1).?.nonce);
+    try std.testing.expectEqual(@as(u64, 2), graph.getEdge(0, 1).?.nonce);
+    try std.testing.expectEqual(@as(usize, 3), graph.edgeCount());
+    try std.testing.expect(!graph.isLive(0));
+
+    // Buckets only hold live edges, whatever got swapped around
+    for (graph.neighbors(0)) |idx| try std.testing.expect(graph.isLive(idx));
+    try std.testing.expectEqual(@as(usize, 3), graph.neighbors(0).len);
+
+    try std.testing.expect(graph.removeEdge(0, 2) != null);
+    try std.testing.expect(graph.removeEdge(0, 2) == null);
+    try std.testing.expect(graph.removeEdge(5, 6) == null);
+    try std.testing.expectEqual(@as(f64, 0.4), graph.getEdge(0, 3).?.risk);
+
+    graph.compact();
+    try std.testing.expectEqual(@as(usize, 2), graph.edges.items.len);
+    try std.testing.expectEqual(@as(u64, 2), graph.edges.items[graph.neighbors(0)[0]].nonce);
+    try std.testing.expectEqual(@as(u64, 3), graph.edges.items[graph.neighbors(0)[1]].nonce);
+    try std.testing.expectEqual(@as(u64, 2), graph.getEdge(0, 1).?.nonce);
+}
+
+test "RiskGraph: revocation storm compacts automatically" {
+    const allocator = std.testing.allocator;
+    var graph = RiskGraph.init(allocator);
+    defer graph.deinit();
+
+    const ts = SovereignTimestamp.fromSeconds(0, .system_boot);
+    const n: u32 = 4 * RiskGraph.compact_min_dead;
+    for (0..n) |i| {
+        try graph.addEdge(.{ .from = @intCast(i % 7), .to = @intCast(i), .risk = 0.1, .timestamp = ts, .nonce = i, .level = 3, .expires_at = ts });
+    }
+
+    // Revoke every edge with an even target
+    var i: u32 = 0;
+    while (i < n) : (i += 2) {
+        try std.testing.expect(graph.removeEdge(i % 7, i) != null);
+    }
+
+    try std.testing.expectEqual(@as(usize, n / 2), graph.edgeCount());
+    try std.testing.expect(graph.dead_edges < n / 2); // compaction ran
+    i = 1;
+    while (i < n) : (i += 2) {
+        try std.testing.expectEqual(@as(u64, i), graph.getEdge(i % 7, i).?.nonce);
+    }
+
+    var total: usize = 0;
+    for (0..7) |from| {
+        for (graph.neighbors(@intCast(from))) |idx| {
+            try std.testing.expect(graph.isLive(idx));
+            try std.testing.expectEqual(@as(NodeId, @intCast(from)), graph.edges.items[idx].from);
+        }
+        total += graph.neighbors(@intCast(from)).len;
+    }
+    try std.testing.expectEqual(@as(usize, n / 2), total);
+}
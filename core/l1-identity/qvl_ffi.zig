@@ -6,20 +6,33 @@
 //! - Betrayal detection (Bellman-Ford)
 //! - Graph mutations
 //!
-//! Thread Safety: Single-threaded only (initial version)
+//! Thread Safety: Every context call is serialized by the context lock.
+//! Concurrent readers should use snapshots instead: a writer publishes with
+//! qvl_snapshot_publish, readers take lock-free handles with
+//! qvl_snapshot_acquire/qvl_snapshot_release and query those.
+//! qvl_detect_betrayal_all fans out internally over worker threads.
 
 const std = @import("std");
 const time = @import("time");
 
-const qvl = @import("qvl.zig");
-const pop_mod = @import("proof_of_path.zig");
-const trust_graph = @import("trust_graph.zig");
+// Public so in-tree Zig callers (bench/) share this module's copies
+pub const qvl = @import("qvl.zig");
+pub const pop_mod = @import("proof_of_path.zig");
+pub const trust_graph = @import("trust_graph.zig");
 const slash = @import("slash.zig");
 
-const RiskGraph = qvl.types.RiskGraph;
+const PersistentGraph = qvl.storage.PersistentGraph;
+const DetectionCache = qvl.detection_cache.DetectionCache;
+const PopVerifyCache = qvl.pop_cache.PopVerifyCache;
+const GraphSnapshot = qvl.snapshot.GraphSnapshot;
+const SnapshotCell = qvl.snapshot.SnapshotCell;
 const RiskEdge = qvl.types.RiskEdge;
 const ReputationMap = qvl.pop.ReputationMap;
+const PlanCache = qvl.gql.PlanCache;
+const QueryResult = qvl.gql.engine.Result;
+const metrics = qvl.metrics;
 const ProofOfPath = pop_mod.ProofOfPath;
+const ProofView = pop_mod.ProofView;
 const PathVerdict = pop_mod.PathVerdict;
 const SovereignTimestamp = time.SovereignTimestamp;
 
@@ -30,9 +43,152 @@ const SovereignTimestamp = time.SovereignTimestamp;
 /// Opaque handle for QVL context (hides Zig internals)
 pub const QvlContext = struct {
     allocator: std.mem.Allocator,
-    risk_graph: RiskGraph,
+    /// Risk graph plus its edge log / checkpoint files (memory only unless
+    /// QvlOptions.store_path is set)
+    store: PersistentGraph,
     reputation: ReputationMap,
     trust_graph: trust_graph.CompactTrustGraph,
+    /// Last detection result per watched source, kept current across mutations
+    betrayal_cache: DetectionCache,
+    /// Memoized PoP verdicts, tagged with the trust graph version
+    pop_cache: PopVerifyCache,
+    /// Serializes all calls that touch the live (mutable) state above
+    lock: std.Thread.Mutex = .{},
+    /// Last published read-only snapshot (lock-free readers)
+    snapshots: SnapshotCell,
+    /// Compiled GQL plans (qvl_query), internally locked
+    plans: PlanCache,
+    /// Shared with published snapshots, which may outlive the context
+    heap: *SharedHeap,
+    /// Per-entry-point latency (qvl_get_stats)
+    stats: metrics.StageStats(Stage) = .{},
+    /// Per-query scratch arena, reset after each call (null = `allocator`)
+    scratch: ?std.heap.ArenaAllocator = null,
+    /// Arena bytes kept across resets
+    scratch_retain: usize = 0,
+    /// Locked view of `scratch` for calls that fan out over threads
+    scratch_shared: std.heap.ThreadSafeAllocator = undefined,
+
+    /// Allocator for memory that does not outlive the current call
+    fn scratchAllocator(self: *QvlContext) std.mem.Allocator {
+        return if (self.scratch) |*arena| arena.allocator() else self.allocator;
+    }
+
+    /// Thread-safe scratch for multi-threaded workers
+    fn sharedScratchAllocator(self: *QvlContext) std.mem.Allocator {
+        return if (self.scratch != null) self.scratch_shared.allocator() else self.allocator;
+    }
+
+    /// Release the current call's scratch memory (keeps up to `scratch_retain`)
+    fn endQuery(self: *QvlContext) void {
+        if (self.scratch) |*arena| _ = arena.reset(.{ .retain_with_limit = self.scratch_retain });
+    }
+};
+
+/// Instrumented entry points, in QvlStage order
+pub const Stage = enum(u8) {
+    detect_betrayal,
+    detect_betrayal_all,
+    verify_pop,
+    verify_pop_batch,
+    query,
+    add_edges,
+    revoke_edge,
+    snapshot_publish,
+    checkpoint,
+};
+
+pub const STAGE_COUNT = 9;
+
+comptime {
+    std.debug.assert(@typeInfo(Stage).@"enum".fields.len == STAGE_COUNT);
+}
+
+/// std.mem.Allocator over C allocation callbacks
+const HostAllocator = struct {
+    alloc_fn: *const fn (?*anyopaque, usize, usize) callconv(.c) ?*anyopaque,
+    free_fn: *const fn (?*anyopaque, ?*anyopaque, usize, usize) callconv(.c) void,
+    user_data: ?*anyopaque,
+
+    fn allocator(self: *HostAllocator) std.mem.Allocator {
+        return .{
+            .ptr = self,
+            .vtable = &.{
+                .alloc = alloc,
+                .resize = std.mem.Allocator.noResize,
+                .remap = std.mem.Allocator.noRemap,
+                .free = free,
+            },
+        };
+    }
+
+    fn alloc(ptr: *anyopaque, len: usize, alignment: std.mem.Alignment, ret_addr: usize) ?[*]u8 {
+        _ = ret_addr;
+        const self: *HostAllocator = @ptrCast(@alignCast(ptr));
+        const mem = self.alloc_fn(self.user_data, len, alignment.toByteUnits()) orelse return null;
+        return @ptrCast(mem);
+    }
+
+    fn free(ptr: *anyopaque, memory: []u8, alignment: std.mem.Alignment, ret_addr: usize) void {
+        _ = ret_addr;
+        const self: *HostAllocator = @ptrCast(@alignCast(ptr));
+        self.free_fn(self.user_data, memory.ptr, memory.len, alignment.toByteUnits());
+    }
+};
+
+/// Heap state shared by a context and the snapshots and query results it
+/// hands out. Refcounted so those released after qvl_deinit still reach the
+/// host hooks and counters; the last holder frees the block through them.
+const SharedHeap = struct {
+    /// Caller-provided hooks (qvl_init_with_options), null = C heap
+    host: ?HostAllocator,
+    /// Counts everything allocated through `allocator` (qvl_get_stats)
+    counting: metrics.CountingAllocator,
+    refs: std.atomic.Value(u32) = .init(1),
+
+    fn create(host: ?HostAllocator) ?*SharedHeap {
+        var hooks = host;
+        const bootstrap = if (hooks) |*h| h.allocator() else std.heap.c_allocator;
+        const self = bootstrap.create(SharedHeap) catch return null;
+        self.* = .{ .host = host, .counting = undefined };
+        self.counting = .{ .child = self.base() };
+        return self;
+    }
+
+    /// Uncounted heap (the context struct and this block itself)
+    fn base(self: *SharedHeap) std.mem.Allocator {
+        return if (self.host) |*h| h.allocator() else std.heap.c_allocator;
+    }
+
+    fn allocator(self: *SharedHeap) std.mem.Allocator {
+        return self.counting.allocator();
+    }
+
+    fn retain(self: *SharedHeap) void {
+        _ = self.refs.fetchAdd(1, .monotonic);
+    }
+
+    fn release(self: *SharedHeap) void {
+        if (self.refs.fetchSub(1, .acq_rel) != 1) return;
+        // The hooks live inside the block: free through a copy
+        var hooks = self.host;
+        const bootstrap = if (hooks) |*h| h.allocator() else std.heap.c_allocator;
+        bootstrap.destroy(self);
+    }
+
+    fn holder(self: *SharedHeap) qvl.snapshot.Holder {
+        return .{ .ptr = self, .retain = retainOpaque, .release = releaseOpaque };
+    }
+
+    fn retainOpaque(ptr: *anyopaque) void {
+        const self: *SharedHeap = @ptrCast(@alignCast(ptr));
+        self.retain();
+    }
+
+    fn releaseOpaque(ptr: *anyopaque) void {
+        const self: *SharedHeap = @ptrCast(@alignCast(ptr));
+        self.release();
+    }
 };
 
 // ============================================================================
@@ -60,6 +216,62 @@ pub const AnomalyScore = extern struct {
     reason: u8, // AnomalyReason enum
 };
 
+pub const QvlOptions = extern struct {
+    /// > 0: per-query scratch arena, keeping up to this many bytes between calls
+    scratch_bytes: usize = 0,
+    /// Optional allocator callbacks (both or neither; default C heap)
+    alloc_fn: ?*const fn (?*anyopaque, usize, usize) callconv(.c) ?*anyopaque = null,
+    free_fn: ?*const fn (?*anyopaque, ?*anyopaque, usize, usize) callconv(.c) void = null,
+    user_data: ?*anyopaque = null,
+    /// NUL-terminated directory persisting the risk graph (NULL = memory only)
+    store_path: [*c]const u8 = null,
+};
+
+/// Latency summary of one stage (qvl_get_stats)
+pub const StageStatsC = extern struct {
+    calls: u64,
+    total_ns: u64,
+    max_ns: u64,
+    /// Bucket upper bounds: within 2x of the true percentile
+    p50_ns: u64,
+    p99_ns: u64,
+};
+
+pub const StatsC = extern struct {
+    stages: [STAGE_COUNT]StageStatsC,
+    allocations: u64,
+    frees: u64,
+    bytes_allocated: u64,
+    live_bytes: u64,
+};
+
+/// qvl_query result handed to C. Holds a heap reference so it can be freed
+/// after qvl_deinit.
+pub const QueryHandle = struct {
+    result: QueryResult,
+    heap: *SharedHeap,
+};
+
+/// One result column of qvl_query
+pub const QueryColumnC = extern struct {
+    name: [*c]const u8,
+    name_len: usize,
+    /// QUERY_COLUMN_U32 or QUERY_COLUMN_F64
+    kind: u8,
+    /// `rows` values of the column's kind
+    values: ?*const anyopaque,
+};
+
+pub const QUERY_COLUMN_U32: u8 = 0;
+pub const QUERY_COLUMN_F64: u8 = 1;
+
+/// qvl_query error codes
+pub const QUERY_ERROR_ARGS: c_int = -1;
+pub const QUERY_ERROR_NO_MEMORY: c_int = -2;
+pub const QUERY_ERROR_PARSE: c_int = -3;
+pub const QUERY_ERROR_UNSUPPORTED: c_int = -4;
+pub const QUERY_ERROR_TOO_LARGE: c_int = -5;
+
 pub const RiskEdgeC = extern struct {
     from: u32,
     to: u32,
@@ -76,32 +288,104 @@ pub const RiskEdgeC = extern struct {
 
 /// Initialize QVL context
 /// Returns NULL on allocation failure
-export fn qvl_init() callconv(.c) ?*QvlContext {
-    // Use C allocator for FFI (heap allocations)
-    const allocator = std.heap.c_allocator;
+pub export fn qvl_init() callconv(.c) ?*QvlContext {
+    return qvl_init_with_options(null);
+}
+
+/// Initialize QVL context with allocator/store options (NULL = qvl_init defaults)
+/// Returns NULL on allocation failure, inconsistent options or an
+/// unreadable store
+export fn qvl_init_with_options(options: ?*const QvlOptions) callconv(.c) ?*QvlContext {
+    const opts: QvlOptions = if (options) |o| o.* else .{};
+    if ((opts.alloc_fn == null) != (opts.free_fn == null)) return null;
+
+    // Use C allocator for FFI (heap allocations) unless the host brings its own
+    var host: ?HostAllocator = null;
+    if (opts.alloc_fn) |alloc_fn| {
+        host = .{ .alloc_fn = alloc_fn, .free_fn = opts.free_fn.?, .user_data = opts.user_data };
+    }
+    const heap = SharedHeap.create(host) orelse return null;
+    // The context takes its own reference
+    defer heap.release();
+    return initContext(heap, opts) catch null;
+}
+
+fn initContext(heap: *SharedHeap, opts: QvlOptions) !*QvlContext {
+    const bootstrap = heap.base();
+    const ctx = try bootstrap.create(QvlContext);
+    errdefer bootstrap.destroy(ctx);
+    const allocator = heap.allocator();
 
-    const ctx = allocator.create(QvlContext) catch return null;
+    var pop_cache = try PopVerifyCache.init(allocator, PopVerifyCache.default_capacity);
+    errdefer pop_cache.deinit();
+    var plans = try PlanCache.init(allocator, PlanCache.default_capacity);
+    errdefer plans.deinit();
     const default_root: [32]u8 = [_]u8{0} ** 32;
+    var graph = try trust_graph.CompactTrustGraph.init(allocator, default_root, .{});
+    errdefer graph.deinit();
+    const store = if (opts.store_path != null)
+        try PersistentGraph.open(std.mem.span(opts.store_path), .{}, allocator)
+    else
+        PersistentGraph.initInMemory(allocator);
+
+    heap.retain();
     ctx.* = .{
         .allocator = allocator,
-        .risk_graph = RiskGraph.init(allocator),
+        .store = store,
         .reputation = ReputationMap.init(allocator),
-        .trust_graph = trust_graph.CompactTrustGraph.init(allocator, default_root, .{}) catch {
-            allocator.destroy(ctx);
-            return null;
-        },
+        .betrayal_cache = DetectionCache.init(allocator, DetectionCache.default_max_sources),
+        .pop_cache = pop_cache,
+        .snapshots = SnapshotCell.init(),
+        .plans = plans,
+        .trust_graph = graph,
+        .heap = heap,
     };
+    ctx.snapshots.holder = heap.holder();
+
+    if (opts.scratch_bytes > 0) {
+        ctx.scratch = std.heap.ArenaAllocator.init(allocator);
+        ctx.scratch_retain = opts.scratch_bytes;
+        ctx.scratch_shared = .{ .child_allocator = ctx.scratch.?.allocator() };
+        ctx.betrayal_cache.scratch = ctx.scratch.?.allocator();
+    }
 
     return ctx;
 }
 
+/// Copy per-stage latency and allocation counters (lock-free; callers may
+/// poll while other threads use the context)
+/// Returns 0 on success, -1 on NULL arguments
+pub export fn qvl_get_stats(ctx: ?*QvlContext, out: ?*StatsC) callconv(.c) c_int {
+    const context = ctx orelse return -1;
+    const dest = out orelse return -1;
+    for (&dest.stages, 0..) |*stage_out, i| {
+        const s = context.stats.summary(@enumFromInt(i));
+        stage_out.* = .{ .calls = s.calls, .total_ns = s.total_ns, .max_ns = s.max_ns, .p50_ns = s.p50_ns, .p99_ns = s.p99_ns };
+    }
+    const heap = context.heap.counting.stats();
+    dest.allocations = heap.allocations;
+    dest.frees = heap.frees;
+    dest.bytes_allocated = heap.bytes_allocated;
+    dest.live_bytes = heap.live_bytes;
+    return 0;
+}
+
 /// Cleanup and free QVL context
-export fn qvl_deinit(ctx: ?*QvlContext) callconv(.c) void {
+pub export fn qvl_deinit(ctx: ?*QvlContext) callconv(.c) void {
     const context = ctx orelse return;
-    context.risk_graph.deinit();
+    context.snapshots.deinit();
+    context.store.close();
     context.reputation.deinit();
+    context.betrayal_cache.deinit();
+    context.pop_cache.deinit();
+    context.plans.deinit();
     context.trust_graph.deinit();
-    context.allocator.destroy(context);
+    if (context.scratch) |*arena| arena.deinit();
+
+    // Snapshots still out keep the heap alive past this point
+    const heap = context.heap;
+    heap.base().destroy(context);
+    heap.release();
 }
 
 // ============================================================================
@@ -116,6 +400,8 @@ export fn qvl_get_trust_score(
     did_len: usize,
 ) callconv(.c) f64 {
     const context = ctx orelse return -1.0;
+    context.lock.lock();
+    defer context.lock.unlock();
     if (did_len != 32) return -1.0; // DID must be 32 bytes
 
     const did_bytes = did[0..did_len];
@@ -134,6 +420,8 @@ export fn qvl_get_trust_score(
 /// Returns -1.0 on error
 export fn qvl_get_reputation(ctx: ?*QvlContext, node_id: u32) callconv(.c) f64 {
     const context = ctx orelse return -1.0;
+    context.lock.lock();
+    defer context.lock.unlock();
     return context.reputation.get(node_id);
 }
 
@@ -142,7 +430,7 @@ export fn qvl_get_reputation(ctx: ?*QvlContext, node_id: u32) callconv(.c) f64 {
 // ============================================================================
 
 /// Verify a serialized PoP proof
-export fn qvl_verify_pop(
+pub export fn qvl_verify_pop(
     ctx: ?*QvlContext,
     proof_bytes: [*c]const u8,
     proof_len: usize,
@@ -150,24 +438,83 @@ export fn qvl_verify_pop(
     receiver_did: [*c]const u8,
 ) callconv(.c) PopVerdict {
     const context = ctx orelse return .invalid_endpoints;
+    context.lock.lock();
+    defer context.lock.unlock();
+    const span = context.stats.start(.verify_pop);
+    defer span.end();
 
-    // Deserialize proof
-    const proof_slice = proof_bytes[0..proof_len];
-    var proof = ProofOfPath.deserialize(context.allocator, proof_slice) catch {
-        return .invalid_endpoints;
-    };
-    defer proof.deinit();
+    if (proof_bytes == null or sender_did == null or receiver_did == null) return .invalid_endpoints;
+
+    return popVerdictToC(verifyPopCached(
+        context,
+        proof_bytes[0..proof_len],
+        sender_did[0..32].*,
+        receiver_did[0..32].*,
+    ));
+}
+
+/// One serialized proof for qvl_verify_pop_batch
+pub const PopProofC = extern struct {
+    proof_bytes: [*c]const u8,
+    proof_len: usize,
+    sender_did: [*c]const u8,
+    receiver_did: [*c]const u8,
+};
+
+/// Verify `count` serialized PoP proofs under a single lock acquisition
+/// Proofs are read in place (no per-proof allocation); verdicts go to
+/// `out_verdicts[0..count]`.
+/// Returns number of valid proofs, or -1 on error
+export fn qvl_verify_pop_batch(
+    ctx: ?*QvlContext,
+    proofs: [*c]const PopProofC,
+    count: usize,
+    out_verdicts: [*c]PopVerdict,
+) callconv(.c) c_int {
+    const context = ctx orelse return -1;
+    if (count == 0) return 0;
+    if (proofs == null or out_verdicts == null) return -1;
+    context.lock.lock();
+    defer context.lock.unlock();
+    const span = context.stats.start(.verify_pop_batch);
+    defer span.end();
 
-    // Copy DIDs
-    var sender: [32]u8 = undefined;
-    var receiver: [32]u8 = undefined;
-    @memcpy(&sender, sender_did[0..32]);
-    @memcpy(&receiver, receiver_did[0..32]);
+    var valid: c_int = 0;
+    for (proofs[0..count], out_verdicts[0..count]) |p, *out| {
+        if (p.proof_bytes == null or p.sender_did == null or p.receiver_did == null) {
+            out.* = .invalid_endpoints;
+            continue;
+        }
+        out.* = popVerdictToC(verifyPopCached(
+            context,
+            p.proof_bytes[0..p.proof_len],
+            p.sender_did[0..32].*,
+            p.receiver_did[0..32].*,
+        ));
+        if (out.* == .valid) valid += 1;
+    }
+    return valid;
+}
 
-    // Verify
-    const verdict = proof.verify(receiver, sender, &context.trust_graph);
+/// Zero-copy verification through the context's verdict cache
+/// (caller holds the context lock)
+fn verifyPopCached(
+    context: *QvlContext,
+    bytes: []const u8,
+    sender: [32]u8,
+    receiver: [32]u8,
+) PathVerdict {
+    const key = PopVerifyCache.keyFor(bytes, receiver, sender);
+    const version = context.trust_graph.version;
+    if (context.pop_cache.lookup(key, version, SovereignTimestamp.now())) |verdict| return verdict;
+
+    const view = ProofView.parse(bytes) catch return .invalid_endpoints;
+    const verdict = view.verify(receiver, sender, &context.trust_graph);
+    context.pop_cache.insert(key, version, verdict, view.expires_at);
+    return verdict;
+}
 
-    // Convert to C enum
+fn popVerdictToC(verdict: PathVerdict) PopVerdict {
     return switch (verdict) {
         .valid => .valid,
         .invalid_endpoints => .invalid_endpoints,
@@ -178,26 +525,223 @@ export fn qvl_verify_pop(
     };
 }
 
+// ============================================================================
+// SNAPSHOTS (lock-free readers)
+// ============================================================================
+
+/// Freeze the current graph/reputation state and publish it to readers
+/// Returns the new snapshot version (> 0), or 0 on error
+export fn qvl_snapshot_publish(ctx: ?*QvlContext) callconv(.c) u64 {
+    const context = ctx orelse return 0;
+    context.lock.lock();
+    defer context.lock.unlock();
+    const span = context.stats.start(.snapshot_publish);
+    defer span.end();
+
+    return publishSnapshot(context) catch 0;
+}
+
+/// Publish the live state; caller holds the context lock. Right after a
+/// checkpoint the risk graph is served straight from the mapped file.
+fn publishSnapshot(context: *QvlContext) !u64 {
+    // Snapshots may outlive the context: allocate from the shared heap
+    const allocator = context.heap.allocator();
+    if (try context.store.mapCsr()) |csr| {
+        return context.snapshots.publishCsr(allocator, csr, &context.reputation, &context.trust_graph);
+    }
+    return context.snapshots.publish(
+        allocator,
+        &context.store.graph,
+        &context.reputation,
+        &context.trust_graph,
+    );
+}
+
+/// Take a reference to the latest published snapshot (lock-free)
+/// Returns NULL if nothing has been published yet
+export fn qvl_snapshot_acquire(ctx: ?*QvlContext) callconv(.c) ?*GraphSnapshot {
+    const context = ctx orelse return null;
+    return context.snapshots.acquire();
+}
+
+/// Drop a snapshot reference (NULL-safe). May outlive qvl_deinit.
+export fn qvl_snapshot_release(snap: ?*GraphSnapshot) callconv(.c) void {
+    const s = snap orelse return;
+    s.release();
+}
+
+/// Version of a snapshot (0 for NULL)
+export fn qvl_snapshot_version(snap: ?*const GraphSnapshot) callconv(.c) u64 {
+    const s = snap orelse return 0;
+    return s.version;
+}
+
+/// Reputation score for a node ID as of the snapshot
+/// Returns -1.0 on error
+export fn qvl_snapshot_get_reputation(snap: ?*const GraphSnapshot, node_id: u32) callconv(.c) f64 {
+    const s = snap orelse return -1.0;
+    return s.reputation.get(node_id);
+}
+
+/// Verify a serialized PoP proof against the snapshot's trust graph
+export fn qvl_snapshot_verify_pop(
+    snap: ?*const GraphSnapshot,
+    proof_bytes: [*c]const u8,
+    proof_len: usize,
+    sender_did: [*c]const u8,
+    receiver_did: [*c]const u8,
+) callconv(.c) PopVerdict {
+    const s = snap orelse return .invalid_endpoints;
+    if (proof_bytes == null or sender_did == null or receiver_did == null) return .invalid_endpoints;
+
+    const view = ProofView.parse(proof_bytes[0..proof_len]) catch return .invalid_endpoints;
+    return popVerdictToC(view.verify(receiver_did[0..32].*, sender_did[0..32].*, &s.trust));
+}
+
+/// Betrayal detection from source node against the snapshot
+/// Returns anomaly score (0.0 = clean, 0.9+ = critical)
+export fn qvl_snapshot_detect_betrayal(snap: ?*const GraphSnapshot, source_node: u32) callconv(.c) AnomalyScore {
+    const clean = AnomalyScore{ .node = source_node, .score = 0.0, .reason = @intFromEnum(AnomalyReason.none) };
+    const s = snap orelse return clean;
+
+    var result = qvl.betrayal.detectBetrayalCsr(&s.risk, source_node, s.allocator) catch return clean;
+    defer result.deinit();
+
+    if (result.betrayal_cycles.items.len == 0) return clean;
+    return .{
+        .node = source_node,
+        .score = result.computeAnomalyScore(),
+        .reason = @intFromEnum(AnomalyReason.negative_cycle),
+    };
+}
+
+// ============================================================================
+// GQL QUERIES
+// ============================================================================
+
+/// Run a GQL query against a snapshot (NULL = latest published; one is
+/// published first if there is none). Plans are compiled once per query
+/// text and cached in the context.
+/// Returns the row count with *out_result set (free it with
+/// qvl_query_result_free), or a QUERY_ERROR_* code.
+export fn qvl_query(
+    ctx: ?*QvlContext,
+    snap: ?*GraphSnapshot,
+    query: [*c]const u8,
+    query_len: usize,
+    out_result: [*c]?*QueryHandle,
+) callconv(.c) c_int {
+    const context = ctx orelse return QUERY_ERROR_ARGS;
+    if (query == null or out_result == null) return QUERY_ERROR_ARGS;
+    out_result.* = null;
+    const span = context.stats.start(.query);
+    defer span.end();
+
+    const s = if (snap) |given| blk: {
+        given.retain();
+        break :blk given;
+    } else context.snapshots.acquire() orelse blk: {
+        context.lock.lock();
+        defer context.lock.unlock();
+        _ = publishSnapshot(context) catch return QUERY_ERROR_NO_MEMORY;
+        break :blk context.snapshots.acquire() orelse return QUERY_ERROR_NO_MEMORY;
+    };
+    defer s.release();
+
+    const plan = context.plans.acquire(query[0..query_len]) catch |err| return queryErrorToC(err);
+    defer plan.release();
+
+    // Results may outlive the context: allocate from the shared heap
+    const allocator = context.heap.allocator();
+    const handle = allocator.create(QueryHandle) catch return QUERY_ERROR_NO_MEMORY;
+    handle.result = qvl.gql.execute(allocator, plan, .{ .csr = &s.risk, .reputation = &s.reputation }, .{}) catch |err| {
+        allocator.destroy(handle);
+        return queryErrorToC(err);
+    };
+    context.heap.retain();
+    handle.heap = context.heap;
+    out_result.* = handle;
+    return std.math.cast(c_int, handle.result.rows) orelse std.math.maxInt(c_int);
+}
+
+fn queryErrorToC(err: anyerror) c_int {
+    return switch (err) {
+        error.OutOfMemory => QUERY_ERROR_NO_MEMORY,
+        error.ResultTooLarge => QUERY_ERROR_TOO_LARGE,
+        error.UnsupportedQuery,
+        error.UnknownLabel,
+        error.UnknownProperty,
+        error.UnknownVariable,
+        error.TypeMismatch,
+        error.TooManyVariables,
+        => QUERY_ERROR_UNSUPPORTED,
+        else => QUERY_ERROR_PARSE,
+    };
+}
+
+/// Column count of a query result (0 for NULL)
+export fn qvl_query_result_columns(res: ?*const QueryHandle) callconv(.c) usize {
+    const r = res orelse return 0;
+    return r.result.columns.len;
+}
+
+/// Row count of a query result (0 for NULL)
+export fn qvl_query_result_rows(res: ?*const QueryHandle) callconv(.c) usize {
+    const r = res orelse return 0;
+    return r.result.rows;
+}
+
+/// Describe column `index`; values stay valid until the result is freed
+/// Returns 0 on success, -1 on bad arguments
+export fn qvl_query_result_column(res: ?*const QueryHandle, index: usize, out: ?*QueryColumnC) callconv(.c) c_int {
+    const r = res orelse return -1;
+    const o = out orelse return -1;
+    if (index >= r.result.columns.len) return -1;
+
+    const col = &r.result.columns[index];
+    o.* = .{
+        .name = col.name.ptr,
+        .name_len = col.name.len,
+        .kind = @intFromEnum(col.kind),
+        .values = switch (col.kind) {
+            .u32 => @ptrCast(col.u32s.items.ptr),
+            .f64 => @ptrCast(col.f64s.items.ptr),
+        },
+    };
+    return 0;
+}
+
+/// Free a query result (NULL-safe). May outlive qvl_deinit.
+export fn qvl_query_result_free(res: ?*QueryHandle) callconv(.c) void {
+    const r = res orelse return;
+    const heap = r.heap;
+    r.result.deinit();
+    heap.allocator().destroy(r);
+    heap.release();
+}
+
 // ============================================================================
 // BETRAYAL DETECTION
 // ============================================================================
 
-/// Run Bellman-Ford betrayal detection from source node
+/// Run Bellman-Ford betrayal detection from source node (queue-based engine)
+/// The source becomes watched: its result is cached and updated
+/// incrementally by later graph mutations.
 /// Returns anomaly score (0.0 = clean, 0.9+ = critical)
 export fn qvl_detect_betrayal(
     ctx: ?*QvlContext,
     source_node: u32,
 ) callconv(.c) AnomalyScore {
     const context = ctx orelse return .{ .node = 0, .score = 0.0, .reason = @intFromEnum(AnomalyReason.none) };
+    context.lock.lock();
+    defer context.lock.unlock();
+    const span = context.stats.start(.detect_betrayal);
+    defer span.end();
+    defer context.endQuery();
 
-    var result = qvl.betrayal.detectBetrayal(
-        &context.risk_graph,
-        source_node,
-        context.allocator,
-    ) catch {
+    const result = context.betrayal_cache.get(&context.store.graph, source_node) catch {
         return .{ .node = 0, .score = 0.0, .reason = @intFromEnum(AnomalyReason.none) };
     };
-    defer result.deinit();
 
     if (result.betrayal_cycles.items.len > 0) {
         // Betrayal detected - compute anomaly score
@@ -212,6 +756,45 @@ export fn qvl_detect_betrayal(
     return .{ .node = source_node, .score = 0.0, .reason = @intFromEnum(AnomalyReason.none) };
 }
 
+/// Run betrayal detection from every registered node across worker threads
+/// Writes up to `max_scores` entries (one per node on a betrayal ring,
+/// sorted by node) to `out_scores`; a buffer of one entry per registered
+/// node always suffices. `threads` = 0 uses one worker per CPU.
+/// Returns total number of flagged nodes, or < 0 on error
+export fn qvl_detect_betrayal_all(
+    ctx: ?*QvlContext,
+    threads: u32,
+    out_scores: [*c]AnomalyScore,
+    max_scores: usize,
+) callconv(.c) c_int {
+    const context = ctx orelse return -1;
+    context.lock.lock();
+    defer context.lock.unlock();
+    const span = context.stats.start(.detect_betrayal_all);
+    defer span.end();
+    defer context.endQuery();
+
+    var result = qvl.betrayal.detectAll(
+        &context.store.graph,
+        context.sharedScratchAllocator(),
+        .{ .threads = threads },
+    ) catch return -2;
+    defer result.deinit();
+
+    if (out_scores != null) {
+        const n = @min(result.anomalies.len, max_scores);
+        for (result.anomalies[0..n], out_scores[0..n]) |score, *out| {
+            out.* = .{
+                .node = score.node,
+                .score = score.score,
+                .reason = @intFromEnum(AnomalyReason.negative_cycle),
+            };
+        }
+    }
+
+    return @intCast(result.anomalies.len);
+}
+
 // ============================================================================
 // GRAPH MUTATIONS
 // ============================================================================
@@ -223,10 +806,91 @@ export fn qvl_add_trust_edge(
     edge_c: [*c]const RiskEdgeC,
 ) callconv(.c) c_int {
     const context = ctx orelse return -1;
+    context.lock.lock();
+    defer context.lock.unlock();
+    const span = context.stats.start(.add_edges);
+    defer span.end();
+    defer context.endQuery();
     const edge_ptr = edge_c orelse return -1;
-    const edge_val = edge_ptr.*;
+    if (!validRisk(edge_ptr.*.risk)) return EDGE_STATUS_INVALID_RISK;
+
+    const edge = riskEdgeFromC(edge_ptr.*);
+    context.store.addEdge(edge) catch return -2;
+    context.betrayal_cache.onEdgeAdded(&context.store.graph, edge);
+    return 0;
+}
+
+/// Per-edge status codes written by qvl_add_trust_edges
+pub const EDGE_STATUS_OK: c_int = 0;
+pub const EDGE_STATUS_NO_MEMORY: c_int = -2;
+pub const EDGE_STATUS_INVALID_RISK: c_int = -3;
+
+/// Risk accepted from C callers: finite, within [-1.0, 1.0]
+fn validRisk(risk: f64) bool {
+    return !std.math.isNan(risk) and risk >= -1.0 and risk <= 1.0;
+}
+
+/// Add a batch of trust edges to risk graph
+/// Edges with a NaN or out-of-range risk are rejected individually;
+/// the rest are inserted in a single pass (see RiskGraph.addEdges).
+/// If `out_status` is non-null it receives one status code per input edge,
+/// on failure too.
+/// Returns number of edges inserted (saturating at maxInt(c_int)), or < 0
+/// on error (nothing inserted)
+export fn qvl_add_trust_edges(
+    ctx: ?*QvlContext,
+    edges_c: [*c]const RiskEdgeC,
+    count: usize,
+    out_status: [*c]c_int,
+) callconv(.c) c_int {
+    const context = ctx orelse return -1;
+    context.lock.lock();
+    defer context.lock.unlock();
+    const span = context.stats.start(.add_edges);
+    defer span.end();
+    defer context.endQuery();
+    if (count == 0) return 0;
+    if (edges_c == null) return -1;
+
+    const input = edges_c[0..count];
+    const scratch = context.scratchAllocator();
+    const batch = scratch.alloc(RiskEdge, count) catch {
+        if (out_status != null) {
+            for (input, out_status[0..count]) |edge_val, *status| {
+                status.* = if (validRisk(edge_val.risk)) EDGE_STATUS_NO_MEMORY else EDGE_STATUS_INVALID_RISK;
+            }
+        }
+        return -2;
+    };
+    defer scratch.free(batch);
+
+    var accepted: usize = 0;
+    for (input, 0..) |edge_val, i| {
+        const ok = validRisk(edge_val.risk);
+        if (out_status != null) {
+            out_status[i] = if (ok) EDGE_STATUS_OK else EDGE_STATUS_INVALID_RISK;
+        }
+        if (!ok) continue;
+        batch[accepted] = riskEdgeFromC(edge_val);
+        accepted += 1;
+    }
+
+    context.store.addEdges(batch[0..accepted]) catch {
+        if (out_status != null) {
+            for (out_status[0..count]) |*status| {
+                if (status.* == EDGE_STATUS_OK) status.* = EDGE_STATUS_NO_MEMORY;
+            }
+        }
+        return -2;
+    };
+    for (batch[0..accepted]) |edge| {
+        context.betrayal_cache.onEdgeAdded(&context.store.graph, edge);
+    }
+    return @intCast(@min(accepted, std.math.maxInt(c_int)));
+}
 
-    const edge = RiskEdge{
+fn riskEdgeFromC(edge_val: RiskEdgeC) RiskEdge {
+    return .{
         .from = edge_val.from,
         .to = edge_val.to,
         .risk = edge_val.risk,
@@ -235,9 +899,6 @@ export fn qvl_add_trust_edge(
         .level = edge_val.level,
         .expires_at = SovereignTimestamp.fromNanoseconds(edge_val.expires_at_ns, .unix_1970),
     };
-
-    context.risk_graph.addEdge(edge) catch return -2;
-    return 0;
 }
 
 /// Revoke trust edge
@@ -248,18 +909,35 @@ export fn qvl_revoke_trust_edge(
     to: u32,
 ) callconv(.c) c_int {
     const context = ctx orelse return -1;
+    context.lock.lock();
+    defer context.lock.unlock();
+    const span = context.stats.start(.revoke_edge);
+    defer span.end();
 
-    // Find and remove edge
-    var i: usize = 0;
-    while (i < context.risk_graph.edges.items.len) : (i += 1) {
-        const edge = &context.risk_graph.edges.items[i];
-        if (edge.from == from and edge.to == to) {
-            _ = context.risk_graph.edges.swapRemove(i);
-            return 0;
-        }
-    }
+    const removed = context.store.removeEdge(from, to) catch return -3;
+    if (removed) |edge| context.betrayal_cache.onEdgeRemoved(edge);
+    // PoP verdicts come from the trust graph: revoke the hop there too
+    const unlinked = context.trust_graph.removeEdge(from, to);
+    if (removed == null and !unlinked) return -2; // Not found
+    // Any cached path may run through the revoked hop
+    context.pop_cache.invalidateAll();
+    return 0;
+}
+
+/// Write the risk graph to a new checkpoint and truncate the edge log
+/// (fsync'd). A restart rebuilds the RiskGraph from the checkpoint columns;
+/// until the next mutation, published snapshots map the checkpoint directly.
+/// Returns 0 on success, -1 without a store, -2 on I/O error
+export fn qvl_checkpoint(ctx: ?*QvlContext) callconv(.c) c_int {
+    const context = ctx orelse return -1;
+    context.lock.lock();
+    defer context.lock.unlock();
+    const span = context.stats.start(.checkpoint);
+    defer span.end();
+    if (context.store.dir == null) return -1;
 
-    return -2; // Not found
+    context.store.checkpoint() catch return -2;
+    return 0;
 }
 
 /// Get DID for a given node ID
@@ -271,6 +949,8 @@ export fn qvl_get_did(
     out_did: [*c]u8,
 ) callconv(.c) bool {
     const context = ctx orelse return false;
+    context.lock.lock();
+    defer context.lock.unlock();
     if (out_did == null) return false;
 
     if (context.trust_graph.getDid(node_id)) |did| {
@@ -288,6 +968,8 @@ export fn qvl_register_node(
     out_id: [*c]u32,
 ) callconv(.c) bool {
     const context = ctx orelse return false;
+    context.lock.lock();
+    defer context.lock.unlock();
     if (did_ptr == null or out_id == null) return false;
 
     var did: [32]u8 = undefined;
@@ -302,7 +984,7 @@ export fn qvl_register_node(
         // Or we check adjacency?
         // Let's just append for now. Duplicate iter in BellmanFord increases N but harmless?
         // BellmanFord iterates nodes to init dist. If duplicates, it inits twice. Harmless.
-        context.risk_graph.addNode(id) catch {};
+        context.store.addNode(id) catch {};
         return true;
     } else |_| {
         return false;
@@ -319,18 +1001,18 @@ export fn qvl_get_betrayal_evidence(
     buf_len: u32,
 ) callconv(.c) u32 {
     const context = ctx orelse return 0;
+    context.lock.lock();
+    defer context.lock.unlock();
+    defer context.endQuery();
 
-    var result = qvl.betrayal.detectBetrayal(
-        &context.risk_graph,
-        node_id,
-        context.allocator,
-    ) catch return 0;
-    defer result.deinit();
+    // Reuses the result of a preceding qvl_detect_betrayal on the same node
+    const result = context.betrayal_cache.get(&context.store.graph, node_id) catch return 0;
 
     if (result.betrayal_cycles.items.len == 0) return 0;
 
-    const evidence = result.generateEvidence(&context.risk_graph, context.allocator) catch return 0;
-    defer context.allocator.free(evidence);
+    const scratch = context.scratchAllocator();
+    const evidence = result.generateEvidence(&context.store.graph, scratch) catch return 0;
+    defer scratch.free(evidence);
 
     if (out_buf == null) return @intCast(evidence.len);
     if (buf_len < evidence.len) return 0; // Buffer too small
@@ -412,4 +1094,351 @@ test "FFI: add edge" {
 
     const result = qvl_add_trust_edge(ctx, &edge);
     try std.testing.expectEqual(result, 0);
+
+    // Same risk validation as the batch call
+    var bad = edge;
+    bad.to = 2;
+    bad.risk = std.math.nan(f64);
+    try std.testing.expectEqual(EDGE_STATUS_INVALID_RISK, qvl_add_trust_edge(ctx, &bad));
+    bad.risk = -1.5;
+    try std.testing.expectEqual(EDGE_STATUS_INVALID_RISK, qvl_add_trust_edge(ctx, &bad));
+    try std.testing.expect(ctx.store.graph.getEdge(0, 2) == null);
+}
+
+test "FFI: add edges batch" {
+    const ctx = qvl_init() orelse return error.InitFailed;
+    defer qvl_deinit(ctx);
+
+    const edges = [_]RiskEdgeC{
+        .{ .from = 0, .to = 1, .risk = 0.5, .timestamp_ns = 1000, .nonce = 0, .level = 3, .expires_at_ns = 2000 },
+        .{ .from = 1, .to = 2, .risk = 4.0, .timestamp_ns = 1000, .nonce = 1, .level = 3, .expires_at_ns = 2000 },
+        .{ .from = 0, .to = 2, .risk = -0.2, .timestamp_ns = 1000, .nonce = 2, .level = 1, .expires_at_ns = 2000 },
+    };
+    var status: [3]c_int = undefined;
+
+    const inserted = qvl_add_trust_edges(ctx, &edges, edges.len, &status);
+    try std.testing.expectEqual(@as(c_int, 2), inserted);
+    try std.testing.expectEqual(EDGE_STATUS_OK, status[0]);
+    try std.testing.expectEqual(EDGE_STATUS_INVALID_RISK, status[1]);
+    try std.testing.expectEqual(EDGE_STATUS_OK, status[2]);
+
+    try std.testing.expectEqual(@as(usize, 2), ctx.store.graph.neighbors(0).len);
+    try std.testing.expect(ctx.store.graph.getEdge(1, 2) == null);
+}
+
+test "FFI: betrayal result cached across detect and evidence" {
+    const ctx = qvl_init() orelse return error.InitFailed;
+    defer qvl_deinit(ctx);
+
+    const ring = [_]RiskEdgeC{
+        .{ .from = 0, .to = 1, .risk = 0.2, .timestamp_ns = 0, .nonce = 0, .level = 3, .expires_at_ns = 0 },
+        .{ .from = 1, .to = 2, .risk = 0.2, .timestamp_ns = 0, .nonce = 1, .level = 3, .expires_at_ns = 0 },
+        .{ .from = 2, .to = 0, .risk = -0.8, .timestamp_ns = 0, .nonce = 2, .level = 1, .expires_at_ns = 0 },
+    };
+    for (0..3) |i| try ctx.store.addNode(@intCast(i));
+    try std.testing.expectEqual(@as(c_int, 3), qvl_add_trust_edges(ctx, &ring, ring.len, null));
+
+    const anomaly = qvl_detect_betrayal(ctx, 0);
+    try std.testing.expectEqual(@as(u8, @intFromEnum(AnomalyReason.negative_cycle)), anomaly.reason);
+
+    const len = qvl_get_betrayal_evidence(ctx, 0, null, 0);
+    try std.testing.expect(len > 0);
+    try std.testing.expectEqual(@as(u64, 1), ctx.betrayal_cache.stats.recomputes);
+    try std.testing.expectEqual(@as(u64, 1), ctx.betrayal_cache.stats.hits);
+
+    // Breaking the ring invalidates the watched source
+    try std.testing.expectEqual(@as(c_int, 0), qvl_revoke_trust_edge(ctx, 2, 0));
+    const clean = qvl_detect_betrayal(ctx, 0);
+    try std.testing.expectEqual(@as(f64, 0.0), clean.score);
+}
+
+test "FFI: all-sources betrayal sweep" {
+    const ctx = qvl_init() orelse return error.InitFailed;
+    defer qvl_deinit(ctx);
+
+    const ring = [_]RiskEdgeC{
+        .{ .from = 0, .to = 1, .risk = 0.2, .timestamp_ns = 0, .nonce = 0, .level = 3, .expires_at_ns = 0 },
+        .{ .from = 1, .to = 0, .risk = -0.5, .timestamp_ns = 0, .nonce = 1, .level = 1, .expires_at_ns = 0 },
+        .{ .from = 2, .to = 0, .risk = 0.1, .timestamp_ns = 0, .nonce = 2, .level = 3, .expires_at_ns = 0 },
+    };
+    for (0..3) |i| try ctx.store.addNode(@intCast(i));
+    _ = qvl_add_trust_edges(ctx, &ring, ring.len, null);
+
+    var scores: [3]AnomalyScore = undefined;
+    const flagged = qvl_detect_betrayal_all(ctx, 2, &scores, scores.len);
+    try std.testing.expectEqual(@as(c_int, 2), flagged);
+    try std.testing.expectEqual(@as(u32, 0), scores[0].node);
+    try std.testing.expectEqual(@as(u32, 1), scores[1].node);
+    try std.testing.expectEqual(@as(u8, @intFromEnum(AnomalyReason.negative_cycle)), scores[1].reason);
+
+    // Size query
+    try std.testing.expectEqual(@as(c_int, 2), qvl_detect_betrayal_all(ctx, 1, null, 0));
+}
+
+test "FFI: snapshots isolate readers from writers" {
+    const ctx = qvl_init() orelse return error.InitFailed;
+    defer qvl_deinit(ctx);
+
+    try std.testing.expect(qvl_snapshot_acquire(ctx) == null);
+    try std.testing.expectEqual(@as(u64, 1), qvl_snapshot_publish(ctx));
+
+    const before = qvl_snapshot_acquire(ctx) orelse return error.NoSnapshot;
+    defer qvl_snapshot_release(before);
+
+    const ring = [_]RiskEdgeC{
+        .{ .from = 0, .to = 1, .risk = 0.2, .timestamp_ns = 0, .nonce = 0, .level = 3, .expires_at_ns = 0 },
+        .{ .from = 1, .to = 0, .risk = -0.5, .timestamp_ns = 0, .nonce = 1, .level = 1, .expires_at_ns = 0 },
+    };
+    _ = qvl_add_trust_edges(ctx, &ring, ring.len, null);
+    try std.testing.expectEqual(@as(u64, 2), qvl_snapshot_publish(ctx));
+
+    const after = qvl_snapshot_acquire(ctx) orelse return error.NoSnapshot;
+    defer qvl_snapshot_release(after);
+
+    try std.testing.expectEqual(@as(u64, 1), qvl_snapshot_version(before));
+    try std.testing.expectEqual(@as(u64, 2), qvl_snapshot_version(after));
+    try std.testing.expectEqual(@as(f64, 0.0), qvl_snapshot_detect_betrayal(before, 0).score);
+    try std.testing.expectEqual(@as(f64, 1.0), qvl_snapshot_detect_betrayal(after, 0).score);
+    try std.testing.expectEqual(@as(f64, 0.5), qvl_snapshot_get_reputation(after, 42));
+}
+
+test "FFI: PoP batch verify with verdict cache" {
+    const ctx = qvl_init() orelse return error.InitFailed;
+    defer qvl_deinit(ctx);
+    const allocator = std.testing.allocator;
+
+    const root = [_]u8{0} ** 32;
+    var peer: [32]u8 = undefined;
+    @memset(&peer, 0x42);
+    try ctx.trust_graph.grantTrust(peer, .full, .friends, 0);
+
+    var proof = (try ProofOfPath.construct(allocator, peer, root, &ctx.trust_graph)).?;
+    defer proof.deinit();
+    const bytes = try proof.serialize(allocator);
+    defer allocator.free(bytes);
+
+    const batch = [_]PopProofC{
+        .{ .proof_bytes = bytes.ptr, .proof_len = bytes.len, .sender_did = &peer, .receiver_did = &root },
+        .{ .proof_bytes = bytes.ptr, .proof_len = bytes.len, .sender_did = &peer, .receiver_did = &root },
+        .{ .proof_bytes = bytes.ptr, .proof_len = 3, .sender_did = &peer, .receiver_did = &root },
+    };
+    var verdicts: [3]PopVerdict = undefined;
+
+    try std.testing.expectEqual(@as(c_int, 2), qvl_verify_pop_batch(ctx, &batch, batch.len, &verdicts));
+    try std.testing.expectEqual(PopVerdict.valid, verdicts[1]);
+    try std.testing.expectEqual(PopVerdict.invalid_endpoints, verdicts[2]);
+    try std.testing.expectEqual(@as(u64, 1), ctx.pop_cache.stats.hits);
+
+    // Revoking the edge bumps the graph version: no stale `valid`
+    try ctx.trust_graph.revokeTrust(peer);
+    try std.testing.expectEqual(PopVerdict.broken_link, qvl_verify_pop(ctx, bytes.ptr, bytes.len, &peer, &root));
+}
+
+test "FFI: revoking a middle hop drops cached PoP verdicts" {
+    const ctx = qvl_init() orelse return error.InitFailed;
+    defer qvl_deinit(ctx);
+    const allocator = std.testing.allocator;
+
+    // root -> a -> b -> c
+    const root = [_]u8{0} ** 32;
+    const a = [_]u8{0xA1} ** 32;
+    const b = [_]u8{0xB2} ** 32;
+    const c = [_]u8{0xC3} ** 32;
+    try ctx.trust_graph.grantTrust(a, .full, .friends, 0);
+    const a_idx = ctx.trust_graph.getNode(a).?;
+    const b_idx = try ctx.trust_graph.getOrInsertNode(b);
+    const c_idx = try ctx.trust_graph.getOrInsertNode(c);
+    try ctx.trust_graph.addEdge(a_idx, .{ .target_idx = b_idx, .level = .full, .expires_at = 0, .visibility = .friends });
+    try ctx.trust_graph.addEdge(b_idx, .{ .target_idx = c_idx, .level = .full, .expires_at = 0, .visibility = .friends });
+
+    var proof = (try ProofOfPath.construct(allocator, c, root, &ctx.trust_graph)).?;
+    defer proof.deinit();
+    const bytes = try proof.serialize(allocator);
+    defer allocator.free(bytes);
+
+    try std.testing.expectEqual(PopVerdict.valid, qvl_verify_pop(ctx, bytes.ptr, bytes.len, &c, &root));
+    try std.testing.expectEqual(PopVerdict.valid, qvl_verify_pop(ctx, bytes.ptr, bytes.len, &c, &root));
+    try std.testing.expectEqual(@as(u64, 1), ctx.pop_cache.stats.hits);
+
+    // Neither endpoint of a -> b is the proof's sender or receiver
+    try std.testing.expectEqual(@as(c_int, 0), qvl_revoke_trust_edge(ctx, a_idx, b_idx));
+    const misses = ctx.pop_cache.stats.misses;
+    try std.testing.expectEqual(PopVerdict.broken_link, qvl_verify_pop(ctx, bytes.ptr, bytes.len, &c, &root));
+    try std.testing.expectEqual(misses + 1, ctx.pop_cache.stats.misses);
+    try std.testing.expectEqual(@as(c_int, -2), qvl_revoke_trust_edge(ctx, a_idx, b_idx));
+}
+
+test "FFI: GQL query against the latest snapshot" {
+    const ctx = qvl_init() orelse return error.InitFailed;
+    defer qvl_deinit(ctx);
+
+    const ring = [_]RiskEdgeC{
+        .{ .from = 0, .to = 1, .risk = 0.2, .timestamp_ns = 0, .nonce = 0, .level = 3, .expires_at_ns = 0 },
+        .{ .from = 1, .to = 0, .risk = -0.5, .timestamp_ns = 0, .nonce = 1, .level = 1, .expires_at_ns = 0 },
+    };
+    _ = qvl_add_trust_edges(ctx, &ring, ring.len, null);
+
+    // No snapshot yet: qvl_query publishes one
+    const query = "MATCH (a)-[r:BETRAYAL]->(b) RETURN b, r.risk AS risk";
+    var result: ?*QueryHandle = null;
+    try std.testing.expectEqual(@as(c_int, 1), qvl_query(ctx, null, query, query.len, &result));
+    defer qvl_query_result_free(result);
+    try std.testing.expectEqual(@as(u64, 1), context_version: {
+        const snap = qvl_snapshot_acquire(ctx) orelse return error.NoSnapshot;
+        defer qvl_snapshot_release(snap);
+        break :context_version qvl_snapshot_version(snap);
+    });
+
+    try std.testing.expectEqual(@as(usize, 2), qvl_query_result_columns(result));
+    var col: QueryColumnC = undefined;
+    try std.testing.expectEqual(@as(c_int, 0), qvl_query_result_column(result, 1, &col));
+    try std.testing.expectEqualStrings("risk", col.name[0..col.name_len]);
+    try std.testing.expectEqual(QUERY_COLUMN_F64, col.kind);
+    const risk: [*]const f64 = @ptrCast(@alignCast(col.values.?));
+    try std.testing.expectEqual(@as(f64, -0.5), risk[0]);
+    try std.testing.expectEqual(@as(c_int, -1), qvl_query_result_column(result, 2, &col));
+
+    // Second run hits the plan cache
+    var again: ?*QueryHandle = null;
+    try std.testing.expectEqual(@as(c_int, 1), qvl_query(ctx, null, query, query.len, &again));
+    qvl_query_result_free(again);
+    try std.testing.expectEqual(@as(u64, 1), ctx.plans.hits);
+
+    var bad: ?*QueryHandle = null;
+    try std.testing.expectEqual(QUERY_ERROR_PARSE, qvl_query(ctx, null, "MATCH (a", 8, &bad));
+    try std.testing.expectEqual(QUERY_ERROR_UNSUPPORTED, qvl_query(ctx, null, "MATCH (a:Account) RETURN a", 26, &bad));
+    try std.testing.expect(bad == null);
+}
+
+test "FFI: init with host allocator and scratch arena" {
+    const Host = struct {
+        var live: usize = 0;
+
+        fn alloc(user: ?*anyopaque, size: usize, alignment: usize) callconv(.c) ?*anyopaque {
+            _ = user;
+            const mem = std.testing.allocator.rawAlloc(size, std.mem.Alignment.fromByteUnits(alignment), @returnAddress()) orelse return null;
+            live += 1;
+            return mem;
+        }
+
+        fn free(user: ?*anyopaque, ptr: ?*anyopaque, size: usize, alignment: usize) callconv(.c) void {
+            _ = user;
+            const bytes: [*]u8 = @ptrCast(ptr orelse return);
+            std.testing.allocator.rawFree(bytes[0..size], std.mem.Alignment.fromByteUnits(alignment), @returnAddress());
+            live -= 1;
+        }
+    };
+
+    // Callbacks must come in pairs
+    try std.testing.expect(qvl_init_with_options(&.{ .alloc_fn = Host.alloc }) == null);
+
+    const ctx = qvl_init_with_options(&.{
+        .scratch_bytes = 64 * 1024,
+        .alloc_fn = Host.alloc,
+        .free_fn = Host.free,
+    }) orelse return error.InitFailed;
+    try std.testing.expect(Host.live > 0);
+
+    const ring = [_]RiskEdgeC{
+        .{ .from = 0, .to = 1, .risk = 0.2, .timestamp_ns = 0, .nonce = 0, .level = 3, .expires_at_ns = 0 },
+        .{ .from = 1, .to = 0, .risk = -0.5, .timestamp_ns = 0, .nonce = 1, .level = 1, .expires_at_ns = 0 },
+    };
+    for (0..2) |i| try ctx.store.addNode(@intCast(i));
+    try std.testing.expectEqual(@as(c_int, 2), qvl_add_trust_edges(ctx, &ring, ring.len, null));
+
+    // Repeated queries reuse the retained arena
+    try std.testing.expectEqual(@as(f64, 1.0), qvl_detect_betrayal(ctx, 0).score);
+    try std.testing.expect(qvl_get_betrayal_evidence(ctx, 0, null, 0) > 0);
+    var scores: [2]AnomalyScore = undefined;
+    try std.testing.expectEqual(@as(c_int, 2), qvl_detect_betrayal_all(ctx, 2, &scores, scores.len));
+    const steady = Host.live;
+    try std.testing.expectEqual(@as(c_int, 2), qvl_detect_betrayal_all(ctx, 2, &scores, scores.len));
+    try std.testing.expectEqual(steady, Host.live);
+
+    // A snapshot and a query result released after qvl_deinit still free
+    // through the hooks
+    try std.testing.expect(qvl_snapshot_publish(ctx) > 0);
+    const snap = qvl_snapshot_acquire(ctx) orelse return error.NoSnapshot;
+    const query = "MATCH (a)-[r:BETRAYAL]->(b) RETURN b";
+    var result: ?*QueryHandle = null;
+    try std.testing.expectEqual(@as(c_int, 1), qvl_query(ctx, snap, query, query.len, &result));
+    qvl_deinit(ctx);
+    try std.testing.expect(Host.live > 0);
+    try std.testing.expectEqual(@as(f64, 1.0), qvl_snapshot_detect_betrayal(snap, 0).score);
+    qvl_snapshot_release(snap);
+    try std.testing.expectEqual(@as(usize, 1), qvl_query_result_rows(result));
+    qvl_query_result_free(result);
+    try std.testing.expectEqual(@as(usize, 0), Host.live);
+}
+
+test "FFI: risk graph persists across contexts" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const dir = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(dir);
+    const path = try allocator.dupeZ(u8, dir);
+    defer allocator.free(path);
+
+    // Memory-only contexts have nothing to checkpoint
+    {
+        const ctx = qvl_init() orelse return error.InitFailed;
+        defer qvl_deinit(ctx);
+        try std.testing.expectEqual(@as(c_int, -1), qvl_checkpoint(ctx));
+    }
+
+    const ring = [_]RiskEdgeC{
+        .{ .from = 0, .to = 1, .risk = 0.2, .timestamp_ns = 0, .nonce = 0, .level = 3, .expires_at_ns = 0 },
+        .{ .from = 1, .to = 0, .risk = -0.5, .timestamp_ns = 0, .nonce = 1, .level = 1, .expires_at_ns = 0 },
+        .{ .from = 1, .to = 2, .risk = 0.3, .timestamp_ns = 0, .nonce = 2, .level = 3, .expires_at_ns = 0 },
+    };
+    {
+        const ctx = qvl_init_with_options(&.{ .store_path = path.ptr }) orelse return error.InitFailed;
+        defer qvl_deinit(ctx);
+        try std.testing.expectEqual(@as(c_int, 3), qvl_add_trust_edges(ctx, &ring, ring.len, null));
+        try std.testing.expectEqual(@as(c_int, 0), qvl_checkpoint(ctx));
+        // Logged only, replayed on the next open
+        try std.testing.expectEqual(@as(c_int, 0), qvl_revoke_trust_edge(ctx, 1, 2));
+    }
+    {
+        const ctx = qvl_init_with_options(&.{ .store_path = path.ptr }) orelse return error.InitFailed;
+        defer qvl_deinit(ctx);
+        try std.testing.expectEqual(@as(usize, 2), ctx.store.graph.edgeCount());
+        try std.testing.expect(ctx.store.graph.getEdge(1, 2) == null);
+        try std.testing.expectEqual(@as(f64, 1.0), qvl_detect_betrayal(ctx, 0).score);
+
+        // Published straight from the mapped checkpoint
+        try std.testing.expectEqual(@as(c_int, 0), qvl_checkpoint(ctx));
+        try std.testing.expect(qvl_snapshot_publish(ctx) > 0);
+        const snap = qvl_snapshot_acquire(ctx) orelse return error.NoSnapshot;
+        defer qvl_snapshot_release(snap);
+        try std.testing.expect(snap.risk.mapping != null);
+        try std.testing.expectEqual(@as(f64, 1.0), qvl_snapshot_detect_betrayal(snap, 0).score);
+    }
+}
+
+test "FFI: stats count calls and heap traffic" {
+    const ctx = qvl_init() orelse return error.InitFailed;
+    defer qvl_deinit(ctx);
+
+    var stats: StatsC = undefined;
+    try std.testing.expectEqual(@as(c_int, -1), qvl_get_stats(ctx, null));
+    try std.testing.expectEqual(@as(c_int, 0), qvl_get_stats(ctx, &stats));
+    // Context members were allocated through the counter
+    try std.testing.expect(stats.allocations > 0);
+    try std.testing.expectEqual(@as(u64, 0), stats.stages[@intFromEnum(Stage.detect_betrayal)].calls);
+
+    const ring = [_]RiskEdgeC{
+        .{ .from = 0, .to = 1, .risk = 0.2, .timestamp_ns = 0, .nonce = 0, .level = 3, .expires_at_ns = 0 },
+        .{ .from = 1, .to = 0, .risk = -0.5, .timestamp_ns = 0, .nonce = 1, .level = 1, .expires_at_ns = 0 },
+    };
+    _ = qvl_add_trust_edges(ctx, &ring, ring.len, null);
+    for (0..3) |_| _ = qvl_detect_betrayal(ctx, 0);
+
+    try std.testing.expectEqual(@as(c_int, 0), qvl_get_stats(ctx, &stats));
+    const detect = stats.stages[@intFromEnum(Stage.detect_betrayal)];
+    try std.testing.expectEqual(@as(u64, 3), detect.calls);
+    try std.testing.expect(detect.p50_ns <= detect.p99_ns and detect.p99_ns <= detect.max_ns);
+    try std.testing.expectEqual(@as(u64, 1), stats.stages[@intFromEnum(Stage.add_edges)].calls);
+    try std.testing.expect(stats.live_bytes > 0 and stats.allocations >= stats.frees);
 }
@@ -82,6 +82,150 @@ pub const TrustEdge = packed struct {
 /// Edge list type (managed ArrayList)
 const EdgeList = std.ArrayListUnmanaged(TrustEdge);
 
+/// Reusable working memory for `CompactTrustGraph.findPathWith`.
+/// Owned by the caller (one per thread); grows with the graph, so repeated
+/// queries are allocation-free once it has seen the largest graph.
+pub const PathScratch = struct {
+    allocator: std.mem.Allocator,
+    /// Query id per node; depth/parent entries are only valid when it matches
+    stamp: []u32 = &.{},
+    fwd_depth: []u8 = &.{},
+    bwd_depth: []u8 = &.{},
+    /// Forward: previous hop toward the source
+    fwd_parent: []u32 = &.{},
+    /// Backward: next hop toward the target
+    bwd_parent: []u32 = &.{},
+    fwd_queue: []u32 = &.{},
+    bwd_queue: []u32 = &.{},
+    /// Result buffer (max_trust_depth + 1 entries)
+    path: []u32 = &.{},
+    /// Node capacity of the arrays above
+    len: usize = 0,
+    query: u32 = 0,
+
+    const unvisited: u8 = std.math.maxInt(u8);
+
+    const Side = enum { forward, backward };
+
+    pub fn init(allocator: std.mem.Allocator) PathScratch {
+        return .{ .allocator = allocator };
+    }
+
+    pub fn deinit(self: *PathScratch) void {
+        self.allocator.free(self.stamp);
+        self.allocator.free(self.fwd_depth);
+        self.allocator.free(self.bwd_depth);
+        self.allocator.free(self.fwd_parent);
+        self.allocator.free(self.bwd_parent);
+        self.allocator.free(self.fwd_queue);
+        self.allocator.free(self.bwd_queue);
+        self.allocator.free(self.path);
+    }
+
+    /// Size for `node_count` nodes and start a new query
+    fn prepare(self: *PathScratch, node_count: usize, max_depth: u8) !void {
+        if (node_count > self.len) {
+            const cap = @max(node_count, self.len * 2);
+            self.stamp = try self.allocator.realloc(self.stamp, cap);
+            @memset(self.stamp[self.len..], 0);
+            self.fwd_depth = try self.allocator.realloc(self.fwd_depth, cap);
+            self.bwd_depth = try self.allocator.realloc(self.bwd_depth, cap);
+            self.fwd_parent = try self.allocator.realloc(self.fwd_parent, cap);
+            self.bwd_parent = try self.allocator.realloc(self.bwd_parent, cap);
+            self.fwd_queue = try self.allocator.realloc(self.fwd_queue, cap);
+            self.bwd_queue = try self.allocator.realloc(self.bwd_queue, cap);
+            self.len = cap;
+        }
+        if (self.path.len < @as(usize, max_depth) + 1) {
+            self.path = try self.allocator.realloc(self.path, @as(usize, max_depth) + 1);
+        }
+
+        self.query +%= 1;
+        if (self.query == 0) {
+            // Stamp wrapped: forget every previous query
+            @memset(self.stamp, 0);
+            self.query = 1;
+        }
+    }
+
+    fn depthOf(self: *const PathScratch, node: u32, side: Side) ?u8 {
+        if (self.stamp[node] != self.query) return null;
+        const d = switch (side) {
+            .forward => self.fwd_depth[node],
+            .backward => self.bwd_depth[node],
+        };
+        return if (d == unvisited) null else d;
+    }
+
+    fn visit(self: *PathScratch, node: u32, side: Side, depth: u8, parent: u32) void {
+        if (self.stamp[node] != self.query) {
+            self.stamp[node] = self.query;
+            self.fwd_depth[node] = unvisited;
+            self.bwd_depth[node] = unvisited;
+        }
+        switch (side) {
+            .forward => {
+                self.fwd_depth[node] = depth;
+                self.fwd_parent[node] = parent;
+            },
+            .backward => {
+                self.bwd_depth[node] = depth;
+                self.bwd_parent[node] = parent;
+            },
+        }
+    }
+
+    /// Stitch source -> meet (forward parents) and meet -> target (backward parents)
+    fn assemblePath(self: *PathScratch, meet: u32, from_idx: u32, to_idx: u32) []const u32 {
+        const head_len = @as(usize, self.fwd_depth[meet]);
+        const total = head_len + @as(usize, self.bwd_depth[meet]) + 1;
+
+        var current = meet;
+        var i = head_len;
+        self.path[i] = current;
+        while (current != from_idx) {
+            current = self.fwd_parent[current];
+            i -= 1;
+            self.path[i] = current;
+        }
+
+        current = meet;
+        i = head_len;
+        while (current != to_idx) {
+            current = self.bwd_parent[current];
+            i += 1;
+            self.path[i] = current;
+        }
+
+        return self.path[0..total];
+    }
+};
+
+/// FIFO over a scratch queue. Each node is enqueued at most once per
+/// side, so the buffer never needs to wrap; pops are O(1).
+const Frontier = struct {
+    queue: []u32,
+    head: usize = 0,
+    tail: usize = 0,
+    /// Depth of the nodes in [head, tail)
+    depth: u8 = 0,
+
+    fn push(self: *Frontier, node: u32) void {
+        self.queue[self.tail] = node;
+        self.tail += 1;
+    }
+
+    fn pop(self: *Frontier) u32 {
+        const node = self.queue[self.head];
+        self.head += 1;
+        return node;
+    }
+
+    fn levelSize(self: *const Frontier) usize {
+        return self.tail - self.head;
+    }
+};
+
 /// Compact trust graph optimized for mobile RAM
 /// Per RFC-0120 S4.3.2
 pub const CompactTrustGraph = struct {
@@ -92,6 +236,9 @@ pub const CompactTrustGraph = struct {
     /// Adjacency list: each node has list of outgoing edges
     adjacency: std.ArrayListUnmanaged(EdgeList),
 
+    /// Reverse adjacency: each node has list of trusters (for backward search)
+    reverse: std.ArrayListUnmanaged(std.ArrayListUnmanaged(u32)),
+
     /// DID storage for reverse lookup (32 bytes each)
     did_storage: std.ArrayListUnmanaged([32]u8),
 
@@ -101,6 +248,9 @@ pub const CompactTrustGraph = struct {
     /// Configuration
     config: Config,
 
+    /// Bumped on every edge mutation (lets verdict caches detect staleness)
+    version: u64,
+
     /// Allocator
     allocator: std.mem.Allocator,
 
@@ -127,9 +277,11 @@ pub const CompactTrustGraph = struct {
         var self = CompactTrustGraph{
             .node_map = std.AutoHashMap(u32, u32).init(allocator),
             .adjacency = .{},
+            .reverse = .{},
             .did_storage = .{},
             .root_idx = 0,
             .config = config,
+            .version = 0,
             .allocator = allocator,
         };
 
@@ -144,10 +296,52 @@ pub const CompactTrustGraph = struct {
             adj.deinit(self.allocator);
         }
         self.adjacency.deinit(self.allocator);
+        for (self.reverse.items) |*rev| {
+            rev.deinit(self.allocator);
+        }
+        self.reverse.deinit(self.allocator);
         self.did_storage.deinit(self.allocator);
         self.node_map.deinit();
     }
 
+    /// Deep copy (used to freeze a read-only snapshot for concurrent readers)
+    pub fn clone(self: *const CompactTrustGraph, allocator: std.mem.Allocator) Error!CompactTrustGraph {
+        var node_map = self.node_map.cloneWithAllocator(allocator) catch return Error.OutOfMemory;
+        errdefer node_map.deinit();
+
+        var did_storage = self.did_storage.clone(allocator) catch return Error.OutOfMemory;
+        errdefer did_storage.deinit(allocator);
+
+        var adjacency = std.ArrayListUnmanaged(EdgeList).initCapacity(allocator, self.adjacency.items.len) catch return Error.OutOfMemory;
+        errdefer {
+            for (adjacency.items) |*adj| adj.deinit(allocator);
+            adjacency.deinit(allocator);
+        }
+        for (self.adjacency.items) |adj| {
+            adjacency.appendAssumeCapacity(adj.clone(allocator) catch return Error.OutOfMemory);
+        }
+
+        var reverse = std.ArrayListUnmanaged(std.ArrayListUnmanaged(u32)).initCapacity(allocator, self.reverse.items.len) catch return Error.OutOfMemory;
+        errdefer {
+            for (reverse.items) |*rev| rev.deinit(allocator);
+            reverse.deinit(allocator);
+        }
+        for (self.reverse.items) |rev| {
+            reverse.appendAssumeCapacity(rev.clone(allocator) catch return Error.OutOfMemory);
+        }
+
+        return CompactTrustGraph{
+            .node_map = node_map,
+            .adjacency = adjacency,
+            .reverse = reverse,
+            .did_storage = did_storage,
+            .root_idx = self.root_idx,
+            .config = self.config,
+            .version = self.version,
+            .allocator = allocator,
+        };
+    }
+
     /// Get or create node index for a DID
     pub fn getOrInsertNode(self: *CompactTrustGraph, did: [32]u8) Error!u32 {
         // Hash DID to u32 for map lookup
@@ -172,6 +366,7 @@ pub const CompactTrustGraph = struct {
 
         self.did_storage.append(self.allocator, did) catch return Error.OutOfMemory;
         self.adjacency.append(self.allocator, .{}) catch return Error.OutOfMemory;
+        self.reverse.append(self.allocator, .{}) catch return Error.OutOfMemory;
         self.node_map.put(did_hash, idx) catch return Error.OutOfMemory;
 
         return idx;
@@ -237,6 +432,7 @@ pub const CompactTrustGraph = struct {
                 edge.level = level;
                 edge.visibility = visibility;
                 edge.expires_at = expires_at;
+                self.version += 1;
                 return;
             }
         }
@@ -247,12 +443,33 @@ pub const CompactTrustGraph = struct {
         }
 
         // Add new edge
-        edges.append(self.allocator, TrustEdge{
+        try self.addEdge(self.root_idx, TrustEdge{
             .target_idx = target_idx,
             .level = level,
             .visibility = visibility,
             .expires_at = expires_at,
-        }) catch return Error.OutOfMemory;
+        });
+    }
+
+    /// Add an edge from any known node (e.g. learned from a peer's
+    /// published trust edges). Keeps the reverse index in sync.
+    pub fn addEdge(self: *CompactTrustGraph, truster_idx: u32, edge: TrustEdge) Error!void {
+        if (truster_idx >= self.adjacency.items.len or edge.target_idx >= self.reverse.items.len) {
+            return Error.NodeNotFound;
+        }
+        if (truster_idx == edge.target_idx) return Error.SelfTrustNotAllowed;
+        if (self.hasDirectTrust(truster_idx, edge.target_idx)) return Error.DuplicateEdge;
+
+        const edges = &self.adjacency.items[truster_idx];
+        if (edges.items.len >= self.config.max_edges_per_node) {
+            return Error.EdgeLimitExceeded;
+        }
+
+        const trusters = &self.reverse.items[edge.target_idx];
+        trusters.ensureUnusedCapacity(self.allocator, 1) catch return Error.OutOfMemory;
+        edges.append(self.allocator, edge) catch return Error.OutOfMemory;
+        trusters.appendAssumeCapacity(truster_idx);
+        self.version += 1;
     }
 
     /// Revoke trust from root to target DID
@@ -264,12 +481,40 @@ pub const CompactTrustGraph = struct {
         while (i < edges.items.len) {
             if (edges.items[i].target_idx == target_idx) {
                 _ = edges.swapRemove(i);
+                self.unlinkTruster(target_idx, self.root_idx);
+                self.version += 1;
                 return;
             }
             i += 1;
         }
     }
 
+    /// Remove the edge truster -> trustee between any two known nodes;
+    /// returns whether it existed. Keeps the reverse index in sync.
+    pub fn removeEdge(self: *CompactTrustGraph, truster_idx: u32, trustee_idx: u32) bool {
+        if (truster_idx >= self.adjacency.items.len) return false;
+        const edges = &self.adjacency.items[truster_idx];
+        for (edges.items, 0..) |edge, i| {
+            if (edge.target_idx == trustee_idx) {
+                _ = edges.swapRemove(i);
+                self.unlinkTruster(trustee_idx, truster_idx);
+                self.version += 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    fn unlinkTruster(self: *CompactTrustGraph, trustee_idx: u32, truster_idx: u32) void {
+        const trusters = &self.reverse.items[trustee_idx];
+        for (trusters.items, 0..) |t, i| {
+            if (t == truster_idx) {
+                _ = trusters.swapRemove(i);
+                return;
+            }
+        }
+    }
+
     /// Get trust edge from root to target (if exists)
     pub fn getTrustEdge(self: *const CompactTrustGraph, target_did: [32]u8) ?TrustEdge {
         const target_idx = self.getNode(target_did) orelse return null;
@@ -284,105 +529,96 @@ pub const CompactTrustGraph = struct {
     }
 
     /// BFS path finding (sender-side only)
-    /// Returns path as list of node indices, or null if no path exists
+    /// Returns path as list of node indices (caller frees), or null if no path exists
     pub fn findPath(
         self: *const CompactTrustGraph,
         from_did: [32]u8,
         to_did: [32]u8,
     ) ?[]u32 {
+        var scratch = PathScratch.init(self.allocator);
+        defer scratch.deinit();
+
+        const path = self.findPathWith(&scratch, from_did, to_did) orelse return null;
+        return self.allocator.dupe(u32, path) catch null;
+    }
+
+    /// Bidirectional BFS path finding using caller-owned scratch.
+    /// Allocates only when the graph has grown past the scratch's capacity.
+    /// Returns a shortest path of at most `config.max_trust_depth` edges;
+    /// the slice points into `scratch` and is valid until its next use.
+    pub fn findPathWith(
+        self: *const CompactTrustGraph,
+        scratch: *PathScratch,
+        from_did: [32]u8,
+        to_did: [32]u8,
+    ) ?[]const u32 {
         const from_idx = self.getNode(from_did) orelse return null;
         const to_idx = self.getNode(to_did) orelse return null;
 
+        const max_depth = self.config.max_trust_depth;
+        scratch.prepare(self.nodeCount(), max_depth) catch return null;
+
         if (from_idx == to_idx) {
             // Same node - return single element path
-            var path = self.allocator.alloc(u32, 1) catch return null;
-            path[0] = from_idx;
-            return path;
+            scratch.path[0] = from_idx;
+            return scratch.path[0..1];
         }
 
-        // BFS with parent tracking
-        var visited = std.AutoHashMap(u32, u32).init(self.allocator);
-        defer visited.deinit();
-
-        var queue: std.ArrayListUnmanaged(u32) = .{};
-        defer queue.deinit(self.allocator);
-
-        queue.append(self.allocator, from_idx) catch return null;
-        visited.put(from_idx, from_idx) catch return null; // Mark start
-
-        while (queue.items.len > 0) {
-            const current = queue.orderedRemove(0);
-
-            if (current >= self.adjacency.items.len) continue;
-
-            for (self.adjacency.items[current].items) |edge| {
-                if (visited.contains(edge.target_idx)) continue;
-
-                visited.put(edge.target_idx, current) catch return null;
-
-                if (edge.target_idx == to_idx) {
-                    // Found! Reconstruct path
-                    return self.reconstructPath(visited, from_idx, to_idx);
-                }
-
-                // Check depth limit
-                const depth = self.pathDepth(visited, edge.target_idx, from_idx);
-                if (depth < self.config.max_trust_depth) {
-                    queue.append(self.allocator, edge.target_idx) catch return null;
-                }
-            }
+        scratch.visit(from_idx, .forward, 0, from_idx);
+        scratch.visit(to_idx, .backward, 0, to_idx);
+        var fwd = Frontier{ .queue = scratch.fwd_queue };
+        var bwd = Frontier{ .queue = scratch.bwd_queue };
+        fwd.push(from_idx);
+        bwd.push(to_idx);
+
+        // Level-synchronous: every meeting point found while expanding a
+        // level closes a path of length fwd.depth + bwd.depth + 1, and no
+        // shorter path can exist (it would have met on an earlier level).
+        while (fwd.depth + bwd.depth < max_depth) {
+            if (fwd.levelSize() == 0 or bwd.levelSize() == 0) return null;
+
+            const meet = if (fwd.levelSize() <= bwd.levelSize())
+                self.expandForward(scratch, &fwd)
+            else
+                self.expandBackward(scratch, &bwd);
+
+            if (meet) |m| return scratch.assemblePath(m, from_idx, to_idx);
         }
 
         return null; // No path found
     }
 
-    fn reconstructPath(
-        self: *const CompactTrustGraph,
-        parents: std.AutoHashMap(u32, u32),
-        from_idx: u32,
-        to_idx: u32,
-    ) ?[]u32 {
-        // Count path length
-        var length: usize = 1;
-        var current = to_idx;
-        while (current != from_idx) {
-            current = parents.get(current) orelse return null;
-            length += 1;
-            if (length > self.config.max_trust_depth + 1) return null; // Safety
-        }
-
-        // Allocate and fill path
-        var path = self.allocator.alloc(u32, length) catch return null;
-
-        current = to_idx;
-        var i: usize = length;
-        while (i > 0) {
-            i -= 1;
-            path[i] = current;
-            if (current == from_idx) break;
-            current = parents.get(current) orelse {
-                self.allocator.free(path);
-                return null;
-            };
+    fn expandForward(self: *const CompactTrustGraph, scratch: *PathScratch, fwd: *Frontier) ?u32 {
+        const level_end = fwd.tail;
+        const next_depth = fwd.depth + 1;
+        while (fwd.head < level_end) {
+            const current = fwd.pop();
+            for (self.adjacency.items[current].items) |edge| {
+                const next = edge.target_idx;
+                if (next >= self.adjacency.items.len or scratch.depthOf(next, .forward) != null) continue;
+                scratch.visit(next, .forward, next_depth, current);
+                if (scratch.depthOf(next, .backward) != null) return next;
+                fwd.push(next);
+            }
         }
-
-        return path;
+        fwd.depth = next_depth;
+        return null;
     }
 
-    fn pathDepth(
-        self: *const CompactTrustGraph,
-        parents: std.AutoHashMap(u32, u32),
-        node: u32,
-        start: u32,
-    ) u8 {
-        _ = self;
-        var depth: u8 = 0;
-        var current = node;
-        while (current != start and depth < 255) {
-            current = parents.get(current) orelse break;
-            depth += 1;
+    fn expandBackward(self: *const CompactTrustGraph, scratch: *PathScratch, bwd: *Frontier) ?u32 {
+        const level_end = bwd.tail;
+        const next_depth = bwd.depth + 1;
+        while (bwd.head < level_end) {
+            const current = bwd.pop();
+            for (self.reverse.items[current].items) |truster| {
+                if (truster >= self.adjacency.items.len or scratch.depthOf(truster, .backward) != null) continue;
+                scratch.visit(truster, .backward, next_depth, current);
+                if (scratch.depthOf(truster, .forward) != null) return truster;
+                bwd.push(truster);
+            }
         }
-        return depth;
+        bwd.depth = next_depth;
+        return null;
     }
 
     /// Count total nodes in graph
@@ -476,7 +712,7 @@ test "CompactTrustGraph: find path" {
     const b_idx = graph.getNode(did_b).?;
     const c_idx = try graph.getOrInsertNode(did_c);
 
-    try graph.adjacency.items[b_idx].append(allocator, TrustEdge{
+    try graph.addEdge(b_idx, TrustEdge{
         .target_idx = c_idx,
         .level = .full,
         .visibility = .bilateral,
@@ -494,6 +730,58 @@ test "CompactTrustGraph: find path" {
     try std.testing.expectEqual(@as(u32, 2), path.?[2]); // C
 }
 
+test "CompactTrustGraph: bidirectional search finds shortest bounded path" {
+    const allocator = std.testing.allocator;
+
+    var dids: [8][32]u8 = undefined;
+    for (&dids, 0..) |*did, i| @memset(did, @intCast(0x10 + i));
+
+    var graph = try CompactTrustGraph.init(allocator, dids[0], .{ .max_trust_depth = 3 });
+    defer graph.deinit();
+
+    var idx: [8]u32 = undefined;
+    for (dids, 0..) |did, i| idx[i] = try graph.getOrInsertNode(did);
+
+    const link = struct {
+        fn add(g: *CompactTrustGraph, from: u32, to: u32) !void {
+            try g.addEdge(from, .{ .target_idx = to, .level = .full, .visibility = .public, .expires_at = 0 });
+        }
+    }.add;
+
+    // Long way 0-1-2-3-4, short way 0-5-4, dead end 5-6, chain 4-7
+    try link(&graph, idx[0], idx[1]);
+    try link(&graph, idx[1], idx[2]);
+    try link(&graph, idx[2], idx[3]);
+    try link(&graph, idx[3], idx[4]);
+    try link(&graph, idx[0], idx[5]);
+    try link(&graph, idx[5], idx[6]);
+    try link(&graph, idx[5], idx[4]);
+    try link(&graph, idx[4], idx[7]);
+    try std.testing.expectError(CompactTrustGraph.Error.DuplicateEdge, link(&graph, idx[0], idx[5]));
+
+    var scratch = PathScratch.init(allocator);
+    defer scratch.deinit();
+
+    const short = graph.findPathWith(&scratch, dids[0], dids[7]).?;
+    try std.testing.expectEqualSlices(u32, &.{ idx[0], idx[5], idx[4], idx[7] }, short);
+    const capacity = scratch.len;
+
+    // Scratch is reused without growing
+    try std.testing.expectEqualSlices(u32, &.{ idx[1], idx[2], idx[3] }, graph.findPathWith(&scratch, dids[1], dids[3]).?);
+    try std.testing.expectEqual(capacity, scratch.len);
+
+    // 1 -> 7 needs 4 hops: beyond max_trust_depth
+    try std.testing.expect(graph.findPathWith(&scratch, dids[1], dids[7]) == null);
+    // Trust is directed
+    try std.testing.expect(graph.findPathWith(&scratch, dids[7], dids[0]) == null);
+
+    // Revocation updates the reverse index: only the long way is left
+    try graph.revokeTrust(dids[5]);
+    try std.testing.expectEqual(@as(usize, 0), graph.reverse.items[idx[5]].items.len);
+    try std.testing.expect(graph.findPathWith(&scratch, dids[0], dids[7]) == null);
+    try std.testing.expectEqual(@as(usize, 4), graph.findPathWith(&scratch, dids[0], dids[3]).?.len);
+}
+
 test "CompactTrustGraph: self trust not allowed" {
     const allocator = std.testing.allocator;
 
@@ -532,6 +820,27 @@ test "CompactTrustGraph: node limit respected" {
     try std.testing.expectError(CompactTrustGraph.Error.NodeLimitExceeded, result);
 }
 
+test "CompactTrustGraph: clone is independent" {
+    const allocator = std.testing.allocator;
+
+    var root_did: [32]u8 = undefined;
+    @memset(&root_did, 0x01);
+    var target_did: [32]u8 = undefined;
+    @memset(&target_did, 0x02);
+
+    var graph = try CompactTrustGraph.init(allocator, root_did, .{});
+    defer graph.deinit();
+    try graph.grantTrust(target_did, .full, .bilateral, 0);
+
+    var frozen = try graph.clone(allocator);
+    defer frozen.deinit();
+
+    try graph.revokeTrust(target_did);
+    try std.testing.expect(!graph.hasDirectTrustByDid(root_did, target_did));
+    try std.testing.expect(frozen.hasDirectTrustByDid(root_did, target_did));
+    try std.testing.expectEqual(@as(usize, 2), frozen.nodeCount());
+}
+
 test "TrustEdge: serialization roundtrip" {
     const edge = TrustEdge{
         .target_idx = 12345,
@@ -246,7 +246,7 @@ test "QuasarVector: validation flow" {
     // Manual edge in graph for path finding (A->S)
     const a_idx = graph.getNode(k_a.ed25519_public).?;
     const s_idx = try graph.getOrInsertNode(k_s.ed25519_public);
-    try graph.adjacency.items[a_idx].append(allocator, .{ .target_idx = s_idx, .level = .full, .visibility = .public, .expires_at = 0 });
+    try graph.addEdge(a_idx, .{ .target_idx = s_idx, .level = .full, .visibility = .public, .expires_at = 0 });
 
     // 3. Sender creates Vector
     var vector = QuasarVector.init(allocator);
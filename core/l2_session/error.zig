@@ -24,6 +24,9 @@ pub const SessionError = error{
     
     /// Quota exceeded
     QuotaExceeded,
+    
+    /// Resumption ticket unknown, expired or not ours (do a full handshake)
+    ResumptionRejected,
 };
 
 /// Failure reasons for telemetry
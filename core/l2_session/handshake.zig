@@ -1,61 +1,260 @@
 //! PQxdh handshake implementation
 //!
 //! Implements X25519Kyber768 hybrid key exchange for post-quantum security.
+//!
+//! Full handshakes are expensive; the responder runs them on a
+//! `Handshake.Pool` off the node loop and finishes them with `accept`,
+//! which also issues a resumption ticket. Returning peers holding a ticket
+//! resume instead (`resumeRequest` -> `respondResume` -> `resumeSession`),
+//! which costs two HKDF calls and no KEM. Each resumption consumes its
+//! ticket and issues a fresh one from the resumed keys (like TLS
+//! NewSessionTicket), so a peer can keep resuming across partitions.
 
 const std = @import("std");
+const pqxdh = @import("pqxdh");
 const Session = @import("session.zig").Session;
+const SessionKeys = @import("session.zig").SessionKeys;
 const SessionConfig = @import("config.zig").SessionConfig;
+const SessionError = @import("error.zig").SessionError;
+const resumption = @import("resumption.zig");
+const HandshakePool = @import("handshake_pool.zig").HandshakePool;
+
+const HkdfSha256 = std.crypto.kdf.hkdf.HkdfSha256;
 
 /// Handshake state machine
 pub const Handshake = struct {
-    /// Initiate handshake as client
+    /// Responder's private prekeys matching its published bundle
+    pub const Prekeys = struct {
+        identity_private: [32]u8,
+        signed_prekey_private: [32]u8,
+        one_time_prekey_private: [32]u8,
+        mlkem_private: [pqxdh.ML_KEM_768.SECRET_KEY_SIZE]u8,
+    };
+
+    /// Full handshake on a worker. `request.peer_did` must stay valid
+    /// until the result has been polled.
+    pub const Job = struct {
+        request: HandshakeRequest,
+    };
+
+    /// Finished worker job; `keys` is null when the key agreement failed
+    pub const Result = struct {
+        peer_did: []const u8,
+        keys: ?SessionKeys,
+    };
+
+    pub const Pool = HandshakePool(*const Prekeys, Job, Result, perform);
+
+    /// Worker entry point for `Pool`: runs the KEM, touches nothing shared
+    pub fn perform(prekeys: *const Prekeys, job: *const Job) Result {
+        const keys: ?SessionKeys = responderKeys(prekeys, &job.request) catch |err| blk: {
+            std.log.debug("L2: handshake from {s} failed: {}", .{ job.request.peer_did, err });
+            break :blk null;
+        };
+        return .{ .peer_did = job.request.peer_did, .keys = keys };
+    }
+
+    /// Initiate handshake as client: runs the KEM against the peer's
+    /// bundle. Send `request`, then `finish` the session on the response.
     pub fn initiate(
+        allocator: std.mem.Allocator,
+        local_did: []const u8,
         peer_did: []const u8,
+        identity_private: [32]u8,
+        bundle: *const pqxdh.PrekeyBundle,
         config: SessionConfig,
-        ctx: anytype,
-    ) !Session {
-        // TODO: Implement PQxdh initiation
-        _ = ctx;
+    ) !Initiated {
+        var agreed = try pqxdh.initiator(identity_private, bundle, allocator);
+        defer std.crypto.secureZero(u8, &agreed.root_key);
+        std.crypto.secureZero(u8, &agreed.ephemeral_private);
 
-        var session = Session.new(peer_did, config);
-        session.state = .handshake_initiated;
-        return session;
+        var initiated = Initiated{
+            .session = Session.new(peer_did, config),
+            .request = .{
+                .peer_did = local_did,
+                .identity_public = try std.crypto.dh.X25519.recoverPublicKey(identity_private),
+                .message = agreed.initial_message,
+            },
+        };
+        initiated.session.keys = sessionKeys(&agreed.root_key, .initiator);
+        initiated.session.state = .handshake_initiated;
+        return initiated;
     }
-    
-    /// Resume existing session
-    pub fn resumeSession(
-        peer_did: []const u8,
-        stored: StoredSession,
-        ctx: anytype,
-    ) !Session {
-        // TODO: Implement fast resumption
-        _ = stored;
-        _ = ctx;
 
-        return Session.new(peer_did, .{});
+    /// Complete an initiated session once the responder accepted it (initiator).
+    /// Returns what to persist for resuming later.
+    pub fn finish(session: *Session, response: *const HandshakeResponse) SessionError!StoredSession {
+        if (session.state != .handshake_initiated) return error.InvalidState;
+        session.state = .established;
+        return .{
+            .peer_did = session.peer_did,
+            .keys = session.keys.?,
+            .created_at = session.created_at,
+            .ticket = response.ticket,
+        };
     }
-    
-    /// Respond to handshake as server
+
+    /// Respond to handshake as server, inline. Prefer `Pool` + `accept` on
+    /// the node loop.
     pub fn respond(
-        request: HandshakeRequest,
+        cache: *resumption.ResumptionCache,
+        prekeys: *const Prekeys,
+        request: *const HandshakeRequest,
+        config: SessionConfig,
+        now: i64,
+    ) !Accepted {
+        const result = perform(prekeys, &.{ .request = request.* });
+        return accept(cache, &result, config, now);
+    }
+
+    /// Turn a polled `Pool` result into a session (responder, node loop).
+    /// Issues the ticket that goes back in the response.
+    pub fn accept(
+        cache: *resumption.ResumptionCache,
+        result: *const Result,
+        config: SessionConfig,
+        now: i64,
+    ) SessionError!Accepted {
+        const keys = result.keys orelse return error.AuthenticationFailed;
+        var accepted = Accepted{
+            .session = Session.new(result.peer_did, config),
+            .response = .{ .ticket = cache.issue(result.peer_did, &keys, now) },
+        };
+        accepted.session.keys = keys;
+        accepted.session.state = .established;
+        return accepted;
+    }
+
+    /// Start resuming a stored session (initiator).
+    /// Fails with ResumptionRejected when there is no usable ticket; fall
+    /// back to `initiate` then.
+    /// `local_did` is the DID the ticket was issued to.
+    pub fn resumeRequest(stored: *const StoredSession, local_did: []const u8, now: i64) SessionError!ResumeRequest {
+        const ticket = stored.ticket orelse return error.ResumptionRejected;
+        if (now >= ticket.expires_at) return error.ResumptionRejected;
+
+        var request = ResumeRequest{ .peer_did = local_did, .ticket_id = ticket.id, .nonce = undefined };
+        std.crypto.random.bytes(&request.nonce);
+        return request;
+    }
+
+    /// Finish resuming once the responder's answer arrived (initiator).
+    /// `stored` takes the resumed keys and the replacement ticket, ready
+    /// for the next resumption.
+    pub fn resumeSession(
+        stored: *StoredSession,
+        request: *const ResumeRequest,
+        response: *const ResumeResponse,
         config: SessionConfig,
-        ctx: anytype,
-    ) !Session {
-        // TODO: Implement PQxdh response
-        _ = request;
-        _ = ctx;
+    ) Session {
+        var secret = resumption.resumptionSecret(&stored.keys);
+        defer std.crypto.secureZero(u8, &secret);
+        var session = Session.new(stored.peer_did, config);
+        session.keys = resumption.deriveKeys(&secret, &request.nonce, &response.nonce, .initiator);
+        session.state = .established;
+        stored.keys = session.keys.?;
+        stored.ticket = response.ticket;
+        return session;
+    }
 
-        return Session.new("", config);
+    /// Accept a resumption request (responder). The ticket is consumed and
+    /// a fresh one, bound to the resumed keys, goes back in the response.
+    /// Fails with ResumptionRejected for unknown, expired or foreign
+    /// tickets; the peer then does a full handshake.
+    pub fn respondResume(
+        cache: *resumption.ResumptionCache,
+        request: *const ResumeRequest,
+        config: SessionConfig,
+        now: i64,
+    ) SessionError!Resumed {
+        var secret = cache.redeem(&request.ticket_id, request.peer_did, now) orelse return error.ResumptionRejected;
+        defer std.crypto.secureZero(u8, &secret);
+
+        var resumed = Resumed{
+            .session = Session.new(request.peer_did, config),
+            .response = .{ .nonce = undefined, .ticket = undefined },
+        };
+        std.crypto.random.bytes(&resumed.response.nonce);
+        const keys = resumption.deriveKeys(&secret, &request.nonce, &resumed.response.nonce, .responder);
+        resumed.session.keys = keys;
+        resumed.session.state = .established;
+        resumed.response.ticket = cache.issue(request.peer_did, &keys, now);
+        return resumed;
     }
 };
 
 /// Incoming handshake request
 pub const HandshakeRequest = struct {
+    /// Initiator's DID
+    peer_did: []const u8,
+    identity_public: [32]u8,
+    message: pqxdh.PQXDHInitialMessage,
+};
+
+/// Responder's answer to a full handshake
+pub const HandshakeResponse = struct {
+    ticket: resumption.Ticket,
+};
+
+/// Initiator side of a full handshake; `request` goes to the peer
+pub const Initiated = struct {
+    session: Session,
+    request: HandshakeRequest,
+};
+
+/// Responder side of a full handshake; `response` goes back to the peer
+pub const Accepted = struct {
+    session: Session,
+    response: HandshakeResponse,
+};
+
+/// Resumption attempt sent instead of a full handshake
+pub const ResumeRequest = struct {
+    /// Initiator's DID
     peer_did: []const u8,
-    ephemeral_pubkey: []const u8,
-    prekey_id: u64,
-    signature: [64]u8,
+    ticket_id: resumption.TicketId,
+    nonce: [resumption.NONCE_LEN]u8,
+};
+
+/// Responder's answer to a resumption
+pub const ResumeResponse = struct {
+    nonce: [resumption.NONCE_LEN]u8,
+    /// Replaces the redeemed ticket
+    ticket: resumption.Ticket,
+};
+
+/// Responder side of a resumed session; `response` goes back to the peer
+pub const Resumed = struct {
+    session: Session,
+    response: ResumeResponse,
 };
 
 /// Stored session for resumption
 const StoredSession = @import("session.zig").StoredSession;
+
+fn responderKeys(prekeys: *const Handshake.Prekeys, request: *const HandshakeRequest) !SessionKeys {
+    var agreed = try pqxdh.responder(
+        prekeys.identity_private,
+        prekeys.signed_prekey_private,
+        prekeys.one_time_prekey_private,
+        prekeys.mlkem_private,
+        request.identity_public,
+        &request.message,
+    );
+    defer std.crypto.secureZero(u8, &agreed.root_key);
+    return sessionKeys(&agreed.root_key, .responder);
+}
+
+/// Directional session keys from the PQxdh root key
+fn sessionKeys(root_key: *const [32]u8, role: resumption.Role) SessionKeys {
+    var okm: [96]u8 = undefined;
+    defer std.crypto.secureZero(u8, &okm);
+    HkdfSha256.expand(&okm, "libertaria l2 session keys", root_key.*);
+    const i2r = okm[0..32].*;
+    const r2i = okm[32..64].*;
+    return .{
+        .enc_key = if (role == .initiator) i2r else r2i,
+        .dec_key = if (role == .initiator) r2i else i2r,
+        .auth_key = okm[64..96].*,
+    };
+}
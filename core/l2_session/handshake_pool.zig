@@ -0,0 +1,177 @@
+//! Asynchronous handshake workers
+//!
+//! Full handshakes (PQxdh with a Kyber KEM) are far more expensive than
+//! anything else the node loop does. They run here instead: the loop
+//! submits jobs to a bounded queue and later collects results from a
+//! bounded completion queue, so handshake CPU never delays established
+//! session traffic.
+//!
+//! Backpressure is explicit. `submit` refuses work when the queue is full
+//! and the caller tells the peer to retry later. Workers stop taking jobs
+//! while the completion queue is full, so a loop that stops polling cannot
+//! make memory grow.
+
+const std = @import("std");
+
+/// Bounded FIFO (not thread-safe; guarded by the pool mutex)
+fn Queue(comptime T: type) type {
+    return struct {
+        const Self = @This();
+
+        items: []T,
+        head: usize = 0,
+        len: usize = 0,
+
+        fn isFull(self: *const Self) bool {
+            return self.len == self.items.len;
+        }
+
+        fn push(self: *Self, item: T) void {
+            std.debug.assert(!self.isFull());
+            self.items[(self.head + self.len) % self.items.len] = item;
+            self.len += 1;
+        }
+
+        fn pop(self: *Self) ?T {
+            if (self.len == 0) return null;
+            const item = self.items[self.head];
+            self.head = (self.head + 1) % self.items.len;
+            self.len -= 1;
+            return item;
+        }
+    };
+}
+
+/// Worker pool running `perform(ctx, job)` for each submitted job
+pub fn HandshakePool(
+    comptime Context: type,
+    comptime Job: type,
+    comptime Result: type,
+    comptime perform: fn (Context, *const Job) Result,
+) type {
+    return struct {
+        const Self = @This();
+
+        allocator: std.mem.Allocator,
+        ctx: Context,
+        threads: []std.Thread,
+
+        mutex: std.Thread.Mutex = .{},
+        /// Signalled when a job is queued or on shutdown
+        work: std.Thread.Condition = .{},
+        /// Signalled when the owner drains completions
+        space: std.Thread.Condition = .{},
+        jobs: Queue(Job),
+        done: Queue(Result),
+        /// Jobs taken by a worker whose result is not yet queued
+        in_flight: usize = 0,
+        running: bool = true,
+
+        /// Jobs refused because the queue was full
+        rejected: u64 = 0,
+
+        /// Start `count` workers with room for `queue_capacity` pending jobs
+        /// and as many unclaimed results.
+        /// Heap-allocated: workers keep a pointer to it.
+        pub fn init(allocator: std.mem.Allocator, ctx: Context, count: usize, queue_capacity: usize) !*Self {
+            std.debug.assert(count > 0 and queue_capacity > 0);
+            const self = try allocator.create(Self);
+            errdefer allocator.destroy(self);
+
+            const jobs = try allocator.alloc(Job, queue_capacity);
+            errdefer allocator.free(jobs);
+            const done = try allocator.alloc(Result, queue_capacity);
+            errdefer allocator.free(done);
+            const threads = try allocator.alloc(std.Thread, count);
+            errdefer allocator.free(threads);
+
+            self.* = .{
+                .allocator = allocator,
+                .ctx = ctx,
+                .threads = threads,
+                .jobs = .{ .items = jobs },
+                .done = .{ .items = done },
+            };
+
+            var started: usize = 0;
+            errdefer self.stopWorkers(threads[0..started]);
+            for (threads) |*thread| {
+                thread.* = try std.Thread.spawn(.{}, workerMain, .{self});
+                started += 1;
+            }
+            return self;
+        }
+
+        /// Stop workers after the job in hand; queued jobs are discarded
+        pub fn deinit(self: *Self) void {
+            self.stopWorkers(self.threads);
+            self.allocator.free(self.threads);
+            self.allocator.free(self.done.items);
+            self.allocator.free(self.jobs.items);
+            self.allocator.destroy(self);
+        }
+
+        /// Queue a job. Returns false (job not taken) when the queue is full.
+        pub fn submit(self: *Self, job: Job) bool {
+            self.mutex.lock();
+            defer self.mutex.unlock();
+            if (self.jobs.isFull()) {
+                self.rejected += 1;
+                return false;
+            }
+            self.jobs.push(job);
+            self.work.signal();
+            return true;
+        }
+
+        /// Move finished results into `out`; returns how many. Never blocks.
+        pub fn poll(self: *Self, out: []Result) usize {
+            self.mutex.lock();
+            defer self.mutex.unlock();
+            var n: usize = 0;
+            while (n < out.len) : (n += 1) {
+                out[n] = self.done.pop() orelse break;
+            }
+            if (n > 0) self.space.broadcast();
+            return n;
+        }
+
+        /// Jobs queued or running
+        pub fn pending(self: *Self) usize {
+            self.mutex.lock();
+            defer self.mutex.unlock();
+            return self.jobs.len + self.in_flight;
+        }
+
+        fn stopWorkers(self: *Self, threads: []std.Thread) void {
+            self.mutex.lock();
+            self.running = false;
+            self.work.broadcast();
+            self.space.broadcast();
+            self.mutex.unlock();
+            for (threads) |thread| thread.join();
+        }
+
+        fn workerMain(self: *Self) void {
+            self.mutex.lock();
+            defer self.mutex.unlock();
+            while (true) {
+                // Only take a job whose result is sure to fit
+                while (self.running and (self.jobs.len == 0 or self.done.len + self.in_flight >= self.done.items.len)) {
+                    if (self.jobs.len == 0) self.work.wait(&self.mutex) else self.space.wait(&self.mutex);
+                }
+                if (!self.running) return;
+
+                const job = self.jobs.pop().?;
+                self.in_flight += 1;
+
+                self.mutex.unlock();
+                const result = perform(self.ctx, &job);
+                self.mutex.lock();
+
+                self.in_flight -= 1;
+                self.done.push(result);
+            }
+        }
+    };
+}
@@ -11,6 +11,8 @@ pub const State = @import("state.zig").State;
 pub const Handshake = @import("handshake.zig").Handshake;
 pub const Heartbeat = @import("heartbeat.zig").Heartbeat;
 pub const KeyRotation = @import("rotation.zig").KeyRotation;
+pub const ResumptionCache = @import("resumption.zig").ResumptionCache;
+pub const HandshakePool = @import("handshake_pool.zig").HandshakePool;
 
 // Re-export core types
 pub const SessionConfig = @import("config.zig").SessionConfig;
@@ -18,4 +20,5 @@ pub const SessionError = @import("error.zig").SessionError;
 
 test {
     std.testing.refAllDecls(@This());
+    _ = @import("test_handshake.zig");
 }
@@ -0,0 +1,155 @@
+//! Session resumption tickets
+//!
+//! After a full PQxdh handshake the responder issues a ticket: a random id
+//! bound to a resumption secret both sides derive from the session keys.
+//! A returning peer presents the id with a fresh nonce and both sides
+//! derive new keys from the secret and the two nonces, skipping the KEM.
+//!
+//! The cache is a fixed ring in issue order plus an id index, so memory
+//! stays bounded during reconnect storms and the oldest ticket is evicted
+//! first. Tickets are single-use: redeeming removes them, and the
+//! responder issues a replacement from the resumed keys.
+
+const std = @import("std");
+const SessionKeys = @import("session.zig").SessionKeys;
+
+const HkdfSha256 = std.crypto.kdf.hkdf.HkdfSha256;
+const Blake2s256 = std.crypto.hash.blake2.Blake2s256;
+
+pub const TICKET_ID_LEN = 16;
+pub const NONCE_LEN = 32;
+
+pub const TicketId = [TICKET_ID_LEN]u8;
+
+/// What the responder sends the peer after a full handshake
+pub const Ticket = struct {
+    id: TicketId,
+    expires_at: i64,
+};
+
+/// Which side of the handshake derived the keys
+pub const Role = enum { initiator, responder };
+
+/// Resumption secret for a session (same on both sides)
+pub fn resumptionSecret(keys: *const SessionKeys) [32]u8 {
+    var secret: [32]u8 = undefined;
+    HkdfSha256.expand(&secret, "libertaria l2 resumption", keys.auth_key);
+    return secret;
+}
+
+/// Fresh session keys from a resumption secret and both nonces
+pub fn deriveKeys(
+    secret: *const [32]u8,
+    initiator_nonce: *const [NONCE_LEN]u8,
+    responder_nonce: *const [NONCE_LEN]u8,
+    role: Role,
+) SessionKeys {
+    var salt: [2 * NONCE_LEN]u8 = undefined;
+    @memcpy(salt[0..NONCE_LEN], initiator_nonce);
+    @memcpy(salt[NONCE_LEN..], responder_nonce);
+    const prk = HkdfSha256.extract(&salt, secret);
+
+    var okm: [96]u8 = undefined;
+    HkdfSha256.expand(&okm, "libertaria l2 resumed keys", prk);
+    const i2r = okm[0..32].*;
+    const r2i = okm[32..64].*;
+    return .{
+        .enc_key = if (role == .initiator) i2r else r2i,
+        .dec_key = if (role == .initiator) r2i else i2r,
+        .auth_key = okm[64..96].*,
+    };
+}
+
+fn peerTag(peer_did: []const u8) [32]u8 {
+    var tag: [32]u8 = undefined;
+    Blake2s256.hash(peer_did, &tag, .{});
+    return tag;
+}
+
+pub const ResumptionCache = struct {
+    const Slot = struct {
+        id: TicketId,
+        peer: [32]u8,
+        secret: [32]u8,
+        expires_at: i64,
+        live: bool,
+    };
+
+    allocator: std.mem.Allocator,
+    lifetime_seconds: i64,
+    /// Ring in issue order; `next` is the slot the next ticket overwrites
+    slots: []Slot,
+    next: usize,
+    index: std.AutoHashMapUnmanaged(TicketId, u32),
+
+    pub fn init(allocator: std.mem.Allocator, capacity: usize, lifetime_seconds: i64) !ResumptionCache {
+        std.debug.assert(capacity > 0 and capacity <= std.math.maxInt(u32));
+        const slots = try allocator.alloc(Slot, capacity);
+        errdefer allocator.free(slots);
+        for (slots) |*slot| slot.live = false;
+
+        var index = std.AutoHashMapUnmanaged(TicketId, u32){};
+        try index.ensureTotalCapacity(allocator, @intCast(capacity));
+
+        return .{
+            .allocator = allocator,
+            .lifetime_seconds = lifetime_seconds,
+            .slots = slots,
+            .next = 0,
+            .index = index,
+        };
+    }
+
+    pub fn deinit(self: *ResumptionCache) void {
+        std.crypto.secureZero(u8, std.mem.sliceAsBytes(self.slots));
+        self.allocator.free(self.slots);
+        self.index.deinit(self.allocator);
+    }
+
+    pub fn count(self: *const ResumptionCache) usize {
+        return self.index.count();
+    }
+
+    /// Issue a ticket for a just-established session, evicting the oldest
+    /// when full. Never allocates.
+    pub fn issue(self: *ResumptionCache, peer_did: []const u8, keys: *const SessionKeys, now: i64) Ticket {
+        const slot_index = self.next;
+        self.next = (self.next + 1) % self.slots.len;
+
+        const slot = &self.slots[slot_index];
+        if (slot.live) _ = self.index.remove(slot.id);
+
+        var id: TicketId = undefined;
+        while (true) {
+            std.crypto.random.bytes(&id);
+            if (!self.index.contains(id)) break;
+        }
+
+        slot.* = .{
+            .id = id,
+            .peer = peerTag(peer_did),
+            .secret = resumptionSecret(keys),
+            .expires_at = now + self.lifetime_seconds,
+            .live = true,
+        };
+        self.index.putAssumeCapacity(id, @intCast(slot_index));
+        return .{ .id = id, .expires_at = slot.expires_at };
+    }
+
+    /// Consume a ticket. Returns its secret if it exists, has not expired
+    /// and was issued to `peer_did`; the ticket is gone either way.
+    pub fn redeem(self: *ResumptionCache, id: *const TicketId, peer_did: []const u8, now: i64) ?[32]u8 {
+        const entry = self.index.fetchRemove(id.*) orelse return null;
+        const slot = &self.slots[entry.value];
+        defer {
+            std.crypto.secureZero(u8, &slot.secret);
+            slot.live = false;
+        }
+
+        if (now >= slot.expires_at) return null;
+        const tag = peerTag(peer_did);
+        if (!std.crypto.timing_safe.eql([32]u8, tag, slot.peer)) return null;
+        const secret = slot.secret;
+        return secret;
+    }
+};
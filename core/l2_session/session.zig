@@ -6,6 +6,7 @@ const std = @import("std");
 const State = @import("state.zig").State;
 const SessionConfig = @import("config.zig").SessionConfig;
 const SessionError = @import("error.zig").SessionError;
+const Ticket = @import("resumption.zig").Ticket;
 
 /// A sovereign session with a peer
 ///
@@ -84,7 +85,7 @@ pub const Session = struct {
 };
 
 /// Session encryption keys (derived from PQxdh)
-const SessionKeys = struct {
+pub const SessionKeys = struct {
     /// Encryption key (ChaCha20-Poly1305)
     enc_key: [32]u8,
     
@@ -100,4 +101,6 @@ pub const StoredSession = struct {
     peer_did: []const u8,
     keys: SessionKeys,
     created_at: i64,
+    /// Resumption ticket issued by the peer, if any
+    ticket: ?Ticket = null,
 };
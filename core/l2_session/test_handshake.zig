@@ -0,0 +1,200 @@
+//! Tests for handshake offload and session resumption
+
+const std = @import("std");
+const testing = std.testing;
+const pqxdh = @import("pqxdh");
+
+const resumption = @import("resumption.zig");
+const Handshake = @import("handshake.zig").Handshake;
+const HandshakePool = @import("handshake_pool.zig").HandshakePool;
+const SessionKeys = @import("session.zig").SessionKeys;
+const StoredSession = @import("session.zig").StoredSession;
+
+test "ResumptionCache issues single-use tickets and evicts the oldest" {
+    const allocator = testing.allocator;
+    var cache = try resumption.ResumptionCache.init(allocator, 2, 600);
+    defer cache.deinit();
+
+    const keys = SessionKeys{ .enc_key = [_]u8{1} ** 32, .dec_key = [_]u8{2} ** 32, .auth_key = [_]u8{3} ** 32 };
+    const t1 = cache.issue("did:a", &keys, 1000);
+    const t2 = cache.issue("did:b", &keys, 1000);
+
+    // Wrong peer burns the ticket
+    try testing.expect(cache.redeem(&t2.id, "did:a", 1001) == null);
+    try testing.expect(cache.redeem(&t2.id, "did:b", 1001) == null);
+
+    const secret = cache.redeem(&t1.id, "did:a", 1001).?;
+    try testing.expectEqualSlices(u8, &resumption.resumptionSecret(&keys), &secret);
+    try testing.expect(cache.redeem(&t1.id, "did:a", 1001) == null);
+
+    // Full ring evicts in issue order; expired tickets are refused
+    const t3 = cache.issue("did:c", &keys, 1000);
+    const t4 = cache.issue("did:d", &keys, 1000);
+    const t5 = cache.issue("did:e", &keys, 1000);
+    try testing.expectEqual(@as(usize, 2), cache.count());
+    try testing.expect(cache.redeem(&t3.id, "did:c", 1001) == null);
+    try testing.expect(cache.redeem(&t4.id, "did:d", 1600) == null);
+    try testing.expect(cache.redeem(&t5.id, "did:e", 1599) != null);
+}
+
+test "Resumed keys agree across roles" {
+    const secret = [_]u8{7} ** 32;
+    const n_i = [_]u8{1} ** resumption.NONCE_LEN;
+    const n_r = [_]u8{2} ** resumption.NONCE_LEN;
+
+    const init_keys = resumption.deriveKeys(&secret, &n_i, &n_r, .initiator);
+    const resp_keys = resumption.deriveKeys(&secret, &n_i, &n_r, .responder);
+    try testing.expectEqualSlices(u8, &init_keys.enc_key, &resp_keys.dec_key);
+    try testing.expectEqualSlices(u8, &init_keys.dec_key, &resp_keys.enc_key);
+    try testing.expectEqualSlices(u8, &init_keys.auth_key, &resp_keys.auth_key);
+
+    // Fresh nonces, fresh keys
+    const other = resumption.deriveKeys(&secret, &n_r, &n_i, .initiator);
+    try testing.expect(!std.mem.eql(u8, &init_keys.enc_key, &other.enc_key));
+}
+
+test "Handshake resumption skips the KEM and matches keys" {
+    const allocator = testing.allocator;
+    var cache = try resumption.ResumptionCache.init(allocator, 8, 3600);
+    defer cache.deinit();
+
+    const keys = SessionKeys{ .enc_key = [_]u8{1} ** 32, .dec_key = [_]u8{2} ** 32, .auth_key = [_]u8{3} ** 32 };
+    const now: i64 = 1000;
+    var stored = StoredSession{ .peer_did = "did:morpheus:peer", .keys = keys, .created_at = now };
+    try testing.expectError(error.ResumptionRejected, Handshake.resumeRequest(&stored, "did:morpheus:self", now));
+
+    // Issued by the responder after the full handshake
+    stored.ticket = cache.issue("did:morpheus:self", &keys, now);
+
+    const request = try Handshake.resumeRequest(&stored, "did:morpheus:self", now + 10);
+    const resumed = try Handshake.respondResume(&cache, &request, .{}, now + 10);
+    const session = Handshake.resumeSession(&stored, &request, &resumed.response, .{});
+
+    try testing.expectEqual(.established, session.state);
+    try testing.expectEqualSlices(u8, &session.keys.?.enc_key, &resumed.session.keys.?.dec_key);
+    try testing.expectEqualSlices(u8, &session.keys.?.dec_key, &resumed.session.keys.?.enc_key);
+    try testing.expect(!std.mem.eql(u8, &session.keys.?.enc_key, &keys.enc_key));
+
+    // Tickets are single-use
+    try testing.expectError(error.ResumptionRejected, Handshake.respondResume(&cache, &request, .{}, now + 11));
+
+    // ...but each resumption hands out the next one: resume again
+    try testing.expectEqualSlices(u8, &resumed.response.ticket.id, &stored.ticket.?.id);
+    const again = try Handshake.resumeRequest(&stored, "did:morpheus:self", now + 20);
+    const resumed_again = try Handshake.respondResume(&cache, &again, .{}, now + 20);
+    const session_again = Handshake.resumeSession(&stored, &again, &resumed_again.response, .{});
+    try testing.expectEqualSlices(u8, &session_again.keys.?.enc_key, &resumed_again.session.keys.?.dec_key);
+    try testing.expect(!std.mem.eql(u8, &session_again.keys.?.enc_key, &session.keys.?.enc_key));
+    try testing.expectEqual(@as(usize, 1), cache.count());
+}
+
+test "HandshakePool completes jobs and applies backpressure" {
+    const allocator = testing.allocator;
+
+    const Gate = struct {
+        open: std.Thread.ResetEvent = .{},
+
+        fn perform(self: *@This(), job: *const u32) u64 {
+            self.open.wait();
+            return @as(u64, job.*) * 2;
+        }
+    };
+    var gate = Gate{};
+
+    const Pool = HandshakePool(*Gate, u32, u64, Gate.perform);
+    const pool = try Pool.init(allocator, &gate, 2, 4);
+    defer pool.deinit();
+
+    // Workers are blocked: at most two jobs in hand, four queued
+    var accepted: u32 = 0;
+    var expected: u64 = 0;
+    var i: u32 = 0;
+    while (i < 16) : (i += 1) {
+        if (pool.submit(i)) {
+            accepted += 1;
+            expected += @as(u64, i) * 2;
+        }
+    }
+    try testing.expect(accepted >= 4 and accepted <= 6);
+    try testing.expectEqual(@as(u64, 16 - accepted), pool.rejected);
+
+    gate.open.set();
+    var results: [8]u64 = undefined;
+    var collected: usize = 0;
+    var sum: u64 = 0;
+    while (collected < accepted) {
+        const n = pool.poll(&results);
+        for (results[0..n]) |r| sum += r;
+        collected += n;
+        if (n == 0) std.Thread.yield() catch {};
+    }
+    try testing.expectEqual(expected, sum);
+    try testing.expectEqual(@as(usize, 0), pool.pending());
+}
+
+fn randomScalar() [32]u8 {
+    var scalar: [32]u8 = undefined;
+    std.crypto.random.bytes(&scalar);
+    return scalar;
+}
+
+test "Full handshake runs on the pool and issues a resumable ticket" {
+    const allocator = testing.allocator;
+    const X25519 = std.crypto.dh.X25519;
+
+    // Responder's bundle and its private halves
+    var seed: [32]u8 = undefined;
+    std.crypto.random.bytes(&seed);
+    const kem = try pqxdh.generateKeypairFromSeed(seed);
+    const prekeys = Handshake.Prekeys{
+        .identity_private = randomScalar(),
+        .signed_prekey_private = randomScalar(),
+        .one_time_prekey_private = randomScalar(),
+        .mlkem_private = kem.secret_key,
+    };
+    const bundle = pqxdh.PrekeyBundle{
+        .identity_key = try X25519.recoverPublicKey(prekeys.identity_private),
+        .signed_prekey_x25519 = try X25519.recoverPublicKey(prekeys.signed_prekey_private),
+        .signed_prekey_signature = [_]u8{0} ** 64,
+        .signed_prekey_mlkem = kem.public_key,
+        .one_time_prekey_x25519 = try X25519.recoverPublicKey(prekeys.one_time_prekey_private),
+        .one_time_prekey_mlkem = kem.public_key,
+    };
+
+    var cache = try resumption.ResumptionCache.init(allocator, 8, 3600);
+    defer cache.deinit();
+    const pool = try Handshake.Pool.init(allocator, &prekeys, 1, 4);
+    defer pool.deinit();
+
+    var initiated = try Handshake.initiate(allocator, "did:morpheus:alice", "did:morpheus:bob", randomScalar(), &bundle, .{});
+    try testing.expectEqual(.handshake_initiated, initiated.session.state);
+    try testing.expect(pool.submit(.{ .request = initiated.request }));
+
+    var results: [1]Handshake.Result = undefined;
+    while (pool.poll(&results) == 0) std.Thread.yield() catch {};
+    const now: i64 = 1000;
+    const accepted = try Handshake.accept(&cache, &results[0], .{}, now);
+    try testing.expectEqualStrings("did:morpheus:alice", accepted.session.peer_did);
+    try testing.expectEqual(@as(usize, 1), cache.count());
+
+    var stored = try Handshake.finish(&initiated.session, &accepted.response);
+    try testing.expectEqual(.established, initiated.session.state);
+    try testing.expectEqualSlices(u8, &initiated.session.keys.?.enc_key, &accepted.session.keys.?.dec_key);
+    try testing.expectEqualSlices(u8, &initiated.session.keys.?.dec_key, &accepted.session.keys.?.enc_key);
+    try testing.expectError(error.InvalidState, Handshake.finish(&initiated.session, &accepted.response));
+
+    // The issued ticket resumes without another KEM
+    try testing.expectEqualStrings("did:morpheus:bob", stored.peer_did);
+    const request = try Handshake.resumeRequest(&stored, "did:morpheus:alice", now + 10);
+    const resumed = try Handshake.respondResume(&cache, &request, .{}, now + 10);
+    const session = Handshake.resumeSession(&stored, &request, &resumed.response, .{});
+    try testing.expectEqualSlices(u8, &session.keys.?.enc_key, &resumed.session.keys.?.dec_key);
+
+    // A degenerate ephemeral key fails on the worker and is refused
+    var forged = try Handshake.initiate(allocator, "did:morpheus:mallory", "did:morpheus:bob", randomScalar(), &bundle, .{});
+    forged.request.message.ephemeral_x25519 = [_]u8{0} ** 32;
+    try testing.expect(pool.submit(.{ .request = forged.request }));
+    while (pool.poll(&results) == 0) std.Thread.yield() catch {};
+    try testing.expect(results[0].keys == null);
+    try testing.expectError(error.AuthenticationFailed, Handshake.accept(&cache, &results[0], .{}, now));
+}
@@ -78,6 +78,13 @@ extern "C" {
         edge: *const QvlRiskEdge,
     ) -> c_int;
     
+    fn qvl_add_trust_edges(
+        ctx: *mut QvlContext,
+        edges: *const QvlRiskEdge,
+        count: usize,
+        out_status: *mut c_int,
+    ) -> c_int;
+
     fn qvl_revoke_trust_edge(
         ctx: *mut QvlContext,
         from: u32,
@@ -272,6 +279,25 @@ impl QvlClient {
         }
     }
     
+    /// Add a batch of trust edges in one FFI call.
+    /// Returns the per-edge status codes (0 = inserted).
+    pub fn add_trust_edges(&self, edges: &[QvlRiskEdge]) -> Result<Vec<i32>, QvlError> {
+        if self.ctx.is_null() {
+            return Err(QvlError::NullContext);
+        }
+
+        let mut status: Vec<c_int> = vec![0; edges.len()];
+        let result = unsafe {
+            qvl_add_trust_edges(self.ctx, edges.as_ptr(), edges.len(), status.as_mut_ptr())
+        };
+
+        if result < 0 {
+            Err(QvlError::MutationFailed)
+        } else {
+            Ok(status)
+        }
+    }
+
     /// Revoke a trust edge
     pub fn revoke_trust_edge(&self, from: u32, to: u32) -> Result<(), QvlError> {
         if self.ctx.is_null() {
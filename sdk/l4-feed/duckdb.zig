@@ -2,61 +2,216 @@ const std = @import("std");
 
 pub const Database = opaque {};
 pub const Connection = opaque {};
-pub const Result = opaque {};
 pub const Appender = opaque {};
+pub const DataChunk = opaque {};
+pub const Vector = opaque {};
 
-pub const State = enum {
-    ok,
-    err,
+pub const State = enum(c_int) {
+    ok = 0,
+    err = 1,
 };
 
-pub extern "c" fn duckdb_open(path: [*c]const u8, out_db: **Database) State;
-pub extern "c" fn duckdb_close(db: *Database) void;
-pub extern "c" fn duckdb_connect(db: *Database, out_con: **Connection) State;
-pub extern "c" fn duckdb_disconnect(con: *Connection) void;
-pub extern "c" fn duckdb_query(con: *Connection, query: [*c]const u8, out_res: ?**Result) State;
+/// Rows per data chunk (DuckDB's STANDARD_VECTOR_SIZE)
+pub const vector_size = 2048;
+
+/// duckdb_result; only ever touched through the C API
+pub const Result = extern struct {
+    deprecated_column_count: u64,
+    deprecated_row_count: u64,
+    deprecated_rows_changed: u64,
+    deprecated_columns: ?*anyopaque,
+    deprecated_error_message: [*c]u8,
+    internal_data: ?*anyopaque,
+};
+
+/// duckdb_string_t: VARCHAR/BLOB vector entry, inlined up to 12 bytes
+pub const StringT = extern union {
+    pointer: extern struct {
+        length: u32,
+        prefix: [4]u8,
+        ptr: [*]const u8,
+    },
+    inlined: extern struct {
+        length: u32,
+        inlined: [12]u8,
+    },
+
+    pub fn bytes(self: *const StringT) []const u8 {
+        const len = self.inlined.length;
+        return if (len <= 12) self.inlined.inlined[0..len] else self.pointer.ptr[0..len];
+    }
+};
+
+pub extern "c" fn duckdb_open(path: [*:0]const u8, out_db: *?*Database) State;
+pub extern "c" fn duckdb_close(db: *?*Database) void;
+pub extern "c" fn duckdb_connect(db: *Database, out_con: *?*Connection) State;
+pub extern "c" fn duckdb_disconnect(con: *?*Connection) void;
+pub extern "c" fn duckdb_query(con: *Connection, query: [*:0]const u8, out_res: ?*Result) State;
 pub extern "c" fn duckdb_destroy_result(res: *Result) void;
 
+pub extern "c" fn duckdb_fetch_chunk(res: Result) ?*DataChunk;
+pub extern "c" fn duckdb_data_chunk_get_size(chunk: *DataChunk) u64;
+pub extern "c" fn duckdb_data_chunk_get_vector(chunk: *DataChunk, col_idx: u64) *Vector;
+pub extern "c" fn duckdb_destroy_data_chunk(chunk: *?*DataChunk) void;
+pub extern "c" fn duckdb_vector_get_data(vector: *Vector) ?*anyopaque;
+pub extern "c" fn duckdb_vector_get_validity(vector: *Vector) ?[*]u64;
+
+pub extern "c" fn duckdb_appender_create(con: *Connection, schema: ?[*:0]const u8, table: [*:0]const u8, out_appender: *?*Appender) State;
+pub extern "c" fn duckdb_appender_flush(appender: *Appender) State;
+pub extern "c" fn duckdb_appender_destroy(appender: *?*Appender) State;
+pub extern "c" fn duckdb_appender_end_row(appender: *Appender) State;
+pub extern "c" fn duckdb_append_int8(appender: *Appender, value: i8) State;
+pub extern "c" fn duckdb_append_int64(appender: *Appender, value: i64) State;
+pub extern "c" fn duckdb_append_uint64(appender: *Appender, value: u64) State;
+pub extern "c" fn duckdb_append_blob(appender: *Appender, data: *const anyopaque, length: u64) State;
+
 pub const DB = struct {
     ptr: *Database,
-    
+
     pub fn open(path: []const u8) !DB {
-        var db: *Database = undefined;
-        const c_path = try std.cstr.addNullByte(std.heap.page_allocator, path);
+        var db: ?*Database = null;
+        const c_path = try std.heap.page_allocator.dupeZ(u8, path);
         defer std.heap.page_allocator.free(c_path);
-        
+
         if (duckdb_open(c_path.ptr, &db) != .ok) {
             return error.DuckDBOpenFailed;
         }
-        return DB{ .ptr = db };
+        return DB{ .ptr = db.? };
     }
-    
+
     pub fn close(self: *DB) void {
-        duckdb_close(self.ptr);
+        var handle: ?*Database = self.ptr;
+        duckdb_close(&handle);
     }
-    
+
     pub fn connect(self: *DB) !Conn {
-        var con: *Connection = undefined;
+        var con: ?*Connection = null;
         if (duckdb_connect(self.ptr, &con) != .ok) {
             return error.DuckDBConnectFailed;
         }
-        return Conn{ .ptr = con };
+        return Conn{ .ptr = con.? };
     }
 };
 
 pub const Conn = struct {
     ptr: *Connection,
-    
+
     pub fn disconnect(self: *Conn) void {
-        duckdb_disconnect(self.ptr);
+        var handle: ?*Connection = self.ptr;
+        duckdb_disconnect(&handle);
     }
-    
+
     pub fn query(self: *Conn, sql: []const u8) !void {
-        const c_sql = try std.cstr.addNullByte(std.heap.page_allocator, sql);
+        const c_sql = try std.heap.page_allocator.dupeZ(u8, sql);
         defer std.heap.page_allocator.free(c_sql);
-        
+
         if (duckdb_query(self.ptr, c_sql.ptr, null) != .ok) {
             return error.DuckDBQueryFailed;
         }
     }
+
+    /// Run a query and read its result chunk by chunk
+    pub fn select(self: *Conn, sql: [:0]const u8) !Rows {
+        var res: Result = undefined;
+        if (duckdb_query(self.ptr, sql.ptr, &res) != .ok) {
+            duckdb_destroy_result(&res);
+            return error.DuckDBQueryFailed;
+        }
+        return Rows{ .res = res };
+    }
+
+    /// Bulk insert into `table` (rows become visible on flush)
+    pub fn appender(self: *Conn, table: [:0]const u8) !TableAppender {
+        var app: ?*Appender = null;
+        if (duckdb_appender_create(self.ptr, null, table.ptr, &app) != .ok) {
+            _ = duckdb_appender_destroy(&app);
+            return error.DuckDBAppenderFailed;
+        }
+        return TableAppender{ .ptr = app.? };
+    }
+};
+
+/// Query result as a stream of data chunks
+pub const Rows = struct {
+    res: Result,
+
+    pub fn deinit(self: *Rows) void {
+        duckdb_destroy_result(&self.res);
+    }
+
+    /// Next chunk (deinit it before the next call), null when exhausted
+    pub fn next(self: *Rows) ?Chunk {
+        const chunk = duckdb_fetch_chunk(self.res) orelse return null;
+        return Chunk{ .ptr = chunk };
+    }
+};
+
+/// Up to `vector_size` rows, stored column by column
+pub const Chunk = struct {
+    ptr: *DataChunk,
+
+    pub fn deinit(self: *Chunk) void {
+        var handle: ?*DataChunk = self.ptr;
+        duckdb_destroy_data_chunk(&handle);
+    }
+
+    pub fn len(self: *const Chunk) usize {
+        return @intCast(duckdb_data_chunk_get_size(self.ptr));
+    }
+
+    /// Raw values of column `col`; `T` must match the column's physical type
+    pub fn column(self: *const Chunk, comptime T: type, col: usize) []const T {
+        const vector = duckdb_data_chunk_get_vector(self.ptr, col);
+        const data = duckdb_vector_get_data(vector) orelse return &.{};
+        const values: [*]const T = @ptrCast(@alignCast(data));
+        return values[0..self.len()];
+    }
+
+    /// NULL mask of column `col` (null = no NULLs in this chunk)
+    pub fn validity(self: *const Chunk, col: usize) ?[*]const u64 {
+        return duckdb_vector_get_validity(duckdb_data_chunk_get_vector(self.ptr, col));
+    }
+};
+
+pub fn isValid(mask: [*]const u64, row: usize) bool {
+    return (mask[row / 64] >> @intCast(row % 64)) & 1 != 0;
+}
+
+pub const TableAppender = struct {
+    ptr: *Appender,
+
+    /// Flush buffered rows and free the appender
+    pub fn close(self: *TableAppender) !void {
+        var handle: ?*Appender = self.ptr;
+        if (duckdb_appender_destroy(&handle) != .ok) return error.DuckDBAppendFailed;
+    }
+
+    /// Write buffered rows to the table
+    pub fn flush(self: *TableAppender) !void {
+        try check(duckdb_appender_flush(self.ptr));
+    }
+
+    pub fn endRow(self: *TableAppender) !void {
+        try check(duckdb_appender_end_row(self.ptr));
+    }
+
+    pub fn appendI8(self: *TableAppender, value: i8) !void {
+        try check(duckdb_append_int8(self.ptr, value));
+    }
+
+    pub fn appendI64(self: *TableAppender, value: i64) !void {
+        try check(duckdb_append_int64(self.ptr, value));
+    }
+
+    pub fn appendU64(self: *TableAppender, value: u64) !void {
+        try check(duckdb_append_uint64(self.ptr, value));
+    }
+
+    pub fn appendBlob(self: *TableAppender, data: []const u8) !void {
+        try check(duckdb_append_blob(self.ptr, data.ptr, data.len));
+    }
+
+    fn check(state: State) !void {
+        if (state != .ok) return error.DuckDBAppendFailed;
+    }
 };
@@ -56,113 +56,190 @@ pub const FeedQuery = struct {
     }
 };
 
+/// When buffered appender rows are written to the table
+pub const IngestConfig = struct {
+    /// Flush once this many rows are buffered
+    flush_rows: usize = 4096,
+    /// Flush once the oldest buffered row is this old (checked on store/poll)
+    flush_interval_ns: u64 = 100 * std.time.ns_per_ms,
+};
+
 /// Hybrid feed storage with DuckDB backend
 pub const FeedStore = struct {
     allocator: std.mem.Allocator,
     db: DB,
     conn: Conn,
+    config: IngestConfig,
+    /// Bulk ingest into `events`; rows are invisible to queries until flushed.
+    /// Null after a failed append or flush until the next store reopens it.
+    appender: ?duckdb.TableAppender,
+    /// Rows in the appender since the last flush
+    pending: usize = 0,
+    /// When the oldest pending row was stored
+    pending_since: i128 = 0,
+    /// Buffered rows thrown away by failed appends or flushes
+    dropped: u64 = 0,
     
     const Self = @This();
     
     /// Initialize FeedStore with DuckDB backend
     pub fn init(allocator: std.mem.Allocator, path: []const u8) !Self {
+        return initWithConfig(allocator, path, .{});
+    }
+    
+    /// Initialize with an explicit ingest flush window
+    pub fn initWithConfig(allocator: std.mem.Allocator, path: []const u8, config: IngestConfig) !Self {
         var db = try DB.open(path);
         errdefer db.close();
         
         var conn = try db.connect();
         errdefer conn.disconnect();
         
-        var self = Self{
+        // Create schema
+        try createSchema(&conn);
+        
+        return Self{
             .allocator = allocator,
             .db = db,
             .conn = conn,
+            .config = config,
+            .appender = try conn.appender("events"),
         };
-        
-        // Create schema
-        try self.createSchema();
-        
-        return self;
     }
     
-    /// Cleanup resources
+    /// Cleanup resources (pending rows are flushed)
     pub fn deinit(self: *Self) void {
+        if (self.appender) |*app| app.close() catch |err| std.log.err("FeedStore: final flush failed: {}", .{err});
         self.conn.disconnect();
         self.db.close();
     }
     
     /// Create database schema
-    fn createSchema(self: *Self) !void {
+    fn createSchema(conn: *Conn) !void {
         const schema_sql = 
             \\CREATE TABLE IF NOT EXISTS events (
             \\    id UBIGINT PRIMARY KEY,
             \\    event_type TINYINT NOT NULL,
-            \\    author BLOB(32) NOT NULL,
+            \\    author BLOB NOT NULL,
             \\    timestamp BIGINT NOT NULL,
-            \\    content_hash BLOB(32) NOT NULL,
+            \\    content_hash BLOB NOT NULL,
             \\    parent_id UBIGINT DEFAULT 0
             \\);
-            
             // Index for timeline queries
-            \\\n            \\CREATE INDEX IF NOT EXISTS idx_author_time 
-            \\    ON events(author, timestamp DESC);
-            
+            \\CREATE INDEX IF NOT EXISTS idx_author_time ON events(author, timestamp);
             // Index for thread reconstruction
-            \\\n            \\CREATE INDEX IF NOT EXISTS idx_parent 
-            \\    ON events(parent_id, timestamp);
-            
+            \\CREATE INDEX IF NOT EXISTS idx_parent ON events(parent_id, timestamp);
             // Index for time-range queries
-            \\\n            \\CREATE INDEX IF NOT EXISTS idx_time 
-            \\    ON events(timestamp DESC);
+            \\CREATE INDEX IF NOT EXISTS idx_time ON events(timestamp);
         ;
         
-        try self.conn.query(schema_sql);
+        try conn.query(schema_sql);
     }
     
-    /// Store single event
+    /// Store single event (buffered; see IngestConfig)
     pub fn store(self: *Self, event: FeedEvent) !void {
-        // TODO: Implement proper prepared statements
-        // For now, skip SQL generation (needs hex encoding fix)
-        _ = event;
-        _ = self;
-        return error.NotImplemented;
+        try self.appendRow(&event);
+        try self.maybeFlush();
+    }
+    
+    /// Store a batch of events through the appender
+    pub fn storeBatch(self: *Self, events: []const FeedEvent) !void {
+        for (events) |*event| try self.appendRow(event);
+        try self.maybeFlush();
     }
     
-    /// Query feed with filters
+    /// error.BatchDropped: the row failed half-way, which leaves the
+    /// appender misaligned, so it and every pending row were discarded
+    fn appendRow(self: *Self, event: *const FeedEvent) !void {
+        if (self.appender == null) self.appender = try self.conn.appender("events");
+        writeRow(&self.appender.?, event) catch {
+            self.dropPending();
+            return error.BatchDropped;
+        };
+        if (self.pending == 0) self.pending_since = std.time.nanoTimestamp();
+        self.pending += 1;
+    }
+
+    fn writeRow(app: *duckdb.TableAppender, event: *const FeedEvent) !void {
+        try app.appendU64(event.id);
+        try app.appendI8(@bitCast(event.event_type));
+        try app.appendBlob(&event.author);
+        try app.appendI64(event.timestamp);
+        try app.appendBlob(&event.content_hash);
+        try app.appendU64(event.parent_id);
+        try app.endRow();
+    }
+
+    /// Destroy the appender with everything it buffered (DuckDB keeps a
+    /// failed chunk and fails every later flush) and count it as dropped;
+    /// the next store opens a fresh appender
+    fn dropPending(self: *Self) void {
+        if (self.appender) |*app| app.close() catch {};
+        self.appender = null;
+        if (self.pending > 0) std.log.err("FeedStore: dropped {d} buffered events", .{self.pending});
+        self.dropped += self.pending;
+        self.pending = 0;
+    }
+    
+    fn maybeFlush(self: *Self) !void {
+        if (self.pending >= self.config.flush_rows or self.windowElapsed()) try self.flush();
+    }
+    
+    fn windowElapsed(self: *const Self) bool {
+        return self.pending > 0 and std.time.nanoTimestamp() - self.pending_since >= self.config.flush_interval_ns;
+    }
+    
+    /// Write buffered events to the table.
+    /// error.BatchDropped: the table rejected the batch (e.g. a duplicate id)
+    /// and all `pending` events were discarded; later stores work again.
+    pub fn flush(self: *Self) !void {
+        if (self.pending == 0) return;
+        self.appender.?.flush() catch {
+            self.dropPending();
+            return error.BatchDropped;
+        };
+        self.pending = 0;
+    }
+    
+    /// Flush if the oldest buffered event is past the flush interval
+    /// (call from an idle timer so quiet feeds still become visible)
+    pub fn poll(self: *Self) !void {
+        if (self.windowElapsed()) try self.flush();
+    }
+    
+    /// Query feed with filters; result is owned by `opts.allocator`
     pub fn query(self: *Self, opts: FeedQuery) ![]FeedEvent {
-        var sql = std.ArrayList(u8).init(self.allocator);
-        defer sql.deinit();
-        
-        try sql.appendSlice("SELECT id, event_type, author, timestamp, content_hash, parent_id FROM events WHERE 1=1");
-        
-        if (opts.author) |author| {
-            _ = author;
-            // TODO: Implement proper hex encoding for SQL
-            // const author_hex = try std.fmt.allocPrint(self.allocator, "...", .{});
-        }
-        
-        if (opts.event_type) |et| {
-            try sql.writer().print(" AND event_type = {d}", .{et.toInt()});
-        }
+        var rows = try self.select(opts);
+        defer rows.deinit();
         
-        if (opts.since) |since| {
-            try sql.writer().print(" AND timestamp >= {d}", .{since});
+        var events = std.ArrayListUnmanaged(FeedEvent){};
+        errdefer events.deinit(opts.allocator);
+        while (rows.next()) |chunk_val| {
+            var chunk = chunk_val;
+            defer chunk.deinit();
+            try decodeChunk(&chunk, try events.addManyAsSlice(opts.allocator, chunk.len()));
         }
+        return events.toOwnedSlice(opts.allocator);
+    }
+    
+    /// Stream a query one chunk (up to duckdb.vector_size events) at a time
+    pub fn cursor(self: *Self, opts: FeedQuery) !FeedCursor {
+        const buf = try opts.allocator.alloc(FeedEvent, duckdb.vector_size);
+        errdefer opts.allocator.free(buf);
+        return FeedCursor{
+            .allocator = opts.allocator,
+            .rows = try self.select(opts),
+            .buf = buf,
+        };
+    }
+    
+    fn select(self: *Self, opts: FeedQuery) !duckdb.Rows {
+        // Read your own writes
+        try self.flush();
         
-        if (opts.until) |until| {
-            try sql.writer().print(" AND timestamp <= {d}", .{until});
-        }
-        
-        if (opts.parent_id) |pid| {
-            try sql.writer().print(" AND parent_id = {d}", .{pid});
-        }
-        
-        try sql.writer().print(" ORDER BY timestamp DESC LIMIT {d} OFFSET {d}", .{opts.limit, opts.offset});
-        
-        // TODO: Execute and parse results
-        // For now, return empty (needs result parsing implementation)
-        try self.conn.query(try sql.toOwnedSlice());
-        
-        return &[_]FeedEvent{};
+        const sql = try buildQuerySql(self.allocator, opts);
+        defer self.allocator.free(sql);
+        return self.conn.select(sql);
     }
     
     /// Get timeline for author (posts + reactions)
@@ -185,12 +262,105 @@ pub const FeedStore = struct {
     
     /// Count events (for metrics/debugging)
     pub fn count(self: *Self) !u64 {
-        // TODO: Implement result parsing
-        _ = self;
-        return 0;
+        try self.flush();
+        var rows = try self.conn.select("SELECT count(*)::UBIGINT FROM events");
+        defer rows.deinit();
+        var chunk = rows.next() orelse return 0;
+        defer chunk.deinit();
+        const counts = chunk.column(u64, 0);
+        return if (counts.len > 0) counts[0] else 0;
     }
 };
 
+/// Streaming query result (see FeedStore.cursor)
+pub const FeedCursor = struct {
+    allocator: std.mem.Allocator,
+    rows: duckdb.Rows,
+    buf: []FeedEvent,
+    
+    pub fn deinit(self: *FeedCursor) void {
+        self.rows.deinit();
+        self.allocator.free(self.buf);
+    }
+    
+    /// Next batch of events, valid until the following call; null at the end
+    pub fn next(self: *FeedCursor) !?[]const FeedEvent {
+        var chunk = self.rows.next() orelse return null;
+        defer chunk.deinit();
+        const out = self.buf[0..chunk.len()];
+        try decodeChunk(&chunk, out);
+        return out;
+    }
+};
+
+/// Column order every feed query selects
+const select_columns = "SELECT id, event_type, author, timestamp, content_hash, parent_id FROM events WHERE 1=1";
+
+fn buildQuerySql(allocator: std.mem.Allocator, opts: FeedQuery) ![:0]u8 {
+    var sql = std.ArrayListUnmanaged(u8){};
+    errdefer sql.deinit(allocator);
+    
+    try sql.appendSlice(allocator, select_columns);
+    
+    if (opts.author) |author| {
+        try sql.appendSlice(allocator, " AND author = '");
+        for (author) |byte| try sql.print(allocator, "\\x{X:0>2}", .{byte});
+        try sql.appendSlice(allocator, "'::BLOB");
+    }
+    
+    if (opts.event_type) |et| {
+        try sql.print(allocator, " AND event_type = {d}", .{et.toInt()});
+    }
+    
+    if (opts.since) |since| {
+        try sql.print(allocator, " AND timestamp >= {d}", .{since});
+    }
+    
+    if (opts.until) |until| {
+        try sql.print(allocator, " AND timestamp <= {d}", .{until});
+    }
+    
+    if (opts.parent_id) |pid| {
+        try sql.print(allocator, " AND parent_id = {d}", .{pid});
+    }
+    
+    try sql.print(allocator, " ORDER BY timestamp DESC LIMIT {d} OFFSET {d}", .{opts.limit, opts.offset});
+    return sql.toOwnedSliceSentinel(allocator, 0);
+}
+
+/// Fill `out` (chunk.len() events) one column at a time, straight from the
+/// chunk's vectors
+fn decodeChunk(chunk: *const duckdb.Chunk, out: []FeedEvent) !void {
+    for (out, chunk.column(u64, 0)) |*event, id| {
+        event.* = .{
+            .id = id,
+            .event_type = 0,
+            .author = undefined,
+            .timestamp = 0,
+            .content_hash = undefined,
+            .parent_id = 0,
+        };
+    }
+    for (out, chunk.column(i8, 1)) |*event, et| event.event_type = @bitCast(et);
+    for (out, chunk.column(duckdb.StringT, 2)) |*event, *blob| try copyHash(&event.author, blob);
+    for (out, chunk.column(i64, 3)) |*event, ts| event.timestamp = ts;
+    for (out, chunk.column(duckdb.StringT, 4)) |*event, *blob| try copyHash(&event.content_hash, blob);
+    
+    // parent_id is the only nullable column (NULL reads as "no parent")
+    const parents = chunk.column(u64, 5);
+    if (chunk.validity(5)) |mask| {
+        for (out, parents, 0..) |*event, pid, row| event.parent_id = if (duckdb.isValid(mask, row)) pid else 0;
+    } else {
+        for (out, parents) |*event, pid| event.parent_id = pid;
+    }
+}
+
+fn copyHash(dest: *[32]u8, blob: *const duckdb.StringT) !void {
+    const bytes = blob.bytes();
+    if (bytes.len != dest.len) return error.CorruptRow;
+    @memcpy(dest, bytes);
+}
+
 // ============================================================================
 // TESTS
 // ============================================================================
@@ -204,8 +374,77 @@ test "EventType conversion" {
     try std.testing.expectEqual(@as(u8, 1), EventType.reaction.toInt());
 }
 
-test "FeedStore init/deinit (requires DuckDB)" {
-    // Skipped if DuckDB not available
-    // var store = try FeedStore.init(std.testing.allocator, ":memory:");
-    // defer store.deinit();
+test "Feed query SQL" {
+    const allocator = std.testing.allocator;
+    var author = [_]u8{0} ** 32;
+    author[0] = 0xAB;
+    author[31] = 0x01;
+
+    const sql = try buildQuerySql(allocator, .{
+        .allocator = allocator,
+        .author = author,
+        .event_type = .post,
+        .since = 100,
+        .limit = 10,
+    });
+    defer allocator.free(sql);
+
+    try std.testing.expect(std.mem.startsWith(u8, sql, select_columns));
+    try std.testing.expect(std.mem.indexOf(u8, sql, " AND author = '\\xAB\\x00") != null);
+    try std.testing.expect(std.mem.indexOf(u8, sql, "\\x01'::BLOB AND event_type = 0 AND timestamp >= 100") != null);
+    try std.testing.expect(std.mem.endsWith(u8, sql, " ORDER BY timestamp DESC LIMIT 10 OFFSET 0"));
+}
+
+test "DuckDB string vector entries" {
+    const short = duckdb.StringT{ .inlined = .{ .length = 3, .inlined = "abc".* ++ [_]u8{0} ** 9 } };
+    try std.testing.expectEqualStrings("abc", short.bytes());
+
+    const hash = [_]u8{7} ** 32;
+    const long = duckdb.StringT{ .pointer = .{ .length = 32, .prefix = hash[0..4].*, .ptr = &hash } };
+    var out: [32]u8 = undefined;
+    try copyHash(&out, &long);
+    try std.testing.expectEqualSlices(u8, &hash, &out);
+    try std.testing.expectError(error.CorruptRow, copyHash(&out, &short));
+}
+
+test "FeedStore drops a rejected batch and keeps ingesting" {
+    const allocator = std.testing.allocator;
+    var store = try FeedStore.initWithConfig(allocator, ":memory:", .{ .flush_rows = 1000, .flush_interval_ns = std.math.maxInt(u64) });
+    defer store.deinit();
+
+    const author = [_]u8{0x5A} ** 32;
+    var event = FeedEvent{
+        .id = 1,
+        .event_type = EventType.post.toInt(),
+        .author = author,
+        .timestamp = 100,
+        .content_hash = [_]u8{1} ** 32,
+        .parent_id = 0,
+    };
+    try store.store(event);
+    try std.testing.expectEqual(@as(u64, 1), try store.count());
+
+    // Duplicate primary key fails the whole batch
+    event.id = 2;
+    event.timestamp = 200;
+    try store.store(event);
+    event.id = 1;
+    try store.store(event);
+    try std.testing.expectError(error.BatchDropped, store.flush());
+    try std.testing.expectEqual(@as(u64, 2), store.dropped);
+    try std.testing.expectEqual(@as(usize, 0), store.pending);
+
+    // A fresh appender takes over
+    event.id = 3;
+    event.timestamp = 300;
+    event.event_type = EventType.reaction.toInt();
+    try store.store(event);
+    const timeline = try store.getTimeline(author, 10);
+    defer allocator.free(timeline);
+    try std.testing.expectEqual(@as(usize, 2), timeline.len);
+    try std.testing.expectEqual(@as(u64, 3), timeline[0].id);
+    try std.testing.expectEqual(EventType.reaction.toInt(), timeline[0].event_type);
+    try std.testing.expectEqual(@as(i64, 300), timeline[0].timestamp);
+    try std.testing.expectEqual(@as(u64, 1), timeline[1].id);
+    try std.testing.expectEqualSlices(u8, &author, &timeline[1].author);
 }